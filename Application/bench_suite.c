@@ -0,0 +1,490 @@
+/**
+ * @file bench_suite.c
+ * @author Embedded Laboratory
+ * @date October 17, 2026
+ * @brief Benchmark Suite, see bench_suite.h.
+ *
+ * Every benchmark times single operations, or a transfer per byte, in
+ * BENCH_SUITE_REPS repetitions. The PS2 benchmarks use the auxiliary port:
+ * its clock is held low so that no device sends, and its data line is driven
+ * by the suite for PS2_State_Machine(). The SSP runs in loop back mode, the
+ * I2C benchmark reads 16 bytes of an EEPROM, every failed transfer is
+ * counted as error. Interrupts stay enabled, min is the undisturbed time.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "bench_suite.h"
+#include "ps2_keyboard.h"
+#include "lcd_16x2.h"
+#include "lpc13xx_gpio.h"
+#include "lpc13xx_uart.h"
+#include "lpc13xx_ssp.h"
+#include "lpc13xx_i2c.h"
+
+#if BENCH_SUITE
+
+#define BENCH_PORT        PS2_PORT_AUX
+#define BENCH_KEYS        8u        /**< Keys per Repetition, fit the Queue. */
+#define BENCH_BYTES       16u       /**< Bytes per Transfer. */
+#define BENCH_LCD_BYTES   32u       /**< LCD Bytes per Repetition. */
+
+#if BENCH_SUITE_NS
+#define BENCH_UNIT        "ns"
+#else
+#define BENCH_UNIT        "cycles"
+#endif
+
+/**
+ * @brief Result of one Benchmark, Times per Operation.
+ */
+typedef struct _Bench_Result_s
+{
+  u32_t ops;        /**< Operations timed. */
+  u32_t min;        /**< Shortest. */
+  u32_t max;        /**< Longest. */
+  u64_t total;      /**< All Operations. */
+  u32_t errors;     /**< Failed Operations. */
+} Bench_Result_s;
+
+// Make Codes of a, s, d, f, j, k, l and space, no two alike in a row
+static const u8_t bench_codes[BENCH_KEYS] =
+{
+  0x1C, 0x1B, 0x23, 0x2B, 0x3B, 0x42, 0x4B, 0x29
+};
+static const u8_t bench_ascii[BENCH_KEYS] =
+{
+  'a', 's', 'd', 'f', 'j', 'k', 'l', ' '
+};
+// UART payload is a line a JSON reader skips
+static const char bench_payload[BENCH_BYTES + 1u] = "# uart payload\r\n";
+
+static u32_t overhead = 0;          // Clock Cycles of an empty Measurement
+static u32_t benches = 0;
+static u32_t total_errors = 0;
+
+static void Bench_Print( const char *line );
+
+#if !BENCH_SUITE_NS
+/**
+ * @brief Time Base of the Suite, DWT Cycle Counter.
+ */
+u32_t Bench_Suite_Clock( void )
+{
+  return DWT->CYCCNT;
+}
+#endif
+
+static void Bench_Reset( Bench_Result_s *r )
+{
+  memset(r, 0, sizeof(*r));
+  r->min = 0xFFFFFFFFu;
+}
+
+/**
+ * @brief Account a Measurement of ops Operations.
+ * @param start Clock when the Measurement started.
+ */
+static void Bench_Time( Bench_Result_s *r, u32_t start, u32_t ops )
+{
+  u32_t time = Bench_Suite_Clock() - start;
+  u32_t per_op;
+  time = ( time > overhead ) ? time - overhead : 0u;
+  per_op = time / ops;
+  if( per_op < r->min )
+    r->min = per_op;
+  if( per_op > r->max )
+    r->max = per_op;
+  r->total += time;
+  r->ops += ops;
+}
+
+/**
+ * @brief Send the JSON Line of a Benchmark.
+ */
+static void Bench_Report( const char *name, const Bench_Result_s *r )
+{
+  char line[160];
+  sprintf(line, "{\"bench\":\"%s\",\"unit\":\"" BENCH_UNIT "\","
+          "\"clock\":\"" BENCH_SUITE_CLOCK "\",\"ops\":%lu,"
+          "\"min\":%lu,\"mean\":%lu,\"max\":%lu,\"errors\":%lu}\r\n", name,
+          (unsigned long)r->ops, (unsigned long)(( r->ops ) ? r->min : 0u),
+          (unsigned long)(( r->ops ) ? r->total / r->ops : 0u),
+          (unsigned long)r->max, (unsigned long)r->errors);
+  Bench_Print(line);
+  benches++;
+  total_errors += r->errors;
+}
+
+/**
+ * @brief Wait until the last Stop Bit is sent.
+ */
+static void Bench_UART_Idle( void )
+{
+  // The THRE interrupt empties the Ring, then the FIFO drains
+  while( UART_TxFree() != UART_TX_RING_SIZE )
+    __WFI();
+  while( UART_CheckBusy() == SET )
+    ;
+}
+
+/**
+ * @brief Send a Line and wait until the UART is idle again.
+ */
+static void Bench_Print( const char *line )
+{
+  UART_Send((uint8_t*)line, strlen(line), BLOCKING);
+  Bench_UART_Idle();
+}
+
+/**
+ * @brief Frame Bit of a Scan Code, Start, 8 Data, odd Parity and Stop.
+ */
+static u8_t Bench_Frame_Bit( u8_t code, u8_t bit )
+{
+  u8_t i, ones = 0;
+  if( bit == 0u )
+    return 0u;
+  if( bit <= 8u )
+    return (code >> (bit - 1u)) & 0x01u;
+  if( bit == 9u )
+  {
+    for( i = 0; i < 8u; i++ )
+      ones += (code >> i) & 0x01u;
+    return ( ones & 0x01u ) ? 0u : 1u;
+  }
+  return 1u;
+}
+
+/**
+ * @brief Receive a Scan Code, all Bits but the Stop Bit.
+ */
+static void Bench_Receive_Head( u8_t code )
+{
+  u8_t bit;
+  for( bit = 0; bit < 10u; bit++ )
+    PS2_Receive_Bit(BENCH_PORT, Bench_Frame_Bit(code, bit));
+}
+
+/**
+ * @brief Data Line of the Benchmark Port, 0 driven low, 1 released.
+ *
+ * DIR is shared with the keyboard port, whose interrupt drives its data line.
+ */
+static void Bench_Data_Line( const PS2_Pins_s *pins, u8_t level )
+{
+  __disable_interrupt();
+  GPIO_SetDir(pins->data_port, pins->data_pin, ( level ) ? 0 : 1);
+  __enable_interrupt();
+}
+
+/**
+ * @brief Stop Bit, the Scan Code is inserted into the Queue.
+ */
+static void Bench_Queue_Put( void )
+{
+  Bench_Result_s r;
+  u32_t rep, i, start;
+  u8_t data;
+  Bench_Reset(&r);
+  for( rep = 0; rep < BENCH_SUITE_REPS; rep++ )
+  {
+    for( i = 0; i < BENCH_KEYS; i++ )
+    {
+      Bench_Receive_Head(bench_codes[i]);
+      start = Bench_Suite_Clock();
+      PS2_Receive_Bit(BENCH_PORT, 1u);
+      Bench_Time(&r, start, 1u);
+    }
+    for( i = 0; i < BENCH_KEYS; i++ )
+    {
+      if( !PS2_Get_Byte(BENCH_PORT, &data) || data != bench_codes[i] )
+        r.errors++;
+    }
+  }
+  Bench_Report("ps2_queue_put", &r);
+}
+
+/**
+ * @brief PS2_Get_Byte() of a queued Scan Code.
+ */
+static void Bench_Queue_Get( void )
+{
+  Bench_Result_s r;
+  u32_t rep, i, start;
+  u8_t data = 0;
+  boolean got;
+  Bench_Reset(&r);
+  for( rep = 0; rep < BENCH_SUITE_REPS; rep++ )
+  {
+    for( i = 0; i < BENCH_KEYS; i++ )
+    {
+      Bench_Receive_Head(bench_codes[i]);
+      PS2_Receive_Bit(BENCH_PORT, 1u);
+    }
+    for( i = 0; i < BENCH_KEYS; i++ )
+    {
+      start = Bench_Suite_Clock();
+      got = PS2_Get_Byte(BENCH_PORT, &data);
+      Bench_Time(&r, start, 1u);
+      if( !got || data != bench_codes[i] )
+        r.errors++;
+    }
+  }
+  Bench_Report("ps2_queue_get", &r);
+}
+
+/**
+ * @brief PS2_State_Machine() per Clock Edge, the Data Line is driven.
+ */
+static void Bench_State_Machine( void )
+{
+  Bench_Result_s r;
+  const PS2_Pins_s *pins = PS2_Get_Pins(BENCH_PORT);
+  u32_t rep, i, start;
+  u8_t bit, data;
+  Bench_Reset(&r);
+  for( rep = 0; rep < BENCH_SUITE_REPS; rep++ )
+  {
+    for( i = 0; i < BENCH_KEYS; i++ )
+    {
+      for( bit = 0; bit < 11u; bit++ )
+      {
+        Bench_Data_Line(pins, Bench_Frame_Bit(bench_codes[i], bit));
+        start = Bench_Suite_Clock();
+        PS2_State_Machine(BENCH_PORT);
+        Bench_Time(&r, start, 1u);
+      }
+    }
+    Bench_Data_Line(pins, 1u);
+    for( i = 0; i < BENCH_KEYS; i++ )
+    {
+      if( !PS2_Get_Byte(BENCH_PORT, &data) || data != bench_codes[i] )
+        r.errors++;
+    }
+  }
+  Bench_Report("ps2_state_machine", &r);
+}
+
+/**
+ * @brief getKey(), Decode_PS2_Key() of a Make or Break Sequence.
+ */
+static void Bench_Decode( void )
+{
+  Bench_Result_s r;
+  u32_t rep, i, start;
+  u8_t key;
+  Bench_Reset(&r);
+  for( rep = 0; rep < BENCH_SUITE_REPS; rep++ )
+  {
+    for( i = 0; i < BENCH_KEYS; i++ )
+    {
+      Bench_Receive_Head(bench_codes[i]);
+      PS2_Receive_Bit(BENCH_PORT, 1u);
+      Bench_Receive_Head(PS2_BREAK);
+      PS2_Receive_Bit(BENCH_PORT, 1u);
+      Bench_Receive_Head(bench_codes[i]);
+      PS2_Receive_Bit(BENCH_PORT, 1u);
+    }
+    for( i = 0; i < 2u * BENCH_KEYS; i++ )
+    {
+      start = Bench_Suite_Clock();
+      key = getKey(BENCH_PORT);
+      Bench_Time(&r, start, 1u);
+      if( key != (( i & 0x01u ) ? 0u : bench_ascii[i / 2u]) )
+        r.errors++;
+    }
+  }
+  Bench_Report("decode_ps2_key", &r);
+}
+
+/**
+ * @brief LCD_Write() into the Command Queue, and written to the LCD.
+ */
+static void Bench_LCD( void )
+{
+  Bench_Result_s queued, written;
+  u32_t rep, i, start;
+  Bench_Reset(&queued);
+  Bench_Reset(&written);
+  for( rep = 0; rep < BENCH_SUITE_REPS; rep++ )
+  {
+    LCD_Cmd(LCD_SECOND_ROW);
+    LCD_Flush();
+    for( i = 0; i < BENCH_LCD_BYTES; i++ )
+    {
+      start = Bench_Suite_Clock();
+      LCD_Write((u8_t)('0' + i % 10u));
+      Bench_Time(&queued, start, 1u);
+    }
+    LCD_Flush();
+    LCD_Cmd(LCD_SECOND_ROW);
+    LCD_Flush();
+    for( i = 0; i < BENCH_LCD_BYTES; i++ )
+    {
+      start = Bench_Suite_Clock();
+      LCD_Write((u8_t)('0' + i % 10u));
+      LCD_Flush();
+      Bench_Time(&written, start, 1u);
+    }
+  }
+  Bench_Report("lcd_write_queued", &queued);
+  Bench_Report("lcd_write_flush", &written);
+}
+
+/**
+ * @brief UART_Send() per Byte into the TX Ring, and until it is on the Line.
+ */
+static void Bench_UART( void )
+{
+  Bench_Result_s ring, line;
+  u32_t rep, start, sent;
+  Bench_Reset(&ring);
+  Bench_Reset(&line);
+  for( rep = 0; rep < BENCH_SUITE_REPS; rep++ )
+  {
+    start = Bench_Suite_Clock();
+    sent = UART_Send((uint8_t*)bench_payload, BENCH_BYTES, NONE_BLOCKING);
+    Bench_Time(&ring, start, BENCH_BYTES);
+    if( sent != BENCH_BYTES )
+      ring.errors++;
+    Bench_UART_Idle();
+    start = Bench_Suite_Clock();
+    sent = UART_Send((uint8_t*)bench_payload, BENCH_BYTES, BLOCKING);
+    Bench_UART_Idle();
+    Bench_Time(&line, start, BENCH_BYTES);
+    if( sent != BENCH_BYTES )
+      line.errors++;
+  }
+  Bench_Report("uart_send", &ring);
+  Bench_Report("uart_send_line", &line);
+}
+
+/**
+ * @brief SSP_ReadWrite() per Byte in Loop Back Mode.
+ */
+static void Bench_SSP( void )
+{
+  Bench_Result_s r;
+  SSP_CFG_Type cfg;
+  SSP_DATA_SETUP_Type xfer;
+  u8_t tx[BENCH_BYTES], rx[BENCH_BYTES];
+  u32_t rep, i, start;
+  int32_t length;
+  Bench_Reset(&r);
+  SSP_ConfigStructInit(&cfg);
+  SSP_Init(LPC_SSP0, &cfg);
+  SSP_LoopBackCmd(LPC_SSP0, ENABLE);
+  SSP_Cmd(LPC_SSP0, ENABLE);
+  for( rep = 0; rep < BENCH_SUITE_REPS; rep++ )
+  {
+    for( i = 0; i < BENCH_BYTES; i++ )
+      tx[i] = (u8_t)(rep * 31u + i);
+    memset(rx, 0, sizeof(rx));
+    xfer.tx_data = tx;
+    xfer.rx_data = rx;
+    xfer.length = BENCH_BYTES;
+    start = Bench_Suite_Clock();
+    length = SSP_ReadWrite(LPC_SSP0, &xfer, SSP_TRANSFER_POLLING);
+    Bench_Time(&r, start, BENCH_BYTES);
+    if( length != (int32_t)BENCH_BYTES || memcmp(tx, rx, BENCH_BYTES) != 0 )
+      r.errors++;
+  }
+  SSP_Cmd(LPC_SSP0, DISABLE);
+  Bench_Report("ssp_readwrite", &r);
+}
+
+/**
+ * @brief I2C_MasterTransferData() of one EEPROM Read in Polling Mode.
+ */
+static void Bench_I2C( void )
+{
+  Bench_Result_s r;
+  I2C_M_SETUP_Type xfer;
+  u8_t address = 0, rx[BENCH_BYTES];
+  u32_t rep, start;
+  Status status;
+  Bench_Reset(&r);
+  I2C_Init(LPC_I2C, 100000u);
+  I2C_Cmd(LPC_I2C, ENABLE);
+  for( rep = 0; rep < BENCH_SUITE_REPS; rep++ )
+  {
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.sl_addr7bit = BENCH_SUITE_I2C_ADDR;
+    xfer.tx_data = &address;
+    xfer.tx_length = 1u;
+    xfer.rx_data = rx;
+    xfer.rx_length = BENCH_BYTES;
+    xfer.retransmissions_max = 3u;
+    start = Bench_Suite_Clock();
+    status = I2C_MasterTransferData(LPC_I2C, &xfer, I2C_TRANSFER_POLLING);
+    Bench_Time(&r, start, 1u);
+    if( status != SUCCESS )
+      r.errors++;
+  }
+  I2C_Cmd(LPC_I2C, DISABLE);
+  Bench_Report("i2c_master_transfer", &r);
+}
+
+/**
+ * @brief Run all Benchmarks.
+ *
+ * The auxiliary PS2 port is taken over, its clock is held low during the PS2
+ * benchmarks and released with the data line afterwards. Returns after the
+ * last line is sent.
+ */
+void Bench_Suite_Run( void )
+{
+  char line[96];
+  const PS2_Pins_s *pins = PS2_Get_Pins(BENCH_PORT);
+  u32_t i, start;
+  Bench_Result_s r;
+#if !BENCH_SUITE_NS
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  UART_Init();
+  UART_SetBaudrate(BENCH_SUITE_BAUDRATE);
+  // Shortest empty Measurement, in case an interrupt hits one of them
+  overhead = 0;
+  Bench_Reset(&r);
+  for( i = 0; i < 16u; i++ )
+  {
+    start = Bench_Suite_Clock();
+    Bench_Time(&r, start, 1u);
+  }
+  overhead = r.min;
+  sprintf(line, "{\"suite\":\"begin\",\"unit\":\"" BENCH_UNIT "\","
+          "\"clock\":\"" BENCH_SUITE_CLOCK "\",\"reps\":%u,"
+          "\"overhead\":%lu}\r\n", (unsigned)BENCH_SUITE_REPS,
+          (unsigned long)overhead);
+  Bench_Print(line);
+
+  // Device on the auxiliary port inhibited, data line free for the suite
+  GPIO_ClearValue(pins->clk_port, pins->clk_pin);
+  __disable_interrupt();
+  GPIO_SetDir(pins->clk_port, pins->clk_pin, 1);
+  __enable_interrupt();
+  GPIO_ClearValue(pins->data_port, pins->data_pin);
+  PS2_Set_Mode(BENCH_PORT, PS2_MODE_KEYBOARD);
+  Bench_Queue_Put();
+  Bench_Queue_Get();
+  Bench_State_Machine();
+  Bench_Decode();
+  Bench_Data_Line(pins, 1u);
+  __disable_interrupt();
+  GPIO_SetDir(pins->clk_port, pins->clk_pin, 0);
+  __enable_interrupt();
+  PS2_Resync(BENCH_PORT);
+
+  Bench_LCD();
+  Bench_UART();
+  Bench_SSP();
+  Bench_I2C();
+  sprintf(line, "{\"suite\":\"end\",\"benches\":%lu,\"errors\":%lu}\r\n",
+          (unsigned long)benches, (unsigned long)total_errors);
+  Bench_Print(line);
+}
+
+#endif /* BENCH_SUITE */
@@ -0,0 +1,67 @@
+/**
+ * @file bench_suite.h
+ * @author Embedded Laboratory
+ * @date October 17, 2026
+ * @brief Benchmark Suite Header File.
+ *
+ * With BENCH_SUITE set to 1 main() runs Bench_Suite_Run() after the
+ * initialization instead of the main loop. The suite times the PS2 scan code
+ * queue, PS2_State_Machine() per clock edge, the scan code decoder, LCD byte
+ * output, UART_Send() and SSP_ReadWrite() and I2C_MasterTransferData() in
+ * polling mode, and sends one JSON line per benchmark over the UART:
+ * @code
+ * {"suite":"begin","unit":"cycles","clock":"dwt","reps":8,"overhead":6}
+ * {"bench":"ps2_state_machine","unit":"cycles","clock":"dwt","ops":704,"min":6,"mean":7,"max":12,"errors":0}
+ * {"suite":"end","benches":10,"errors":0}
+ * @endcode
+ * min, mean and max are per operation, the cost of reading the clock is
+ * taken off. Times are DWT cycles on the board, the host build of the suite
+ * (BENCH_SUITE_NS) provides Bench_Suite_Clock() in nano-seconds. clock
+ * tells where the times come from, "vboard" cycles of the virtual board are
+ * simulated: code between register accesses takes no time there, so they are
+ * not measurements of the firmware.
+ */
+
+#ifndef BENCH_SUITE_H
+#define BENCH_SUITE_H
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Benchmark Image, 0 Disabled, 1 main() runs the Suite */
+#ifndef BENCH_SUITE
+#define BENCH_SUITE             0
+#endif
+
+/* Time Base, 0 DWT Cycles, 1 Bench_Suite_Clock() of the Host in ns */
+#ifndef BENCH_SUITE_NS
+#define BENCH_SUITE_NS          0
+#endif
+
+/* Clock of the Results, "dwt" Board, "host" Host ns, "vboard" simulated */
+#ifndef BENCH_SUITE_CLOCK
+#if BENCH_SUITE_NS
+#define BENCH_SUITE_CLOCK       "host"
+#else
+#define BENCH_SUITE_CLOCK       "dwt"
+#endif
+#endif
+
+#define BENCH_SUITE_REPS        8u      /**< Repetitions of every Benchmark. */
+#define BENCH_SUITE_BAUDRATE    115200u /**< UART Baudrate of the Results. */
+#define BENCH_SUITE_I2C_ADDR    0x50u   /**< EEPROM of the I2C Benchmark. */
+
+// Function Prototypes
+#if BENCH_SUITE
+void Bench_Suite_Run( void );
+u32_t Bench_Suite_Clock( void );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_SUITE_H */
@@ -9,19 +9,38 @@
  */
 
 #include "config.h"
+#include "lpc13xx_timer.h"
+#include "isr_profile.h"
+#include "events.h"
 
 // Private Variable
 static u32_t msTicks = 0;		// Stores milli-second Counter
+static volatile u32_t usHigh = 0;	// Overflows of micro-second Timer
+static volatile u32_t usLast = 0;	// Timer Value at last SysTick
+
+static void Micros_Init( void );
 
 /**
  * @brief SysTick Interrupt Service Routine.
  *
- * SysTick Interrupt is configured to give interrupt every 1msecond.
+ * SysTick Interrupt is configured to give interrupt every 1msecond, it posts
+ * EVENT_TICK so the main loop wakes up for its timers.
  * 
  */
 void SysTick_Handler( void )
 {
+  u32_t now;
+  ISR_PROFILE_ENTER(ISR_PROFILE_SYSTICK);
+  now = MICROS_TIMER->TC;
   msTicks++;
+  // Timer wraps every 71 minutes, it is seen here long before it wraps again
+  if( now < usLast )
+  {
+    usHigh++;
+  }
+  usLast = now;
+  Event_Post(EVENT_TICK);
+  ISR_PROFILE_EXIT(ISR_PROFILE_SYSTICK);
 }
 
 /**
@@ -35,6 +54,8 @@ void InitializeSystem( void )
   u32_t returnCode = 0;
   u32_t SystemFrequency = 72000000ul;
   SystemInit();
+  // Timer must run before SysTick Interrupt reads it
+  Micros_Init();
   returnCode = SysTick_Config(SystemFrequency/1000);	// 1 msec interrupt
   if( returnCode != 0)
   {
@@ -42,6 +63,21 @@ void InitializeSystem( void )
   }
 }
 
+/**
+ * @brief Initialize micro-second Timer.
+ *
+ * 32-Bit Timer1 is prescaled to 1 MHz and runs freely without interrupt, it
+ * is extended to 64 bits by the SysTick Interrupt.
+ */
+static void Micros_Init( void )
+{
+  TIM_TIMERCFG_Type timer_cfg;
+  timer_cfg.PrescaleOption = TIM_PRESCALE_USVAL;
+  timer_cfg.PrescaleValue = 1;
+  TIM_Init(MICROS_TIMER, TIM_TIMER_MODE, &timer_cfg);
+  TIM_Cmd(MICROS_TIMER, ENABLE);
+}
+
 /**
  * @brief Millis.
  *
@@ -54,3 +90,42 @@ u32_t millis( void )
 {
   return msTicks;
 }
+
+/**
+ * @brief Micros.
+ *
+ * Returns the number of micro-seconds since the timer was started, it can be
+ * called from interrupts and is only a register read. This number will
+ * overflow (go back to zero), after approximately 71 minutes, differences of
+ * two values are correct across the overflow.
+ * @return Number of micro-seconds since the program started (#u32_t)
+ */
+u32_t micros( void )
+{
+  return MICROS_TIMER->TC;
+}
+
+/**
+ * @brief Micros, 64 bits.
+ *
+ * Same as micros() but extended with the overflows counted by the SysTick
+ * Interrupt, so it doesn't overflow. Timer wrapped after the last SysTick if
+ * it is now below the value seen by that SysTick.
+ * @return Number of micro-seconds since the program started (#u64_t)
+ */
+u64_t micros64( void )
+{
+  u32_t high, last, now;
+  do
+  {
+    high = usHigh;
+    last = usLast;
+    now = MICROS_TIMER->TC;
+  } while( high != usHigh || last != usLast );
+  if( now < last )
+  {
+    high++;
+  }
+  return ((u64_t)high << 32) | now;
+}
+
@@ -23,8 +23,12 @@
 #define EXT_INT_PORT    0     /**< External Interrupt Port Number. */
 #define EXT_INT_PIN     7     /**< External Interrupt Pin Number. */
 
+#define MICROS_TIMER    LPC_TMR32B1   /**< Free Running micro-second Timer. */
+
 /* Function Prototype */
 void InitializeSystem( void );
 u32_t millis( void );
+u32_t micros( void );
+u64_t micros64( void );
 
 #endif /* _CONFIG_H */
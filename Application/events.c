@@ -0,0 +1,69 @@
+/**
+ * @file events.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Event Flags.
+ *
+ * Pending events are a bit mask written by interrupts of different priority
+ * and cleared by the main loop, every change is done with interrupts disabled.
+ */
+
+#include "events.h"
+#include "lpc13xx_clkpwr.h"
+
+// Private Variable
+static volatile u32_t pending = 0;    // Posted and not yet taken Events
+
+/**
+ * @brief Post Events.
+ *
+ * Can be called from any Interrupt and from the main loop.
+ * @param events Events to post, see EVENT_xxx.
+ */
+void Event_Post( u32_t events )
+{
+  __disable_interrupt();
+  pending |= events;
+  __enable_interrupt();
+}
+
+/**
+ * @brief Take all pending Events.
+ * @return Events, 0 if no event is pending.
+ */
+u32_t Event_Get( void )
+{
+  u32_t events;
+  __disable_interrupt();
+  events = pending;
+  pending = 0;
+  __enable_interrupt();
+  return events;
+}
+
+/**
+ * @brief Wait for Events.
+ *
+ * Sleeps until an Interrupt posts an Event. Pending events are checked with
+ * interrupts disabled and the core goes to sleep in that state, an interrupt
+ * which arrives after the check still wakes it up and runs right after the
+ * interrupts are enabled again, so no event is slept over.
+ * @return Events, never 0.
+ */
+u32_t Event_Wait( void )
+{
+  u32_t events;
+  __disable_interrupt();
+  while( !pending )
+  {
+    // Sleep Mode, peripherals and clocks keep running
+    PMU_Sleep(0, LPC_SYSCON->PDSLEEPCFG);
+    // Let the Interrupt which woke us up run
+    __enable_interrupt();
+    __disable_interrupt();
+  }
+  events = pending;
+  pending = 0;
+  __enable_interrupt();
+  return events;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file events.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Event Flags Header File.
+ *
+ * Interrupts post events, the main loop takes all pending events at once and
+ * sleeps while there is none.
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EVENT_TICK          (1ul << 0)  /**< SysTick, every milli-second. */
+#define EVENT_PS2           (1ul << 1)  /**< PS2 Frame received on any Port. */
+#define EVENT_UART_RX       (1ul << 2)  /**< UART Byte received. */
+#define EVENT_USB           (1ul << 3)  /**< USB Report sent or LEDs received. */
+
+// Function Prototypes
+void Event_Post( u32_t events );
+u32_t Event_Get( void );
+u32_t Event_Wait( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENTS_H */
@@ -0,0 +1,234 @@
+/**
+ * @file isr_profile.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Interrupt Handler Cycle Profiler.
+ *
+ * Handlers may preempt each other, e.g. the PS2 Clock interrupt preempts the
+ * SysTick interrupt which has the lowest priority. Every handler remembers the
+ * nested cycle total at its entry, at its exit the cycles added since then by
+ * preempting handlers are taken off its own count.
+ */
+
+#include <string.h>
+#include "isr_profile.h"
+#include "lpc13xx_uart.h"
+
+#if ISR_PROFILE
+
+/**
+ * @brief Entry of a running Handler.
+ */
+typedef struct _ISR_Profile_Entry_s
+{
+  u32_t start;    /**< Cycle Counter at Entry. */
+  u32_t nested;   /**< nested_cycles at Entry. */
+} ISR_Profile_Entry_s;
+
+static ISR_Profile_Stats_s stats[ISR_PROFILE_HANDLERS];
+static ISR_Profile_Entry_s entries[ISR_PROFILE_HANDLERS];
+static volatile u32_t nested_cycles = 0;  // Cycles of all finished Handlers
+static u32_t overhead = 0;                // Cycles of Enter and Exit itself
+static u64_t reset_us = 0;                // Time of last Reset
+static u8_t dump_item = ISR_PROFILE_HANDLERS + 2u;  // Next Line of Dump
+
+/** Handler Names used in the Dump. */
+static const char* const isr_names[ISR_PROFILE_HANDLERS] = {
+  "pioint3", "pioint0", "systick", "uart", "i2c", "ssp", "usb", "lcd"
+};
+
+static u8_t ISR_Profile_Dump_Line( u8_t item, char *line );
+
+/**
+ * @brief Initialize Profiler.
+ *
+ * Enables the DWT Cycle Counter and measures the cycles taken by an empty
+ * ISR_Profile_Enter()/ISR_Profile_Exit() pair, they are taken off every
+ * invocation. UART is initialized for the dump.
+ */
+void ISR_Profile_Init( void )
+{
+  u8_t i;
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  overhead = 0;
+  ISR_Profile_Reset();
+  // Shortest of a few pairs, in case an interrupt hits one of them
+  for( i = 0; i < 8u; i++ )
+  {
+    ISR_Profile_Enter(ISR_PROFILE_PIOINT3);
+    ISR_Profile_Exit(ISR_PROFILE_PIOINT3);
+  }
+  overhead = stats[ISR_PROFILE_PIOINT3].min_cycles;
+  ISR_Profile_Reset();
+  UART_Init();
+}
+
+/**
+ * @brief Handler Entry, first statement of the Handler.
+ * @param isr Handler, see ISR_Profile_e.
+ */
+void ISR_Profile_Enter( u8_t isr )
+{
+  ISR_Profile_Entry_s *e = &entries[isr];
+  e->nested = nested_cycles;
+  e->start = DWT->CYCCNT;
+}
+
+/**
+ * @brief Handler Exit, last statement of the Handler.
+ * @param isr Handler, see ISR_Profile_e.
+ */
+void ISR_Profile_Exit( u8_t isr )
+{
+  u32_t now = DWT->CYCCNT;
+  ISR_Profile_Entry_s *e = &entries[isr];
+  ISR_Profile_Stats_s *s = &stats[isr];
+  u32_t cycles, own;
+  __disable_interrupt();
+  // Handlers which preempted this one, including their Enter and Exit
+  cycles = (now - e->start) - (nested_cycles - e->nested);
+  own = ( cycles > overhead ) ? (cycles - overhead) : 0;
+  s->count++;
+  s->total_cycles += own;
+  if( own < s->min_cycles )
+  {
+    s->min_cycles = own;
+  }
+  if( own > s->max_cycles )
+  {
+    s->max_cycles = own;
+  }
+  // Rest of this Exit is also taken off the Handler this one preempted
+  nested_cycles += cycles + (DWT->CYCCNT - now);
+  __enable_interrupt();
+}
+
+/**
+ * @brief Clear the Statistics of all Handlers.
+ */
+void ISR_Profile_Reset( void )
+{
+  u8_t i;
+  __disable_interrupt();
+  memset(stats, 0, sizeof(stats));
+  for( i = 0; i < ISR_PROFILE_HANDLERS; i++ )
+  {
+    stats[i].min_cycles = 0xFFFFFFFFul;
+  }
+  reset_us = micros64();
+  __enable_interrupt();
+}
+
+/**
+ * @brief Statistics of a Handler.
+ *
+ * Copied with interrupts disabled, so the fields belong together.
+ * @param isr Handler, see ISR_Profile_e.
+ * @param stats_copy Statistics are copied here.
+ */
+void ISR_Profile_Get( u8_t isr, ISR_Profile_Stats_s *stats_copy )
+{
+  __disable_interrupt();
+  *stats_copy = stats[isr];
+  __enable_interrupt();
+}
+
+/**
+ * @brief Cycles taken off every Invocation for the Profiler itself.
+ */
+u32_t ISR_Profile_Overhead( void )
+{
+  return overhead;
+}
+
+/**
+ * @brief Line of the Dump.
+ * @param item Line Number, BEGIN, one per Handler, END.
+ * @param line Buffer for the Line.
+ * @return Length of Line.
+ */
+static u8_t ISR_Profile_Dump_Line( u8_t item, char *line )
+{
+  int length;
+  u8_t isr = item - 1u;
+  ISR_Profile_Stats_s s;
+  u64_t elapsed;
+  u32_t mean, load;
+  if( item == 0u )
+  {
+    length = sprintf(line, "ISR BEGIN %lu %lu %lu\r\n", (unsigned long)millis(),
+                     (unsigned long)ISR_PROFILE_CPU_HZ,
+                     (unsigned long)overhead);
+  }
+  else if( isr < ISR_PROFILE_HANDLERS )
+  {
+    elapsed = (micros64() - reset_us) * (ISR_PROFILE_CPU_HZ / 1000000ul);
+    ISR_Profile_Get(isr, &s);
+    mean = s.count ? (u32_t)(s.total_cycles / s.count) : 0;
+    load = elapsed ? (u32_t)(s.total_cycles * 1000000ull / elapsed) : 0;
+    length = sprintf(line, "ISR STATS %s %lu %lu %lu %lu %lu\r\n",
+                     isr_names[isr], (unsigned long)s.count,
+                     (unsigned long)(s.count ? s.min_cycles : 0),
+                     (unsigned long)mean, (unsigned long)s.max_cycles,
+                     (unsigned long)load);
+  }
+  else
+  {
+    length = sprintf(line, "ISR END\r\n");
+  }
+  return (u8_t)length;
+}
+
+/**
+ * @brief Dump Handler Statistics.
+ *
+ * Starts a dump, ISR_Profile_Dump_Task() sends it. Statistics are sent as
+ * text over UART, load is the share of the CPU cycles since the last reset in
+ * parts per million:
+ * @code
+ * ISR BEGIN <millis> <cpu_hz> <overhead_cycles>
+ * ISR STATS <name> <count> <min> <mean> <max> <load_ppm>
+ * ISR END
+ * @endcode
+ * Statistics are not cleared, see ISR_Profile_Reset(). A dump in progress is
+ * not restarted.
+ */
+void ISR_Profile_Dump( void )
+{
+  if( dump_item >= ISR_PROFILE_HANDLERS + 2u )
+  {
+    dump_item = 0;
+  }
+}
+
+/**
+ * @brief Send the running Dump.
+ *
+ * Queues as many whole lines as fit in the UART TX ring, the UART interrupt
+ * sends them. Call it from every pass of the main loop.
+ * @return TRUE while the Dump is in progress.
+ */
+boolean ISR_Profile_Dump_Task( void )
+{
+  char line[80];
+  u8_t length;
+  boolean room = TRUE;
+  while( room && (dump_item < ISR_PROFILE_HANDLERS + 2u) )
+  {
+    length = ISR_Profile_Dump_Line(dump_item, line);
+    if( length <= UART_TxFree() )
+    {
+      UART_Send((uint8_t*)line, length, NONE_BLOCKING);
+      dump_item++;
+    }
+    else
+    {
+      room = FALSE;
+    }
+  }
+  return ( dump_item < ISR_PROFILE_HANDLERS + 2u );
+}
+
+#endif /* ISR_PROFILE */
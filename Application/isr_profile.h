@@ -0,0 +1,82 @@
+/**
+ * @file isr_profile.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Interrupt Handler Cycle Profiler Header File.
+ *
+ * Every profiled handler calls ISR_PROFILE_ENTER() first and ISR_PROFILE_EXIT()
+ * last, the cycles in between are counted with the DWT Cycle Counter of the
+ * Cortex-M3. Cycles spent in handlers which preempted the handler are not
+ * counted for it, the exception entry and exit (12 cycles each) are not seen.
+ * With ISR_PROFILE set to 0 the macros are empty.
+ */
+
+#ifndef ISR_PROFILE_H
+#define ISR_PROFILE_H
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Instrumentation, 0 Disabled, 1 Enabled */
+#ifndef ISR_PROFILE
+#define ISR_PROFILE             0
+#endif
+
+#define ISR_PROFILE_CPU_HZ      72000000ul  /**< Core Clock, see InitializeSystem(). */
+#define ISR_PROFILE_DUMP_MS     10000u      /**< Period of Dump in main loop. */
+
+/**
+ * @brief Profiled Interrupt Handlers
+ */
+typedef enum _ISR_Profile_e
+{
+  ISR_PROFILE_PIOINT3 = 0,  /**< PIOINT3_IRQHandler, PS2 Clock Edges. */
+  ISR_PROFILE_PIOINT0,      /**< PIOINT0_IRQHandler, External Interrupt. */
+  ISR_PROFILE_SYSTICK,      /**< SysTick_Handler. */
+  ISR_PROFILE_UART,         /**< UART_IRQHandler. */
+  ISR_PROFILE_I2C,          /**< I2C_StdIntHandler. */
+  ISR_PROFILE_SSP,          /**< SSP_StdIntHandler. */
+  ISR_PROFILE_USB,          /**< USB_IRQHandler. */
+  ISR_PROFILE_LCD,          /**< TIMER16_0_IRQHandler, LCD Command Queue. */
+  ISR_PROFILE_HANDLERS
+} ISR_Profile_e;
+
+/**
+ * @brief Cycle Statistics of one Handler.
+ */
+typedef struct _ISR_Profile_Stats_s
+{
+  u32_t count;        /**< Invocations. */
+  u32_t min_cycles;   /**< Shortest Invocation, 0xFFFFFFFF if none. */
+  u32_t max_cycles;   /**< Longest Invocation. */
+  u64_t total_cycles; /**< Cycles of all Invocations. */
+} ISR_Profile_Stats_s;
+
+// Function Prototypes
+#if ISR_PROFILE
+void ISR_Profile_Init( void );
+void ISR_Profile_Enter( u8_t isr );
+void ISR_Profile_Exit( u8_t isr );
+void ISR_Profile_Reset( void );
+void ISR_Profile_Get( u8_t isr, ISR_Profile_Stats_s *stats );
+u32_t ISR_Profile_Overhead( void );
+void ISR_Profile_Dump( void );
+boolean ISR_Profile_Dump_Task( void );
+#define ISR_PROFILE_ENTER(isr)      ISR_Profile_Enter(isr)
+#define ISR_PROFILE_EXIT(isr)       ISR_Profile_Exit(isr)
+#else
+#define ISR_Profile_Init()          do { } while(0)
+#define ISR_Profile_Dump()          do { } while(0)
+#define ISR_Profile_Dump_Task()     (FALSE)
+#define ISR_PROFILE_ENTER(isr)      do { } while(0)
+#define ISR_PROFILE_EXIT(isr)       do { } while(0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ISR_PROFILE_H */
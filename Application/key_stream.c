@@ -0,0 +1,254 @@
+/**
+ * @file key_stream.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Binary Key Event Stream.
+ *
+ * Events are added to the open frame by the main loop, the frame is sent when
+ * the batching window of its first event has passed or the next record might
+ * not fit. Frames are encoded right into the UART TX ring when its free region
+ * is long enough, otherwise they are copied. A frame which doesn't fit in the
+ * ring is dropped, its sequence number is skipped so the host sees the loss.
+ */
+
+#include <string.h>
+#include "key_stream.h"
+#include "lpc13xx_uart.h"
+
+#if KEY_STREAM
+
+/** CRC-8, Polynomial 0x07, one entry per byte value. */
+static const u8_t crc8_table[256] = {
+  0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+  0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+  0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65,
+  0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+  0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5,
+  0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+  0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85,
+  0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+  0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2,
+  0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+  0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2,
+  0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+  0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32,
+  0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+  0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42,
+  0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+  0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C,
+  0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+  0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC,
+  0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+  0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C,
+  0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+  0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C,
+  0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+  0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B,
+  0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+  0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B,
+  0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+  0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB,
+  0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+  0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB,
+  0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3
+};
+
+static u8_t frame[KEY_STREAM_FRAME_MAX];  // Open Frame, before COBS
+static u8_t frame_length = 0;             // Bytes in Frame, 0 if none open
+static u8_t sequence = 0;                 // Sequence Number of next Frame
+static u8_t last_modifiers = 0;           // Modifiers of previous Record
+static u32_t last_timestamp = 0;          // Start Bit of previous Record
+static u32_t batch_start = 0;             // micros() of first Record
+static Key_Stream_Stats_s stats;
+
+static u8_t Put_Varint( u8_t *out, u32_t value );
+static u8_t COBS_Encode( const u8_t *in, u8_t length, u8_t *out );
+
+/**
+ * @brief Initialize Key Event Stream.
+ *
+ * UART is initialized for the stream, call it after the other UART users.
+ */
+void Key_Stream_Init( void )
+{
+  UART_Init();
+  UART_SetBaudrate(KEY_STREAM_BAUDRATE);
+  memset(&stats, 0, sizeof(stats));
+  frame_length = 0;
+}
+
+/**
+ * @brief Add a Key Event to the Stream.
+ * @param port PS2 Port of the Event, see PS2_PORT_xxx.
+ * @param event Decoded Key Event.
+ */
+void Key_Stream_Event( u8_t port, const PS2_Key_Event_s *event )
+{
+  u8_t *record, length = 2u;
+  u8_t info = (u8_t)((event->flags & ~(KEY_STREAM_MODS | KEY_STREAM_PORT_MASK))
+                     | (port << KEY_STREAM_PORT_SHIFT));
+  u32_t time = event->timestamp - last_timestamp;
+  // Record and CRC must fit
+  if( frame_length + KEY_STREAM_RECORD_MAX + 1u > KEY_STREAM_FRAME_MAX )
+  {
+    Key_Stream_Flush();
+  }
+  if( frame_length == 0u )
+  {
+    // First Record carries Modifiers and absolute Time
+    frame[0] = sequence;
+    frame_length = 1u;
+    batch_start = micros();
+    info |= KEY_STREAM_MODS;
+    time = event->timestamp;
+  }
+  else if( event->modifiers != last_modifiers )
+  {
+    info |= KEY_STREAM_MODS;
+  }
+  record = &frame[frame_length];
+  record[0] = event->keycode;
+  record[1] = info;
+  if( info & KEY_STREAM_MODS )
+  {
+    record[length++] = event->modifiers;
+  }
+  length += Put_Varint(&record[length], time);
+  frame_length += length;
+  last_modifiers = event->modifiers;
+  last_timestamp = event->timestamp;
+  stats.events++;
+  if( KEY_STREAM_WINDOW_US == 0u )
+  {
+    Key_Stream_Flush();
+  }
+}
+
+/**
+ * @brief Send the open Frame once its Batching Window has passed.
+ *
+ * Call it from every pass of the main loop.
+ */
+void Key_Stream_Task( void )
+{
+  if( frame_length && (micros() - batch_start >= KEY_STREAM_WINDOW_US) )
+  {
+    Key_Stream_Flush();
+  }
+}
+
+/**
+ * @brief Send the open Frame now.
+ */
+void Key_Stream_Flush( void )
+{
+  u8_t encoded[KEY_STREAM_ENCODED_MAX];
+  u8_t *out;
+  u8_t length;
+  if( frame_length )
+  {
+    frame[frame_length] = Key_Stream_CRC8(frame, frame_length);
+    frame_length++;
+    // Encode in place if the free region of the TX ring is long enough
+    if( UART_TxSpan(&out) < KEY_STREAM_ENCODED_MAX )
+    {
+      out = encoded;
+    }
+    out[0] = 0x00;
+    length = (u8_t)(COBS_Encode(frame, frame_length, &out[1]) + 1u);
+    out[length++] = 0x00;
+    if( out != encoded )
+    {
+      UART_TxCommit(length);
+    }
+    else if( UART_TxFree() >= length )
+    {
+      UART_Send(encoded, length, NONE_BLOCKING);
+    }
+    else
+    {
+      length = 0;
+      stats.dropped++;
+    }
+    if( length )
+    {
+      stats.frames++;
+      stats.bytes += length;
+    }
+    sequence++;
+    frame_length = 0;
+  }
+}
+
+/**
+ * @brief CRC-8 of the Stream.
+ * @param data Bytes to check.
+ * @param length Number of Bytes.
+ * @return CRC-8, Polynomial 0x07, initial Value 0.
+ */
+u8_t Key_Stream_CRC8( const u8_t *data, u8_t length )
+{
+  u8_t crc = 0;
+  while( length-- )
+  {
+    crc = crc8_table[crc ^ *data++];
+  }
+  return crc;
+}
+
+/**
+ * @brief Stream Statistics.
+ */
+const Key_Stream_Stats_s* Key_Stream_Get_Stats( void )
+{
+  return &stats;
+}
+
+/**
+ * @brief Write a base-128 Varint, low 7 bits first.
+ * @return Number of Bytes written, 1 to 5.
+ */
+static u8_t Put_Varint( u8_t *out, u32_t value )
+{
+  u8_t length = 0;
+  while( value >= 0x80u )
+  {
+    out[length++] = (u8_t)(value | 0x80u);
+    value >>= 7;
+  }
+  out[length++] = (u8_t)value;
+  return length;
+}
+
+/**
+ * @brief COBS Encoding, removes all 0x00 Bytes.
+ *
+ * Every block starts with the offset to the next 0x00, which is left out.
+ * length must be below 255, so no block is longer than 254 bytes.
+ * @param in Bytes to encode.
+ * @param length Number of Bytes.
+ * @param out Encoded Bytes, length + 1.
+ * @return Number of encoded Bytes.
+ */
+static u8_t COBS_Encode( const u8_t *in, u8_t length, u8_t *out )
+{
+  u8_t code_index = 0, code = 1u, n = 1u, i;
+  for( i = 0; i < length; i++ )
+  {
+    if( in[i] == 0x00u )
+    {
+      out[code_index] = code;
+      code_index = n++;
+      code = 1u;
+    }
+    else
+    {
+      out[n++] = in[i];
+      code++;
+    }
+  }
+  out[code_index] = code;
+  return n;
+}
+
+#endif /* KEY_STREAM */
@@ -0,0 +1,91 @@
+/**
+ * @file key_stream.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Binary Key Event Stream Header File.
+ *
+ * Decoded key events of all PS2 ports are sent over UART as binary frames.
+ * Events arriving within KEY_STREAM_WINDOW_US of the first one share a frame.
+ * A frame is COBS encoded and enclosed in 0x00 delimiters:
+ * @code
+ * 0x00 COBS( seq record... crc8 ) 0x00
+ * record: keycode info [modifiers] time
+ * @endcode
+ * seq counts frames, so the receiver finds lost frames. crc8 (polynomial
+ * 0x07, initial 0) covers seq and the records. keycode is the HID usage, info
+ * holds the PS2_EVT_xxx flags, the port and KEY_STREAM_MODS if the modifier
+ * mask follows. time is a little endian base-128 varint: micros() of the
+ * start bit for the first record of a frame, the time since the previous
+ * record otherwise. Host/key_stream_decode decodes the stream.
+ */
+
+#ifndef KEY_STREAM_H
+#define KEY_STREAM_H
+
+#include "config.h"
+#include "ps2_keyboard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Key Event Stream, 0 Disabled, 1 Enabled */
+#ifndef KEY_STREAM
+#define KEY_STREAM            1
+#endif
+
+/* Batching Window, 0 sends every event in its own frame */
+#ifndef KEY_STREAM_WINDOW_US
+#define KEY_STREAM_WINDOW_US  5000u
+#endif
+
+#define KEY_STREAM_BAUDRATE   115200u /**< UART Baudrate of Stream. */
+#define KEY_STREAM_FRAME_MAX  48u     /**< Sequence, Records and CRC. */
+#define KEY_STREAM_RECORD_MAX 8u      /**< Largest Record, 5 byte Time. */
+/** Frame after COBS encoding with both Delimiters. */
+#define KEY_STREAM_ENCODED_MAX  (KEY_STREAM_FRAME_MAX + 3u)
+
+#if KEY_STREAM_FRAME_MAX > 254u
+#error "COBS Encoder supports one block only"
+#endif
+
+/* Record Info Byte, PS2_EVT_xxx Flags with Port and Modifier Bits */
+#define KEY_STREAM_PORT_SHIFT 2u      /**< Port Number Bits 2-3. */
+#define KEY_STREAM_PORT_MASK  0x0Cu   /**< Port Number Mask. */
+#define KEY_STREAM_MODS       0x80u   /**< Modifier Mask follows. */
+
+#if PS2_PORTS > 4u
+#error "Port Number needs more bits in the Record Info Byte"
+#endif
+
+/**
+ * @brief Stream Statistics.
+ */
+typedef struct _Key_Stream_Stats_s
+{
+  u32_t events;         /**< Key Events streamed. */
+  u32_t frames;         /**< Frames queued in UART TX Ring. */
+  u32_t bytes;          /**< Bytes queued in UART TX Ring. */
+  u32_t dropped;        /**< Frames dropped, UART TX Ring full. */
+} Key_Stream_Stats_s;
+
+// Function Prototypes
+#if KEY_STREAM
+void Key_Stream_Init( void );
+void Key_Stream_Event( u8_t port, const PS2_Key_Event_s *event );
+void Key_Stream_Task( void );
+void Key_Stream_Flush( void );
+u8_t Key_Stream_CRC8( const u8_t *data, u8_t length );
+const Key_Stream_Stats_s* Key_Stream_Get_Stats( void );
+#else
+#define Key_Stream_Init()           do { } while(0)
+#define Key_Stream_Event(port, e)   do { } while(0)
+#define Key_Stream_Task()           do { } while(0)
+#define Key_Stream_Flush()          do { } while(0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KEY_STREAM_H */
@@ -0,0 +1,200 @@
+/**
+ * @file latency.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Key Latency Histograms.
+ *
+ * Each stage is written by one context only, LATENCY_FRAME by the PS2
+ * interrupt and the others by the main loop, so recording needs no interrupt
+ * masking. A dump is sent over several passes of the main loop, so it may be
+ * off by the keys recorded in between.
+ */
+
+#include <string.h>
+#include "latency.h"
+#include "lpc13xx_uart.h"
+
+#if LATENCY_TRACE
+
+/** Lines of a Dump: BEGIN, a STAGE line and the buckets per stage, END. */
+#define LATENCY_DUMP_ITEMS    (2u + LATENCY_STAGES * (1u + LATENCY_BUCKETS))
+
+static Latency_Histogram_s histograms[LATENCY_STAGES];
+static u16_t dump_item = LATENCY_DUMP_ITEMS;  // Next Line of running Dump
+
+/** Stage Names used in the Dump. */
+static const char* const stage_names[LATENCY_STAGES] = {
+  "frame", "dequeue", "decode", "sink", "wake", "usb"
+};
+
+static u8_t Latency_Dump_Line( u16_t item, char *line );
+
+/**
+ * @brief Initialize Latency Histograms.
+ *
+ * UART is initialized for the dump, histograms start empty.
+ */
+void Latency_Init( void )
+{
+  UART_Init();
+  UART_SetBaudrate(LATENCY_BAUDRATE);
+}
+
+/**
+ * @brief Bucket of a Time.
+ *
+ * Below 4 us every micro-second has its own bucket, above that every power of
+ * two is split in 4 buckets, so a bucket is at most 25% wide.
+ */
+static u8_t Latency_Bucket( u32_t us )
+{
+  u8_t bucket;
+  u32_t msb;
+  if( us < 4u )
+  {
+    bucket = (u8_t)us;
+  }
+  else if( us >= LATENCY_MAX_US )
+  {
+    bucket = LATENCY_BUCKETS - 1u;
+  }
+  else
+  {
+    msb = 31u - __CLZ(us);
+    bucket = (u8_t)((msb - 1u) * 4u + ((us >> (msb - 2u)) & 0x03u));
+  }
+  return bucket;
+}
+
+/**
+ * @brief Lowest Time of a Bucket.
+ * @param bucket Bucket Index.
+ * @return Time in micro-seconds.
+ */
+u32_t Latency_Bucket_Low( u8_t bucket )
+{
+  u32_t low = bucket;
+  if( bucket >= 4u )
+  {
+    low = (4ul + (bucket & 0x03u)) << (bucket / 4u - 1u);
+  }
+  return low;
+}
+
+/**
+ * @brief Record Latency of a Stage.
+ * @param stage Pipeline Stage, see Latency_Stage_e.
+ * @param start_us Start Bit Time of the Key or Byte, see micros().
+ */
+void Latency_Record( u8_t stage, u32_t start_us )
+{
+  Latency_Histogram_s *h = &histograms[stage];
+  u32_t us = micros() - start_us;
+  h->buckets[Latency_Bucket(us)]++;
+  h->count++;
+  if( us > h->max_us )
+  {
+    h->max_us = us;
+  }
+}
+
+/**
+ * @brief Latency Histogram of a Stage.
+ * @param stage Pipeline Stage, see Latency_Stage_e.
+ * @return Pointer to Histogram.
+ */
+const Latency_Histogram_s* Latency_Get( u8_t stage )
+{
+  return &histograms[stage];
+}
+
+/**
+ * @brief Line of the Dump.
+ * @param item Line Number, see LATENCY_DUMP_ITEMS.
+ * @param line Buffer for the Line.
+ * @return Length of Line, 0 for an empty bucket.
+ */
+static u8_t Latency_Dump_Line( u16_t item, char *line )
+{
+  int length = 0;
+  u8_t stage, bucket;
+  const Latency_Histogram_s *h;
+  if( item == 0u )
+  {
+    length = sprintf(line, "LAT BEGIN %lu\r\n", (unsigned long)millis());
+  }
+  else if( item == LATENCY_DUMP_ITEMS - 1u )
+  {
+    length = sprintf(line, "LAT END\r\n");
+  }
+  else
+  {
+    stage = (u8_t)((item - 1u) / (1u + LATENCY_BUCKETS));
+    bucket = (u8_t)((item - 1u) % (1u + LATENCY_BUCKETS));
+    h = &histograms[stage];
+    if( bucket == 0u )
+    {
+      length = sprintf(line, "LAT STAGE %s %lu %lu\r\n", stage_names[stage],
+                       (unsigned long)h->count, (unsigned long)h->max_us);
+    }
+    else if( h->buckets[bucket - 1u] )
+    {
+      length = sprintf(line, "LAT BUCKET %s %lu %lu\r\n", stage_names[stage],
+                       (unsigned long)Latency_Bucket_Low(bucket - 1u),
+                       (unsigned long)h->buckets[bucket - 1u]);
+    }
+  }
+  return (u8_t)length;
+}
+
+/**
+ * @brief Dump Latency Histograms.
+ *
+ * Starts a dump, Latency_Dump_Task() sends it. Histograms are sent as text
+ * over UART, only buckets with samples are sent:
+ * @code
+ * LAT BEGIN <millis>
+ * LAT STAGE <name> <count> <max_us>
+ * LAT BUCKET <name> <low_us> <count>
+ * LAT END
+ * @endcode
+ * Histograms are not cleared, each dump contains all keys since reset. A dump
+ * in progress is not restarted.
+ */
+void Latency_Dump( void )
+{
+  if( dump_item >= LATENCY_DUMP_ITEMS )
+  {
+    dump_item = 0;
+  }
+}
+
+/**
+ * @brief Send the running Dump.
+ *
+ * Queues as many whole lines as fit in the UART TX ring and returns, the UART
+ * interrupt sends them. Call it from every pass of the main loop.
+ * @return TRUE while the Dump is in progress.
+ */
+boolean Latency_Dump_Task( void )
+{
+  char line[48];
+  u8_t length;
+  boolean room = TRUE;
+  while( room && (dump_item < LATENCY_DUMP_ITEMS) )
+  {
+    length = Latency_Dump_Line(dump_item, line);
+    if( length <= UART_TxFree() )
+    {
+      UART_Send((uint8_t*)line, length, NONE_BLOCKING);
+      dump_item++;
+    }
+    else
+    {
+      room = FALSE;
+    }
+  }
+  return ( dump_item < LATENCY_DUMP_ITEMS );
+}
+
+#endif /* LATENCY_TRACE */
@@ -0,0 +1,76 @@
+/**
+ * @file latency.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Key Latency Histograms Header File.
+ *
+ * Every key is stamped with the micros() time of the Start Bit of its first
+ * byte. At each stage of the pipeline the time since that Start Bit is added
+ * to a log bucketed histogram of the stage. Histograms are dumped over UART
+ * as text, Host/latency_report turns a dump into percentiles.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Instrumentation, 0 Disabled, 1 Enabled */
+#ifndef LATENCY_TRACE
+#define LATENCY_TRACE         1
+#endif
+
+/* Histogram Buckets, 4 per power of two, below 4 us one per micro-second */
+#define LATENCY_MAX_US        (1ul << 21)   /**< Larger Times go in last Bucket. */
+#define LATENCY_BUCKETS       80u     /**< Buckets below LATENCY_MAX_US. */
+#define LATENCY_DUMP_MS       10000u  /**< Period of Dump in main loop. */
+#define LATENCY_BAUDRATE      115200u /**< UART Baudrate of Dump. */
+
+/**
+ * @brief Pipeline Stages
+ */
+typedef enum _Latency_Stage_e
+{
+  LATENCY_FRAME = 0,    /**< Stop Bit of byte received (ISR). */
+  LATENCY_DEQUEUE,      /**< Byte taken from Queue by main loop. */
+  LATENCY_DECODE,       /**< Key Event complete. */
+  LATENCY_SINK,         /**< Key written to LCD. */
+  LATENCY_WAKE,         /**< First Frame after Deep-Sleep, from Wake-Up. */
+  LATENCY_USB,          /**< Key Report written to USB Endpoint. */
+  LATENCY_STAGES
+} Latency_Stage_e;
+
+/**
+ * @brief Latency Histogram of one Stage.
+ */
+typedef struct _Latency_Histogram_s
+{
+  u32_t count;                        /**< Samples in Histogram. */
+  u32_t max_us;                       /**< Largest Sample. */
+  u32_t buckets[LATENCY_BUCKETS];     /**< Samples per Bucket. */
+} Latency_Histogram_s;
+
+// Function Prototypes
+#if LATENCY_TRACE
+void Latency_Init( void );
+void Latency_Record( u8_t stage, u32_t start_us );
+u32_t Latency_Bucket_Low( u8_t bucket );
+const Latency_Histogram_s* Latency_Get( u8_t stage );
+void Latency_Dump( void );
+boolean Latency_Dump_Task( void );
+#else
+#define Latency_Init()              do { } while(0)
+#define Latency_Record(stage, t)    do { } while(0)
+#define Latency_Dump()              do { } while(0)
+#define Latency_Dump_Task()         (FALSE)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCY_H */
@@ -7,26 +7,63 @@
 
 #include "lcd_16x2.h"
 
+#define LCD_QUEUE_DATA        0x100u  /**< Queue Entry is a Character, RS=1.*/
+#define LCD_PULSE_LOOPS       8u      /**< EN high for more than 450 ns.*/
+
+/** Port Pins of a Byte on the Data Lines. */
+#define LCD_BUS(b)    ( (((b) & 0x01u) ? (1u << LCD_D0) : 0u) | \
+                        (((b) & 0x02u) ? (1u << LCD_D1) : 0u) | \
+                        (((b) & 0x04u) ? (1u << LCD_D2) : 0u) | \
+                        (((b) & 0x08u) ? (1u << LCD_D3) : 0u) | \
+                        (((b) & 0x10u) ? (1u << LCD_D4) : 0u) | \
+                        (((b) & 0x20u) ? (1u << LCD_D5) : 0u) | \
+                        (((b) & 0x40u) ? (1u << LCD_D6) : 0u) | \
+                        (((b) & 0x80u) ? (1u << LCD_D7) : 0u) )
+#define LCD_BUS4(b)   LCD_BUS(b), LCD_BUS((b) + 1u), LCD_BUS((b) + 2u), \
+                      LCD_BUS((b) + 3u)
+#define LCD_BUS16(b)  LCD_BUS4(b), LCD_BUS4((b) + 4u), LCD_BUS4((b) + 8u), \
+                      LCD_BUS4((b) + 12u)
+
+/** Port Pattern of every Byte, computed by the compiler from the Pin Map. */
+static const u16_t lcd_bus_pattern[256] =
+{
+  LCD_BUS16(0x00u), LCD_BUS16(0x10u), LCD_BUS16(0x20u), LCD_BUS16(0x30u),
+  LCD_BUS16(0x40u), LCD_BUS16(0x50u), LCD_BUS16(0x60u), LCD_BUS16(0x70u),
+  LCD_BUS16(0x80u), LCD_BUS16(0x90u), LCD_BUS16(0xA0u), LCD_BUS16(0xB0u),
+  LCD_BUS16(0xC0u), LCD_BUS16(0xD0u), LCD_BUS16(0xE0u), LCD_BUS16(0xF0u)
+};
+
+static volatile u16_t lcd_queue[LCD_QUEUE_SIZE];
+static volatile u8_t lcd_head = 0;        /**< Written by main loop. */
+static volatile u8_t lcd_tail = 0;        /**< Written by Timer Interrupt. */
+static volatile boolean lcd_idle = TRUE;  /**< Timer stopped, LCD ready. */
+static LCD_Stats_s stats = {0, 0, 0, 0};
+
 /* Private Function Prototype*/
-static void lcd_delay_ms( u32_t ms );
+static void lcd_delay_pulse( void );
+static void LCD_Enqueue( u16_t entry );
+static void LCD_Next( void );
+static void LCD_Bus_Write( u16_t entry );
+static void LCD_Data_Dir( u8_t dir );
+#if LCD_BUSY_POLL
+static boolean LCD_Read_Busy( void );
+#endif
 
 /**
  * @brief Initialize 16x2 LCD Module.
  *
- * Initialize 16x2 LCD Module in 8-bit mode.
+ * Initialize 16x2 LCD Module in 8-bit mode. The initialization commands are
+ * queued behind the power on delay of the timer, the function doesn't wait.
  * 
  */
 void LCD_Init(void)
 {
+  TIM_TIMERCFG_Type timer_cfg;
+  TIM_MATCHCFG_Type match_cfg;
+
   // Set LCD Pins as Output Pins
-  GPIO_SetDir( LCD_DATA_PORT, LCD_D0, 1);
-  GPIO_SetDir( LCD_DATA_PORT, LCD_D1, 1);
-  GPIO_SetDir( LCD_DATA_PORT, LCD_D2, 1);
-  GPIO_SetDir( LCD_DATA_PORT, LCD_D3, 1);
-  GPIO_SetDir( LCD_DATA_PORT, LCD_D4, 1);
-  GPIO_SetDir( LCD_DATA_PORT, LCD_D5, 1);
-  GPIO_SetDir( LCD_DATA_PORT, LCD_D6, 1);
-  GPIO_SetDir( LCD_DATA_PORT, LCD_D7, 1);
+  LCD_DATA_GPIO->MASKED_ACCESS[LCD_DATA_MASK] = 0;
+  LCD_Data_Dir(1);
   
   LPC_IOCON->R_PIO1_0 |= 0x1;
   LPC_IOCON->R_PIO1_1 |= 0x1;
@@ -37,30 +74,33 @@ void LCD_Init(void)
   
   GPIO_SetDir( LCD_BACKLIT_PORT, LCD_BACKLIT_PIN, 1);
   
-  // Clear Values
-  GPIO_ClearValue( LCD_DATA_PORT, LCD_D0);
-  GPIO_ClearValue( LCD_DATA_PORT, LCD_D1);
-  GPIO_ClearValue( LCD_DATA_PORT, LCD_D2);
-  GPIO_ClearValue( LCD_DATA_PORT, LCD_D3);
-  GPIO_ClearValue( LCD_DATA_PORT, LCD_D4);
-  GPIO_ClearValue( LCD_DATA_PORT, LCD_D5);
-  GPIO_ClearValue( LCD_DATA_PORT, LCD_D6);
-  GPIO_ClearValue( LCD_DATA_PORT, LCD_D7);
+  // Clear Values, EN idles low and latches on its falling edge
   GPIO_ClearValue( LCD_RS_PORT, LCD_RS);
   GPIO_ClearValue( LCD_RW_PORT, LCD_RW);
   GPIO_ClearValue( LCD_EN_PORT, LCD_EN);
   GPIO_ClearValue(LCD_BACKLIT_PORT,LCD_BACKLIT_PIN);
+
+  // One-Shot Timer in micro-seconds, the match stops and resets it
+  lcd_head = 0;
+  lcd_tail = 0;
+  lcd_idle = FALSE;
+  timer_cfg.PrescaleOption = TIM_PRESCALE_USVAL;
+  timer_cfg.PrescaleValue = 1;
+  TIM_Init(LCD_TIMER, TIM_TIMER_MODE, &timer_cfg);
+  match_cfg.MatchChannel = 0;
+  match_cfg.IntOnMatch = ENABLE;
+  match_cfg.StopOnMatch = ENABLE;
+  match_cfg.ResetOnMatch = ENABLE;
+  match_cfg.ExtMatchOutputType = TIM_EM_NOTHING;
+  match_cfg.MatchValue = LCD_POWER_ON_US;
+  TIM_ConfigMatch(LCD_TIMER, &match_cfg);
+  NVIC_EnableIRQ(LCD_TIMER_IRQn);
+  TIM_Cmd(LCD_TIMER, ENABLE);
+
   LCD_Cmd(LCD_16x2_INIT);
-  lcd_delay_ms(10u);
-  lcd_delay_ms(10u);
-  LCD_Cmd(LCD_DISP_ON_CUR_ON);
-  lcd_delay_ms(10u);
   LCD_Cmd(LCD_DISP_ON_CUR_OFF);
-  lcd_delay_ms(10u);
   LCD_Cmd(LCD_CLEAR);
-  lcd_delay_ms(10u);
   LCD_Cmd(LCD_FIRST_ROW);
-  lcd_delay_ms(20u);
 }
 
 /**
@@ -70,30 +110,12 @@ void LCD_Init(void)
  * <b>LCD_16x2_INIT,LCD_DISP_ON_CUR_ON,LCD_DISP_ON_CUR_OFF,LCD_DISP_ON_CUR_BLNK,
  * LCD_FIRST_ROW,LCD_SECOND_ROW,LCD_CLEAR</b>.
  * @param command Command to Send to the LCD.
+ * @note Command is queued, waits only if the queue is full.
  */
 void LCD_Cmd(u8_t command)
 {
-  CHECK_BIT(command, 0u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D0):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D0);
-  CHECK_BIT(command, 1u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D1):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D1);
-  CHECK_BIT(command, 2u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D2):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D2);
-  CHECK_BIT(command, 3u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D3):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D3);
-  CHECK_BIT(command, 4u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D4):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D4);
-  CHECK_BIT(command, 5u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D5):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D5);
-  CHECK_BIT(command, 6u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D6):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D6);
-  CHECK_BIT(command, 7u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D7):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D7);
-  GPIO_ClearValue( LCD_RS_PORT,LCD_RS);
-  GPIO_ClearValue( LCD_RW_PORT,LCD_RW);
-  GPIO_ClearValue( LCD_EN_PORT,LCD_EN);
-  lcd_delay_ms(1);
-  GPIO_SetValue( LCD_EN_PORT,LCD_EN);
+  stats.commands++;
+  LCD_Enqueue(command);
 }
 
 /**
@@ -101,30 +123,12 @@ void LCD_Cmd(u8_t command)
  *
  * Write Data on LCD, specified as arguments.
  * @param Data Data to Write on LCD.
+ * @note Data is queued, waits only if the queue is full.
  */
 void LCD_Write(u8_t Data)
 {
-  CHECK_BIT(Data, 0u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D0):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D0);
-  CHECK_BIT(Data, 1u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D1):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D1);
-  CHECK_BIT(Data, 2u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D2):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D2);
-  CHECK_BIT(Data, 3u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D3):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D3);
-  CHECK_BIT(Data, 4u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D4):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D4);
-  CHECK_BIT(Data, 5u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D5):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D5);
-  CHECK_BIT(Data, 6u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D6):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D6);
-  CHECK_BIT(Data, 7u) ? GPIO_SetValue( LCD_DATA_PORT,LCD_D7):
-    GPIO_ClearValue( LCD_DATA_PORT,LCD_D7);
-  GPIO_SetValue( LCD_RS_PORT,LCD_RS);
-  GPIO_ClearValue( LCD_RW_PORT,LCD_RW);
-  GPIO_ClearValue( LCD_EN_PORT,LCD_EN);
-  lcd_delay_ms(1);
-  GPIO_SetValue( LCD_EN_PORT,LCD_EN);
+  stats.characters++;
+  LCD_Enqueue(LCD_QUEUE_DATA | Data);
 }
 
 /**
@@ -165,16 +169,188 @@ void LCD_BackLight_Off( void )
 }
 
 /**
- * @brief Delay For LCD.
+ * @brief LCD Idle.
  *
- * @warning Note Accurate, approximate.
+ * @return TRUE if the queue is empty and the last command is executed.
+ */
+boolean IS_LCD_Idle( void )
+{
+  return ( lcd_idle && lcd_head == lcd_tail );
+}
+
+/**
+ * @brief Wait for LCD.
+ *
+ * Waits until all queued commands are executed, e.g. before the LCD or its
+ * timer is powered down.
+ */
+void LCD_Flush( void )
+{
+  // Every queued entry ends with a timer interrupt
+  while( !IS_LCD_Idle() )
+    __WFI();
+}
+
+/**
+ * @brief LCD Command Queue Statistics.
+ */
+const LCD_Stats_s* LCD_Get_Stats( void )
+{
+  return &stats;
+}
+
+/**
+ * @brief LCD Timer Interrupt.
+ *
+ * The execution time of the last command has passed, the next one is written
+ * to the LCD. Call it from the interrupt handler of LCD_TIMER.
  */
-static void lcd_delay_ms( u32_t ms )
+void LCD_Timer_IRQHandler( void )
 {
-  u32_t i,j = 0;
-  for(i=0;i<=ms;i++)
+  if( TIM_GetIntStatus(LCD_TIMER, TIM_MR0_INT) )
   {
-    for(j=0;j<6000u;j++)
-      ;
+    TIM_ClearIntPending(LCD_TIMER, TIM_MR0_INT);
+    LCD_Next();
   }
 }
+
+/**
+ * @brief Put a Command or Character in the Queue.
+ *
+ * Waits for the timer interrupt to make room if the queue is full, must not
+ * be called from an interrupt of the same or higher priority. An idle LCD is
+ * written right away, then the timer takes over.
+ * @param entry Command, or Character with LCD_QUEUE_DATA.
+ */
+static void LCD_Enqueue( u16_t entry )
+{
+  if( (u8_t)(lcd_head - lcd_tail) >= LCD_QUEUE_SIZE )
+  {
+    stats.full_waits++;
+    while( (u8_t)(lcd_head - lcd_tail) >= LCD_QUEUE_SIZE )
+      __WFI();
+  }
+  lcd_queue[lcd_head & (LCD_QUEUE_SIZE - 1u)] = entry;
+  __DMB();
+  lcd_head++;
+  NVIC_DisableIRQ(LCD_TIMER_IRQn);
+  if( lcd_idle )
+  {
+    LCD_Next();
+  }
+  NVIC_EnableIRQ(LCD_TIMER_IRQn);
+}
+
+/**
+ * @brief Write next Queue Entry.
+ *
+ * Runs in the timer interrupt, or with it disabled when the LCD is idle. The
+ * timer is started for the execution time of the entry, clear and home take
+ * 1.52 ms, all others 37 us plus 4 us for characters at the typical 270 kHz
+ * oscillator. Without busy flag the times of the slowest oscillator (190 kHz)
+ * are used.
+ */
+static void LCD_Next( void )
+{
+  u16_t entry;
+  boolean busy = FALSE;
+#if LCD_BUSY_POLL
+  // The typical time has passed, the busy flag tells if the LCD is done
+  busy = ( !lcd_idle && LCD_Read_Busy() );
+#endif
+  if( busy )
+  {
+    stats.busy_polls++;
+    LCD_TIMER->MR0 = LCD_POLL_US;
+    LCD_TIMER->TCR = TIM_ENABLE;
+  }
+  else if( lcd_tail != lcd_head )
+  {
+    entry = lcd_queue[lcd_tail & (LCD_QUEUE_SIZE - 1u)];
+    lcd_tail++;
+    lcd_idle = FALSE;
+    LCD_Bus_Write(entry);
+    if( entry <= LCD_RETURN_HOME + 1u )
+      LCD_TIMER->MR0 = LCD_HOME_US;
+    else
+      LCD_TIMER->MR0 = LCD_EXEC_US;
+    LCD_TIMER->TCR = TIM_ENABLE;
+  }
+  else
+  {
+    lcd_idle = TRUE;
+  }
+}
+
+/**
+ * @brief Write Command or Character on the LCD Bus.
+ *
+ * @param entry Command, or Character with LCD_QUEUE_DATA.
+ */
+static void LCD_Bus_Write( u16_t entry )
+{
+  // All Data Lines change with one store, the other pins of the port not
+  LCD_DATA_GPIO->MASKED_ACCESS[LCD_DATA_MASK] = lcd_bus_pattern[entry & 0xFFu];
+  ( entry & LCD_QUEUE_DATA ) ? GPIO_SetValue( LCD_RS_PORT,LCD_RS):
+    GPIO_ClearValue( LCD_RS_PORT,LCD_RS);
+  GPIO_ClearValue( LCD_RW_PORT,LCD_RW);
+  GPIO_SetValue( LCD_EN_PORT,LCD_EN);
+  lcd_delay_pulse();
+  GPIO_ClearValue( LCD_EN_PORT,LCD_EN);
+}
+
+#if LCD_BUSY_POLL
+/**
+ * @brief Read Busy Flag.
+ *
+ * Data Lines are inputs while RW is high, the busy flag is D7.
+ * @return TRUE if the LCD still executes the last command.
+ */
+static boolean LCD_Read_Busy( void )
+{
+  boolean busy;
+  LCD_Data_Dir(0);
+  GPIO_ClearValue( LCD_RS_PORT,LCD_RS);
+  GPIO_SetValue( LCD_RW_PORT,LCD_RW);
+  GPIO_SetValue( LCD_EN_PORT,LCD_EN);
+  lcd_delay_pulse();
+  busy = ( GPIO_ReadValue(LCD_DATA_PORT) & (1u << LCD_D7) ) ? TRUE : FALSE;
+  GPIO_ClearValue( LCD_EN_PORT,LCD_EN);
+  GPIO_ClearValue( LCD_RW_PORT,LCD_RW);
+  LCD_Data_Dir(1);
+  return busy;
+}
+#endif
+
+/**
+ * @brief Set Direction of the Data Lines.
+ *
+ * The PS2 interrupts drive their data pins with the direction register of
+ * the same port, hence interrupts are disabled while it is changed.
+ * @param dir 1 Output, 0 Input.
+ */
+static void LCD_Data_Dir( u8_t dir )
+{
+  __disable_interrupt();
+  if( dir )
+  {
+    LCD_DATA_GPIO->DIR |= LCD_DATA_MASK;
+  }
+  else
+  {
+    LCD_DATA_GPIO->DIR &= ~LCD_DATA_MASK;
+  }
+  __enable_interrupt();
+}
+
+/**
+ * @brief Delay For LCD Enable Pulse.
+ *
+ * @warning Note Accurate, approximate.
+ */
+static void lcd_delay_pulse( void )
+{
+  volatile u8_t i;
+  for( i = 0; i < LCD_PULSE_LOOPS; i++ )
+    ;
+}
@@ -3,12 +3,20 @@
  * @author Embedded Laboratory
  * @date May 12, 2016
  * @brief LCD Functions.
+ *
+ * Commands and characters are not written to the LCD by the caller, they go
+ * into a command queue which is drained by the match interrupt of LCD_TIMER.
+ * After every instruction the timer waits for the HD44780 execution time, or
+ * with LCD_BUSY_POLL set to 1 the busy flag is read back over the RW pin, so
+ * LCD_Cmd() and LCD_Write() return immediately. Only a full queue makes the
+ * caller wait.
  */
 
 #ifndef LCD_16x2_H
 #define	LCD_16x2_H
 
 #include "config.h"
+#include "lpc13xx_timer.h"
 
 #ifdef	__cplusplus
 extern "C"
@@ -24,6 +32,12 @@ extern "C"
 #define LCD_D6                9     /**< LCD Data Line6.*/
 #define LCD_D7                10    /**< LCD Data Line7.*/
 #define LCD_DATA_PORT         PORT2 /**< LCD Data Lines Direction.*/
+#define LCD_DATA_GPIO         LPC_GPIO2 /**< Registers of LCD_DATA_PORT.*/
+/** Pins of the Data Lines, written at once through the masked access. */
+#define LCD_DATA_MASK         ((1u << LCD_D0) | (1u << LCD_D1) | \
+                               (1u << LCD_D2) | (1u << LCD_D3) | \
+                               (1u << LCD_D4) | (1u << LCD_D5) | \
+                               (1u << LCD_D6) | (1u << LCD_D7))
   
 #define LCD_RS                2     /**< LCD RS Pin.*/
 #define LCD_RW                1     /**< LCD RW Pin.*/
@@ -43,6 +57,40 @@ extern "C"
 #define LCD_FIRST_ROW         0x80    /**< Move Pointer to First Row.*/
 #define LCD_SECOND_ROW        0xC0    /**< Move Pointer to Second Row.*/
 #define LCD_CLEAR             0x01    /**< Clear LCD Display.*/
+#define LCD_RETURN_HOME       0x02    /**< Move Pointer and Display Home.*/
+
+/* Busy Flag, 0 waits the Execution Times, 1 polls the Busy Flag on D7 */
+#ifndef LCD_BUSY_POLL
+#define LCD_BUSY_POLL         0
+#endif
+
+#define LCD_TIMER             LPC_TMR16B0     /**< Timer of Command Queue.*/
+#define LCD_TIMER_IRQn        TIMER_16_0_IRQn /**< Interrupt of LCD_TIMER.*/
+#define LCD_QUEUE_SIZE        64u     /**< Queued Commands and Characters.*/
+#define LCD_POWER_ON_US       40000u  /**< Wait after Power On.*/
+#define LCD_POLL_US           10u     /**< Busy Flag Poll Interval.*/
+#if LCD_BUSY_POLL
+#define LCD_EXEC_US           41u     /**< Instruction or Data, typical.*/
+#define LCD_HOME_US           1520u   /**< Clear and Home, typical.*/
+#else
+#define LCD_EXEC_US           64u     /**< Instruction or Data, slowest.*/
+#define LCD_HOME_US           2200u   /**< Clear and Home, slowest.*/
+#endif
+
+#if (LCD_QUEUE_SIZE & (LCD_QUEUE_SIZE - 1u)) || LCD_QUEUE_SIZE > 128u
+#error "LCD_QUEUE_SIZE must be a power of two up to 128"
+#endif
+
+/**
+ * @brief LCD Command Queue Statistics.
+ */
+typedef struct _LCD_Stats_s
+{
+  u32_t commands;       /**< Commands queued. */
+  u32_t characters;     /**< Characters queued. */
+  u32_t full_waits;     /**< Callers which waited for a full Queue. */
+  u32_t busy_polls;     /**< Busy Flag reads which found the LCD busy. */
+} LCD_Stats_s;
 
 /* LCD Function Prototypes */
 void LCD_Init(void);
@@ -51,6 +99,10 @@ void LCD_Write(u8_t Data);
 void LCD_Write_Text(u8_t *msg);
 void LCD_BackLight_On( void );
 void LCD_BackLight_Off( void );
+boolean IS_LCD_Idle( void );
+void LCD_Flush( void );
+const LCD_Stats_s* LCD_Get_Stats( void );
+void LCD_Timer_IRQHandler( void );
 
 #ifdef	__cplusplus
 }
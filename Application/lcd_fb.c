@@ -0,0 +1,247 @@
+/**
+ * @file lcd_fb.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief LCD Shadow Framebuffer.
+ *
+ * Two copies of the screen are kept: the shadow written by the application
+ * and the front, the content the LCD shows once the queued commands are
+ * executed. LCD_FB_Flush() queues the differences in address order and
+ * copies them to the front, so every cell is sent at most once per change.
+ * Latin-1 characters are mapped to LCD character codes by the glyph cache
+ * (lcd_glyph.c), the front keeps the codes written, so a cell whose glyph
+ * moved to another slot or fell back to ASCII is rewritten too.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "lcd_fb.h"
+#include "lcd_16x2.h"
+#include "lcd_glyph.h"
+
+#define LCD_FB_ADDRESS_UNKNOWN  0xFFu   /**< LCD Address not known. */
+
+static char shadow[LCD_FB_ROWS][LCD_FB_COLUMNS];      // Written by Application
+static char front[LCD_FB_ROWS][LCD_FB_COLUMNS];       // Shadow of last Flush
+static u8_t front_code[LCD_FB_ROWS][LCD_FB_COLUMNS];  // Codes in DDRAM
+static u8_t cursor_row = 0;                     // Next Cell of LCD_FB_Putc
+static u8_t cursor_column = 0;
+static u8_t lcd_address = LCD_FB_ADDRESS_UNKNOWN;     // DDRAM Address of LCD
+static u8_t show_address = LCD_FB_ADDRESS_UNKNOWN;    // Cell of LCD Cursor
+static boolean lcd_cursor = FALSE;                    // LCD Cursor is On
+static LCD_FB_Stats_s stats;
+
+/**
+ * @brief Initialize Framebuffer.
+ *
+ * Call it after LCD_Init(), both copies start blank like the cleared LCD.
+ */
+void LCD_FB_Init( void )
+{
+  memset(shadow, ' ', sizeof(shadow));
+  memset(front, ' ', sizeof(front));
+  memset(front_code, ' ', sizeof(front_code));
+  memset(&stats, 0, sizeof(stats));
+  LCD_Glyph_Init();
+  cursor_row = 0;
+  cursor_column = 0;
+  lcd_address = LCD_FB_ADDRESS_UNKNOWN;
+  show_address = LCD_FB_ADDRESS_UNKNOWN;
+  lcd_cursor = FALSE;
+}
+
+/**
+ * @brief Clear Framebuffer.
+ *
+ * Shadow is filled with spaces and the cursor goes home, nothing is sent to
+ * the LCD before LCD_FB_Flush().
+ */
+void LCD_FB_Clear( void )
+{
+  memset(shadow, ' ', sizeof(shadow));
+  cursor_row = 0;
+  cursor_column = 0;
+}
+
+/**
+ * @brief Move Cursor of the Framebuffer.
+ *
+ * @param row Row, 0 or 1.
+ * @param column Column, 0 to 15.
+ */
+void LCD_FB_Goto( u8_t row, u8_t column )
+{
+  cursor_row = row % LCD_FB_ROWS;
+  cursor_column = ( column < LCD_FB_COLUMNS ) ? column : LCD_FB_COLUMNS - 1u;
+}
+
+/**
+ * @brief Put Character into Framebuffer.
+ *
+ * '\n' goes to the start of the next row, '\r' to the start of the row. A
+ * character after the last column wraps to the next row, after the last row
+ * to the first one.
+ * @param c Latin-1 Character.
+ */
+void LCD_FB_Putc( char c )
+{
+  if( c == '\n' )
+  {
+    cursor_row = (cursor_row + 1u) % LCD_FB_ROWS;
+    cursor_column = 0;
+  }
+  else if( c == '\r' )
+  {
+    cursor_column = 0;
+  }
+  else
+  {
+    if( cursor_column >= LCD_FB_COLUMNS )
+    {
+      cursor_row = (cursor_row + 1u) % LCD_FB_ROWS;
+      cursor_column = 0;
+    }
+    shadow[cursor_row][cursor_column] = c;
+    cursor_column++;
+  }
+}
+
+/**
+ * @brief Put String into Framebuffer.
+ *
+ * @param text String terminated by NULL Character.
+ */
+void LCD_FB_Puts( const char *text )
+{
+  while( *text )
+  {
+    LCD_FB_Putc(*text);
+    text++;
+  }
+}
+
+/**
+ * @brief Formatted Output into Framebuffer.
+ *
+ * Output is cut after one screen of characters.
+ * @param format printf Format String.
+ */
+void LCD_FB_Printf( const char *format, ... )
+{
+  char text[LCD_FB_ROWS * LCD_FB_COLUMNS + 1u];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  LCD_FB_Puts(text);
+}
+
+/**
+ * @brief Show the Cursor of the LCD on a Cell.
+ *
+ * The cursor is placed by the next LCD_FB_Flush(), it is independent of the
+ * cursor of LCD_FB_Putc().
+ * @param row Row, 0 or 1.
+ * @param column Column, 0 to 15.
+ */
+void LCD_FB_Cursor( u8_t row, u8_t column )
+{
+  row = row % LCD_FB_ROWS;
+  column = ( column < LCD_FB_COLUMNS ) ? column : LCD_FB_COLUMNS - 1u;
+  show_address = (u8_t)(row * LCD_FB_ROW_ADDRESS + column);
+}
+
+/**
+ * @brief Hide the Cursor of the LCD with the next LCD_FB_Flush().
+ */
+void LCD_FB_Cursor_Off( void )
+{
+  show_address = LCD_FB_ADDRESS_UNKNOWN;
+}
+
+/**
+ * @brief Send Changes to the LCD.
+ *
+ * The character codes of the new screen are looked up first, glyphs missing
+ * in CGRAM are uploaded then. Cells whose code changed are queued in address
+ * order, a cursor move only where the address of the LCD doesn't already
+ * point to the cell. The LCD cursor is switched and moved last, the address
+ * of the LCD is where it is shown.
+ */
+void LCD_FB_Flush( void )
+{
+  u8_t code[LCD_FB_ROWS][LCD_FB_COLUMNS];
+  u8_t row, column, address;
+  boolean uploaded = FALSE, changed = FALSE, show;
+  if( memcmp(shadow, front, sizeof(shadow)) != 0 )
+  {
+    // Glyphs kept for this screen before any is replaced
+    LCD_Glyph_Begin();
+    for( row = 0; row < LCD_FB_ROWS; row++ )
+    {
+      for( column = 0; column < LCD_FB_COLUMNS; column++ )
+      {
+        LCD_Glyph_Touch((u8_t)shadow[row][column]);
+      }
+    }
+    for( row = 0; row < LCD_FB_ROWS; row++ )
+    {
+      for( column = 0; column < LCD_FB_COLUMNS; column++ )
+      {
+        code[row][column] = LCD_Glyph_Code((u8_t)shadow[row][column],
+                                           &uploaded);
+      }
+    }
+    if( uploaded )
+    {
+      lcd_address = LCD_FB_ADDRESS_UNKNOWN;
+    }
+    for( row = 0; row < LCD_FB_ROWS; row++ )
+    {
+      for( column = 0; column < LCD_FB_COLUMNS; column++ )
+      {
+        if( code[row][column] != front_code[row][column] )
+        {
+          address = (u8_t)(row * LCD_FB_ROW_ADDRESS + column);
+          if( address != lcd_address )
+          {
+            LCD_Cmd(LCD_FIRST_ROW | address);
+            stats.moves++;
+          }
+          LCD_Write(code[row][column]);
+          front_code[row][column] = code[row][column];
+          // The LCD increments its address after every character
+          lcd_address = address + 1u;
+          stats.writes++;
+          changed = TRUE;
+        }
+      }
+    }
+    memcpy(front, shadow, sizeof(front));
+  }
+  show = ( show_address != LCD_FB_ADDRESS_UNKNOWN ) ? TRUE : FALSE;
+  if( show != lcd_cursor )
+  {
+    lcd_cursor = show;
+    LCD_Cmd(lcd_cursor ? LCD_DISP_ON_CUR_ON : LCD_DISP_ON_CUR_OFF);
+  }
+  if( lcd_cursor && show_address != lcd_address )
+  {
+    LCD_Cmd(LCD_FIRST_ROW | show_address);
+    lcd_address = show_address;
+    stats.moves++;
+  }
+  if( changed )
+  {
+    stats.flushes++;
+  }
+}
+
+/**
+ * @brief Framebuffer Statistics.
+ */
+const LCD_FB_Stats_s* LCD_FB_Get_Stats( void )
+{
+  return &stats;
+}
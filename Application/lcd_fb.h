@@ -0,0 +1,55 @@
+/**
+ * @file lcd_fb.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief LCD Shadow Framebuffer Header File.
+ *
+ * Text is written into a 2x16 shadow of the LCD, LCD_FB_Flush() compares it
+ * with what the LCD shows and queues only the changed cells. A cursor move
+ * is queued only where a changed cell is not at the address the LCD already
+ * points to, runs of changed cells use the auto-increment of the address.
+ * LCD_CLEAR is never used, a cleared shadow flushes as spaces over the old
+ * text. The cursor of the LCD is shown on a cell with LCD_FB_Cursor(), it is
+ * moved there after the changed cells.
+ */
+
+#ifndef LCD_FB_H
+#define LCD_FB_H
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LCD_FB_ROWS           2u      /**< Rows of the LCD. */
+#define LCD_FB_COLUMNS        16u     /**< Characters per Row. */
+#define LCD_FB_ROW_ADDRESS    0x40u   /**< DDRAM Address of second Row. */
+
+/**
+ * @brief Framebuffer Statistics, Bus Cycles queued by LCD_FB_Flush().
+ */
+typedef struct _LCD_FB_Stats_s
+{
+  u32_t flushes;        /**< Flushes with at least one changed Cell. */
+  u32_t moves;          /**< Cursor Moves queued. */
+  u32_t writes;         /**< Characters queued. */
+} LCD_FB_Stats_s;
+
+// Function Prototypes
+void LCD_FB_Init( void );
+void LCD_FB_Clear( void );
+void LCD_FB_Goto( u8_t row, u8_t column );
+void LCD_FB_Putc( char c );
+void LCD_FB_Puts( const char *text );
+void LCD_FB_Printf( const char *format, ... );
+void LCD_FB_Cursor( u8_t row, u8_t column );
+void LCD_FB_Cursor_Off( void );
+void LCD_FB_Flush( void );
+const LCD_FB_Stats_s* LCD_FB_Get_Stats( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LCD_FB_H */
@@ -0,0 +1,311 @@
+/**
+ * @file lcd_glyph.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief LCD Custom Glyph Cache.
+ *
+ * Every slot remembers the update of the screen it was last shown on. A
+ * screen update first touches the glyphs already in CGRAM, so a miss can
+ * only evict a slot which is not on the new screen: the one shown longest
+ * ago. The upload is queued before the cells are written, so it doesn't
+ * delay the cells using the slot.
+ */
+
+#include "lcd_glyph.h"
+#include "lcd_16x2.h"
+
+/** 5x8 Glyphs of Latin-1 0xA0 to 0xFF, one byte per row, bit 4 left. */
+static const u8_t lcd_glyph_font[LCD_GLYPH_FONT_SIZE][8] = {
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xA0 no-break, ROM
+  { 0x04, 0x00, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 }, // 0xA1 inverted !
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xA2 cent, ROM
+  { 0x06, 0x09, 0x08, 0x1C, 0x08, 0x09, 0x16, 0x00 }, // 0xA3 pound
+  { 0x00, 0x11, 0x0E, 0x0A, 0x0E, 0x11, 0x00, 0x00 }, // 0xA4 currency
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xA5 yen, ROM
+  { 0x04, 0x04, 0x04, 0x00, 0x04, 0x04, 0x04, 0x00 }, // 0xA6 broken bar
+  { 0x0E, 0x10, 0x0E, 0x11, 0x0E, 0x01, 0x0E, 0x00 }, // 0xA7 section
+  { 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xA8 diaeresis
+  { 0x0E, 0x11, 0x16, 0x14, 0x16, 0x11, 0x0E, 0x00 }, // 0xA9 copyright
+  { 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00, 0x1F, 0x00 }, // 0xAA feminine ordinal
+  { 0x00, 0x05, 0x0A, 0x14, 0x0A, 0x05, 0x00, 0x00 }, // 0xAB left guillemet
+  { 0x00, 0x00, 0x1F, 0x01, 0x01, 0x00, 0x00, 0x00 }, // 0xAC not
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xAD soft hyphen, ROM
+  { 0x0E, 0x11, 0x16, 0x16, 0x15, 0x11, 0x0E, 0x00 }, // 0xAE registered
+  { 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xAF macron
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xB0 degree, ROM
+  { 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00, 0x1F, 0x00 }, // 0xB1 plus-minus
+  { 0x0C, 0x12, 0x04, 0x08, 0x1E, 0x00, 0x00, 0x00 }, // 0xB2 superscript 2
+  { 0x1C, 0x02, 0x0C, 0x02, 0x1C, 0x00, 0x00, 0x00 }, // 0xB3 superscript 3
+  { 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xB4 acute
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xB5 micro, ROM
+  { 0x0F, 0x1D, 0x1D, 0x0D, 0x05, 0x05, 0x05, 0x00 }, // 0xB6 pilcrow
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xB7 middle dot, ROM
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x0C }, // 0xB8 cedilla
+  { 0x08, 0x18, 0x08, 0x08, 0x1C, 0x00, 0x00, 0x00 }, // 0xB9 superscript 1
+  { 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x1F, 0x00 }, // 0xBA masculine ordinal
+  { 0x00, 0x14, 0x0A, 0x05, 0x0A, 0x14, 0x00, 0x00 }, // 0xBB right guillemet
+  { 0x10, 0x10, 0x12, 0x16, 0x0A, 0x0F, 0x02, 0x00 }, // 0xBC one quarter
+  { 0x10, 0x10, 0x10, 0x16, 0x01, 0x02, 0x07, 0x00 }, // 0xBD one half
+  { 0x18, 0x08, 0x1A, 0x0E, 0x1A, 0x07, 0x02, 0x00 }, // 0xBE three quarters
+  { 0x04, 0x00, 0x04, 0x08, 0x10, 0x11, 0x0E, 0x00 }, // 0xBF inverted ?
+  { 0x08, 0x04, 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // 0xC0 A grave
+  { 0x02, 0x04, 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // 0xC1 A acute
+  { 0x04, 0x0A, 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // 0xC2 A circ
+  { 0x0D, 0x16, 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // 0xC3 A tilde
+  { 0x0A, 0x00, 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // 0xC4 A diaer
+  { 0x0E, 0x0A, 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // 0xC5 A ring
+  { 0x0F, 0x14, 0x14, 0x1E, 0x14, 0x14, 0x17, 0x00 }, // 0xC6 AE
+  { 0x0E, 0x11, 0x10, 0x10, 0x11, 0x0E, 0x04, 0x0C }, // 0xC7 C cedilla
+  { 0x08, 0x04, 0x1F, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // 0xC8 E grave
+  { 0x02, 0x04, 0x1F, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // 0xC9 E acute
+  { 0x04, 0x0A, 0x1F, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // 0xCA E circ
+  { 0x0A, 0x00, 0x1F, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // 0xCB E diaer
+  { 0x08, 0x04, 0x0E, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 0xCC I grave
+  { 0x02, 0x04, 0x0E, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 0xCD I acute
+  { 0x04, 0x0A, 0x0E, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 0xCE I circ
+  { 0x0A, 0x00, 0x0E, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 0xCF I diaer
+  { 0x1C, 0x12, 0x11, 0x1D, 0x11, 0x12, 0x1C, 0x00 }, // 0xD0 Eth
+  { 0x0D, 0x16, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // 0xD1 N tilde
+  { 0x08, 0x04, 0x0E, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 0xD2 O grave
+  { 0x02, 0x04, 0x0E, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 0xD3 O acute
+  { 0x04, 0x0A, 0x0E, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 0xD4 O circ
+  { 0x0D, 0x16, 0x0E, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 0xD5 O tilde
+  { 0x0A, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 0xD6 O diaer
+  { 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x00, 0x00 }, // 0xD7 multiplication
+  { 0x0E, 0x13, 0x15, 0x15, 0x15, 0x19, 0x0E, 0x00 }, // 0xD8 O stroke
+  { 0x08, 0x04, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 0xD9 U grave
+  { 0x02, 0x04, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 0xDA U acute
+  { 0x04, 0x0A, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 0xDB U circ
+  { 0x0A, 0x00, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 0xDC U diaer
+  { 0x02, 0x04, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, // 0xDD Y acute
+  { 0x10, 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x00 }, // 0xDE Thorn
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xDF sharp s, ROM
+  { 0x08, 0x04, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00 }, // 0xE0 a grave
+  { 0x02, 0x04, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00 }, // 0xE1 a acute
+  { 0x04, 0x0A, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00 }, // 0xE2 a circ
+  { 0x0D, 0x16, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00 }, // 0xE3 a tilde
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xE4 a diaer, ROM
+  { 0x0E, 0x0A, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00 }, // 0xE5 a ring
+  { 0x00, 0x00, 0x1A, 0x05, 0x0F, 0x14, 0x0F, 0x00 }, // 0xE6 ae
+  { 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E, 0x04, 0x0C }, // 0xE7 c cedilla
+  { 0x08, 0x04, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00 }, // 0xE8 e grave
+  { 0x02, 0x04, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00 }, // 0xE9 e acute
+  { 0x04, 0x0A, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00 }, // 0xEA e circ
+  { 0x0A, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00 }, // 0xEB e diaer
+  { 0x08, 0x04, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00 }, // 0xEC i grave
+  { 0x02, 0x04, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00 }, // 0xED i acute
+  { 0x04, 0x0A, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00 }, // 0xEE i circ
+  { 0x0A, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00 }, // 0xEF i diaer
+  { 0x0C, 0x06, 0x0A, 0x01, 0x0F, 0x11, 0x0E, 0x00 }, // 0xF0 eth
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xF1 n tilde, ROM
+  { 0x08, 0x04, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00 }, // 0xF2 o grave
+  { 0x02, 0x04, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00 }, // 0xF3 o acute
+  { 0x04, 0x0A, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00 }, // 0xF4 o circ
+  { 0x0D, 0x16, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00 }, // 0xF5 o tilde
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xF6 o diaer, ROM
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xF7 division, ROM
+  { 0x00, 0x00, 0x0E, 0x13, 0x15, 0x19, 0x0E, 0x00 }, // 0xF8 o stroke
+  { 0x08, 0x04, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00 }, // 0xF9 u grave
+  { 0x02, 0x04, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00 }, // 0xFA u acute
+  { 0x04, 0x0A, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00 }, // 0xFB u circ
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 0xFC u diaer, ROM
+  { 0x02, 0x04, 0x11, 0x11, 0x11, 0x0F, 0x01, 0x0E }, // 0xFD y acute
+  { 0x00, 0x10, 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10 }, // 0xFE thorn
+  { 0x0A, 0x00, 0x11, 0x11, 0x11, 0x0F, 0x01, 0x0E },  // 0xFF y diaer
+};
+
+/** Latin-1 Characters found in the LCD ROM (A00), Character and ROM Code. */
+static const u8_t lcd_glyph_rom[][2] = {
+  { 0xA0, 0x20 }, { 0xA2, 0xEC }, { 0xA5, 0x5C }, { 0xAD, 0x2D },
+  { 0xB0, 0xDF }, { 0xB5, 0xE4 }, { 0xB7, 0xA5 }, { 0xDF, 0xE2 },
+  { 0xE4, 0xE1 }, { 0xF1, 0xEE }, { 0xF6, 0xEF }, { 0xF7, 0xFD },
+  { 0xFC, 0xF5 }
+};
+
+/** ASCII Character shown when no CGRAM Slot is free, 0xA0 to 0xFF. */
+static const char lcd_glyph_fallback[LCD_GLYPH_FONT_SIZE + 1u] =
+  " !cLoY|S\"ca<--R-o+23'uP.,1o>///?"
+  "AAAAAAACEEEEIIIIDNOOOOOxOUUUUYPs"
+  "aaaaaaaceeeeiiiidnooooo/ouuuuypy";
+
+static u8_t slot_char[LCD_GLYPH_SLOTS];   // Latin-1 Character, 0 if empty
+static u32_t slot_shown[LCD_GLYPH_SLOTS]; // Update the Slot was last shown
+static u32_t update = 0;                  // Current Screen Update
+static LCD_Glyph_Stats_s stats;
+
+static u8_t Glyph_Rom_Code( u8_t c );
+static u8_t Glyph_Find( u8_t c );
+
+/**
+ * @brief Initialize Glyph Cache.
+ *
+ * All slots are empty, the CGRAM content is not known.
+ */
+void LCD_Glyph_Init( void )
+{
+  u8_t slot;
+  for( slot = 0; slot < LCD_GLYPH_SLOTS; slot++ )
+  {
+    slot_char[slot] = 0;
+    slot_shown[slot] = 0;
+  }
+  update = 0;
+  stats.hits = 0;
+  stats.misses = 0;
+  stats.evictions = 0;
+  stats.fallbacks = 0;
+}
+
+/**
+ * @brief Start a Screen Update.
+ *
+ * Call LCD_Glyph_Touch() for all characters of the new screen, then
+ * LCD_Glyph_Code() for every cell.
+ */
+void LCD_Glyph_Begin( void )
+{
+  update++;
+}
+
+/**
+ * @brief Mark a Glyph as shown.
+ *
+ * A glyph in CGRAM is kept for the current screen update.
+ * @param c Latin-1 Character.
+ */
+void LCD_Glyph_Touch( u8_t c )
+{
+  u8_t slot;
+  if( c >= LCD_GLYPH_FIRST )
+  {
+    slot = Glyph_Find(c);
+    if( slot < LCD_GLYPH_SLOTS && slot_shown[slot] != update )
+    {
+      slot_shown[slot] = update;
+      stats.hits++;
+    }
+  }
+}
+
+/**
+ * @brief LCD Character Code of a Latin-1 Character.
+ *
+ * ASCII and characters of the LCD ROM are mapped directly. Other characters
+ * get a CGRAM slot, on a miss the glyph is uploaded into the slot shown
+ * longest ago. If all slots are on the current screen the ASCII fallback is
+ * returned.
+ * @param c Latin-1 Character.
+ * @param uploaded Set to TRUE if the glyph was uploaded, the LCD address
+ * then points into the CGRAM.
+ * @return Character Code to write into the DDRAM.
+ */
+u8_t LCD_Glyph_Code( u8_t c, boolean *uploaded )
+{
+  u8_t code = c, slot, victim = LCD_GLYPH_SLOTS, row;
+  if( c >= LCD_GLYPH_FIRST )
+  {
+    code = Glyph_Rom_Code(c);
+  }
+  if( c >= LCD_GLYPH_FIRST && code == 0 )
+  {
+    LCD_Glyph_Touch(c);
+    slot = Glyph_Find(c);
+    if( slot < LCD_GLYPH_SLOTS )
+    {
+      code = slot;
+    }
+    else
+    {
+      // Least recently shown slot which is not on this screen
+      for( slot = 0; slot < LCD_GLYPH_SLOTS; slot++ )
+      {
+        if( slot_shown[slot] != update &&
+            (victim == LCD_GLYPH_SLOTS ||
+             slot_shown[slot] < slot_shown[victim]) )
+        {
+          victim = slot;
+        }
+      }
+      if( victim < LCD_GLYPH_SLOTS )
+      {
+        if( slot_char[victim] != 0 )
+        {
+          stats.evictions++;
+        }
+        stats.misses++;
+        slot_char[victim] = c;
+        slot_shown[victim] = update;
+        LCD_Cmd((u8_t)(LCD_GLYPH_SET_CGRAM | (victim << 3)));
+        for( row = 0; row < 8u; row++ )
+        {
+          LCD_Write(lcd_glyph_font[c - LCD_GLYPH_FIRST][row]);
+        }
+        *uploaded = TRUE;
+        code = victim;
+      }
+      else
+      {
+        stats.fallbacks++;
+        code = (u8_t)lcd_glyph_fallback[c - LCD_GLYPH_FIRST];
+      }
+    }
+  }
+  return code;
+}
+
+/**
+ * @brief Glyph of a Latin-1 Character.
+ *
+ * @param c Latin-1 Character.
+ * @return 8 Rows of the Glyph, NULL if the character is not in the font.
+ */
+const u8_t* LCD_Glyph_Bitmap( u8_t c )
+{
+  const u8_t *bitmap = NULL;
+  if( c >= LCD_GLYPH_FIRST && Glyph_Rom_Code(c) == 0 )
+  {
+    bitmap = lcd_glyph_font[c - LCD_GLYPH_FIRST];
+  }
+  return bitmap;
+}
+
+/**
+ * @brief Glyph Cache Statistics.
+ */
+const LCD_Glyph_Stats_s* LCD_Glyph_Get_Stats( void )
+{
+  return &stats;
+}
+
+/**
+ * @brief ROM Code of a Latin-1 Character.
+ *
+ * @return Character Code in the LCD ROM, 0 if the ROM doesn't have it.
+ */
+static u8_t Glyph_Rom_Code( u8_t c )
+{
+  u8_t i, code = 0;
+  for( i = 0; i < sizeof(lcd_glyph_rom) / sizeof(lcd_glyph_rom[0]); i++ )
+  {
+    if( lcd_glyph_rom[i][0] == c )
+    {
+      code = lcd_glyph_rom[i][1];
+    }
+  }
+  return code;
+}
+
+/**
+ * @brief CGRAM Slot of a Glyph.
+ *
+ * @return Slot, LCD_GLYPH_SLOTS if the glyph is not in CGRAM.
+ */
+static u8_t Glyph_Find( u8_t c )
+{
+  u8_t slot = 0;
+  while( slot < LCD_GLYPH_SLOTS && slot_char[slot] != c )
+  {
+    slot++;
+  }
+  return slot;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file lcd_glyph.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief LCD Custom Glyph Cache Header File.
+ *
+ * The HD44780 ROM (A00) has only a few Latin-1 characters, e.g. the umlauts
+ * of a, o and u. Latin-1 0xA0 to 0xFF not found in the ROM are drawn from a
+ * font in flash and uploaded into one of the 8 CGRAM slots, whose character
+ * codes 0x00 to 0x07 are then written to the DDRAM. The slots are a cache: a
+ * glyph is uploaded only if it isn't in a slot yet, the slot not shown for
+ * the longest time is replaced. Glyphs on screen are never evicted by others
+ * on the same screen, a ninth distinct glyph is shown as its ASCII fallback.
+ */
+
+#ifndef LCD_GLYPH_H
+#define LCD_GLYPH_H
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LCD_GLYPH_SLOTS       8u      /**< CGRAM Slots of 5x8 Glyphs. */
+#define LCD_GLYPH_FIRST       0xA0u   /**< First Latin-1 Character in Font. */
+#define LCD_GLYPH_FONT_SIZE   96u     /**< Latin-1 0xA0 to 0xFF. */
+#define LCD_GLYPH_SET_CGRAM   0x40u   /**< Set CGRAM Address Command. */
+
+/**
+ * @brief Glyph Cache Statistics.
+ *
+ * Every screen update looks up each distinct glyph on screen once, the hit
+ * rate is hits / (hits + misses).
+ */
+typedef struct _LCD_Glyph_Stats_s
+{
+  u32_t hits;           /**< Glyph found in CGRAM. */
+  u32_t misses;         /**< Glyph uploaded into CGRAM. */
+  u32_t evictions;      /**< Uploads which replaced another Glyph. */
+  u32_t fallbacks;      /**< Cells shown as ASCII, all Slots on screen. */
+} LCD_Glyph_Stats_s;
+
+// Function Prototypes
+void LCD_Glyph_Init( void );
+void LCD_Glyph_Begin( void );
+void LCD_Glyph_Touch( u8_t c );
+u8_t LCD_Glyph_Code( u8_t c, boolean *uploaded );
+const u8_t* LCD_Glyph_Bitmap( u8_t c );
+const LCD_Glyph_Stats_s* LCD_Glyph_Get_Stats( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LCD_GLYPH_H */
@@ -0,0 +1,246 @@
+/**
+ * @file line_edit.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Input Line Editor.
+ *
+ * The characters before the cursor are at the start of the buffer, the
+ * characters after it at the end, the gap in between is the free space:
+ * @code
+ * buffer: [ 0 .. gap_start ) gap [ gap_end .. LINE_EDIT_SIZE )
+ * @endcode
+ * Insert writes at gap_start, Backspace and Delete widen the gap, Left and
+ * Right move one character across it. Home and End move the gap with one
+ * memmove() of the characters passed over.
+ */
+
+#include <string.h>
+#include "line_edit.h"
+#include "lcd_fb.h"
+
+#define LINE_LENGTH()   ((u8_t)(gap_start + (LINE_EDIT_SIZE - gap_end)))
+
+static char buffer[LINE_EDIT_SIZE];   // Line with Gap at the Cursor
+static u8_t gap_start = 0;            // Cursor, Characters before the Gap
+static u8_t gap_end = LINE_EDIT_SIZE; // First Character after the Gap
+static u8_t view = 0;                 // First Character shown
+static u8_t edit_row = 0;             // LCD Row of the Line
+static Line_Edit_Stats_s stats;
+
+static void Line_Edit_Move_Gap( u8_t position );
+static void Line_Edit_Render( void );
+
+/**
+ * @brief Initialize Line Editor.
+ *
+ * Call it after LCD_FB_Init(), the empty line is drawn on the row.
+ * @param row LCD Row of the Line.
+ */
+void Line_Edit_Init( u8_t row )
+{
+  edit_row = row % LCD_FB_ROWS;
+  memset(&stats, 0, sizeof(stats));
+  Line_Edit_Clear();
+}
+
+/**
+ * @brief Empty the Line, e.g. after it was read with Enter.
+ */
+void Line_Edit_Clear( void )
+{
+  gap_start = 0;
+  gap_end = LINE_EDIT_SIZE;
+  view = 0;
+  Line_Edit_Render();
+}
+
+/**
+ * @brief Edit the Line with a Key.
+ *
+ * Printable keys are inserted at the cursor, Left, Right, Home and End move
+ * the cursor, Backspace and Delete remove the character before and after
+ * the cursor, Escape empties the line. Key releases are ignored, typematic
+ * repeats (PS2_EVT_REPEAT) edit again like a press.
+ * @param event Key Event of PS2_Get_Event().
+ * @return TRUE if Enter completed the Line, read it with Line_Edit_Get_Line().
+ */
+boolean Line_Edit_Key( const PS2_Key_Event_s *event )
+{
+  boolean done = FALSE;
+  if( event->flags & PS2_EVT_MAKE )
+  {
+    stats.keys++;
+    switch( event->keycode )
+    {
+      case PS2_KEY_LEFT:
+        if( gap_start > 0u )
+        {
+          buffer[--gap_end] = buffer[--gap_start];
+        }
+        break;
+      case PS2_KEY_RIGHT:
+        if( gap_end < LINE_EDIT_SIZE )
+        {
+          buffer[gap_start++] = buffer[gap_end++];
+        }
+        break;
+      case PS2_KEY_HOME:
+        Line_Edit_Move_Gap(0);
+        break;
+      case PS2_KEY_END:
+        Line_Edit_Move_Gap(LINE_LENGTH());
+        break;
+      case PS2_KEY_BKSP:
+        if( gap_start > 0u )
+        {
+          gap_start--;
+        }
+        break;
+      case PS2_KEY_DELETE:
+        if( gap_end < LINE_EDIT_SIZE )
+        {
+          gap_end++;
+        }
+        break;
+      case PS2_KEY_ENTER:
+      case PS2_KEY_KP_ENTER:
+        stats.lines++;
+        done = TRUE;
+        break;
+      case PS2_KEY_ESC:
+        gap_start = 0;
+        gap_end = LINE_EDIT_SIZE;
+        break;
+      default:
+        // Control Characters like Tab are not part of the Line
+        if( event->ascii >= ' ' && event->ascii != 0x7Fu &&
+            !(event->modifiers & PS2_MOD_CTRL) )
+        {
+          if( gap_start < gap_end )
+          {
+            buffer[gap_start++] = (char)event->ascii;
+          }
+          else
+          {
+            stats.full++;
+          }
+        }
+        break;
+    }
+    Line_Edit_Render();
+  }
+  return done;
+}
+
+/**
+ * @brief Copy of the Line.
+ *
+ * @param line Destination, terminated by NULL Character.
+ * @param size Size of line, a longer Line is cut.
+ * @return Characters copied.
+ */
+u8_t Line_Edit_Get_Line( char *line, u8_t size )
+{
+  u8_t before = 0, after = 0;
+  if( size > 0u )
+  {
+    before = ( gap_start < size ) ? gap_start : (u8_t)(size - 1u);
+    if( before == gap_start )
+    {
+      after = (u8_t)(LINE_EDIT_SIZE - gap_end);
+      if( after > size - 1u - before )
+      {
+        after = (u8_t)(size - 1u - before);
+      }
+    }
+    memcpy(line, buffer, before);
+    memcpy(&line[before], &buffer[gap_end], after);
+    line[before + after] = 0;
+  }
+  return (u8_t)(before + after);
+}
+
+/**
+ * @brief Cursor Position, Characters before the Cursor.
+ */
+u8_t Line_Edit_Get_Cursor( void )
+{
+  return gap_start;
+}
+
+/**
+ * @brief Line Editor Statistics.
+ */
+const Line_Edit_Stats_s* Line_Edit_Get_Stats( void )
+{
+  return &stats;
+}
+
+/**
+ * @brief Move the Gap, i.e. the Cursor, to a Position of the Line.
+ *
+ * @param position Characters before the Cursor afterwards.
+ */
+static void Line_Edit_Move_Gap( u8_t position )
+{
+  u8_t count;
+  if( position < gap_start )
+  {
+    count = (u8_t)(gap_start - position);
+    gap_start = position;
+    gap_end = (u8_t)(gap_end - count);
+    memmove(&buffer[gap_end], &buffer[gap_start], count);
+  }
+  else
+  {
+    count = (u8_t)(position - gap_start);
+    memmove(&buffer[gap_start], &buffer[gap_end], count);
+    gap_start = position;
+    gap_end = (u8_t)(gap_end + count);
+  }
+}
+
+/**
+ * @brief Draw the Window on the Line into the Framebuffer.
+ *
+ * The window is scrolled only as far as needed to show the cursor, and back
+ * if the end of the line moved into it, so that no cell is left empty while
+ * there is text left of the window.
+ */
+static void Line_Edit_Render( void )
+{
+  u8_t length = LINE_LENGTH();
+  u8_t column, index;
+  if( gap_start < view )
+  {
+    view = gap_start;
+  }
+  else if( gap_start >= view + LINE_EDIT_COLUMNS )
+  {
+    view = (u8_t)(gap_start - LINE_EDIT_COLUMNS + 1u);
+  }
+  // The cell after the last Character holds the Cursor at the End
+  if( view + LINE_EDIT_COLUMNS > length + 1u )
+  {
+    view = ( length + 1u > LINE_EDIT_COLUMNS ) ?
+           (u8_t)(length + 1u - LINE_EDIT_COLUMNS) : 0u;
+  }
+  LCD_FB_Goto(edit_row, 0);
+  for( column = 0; column < LINE_EDIT_COLUMNS; column++ )
+  {
+    index = (u8_t)(view + column);
+    if( index >= length )
+    {
+      LCD_FB_Putc(' ');
+    }
+    else if( index < gap_start )
+    {
+      LCD_FB_Putc(buffer[index]);
+    }
+    else
+    {
+      LCD_FB_Putc(buffer[index + (gap_end - gap_start)]);
+    }
+  }
+  LCD_FB_Cursor(edit_row, (u8_t)(gap_start - view));
+}
@@ -0,0 +1,60 @@
+/**
+ * @file line_edit.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Input Line Editor Header File.
+ *
+ * The line is kept in a gap buffer, the free space of the buffer is a gap at
+ * the cursor. Inserting or deleting a character at the cursor and moving the
+ * cursor by one character change only the bounds of the gap, the time of an
+ * edit doesn't depend on the length of the line. One row of the LCD is a 16
+ * character window on the line, scrolled so that the cursor stays visible,
+ * the cursor of the LCD marks the insert position. The window is written to
+ * the framebuffer (lcd_fb.c), only the cells changed by an edit are sent to
+ * the LCD.
+ */
+
+#ifndef LINE_EDIT_H
+#define LINE_EDIT_H
+
+#include "config.h"
+#include "ps2_keyboard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Buffer Size, longest Line */
+#ifndef LINE_EDIT_SIZE
+#define LINE_EDIT_SIZE        128u
+#endif
+
+#define LINE_EDIT_COLUMNS     16u     /**< Characters shown of the Line. */
+
+#if (LINE_EDIT_SIZE > 255u) || (LINE_EDIT_SIZE < LINE_EDIT_COLUMNS)
+#error "LINE_EDIT_SIZE must be 16 to 255"
+#endif
+
+/**
+ * @brief Line Editor Statistics.
+ */
+typedef struct _Line_Edit_Stats_s
+{
+  u32_t keys;           /**< Keys handled. */
+  u32_t lines;          /**< Lines completed with Enter. */
+  u32_t full;           /**< Characters dropped, Line was full. */
+} Line_Edit_Stats_s;
+
+// Function Prototypes
+void Line_Edit_Init( u8_t row );
+void Line_Edit_Clear( void );
+boolean Line_Edit_Key( const PS2_Key_Event_s *event );
+u8_t Line_Edit_Get_Line( char *line, u8_t size );
+u8_t Line_Edit_Get_Cursor( void );
+const Line_Edit_Stats_s* Line_Edit_Get_Stats( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LINE_EDIT_H */
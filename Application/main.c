@@ -20,7 +20,20 @@
 
 #include "config.h"
 #include "ps2_keyboard.h"
+#include "ps2_capture.h"
+#include "ps2_mouse.h"
+#include "latency.h"
+#include "isr_profile.h"
+#include "events.h"
+#include "power.h"
+#include "usb_hid.h"
+#include "key_stream.h"
+#include "lpc13xx_uart.h"
 #include "lcd_16x2.h"
+#include "lcd_fb.h"
+#include "line_edit.h"
+#include "scrollback.h"
+#include "bench_suite.h"
 
 static boolean int_led_state = FALSE;
 
@@ -29,10 +42,29 @@ static boolean int_led_state = FALSE;
  */
 int main()
 {
-  u32_t timestamp = 0, keyboard_timestamp = 0, lcd_backlit_timestamp = 0;;
-  u8_t keypress = 0, lcd_count = 0;;
-  boolean led_state = TRUE, first_keypress = FALSE;
+  u32_t timestamp = 0, lcd_backlit_timestamp = 0, events;
+#if LATENCY_TRACE
+  u32_t latency_timestamp = 0;
+#endif
+#if ISR_PROFILE
+  u32_t profile_timestamp = 0;
+#endif
+  const uint8_t *rx_span;
+  uint32_t rx_length, i;
+#if POWER_DEEP_SLEEP
+  u32_t activity_timestamp = 0;
+#endif
+  u8_t port;
+  char line[LINE_EDIT_SIZE + 1u];
+  PS2_Key_Event_s event;
+#if PS2_AUX_MOUSE
+  PS2_Mouse_Report_s mouse;
+#endif
+  boolean led_state = TRUE;
   InitializeSystem();
+  Latency_Init();
+  ISR_Profile_Init();
+  Key_Stream_Init();
   // Enable External Interrupt for Port-0
   NVIC_EnableIRQ(EINT0_IRQn);
   // Set Direction as Output
@@ -45,38 +77,152 @@ int main()
   // Enable Interrupt
   GPIO_IntEnable( EXT_INT_PORT, EXT_INT_PIN );
   GPIO_Init();
+#if PS2_CAPTURE_RECEIVER
+  PS2_Capture_Init();
+#else
   PS2_Keyboard_Init();
+  PS2_Set_Typematic(PS2_PORT_KEYBOARD, PS2_TYPEMATIC_FASTEST);
+#if PS2_AUX_MOUSE
+  PS2_Mouse_Init(PS2_PORT_AUX);
+#endif
+#endif
+#if USB_HID_BRIDGE
+  USB_Device_Init();
+#endif
   LCD_Init();
+  LCD_FB_Init();
   timestamp = millis();
   LCD_BackLight_On();
-  LCD_Write_Text("PS2 Board Exmple");
-  LCD_Cmd(LCD_FIRST_ROW);
+  // First row shows the history of entered lines and received text, keys
+  // are edited on the second row
+  Scrollback_Init(0, 1);
+  Scrollback_Puts("PS2 Board Exmple\n");
+  Line_Edit_Init(1);
+  Scrollback_Render();
+  LCD_FB_Flush();
+#if BENCH_SUITE
+  // Benchmark image, the results go out over the UART, then the board idles
+  Bench_Suite_Run();
+  while(1)
+    __WFI();
+#endif
   while(1)
   {
-    if (millis() - keyboard_timestamp > 50u )
+    // Sleep until an interrupt has something for the main loop, SysTick
+    // wakes it up every milli-second for the timers below
+    events = Event_Wait();
+#if !PS2_CAPTURE_RECEIVER
+    PS2_Command_Task();
+#if PS2_AUX_MOUSE
+    PS2_Mouse_Task();
+#endif
+#endif
+    // A finished USB report makes room for the next key in the queue
+    if( events & (EVENT_PS2 | EVENT_USB) )
     {
-      keyboard_timestamp = millis();
-      if( !(IS_PS2_Busy()) )
+#if POWER_DEEP_SLEEP
+      activity_timestamp = millis();
+#endif
+      // Keys from Keyboard and Barcode Wedge are shown on the same LCD, a
+      // frame still in progress posts the event again at its stop bit
+      for( port = 0; port < (PS2_AUX_MOUSE ? PS2_PORT_AUX : PS2_PORTS); port++ )
       {
-        u8_t temp = getKey();
-        if( temp )
+        while( !(IS_PS2_Busy(port)) )
         {
-          keypress = temp;
-          lcd_count++;
-          if(lcd_count > 15u || !first_keypress)
+#if USB_HID_BRIDGE
+          // Each key goes to the USB host in its own report, the others
+          // wait in the PS2 queue until the endpoint is free
+          if( port == PS2_PORT_KEYBOARD && !IS_USB_HID_Ready() )
+            break;
+#endif
+          if( !PS2_Get_Event(port, &event) )
+            break;
+#if USB_HID_BRIDGE
+          if( port == PS2_PORT_KEYBOARD )
+            USB_HID_Key_Event(port, &event);
+#endif
+          Key_Stream_Event(port, &event);
+          // Up, Down, Page Up and Page Down scroll the history
+          if( !Scrollback_Key(&event) && Line_Edit_Key(&event) )
+          {
+            // Entered Line goes to the history, editing starts over
+            Line_Edit_Get_Line(line, sizeof(line));
+            Scrollback_Puts(line);
+            Scrollback_Putc('\n');
+            Line_Edit_Clear();
+          }
+          if( (event.flags & PS2_EVT_MAKE) && event.ascii )
           {
-            lcd_count = 0;
-            LCD_Cmd(LCD_CLEAR);
-            LCD_Cmd(LCD_FIRST_ROW);
+            Latency_Record(LATENCY_SINK, event.timestamp);
+            LCD_BackLight_On();
+            lcd_backlit_timestamp = millis();
           }
-          first_keypress = TRUE;
-          LCD_Write(keypress);
-          LCD_BackLight_On();
-          lcd_backlit_timestamp = millis();
         }
       }
+      // Only the cells changed by all keys of this pass go to the LCD
+      Scrollback_Render();
+      LCD_FB_Flush();
+#if PS2_AUX_MOUSE
+      // Movement is accumulated in the interrupt, any mouse activity wakes the
+      // back light
+      if( PS2_Mouse_Read(PS2_PORT_AUX, &mouse) )
+      {
+        LCD_BackLight_On();
+        lcd_backlit_timestamp = millis();
+      }
+#endif
     }
+#if USB_HID_BRIDGE
+    // LED reports of the host and idle reports
+    USB_HID_Task();
+#endif
+    // Batched key events go out once their window has passed
+    Key_Stream_Task();
     
+    // Received text goes to the history, any byte also asks for the dumps
+    // right away
+    if( events & EVENT_UART_RX )
+    {
+      while( (rx_length = UART_RxSpan(&rx_span)) != 0u )
+      {
+        for( i = 0; i < rx_length; i++ )
+          Scrollback_Putc((char)rx_span[i]);
+        UART_RxRelease(rx_length);
+      }
+      Scrollback_Render();
+      LCD_FB_Flush();
+    }
+#if LATENCY_TRACE
+    if( millis() - latency_timestamp > LATENCY_DUMP_MS ||
+        (events & EVENT_UART_RX) )
+    {
+      latency_timestamp = millis();
+      Latency_Dump();
+    }
+    // Dumps go out through the UART TX ring a few lines per pass
+    Latency_Dump_Task();
+#endif
+#if ISR_PROFILE
+    if( millis() - profile_timestamp > ISR_PROFILE_DUMP_MS ||
+        (events & EVENT_UART_RX) )
+    {
+      profile_timestamp = millis();
+      ISR_Profile_Dump();
+    }
+    ISR_Profile_Dump_Task();
+#endif
+
+#if POWER_DEEP_SLEEP
+    if( millis() - activity_timestamp > POWER_IDLE_MS )
+    {
+      // Nothing received for a long time, sleep until the next key
+      LCD_BackLight_Off();
+      GPIO_SetValue(LED_PORT, GreenLED);
+      Power_Deep_Sleep();
+      activity_timestamp = millis();
+    }
+#endif
+
     if( millis() - lcd_backlit_timestamp > 10000u)
     {
       lcd_backlit_timestamp = millis();
@@ -108,6 +254,7 @@ int main()
 void PIOINT0_IRQHandler(void)
 {
   uint32_t regVal;
+  ISR_PROFILE_ENTER(ISR_PROFILE_PIOINT0);
   regVal = GPIO_IntStatus( EXT_INT_PORT, EXT_INT_PIN);
   if ( regVal )
   {
@@ -123,23 +270,47 @@ void PIOINT0_IRQHandler(void)
       GPIO_ClearValue(LED_PORT, BlueLED);
     }
   }
+  ISR_PROFILE_EXIT(ISR_PROFILE_PIOINT0);
   return;
 }
 
 /**
  * @brief External Interrupt Port3
  *
- * PS2 State Machine is Handled in this Interrupt.
+ * PS2 State Machines of Keyboard and Auxiliary Port are Handled in this
+ * Interrupt, both Clock Pins are on Port3.
  * 
  */
 void PIOINT3_IRQHandler(void)
 {
-  uint32_t regVal;
-  regVal = GPIO_IntStatus( PS2_CLK_PORT, PS2_CLK_PIN);
-  if ( regVal )
-  {
-    GPIO_IntClear( PS2_CLK_PORT, PS2_CLK_PIN);
-    PS2_State_Machine();
-  }
+  ISR_PROFILE_ENTER(ISR_PROFILE_PIOINT3);
+  PS2_GPIO_IRQHandler(PORT3);
+  ISR_PROFILE_EXIT(ISR_PROFILE_PIOINT3);
+  return;
+}
+
+/**
+ * @brief 16-Bit Timer0 Interrupt
+ *
+ * Writes the next queued command or character to the LCD.
+ */
+void TIMER16_0_IRQHandler(void)
+{
+  ISR_PROFILE_ENTER(ISR_PROFILE_LCD);
+  LCD_Timer_IRQHandler();
+  ISR_PROFILE_EXIT(ISR_PROFILE_LCD);
+  return;
+}
+
+#if PS2_CAPTURE_RECEIVER
+/**
+ * @brief 16-Bit Timer1 Interrupt
+ *
+ * PS2 Clock edges are captured and time stamped by this Timer.
+ */
+void TIMER16_1_IRQHandler(void)
+{
+  PS2_Capture_IRQHandler();
   return;
 }
+#endif
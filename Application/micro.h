@@ -15,6 +15,7 @@
 typedef uint8_t  u8_t;     /**< 8 bits unsigned. */
 typedef uint16_t u16_t;    /**< 16 bits unsigned. */
 typedef uint32_t u32_t;    /**< 32 bits unsigned. */
+typedef uint64_t u64_t;    /**< 64 bits unsigned. */
 typedef int8_t   s8_t;     /**< 8 bits signed. */
 typedef int16_t  s16_t;    /**< 16 bits signed. */
 typedef int32_t  s32_t;    /**< 32 bits signed. */
@@ -0,0 +1,199 @@
+/**
+ * @file power.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Deep-Sleep Idle Mode.
+ *
+ * GPIO interrupts don't see edges during Deep-Sleep, only the start logic
+ * does. Start logic inputs are PIO0_0 to PIO3_3, 12 per GPIO Port, PS2 Clock
+ * Pins are armed as falling edge inputs just before Deep-Sleep and disarmed
+ * after it, so they don't interrupt every clock edge while running.
+ *
+ * Main clock is switched to the IRC before Deep-Sleep, the core wakes up on
+ * the IRC and runs the GPIO interrupts while the system oscillator and the
+ * PLL start up again. Prescaler of micros() is changed with the main clock.
+ * SysTick is stopped from before Deep-Sleep until the PLL clocks the core, a
+ * tick pending at WFI would wake the core right away.
+ */
+
+#include "power.h"
+#include "ps2_keyboard.h"
+#include "usb_hid.h"
+#include "lpc13xx_clkpwr.h"
+
+#if POWER_DEEP_SLEEP
+
+#if PS2_CAPTURE_RECEIVER
+#error "Deep-Sleep needs the GPIO interrupt receiver"
+#endif
+#if USB_HID_BRIDGE
+#error "Deep-Sleep stops the USB clock, use USB Suspend instead"
+#endif
+
+#define START_INPUTS_PER_PORT   12u   /**< Start Logic Inputs per GPIO Port. */
+#define MAINCLKSEL_IRC          0u    /**< Main Clock from IRC. */
+#define MAINCLKSEL_PLL          3u    /**< Main Clock from PLL Output. */
+
+static Power_Stats_s stats = {0, 0, 0, 0, 0};
+
+static void Sleep_Until_Edge( const u32_t mask[2] );
+static void Main_Clock_Select( u32_t source, u32_t hz );
+
+/**
+ * @brief Deep-Sleep if all PS2 Ports are idle.
+ *
+ * Call it from the main loop once nothing happened for POWER_IDLE_MS. Returns
+ * after the core woke up and the PLL clocks it again, the key which woke it
+ * up is received meanwhile.
+ * @return TRUE if the core was in Deep-Sleep.
+ */
+boolean Power_Deep_Sleep( void )
+{
+  const PS2_Pins_s *pins;
+  u32_t mask[2] = {0, 0};
+  u8_t port, input;
+  boolean idle = TRUE;
+  for( port = 0; port < PS2_PORTS; port++ )
+  {
+    pins = PS2_Get_Pins(port);
+    input = (u8_t)(pins->clk_port * START_INPUTS_PER_PORT + pins->clk_pin);
+    mask[input / 32u] |= (1ul << (input % 32u));
+    // Clock Line Low is a frame starting or a command in progress
+    if( !IS_PS2_Idle(port) ||
+        !((GPIO_ReadValue(pins->clk_port) >> pins->clk_pin) & 0x01) )
+    {
+      idle = FALSE;
+    }
+  }
+  if( idle )
+  {
+    Sleep_Until_Edge(mask);
+  }
+  else
+  {
+    stats.aborts++;
+  }
+  return idle;
+}
+
+/**
+ * @brief Deep-Sleep until a Start Logic Input falls.
+ * @param mask Start Logic Inputs of the PS2 Clock Pins, inputs 0-31 and 32-39.
+ */
+static void Sleep_Until_Edge( const u32_t mask[2] )
+{
+  const PS2_Pins_s *pins;
+  u32_t woke[2], wake_us;
+  u8_t port, input;
+  __disable_interrupt();
+  // A tick since the idle check would end the sleep at once and the main
+  // loop would stay awake for another POWER_IDLE_MS
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+  // Arm start logic, falling edges of the Clock Pins
+  LPC_SYSCON->STARTAPRP0 &= ~mask[0];
+  LPC_SYSCON->STARTAPRP1 &= ~mask[1];
+  LPC_SYSCON->STARTRSRP0CLR = mask[0];
+  LPC_SYSCON->STARTRSRP1CLR = mask[1];
+  LPC_SYSCON->STARTERP0 |= mask[0];
+  LPC_SYSCON->STARTERP1 |= mask[1];
+  for( input = 0; input < 40u; input++ )
+  {
+    if( mask[input / 32u] & (1ul << (input % 32u)) )
+    {
+      NVIC_ClearPendingIRQ((IRQn_Type)(WAKEUP0_IRQn + input));
+      NVIC_EnableIRQ((IRQn_Type)(WAKEUP0_IRQn + input));
+    }
+  }
+  // An edge since the idle check is pending in the GPIO interrupt and ends
+  // the sleep right away
+  Main_Clock_Select(MAINCLKSEL_IRC, POWER_IRC_HZ);
+  PMU_Sleep(1, POWER_PDSLEEPCFG);
+  wake_us = micros();
+  stats.sleeps++;
+  woke[0] = LPC_SYSCON->STARTSRP0 & mask[0];
+  woke[1] = LPC_SYSCON->STARTSRP1 & mask[1];
+  for( port = 0; port < PS2_PORTS; port++ )
+  {
+    pins = PS2_Get_Pins(port);
+    input = (u8_t)(pins->clk_port * START_INPUTS_PER_PORT + pins->clk_pin);
+    if( woke[input / 32u] & (1ul << (input % 32u)) )
+    {
+      // Start Bit is lost unless the GPIO interrupt caught the edge
+      if( GPIO_IntStatus(pins->clk_port, pins->clk_pin) )
+      {
+        PS2_Wake(port, wake_us, FALSE);
+      }
+      else
+      {
+        PS2_Wake(port, wake_us, TRUE);
+        stats.replays++;
+      }
+    }
+  }
+  // Disarm start logic, it must not interrupt every clock edge
+  LPC_SYSCON->STARTERP0 &= ~mask[0];
+  LPC_SYSCON->STARTERP1 &= ~mask[1];
+  LPC_SYSCON->STARTRSRP0CLR = mask[0];
+  LPC_SYSCON->STARTRSRP1CLR = mask[1];
+  for( input = 0; input < 40u; input++ )
+  {
+    if( mask[input / 32u] & (1ul << (input % 32u)) )
+    {
+      NVIC_DisableIRQ((IRQn_Type)(WAKEUP0_IRQn + input));
+      NVIC_ClearPendingIRQ((IRQn_Type)(WAKEUP0_IRQn + input));
+    }
+  }
+  // Rest of the frame is received on the IRC while the PLL locks
+  __enable_interrupt();
+  while( !(LPC_SYSCON->SYSPLLSTAT & 0x01) );
+  Main_Clock_Select(MAINCLKSEL_PLL, POWER_PLL_HZ);
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+  stats.pll_us = micros() - wake_us;
+  if( stats.pll_us > stats.pll_max_us )
+  {
+    stats.pll_max_us = stats.pll_us;
+  }
+}
+
+/**
+ * @brief Deep-Sleep Statistics.
+ *
+ * Time from Wake-Up to the end of the first frame is in the LATENCY_WAKE
+ * histogram, frames lost after Wake-Up are counted in the PS2 statistics.
+ * @return Pointer to Statistics.
+ */
+const Power_Stats_s* Power_Get_Stats( void )
+{
+  return &stats;
+}
+
+/**
+ * @brief Switch Main Clock.
+ *
+ * micros() Timer is prescaled to 1 MHz again for the new clock.
+ * @param source MAINCLKSEL Value.
+ * @param hz Main Clock Frequency.
+ */
+static void Main_Clock_Select( u32_t source, u32_t hz )
+{
+  LPC_SYSCON->MAINCLKSEL = source;
+  LPC_SYSCON->MAINCLKUEN = 0;
+  LPC_SYSCON->MAINCLKUEN = 1;
+  while( !(LPC_SYSCON->MAINCLKUEN & 0x01) );
+  MICROS_TIMER->PR = hz / 1000000ul - 1u;
+}
+
+/**
+ * @brief Start Logic Wake-Up Interrupt.
+ *
+ * Start logic is disarmed before interrupts are enabled again, nothing is
+ * left to do here.
+ */
+void WAKEUP_IRQHandler( void )
+{
+  LPC_SYSCON->STARTRSRP0CLR = LPC_SYSCON->STARTSRP0;
+  LPC_SYSCON->STARTRSRP1CLR = LPC_SYSCON->STARTSRP1;
+}
+
+#endif /* POWER_DEEP_SLEEP */
@@ -0,0 +1,54 @@
+/**
+ * @file power.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Deep-Sleep Idle Mode Header File.
+ *
+ * When all PS2 Ports are idle the core goes to Deep-Sleep, the falling edge of
+ * any PS2 Clock Pin wakes it up through the start logic. The start bit which
+ * woke the core is given to the PS2 State Machine, the rest of the frame is
+ * received by the GPIO interrupt as usual while the PLL locks again.
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Deep-Sleep Idle Mode, 0 Disabled, 1 Enabled */
+#ifndef POWER_DEEP_SLEEP
+#define POWER_DEEP_SLEEP      0
+#endif
+
+#define POWER_IDLE_MS         30000u      /**< Idle Time before Deep-Sleep. */
+#define POWER_PDSLEEPCFG      0x000018FFul  /**< BOD and WDT Osc. off in Deep-Sleep. */
+#define POWER_IRC_HZ          12000000ul  /**< Main Clock while PLL locks. */
+#define POWER_PLL_HZ          72000000ul  /**< Main Clock from PLL. */
+
+/**
+ * @brief Deep-Sleep Statistics.
+ */
+typedef struct _Power_Stats_s
+{
+  u32_t sleeps;         /**< Deep-Sleeps entered. */
+  u32_t aborts;         /**< Deep-Sleeps skipped, a Clock Line was Low. */
+  u32_t replays;        /**< Start Bits given to the State Machine. */
+  u32_t pll_us;         /**< Last Wake-Up to PLL Clock Time. */
+  u32_t pll_max_us;     /**< Longest Wake-Up to PLL Clock Time. */
+} Power_Stats_s;
+
+// Function Prototypes
+#if POWER_DEEP_SLEEP
+boolean Power_Deep_Sleep( void );
+const Power_Stats_s* Power_Get_Stats( void );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POWER_H */
@@ -0,0 +1,137 @@
+/**
+ * @file ps2_capture.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief PS2 Timer Capture Receiver.
+ *
+ * Timer captures both edges of PS2 Clock, on falling edge the Data Line is
+ * sampled and kept pending, on the following rising edge the low time of the
+ * clock is checked and only then the bit is given to the PS2 State Machine.
+ * Timing decisions are done in PS2_Capture_Edge() which doesn't touch the
+ * hardware, hence it can be run on host with synthetic capture values.
+ */
+
+#include "ps2_capture.h"
+#include "lpc13xx_timer.h"
+
+static PS2_Capture_Stats_s stats = {0, 0, 0, 0};
+static u16_t fall_time = 0;       /**< Capture Value of Pending Falling Edge. */
+static u16_t last_bit_time = 0;   /**< Capture Value of Last Accepted Bit. */
+static u8_t frame_bits = 0;       /**< Bits accepted in current Frame. */
+static u8_t pending_data = 0;     /**< Data sampled at Falling Edge. */
+static boolean pending = FALSE;   /**< Falling Edge waiting for Rising Edge. */
+
+/**
+ * @brief Initialize PS2 Capture Receiver.
+ *
+ * PS2 Clock Pin is configured as CT16B1_CAP0, Timer is prescaled to 1 MHz and
+ * captures both edges with interrupt. Data Pin is same as GPIO Receiver.
+ */
+void PS2_Capture_Init( void )
+{
+  TIM_TIMERCFG_Type timer_cfg;
+  TIM_CAPTURECFG_Type capture_cfg;
+
+  GPIO_SetDir( PS2_DATA_PORT, PS2_DATA_PIN, 0);
+  // PIO1_8 Function 1 is CT16B1_CAP0
+  LPC_IOCON->PIO1_8 = (LPC_IOCON->PIO1_8 & ~0x07u) | 0x01u;
+
+  timer_cfg.PrescaleOption = TIM_PRESCALE_USVAL;
+  timer_cfg.PrescaleValue = 1;
+  TIM_Init(LPC_TMR16B1, TIM_TIMER_MODE, &timer_cfg);
+
+  capture_cfg.CaptureChannel = 0;
+  capture_cfg.RisingEdge = ENABLE;
+  capture_cfg.FallingEdge = ENABLE;
+  capture_cfg.IntOnCaption = ENABLE;
+  TIM_ConfigCapture(LPC_TMR16B1, &capture_cfg);
+
+  NVIC_EnableIRQ(TIMER_16_1_IRQn);
+  TIM_Cmd(LPC_TMR16B1, ENABLE);
+}
+
+/**
+ * @brief PS2 Clock Edge.
+ *
+ * Timing part of the receiver, called for every captured clock edge.
+ * @param time Timer Capture Value in micro-seconds.
+ * @param clock Clock Line level after the edge, 0 for falling edge.
+ * @param data Data Line level at the edge.
+ */
+void PS2_Capture_Edge( u16_t time, u8_t clock, u8_t data )
+{
+  u16_t period;
+  stats.edges++;
+  if( clock == 0u )
+  {
+    // Falling Edge, sample data now as it is valid only while clock is low
+    fall_time = time;
+    pending_data = data;
+    pending = TRUE;
+    return;
+  }
+  if( !pending )
+  {
+    // Rising edge without falling edge, falling edge is lost
+    return;
+  }
+  pending = FALSE;
+  if( (u16_t)(time - fall_time) < PS2_MIN_LOW_US )
+  {
+    stats.glitches++;
+    return;
+  }
+  if( frame_bits )
+  {
+    period = (u16_t)(fall_time - last_bit_time);
+    if( period > PS2_MAX_BIT_US )
+    {
+      // Previous frame is incomplete, this bit starts a new frame
+      stats.timing_errors++;
+      PS2_Resync(PS2_PORT_KEYBOARD);
+      frame_bits = 0;
+    }
+    else if( period < PS2_MIN_BIT_US )
+    {
+      stats.timing_errors++;
+      return;
+    }
+  }
+  last_bit_time = fall_time;
+  stats.bits++;
+  PS2_Receive_Bit(PS2_PORT_KEYBOARD, pending_data);
+  frame_bits++;
+  if( frame_bits >= PS2_FRAME_BITS || (frame_bits == 1u && pending_data) )
+  {
+    // Frame complete, or no start bit and State Machine is still idle
+    frame_bits = 0;
+  }
+}
+
+/**
+ * @brief PS2 Capture Interrupt.
+ *
+ * Call this function from TIMER16_1_IRQHandler.
+ * @note On LPC13xx GPIO Data Register reflects the pin level even if pin is
+ * used as capture input.
+ */
+void PS2_Capture_IRQHandler( void )
+{
+  u8_t clock, data;
+  if( TIM_GetIntCaptureStatus(LPC_TMR16B1, 0) )
+  {
+    TIM_ClearIntCapturePending(LPC_TMR16B1, 0);
+    clock = (u8_t)((GPIO_ReadValue(PS2_CAP_CLK_PORT) >> PS2_CAP_CLK_PIN) & 0x01);
+    data = (u8_t)((GPIO_ReadValue(PS2_DATA_PORT) >> PS2_DATA_PIN) & 0x01);
+    PS2_Capture_Edge( (u16_t)TIM_GetCaptureValue(LPC_TMR16B1), clock, data);
+  }
+}
+
+/**
+ * @brief PS2 Capture Receiver Statistics.
+ * @return Pointer to Statistics.
+ */
+const PS2_Capture_Stats_s* PS2_Capture_Get_Stats( void )
+{
+  return &stats;
+}
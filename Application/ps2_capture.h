@@ -0,0 +1,58 @@
+/**
+ * @file ps2_capture.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief PS2 Timer Capture Receiver Header File.
+ *
+ * Alternative to the GPIO interrupt receiver, PS2 Clock is connected to the
+ * capture input of 16-bit Timer1 so that every edge is time stamped by the
+ * hardware. Clock pulses shorter than the PS2 minimum are rejected as noise.
+ * Only the Keyboard Port (PS2_PORT_KEYBOARD) is received this way.
+ */
+
+#ifndef PS2_CAPTURE_H
+#define PS2_CAPTURE_H
+
+#include "ps2_keyboard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Receiver Selection, 0 GPIO Interrupt Receiver, 1 Timer Capture Receiver */
+#ifndef PS2_CAPTURE_RECEIVER
+#define PS2_CAPTURE_RECEIVER  0
+#endif
+
+/* Port and Pin Configuration, CT16B1_CAP0 */
+#define PS2_CAP_CLK_PORT      1     /**< PS2 Clock PORT in Capture Mode. */
+#define PS2_CAP_CLK_PIN       8     /**< PS2 Clock Pin in Capture Mode. */
+
+/* PS2 Timings in micro-seconds, Timer runs at 1MHz */
+#define PS2_MIN_LOW_US        20u   /**< Shorter Clock Low is a Glitch. */
+#define PS2_MIN_BIT_US        50u   /**< Minimum Clock Period. */
+#define PS2_MAX_BIT_US        120u  /**< Maximum Clock Period in Frame. */
+#define PS2_FRAME_BITS        11u   /**< Start, 8 Data, Parity and Stop. */
+
+/**
+ * @brief PS2 Capture Receiver Statistics.
+ */
+typedef struct _PS2_Capture_Stats_s
+{
+  u32_t edges;          /**< Number of Captured Edges. */
+  u32_t bits;           /**< Number of Bits given to State Machine. */
+  u32_t glitches;       /**< Clock Pulses shorter than PS2_MIN_LOW_US. */
+  u32_t timing_errors;  /**< Bits with period out of PS2 limits. */
+} PS2_Capture_Stats_s;
+
+// Function Prototypes
+void PS2_Capture_Init( void );
+void PS2_Capture_Edge( u16_t time, u8_t clock, u8_t data );
+void PS2_Capture_IRQHandler( void );
+const PS2_Capture_Stats_s* PS2_Capture_Get_Stats( void );
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* PS2_CAPTURE_H */
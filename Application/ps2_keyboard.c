@@ -7,75 +7,277 @@
  */
 
 #include "ps2_keyboard.h"
+#include "ps2_mouse.h"
+#include "latency.h"
+#include "events.h"
 
 /* Private Functions */
-static u8_t Decode_PS2_Key( void );
-static u8_t Delete_From_Queue ( void );
-static u8_t Get_From_Queue ( void );
-static boolean IS_Queue_Empty( void );
-static boolean Insert_In_Queue( u8_t scan_code );
+static u8_t Decode_PS2_Key( PS2_Port_s *p );
+static u8_t Key_To_Ascii( PS2_Port_s *p, u8_t scan_code, boolean extended );
+#if PS2_ALTGR_LATIN1
+static u8_t Key_To_Latin1( PS2_Port_s *p, u8_t scan_code );
+#endif
+static u8_t Locks_To_Leds( u8_t locks );
+static void Make_Key_Event( PS2_Port_s *p, u8_t scan_code, u8_t keycode,
+                            boolean extended, boolean release,
+                            PS2_Key_Event_s *event );
+static boolean Port_Parse_Byte( PS2_Port_s *p, u8_t scan_code,
+                                u32_t timestamp, PS2_Key_Event_s *event );
+static boolean Port_Get_Event( PS2_Port_s *p, PS2_Key_Event_s *event );
+static void Port_Resync( PS2_Port_s *p );
+static u8_t Delete_From_Queue ( PS2_Port_s *p );
+static u8_t Get_From_Queue ( PS2_Port_s *p );
+static boolean IS_Queue_Empty( PS2_Port_s *p );
+static boolean IS_Frame_In_Progress( PS2_Port_s *p );
+static boolean Insert_In_Queue( PS2_Port_s *p, u8_t scan_code,
+                                u32_t timestamp );
+static void PS2_Transmit_Bit( PS2_Port_s *p );
+static void PS2_Data_Drive( PS2_Port_s *p, u8_t level );
+static boolean Port_Send_Command( PS2_Port_s *p, u8_t command, u8_t flags );
+static boolean Port_Send_Command_Arg( PS2_Port_s *p, u8_t command,
+                                      u8_t argument );
+static void Port_Command_Task( PS2_Port_s *p );
+static void PS2_Command_Done( PS2_Port_s *p );
+static void PS2_Command_Retry( PS2_Port_s *p );
+static void Port_Wake_Frame( PS2_Port_s *p, boolean ok );
 
 // http://www.computer-engineering.org/ps2keyboard/scancodes2.html
 // PS2 keyboard codes (standard set #2)
-const u8_t PS2_KeyCodes[128] = {
-  0,    F9,     0,      F5,     F3,     F1,     F2,     F12,    //0x00
-  0,    F10,    F8,     F6,     F4,     TAB,    '`',    0,      //0x08
-  0,    0,      L_SHFT, 0,      L_CTRL, 'q',    '1',    0,      //0x10
-  0,    0,      'z',    's',    'a',    'w',    '2',    0,      //0x18
-  0,    'c',    'x',    'd',    'e',    '4',    '3',    0,      //0x20
-  0,    ' ',    'v',    'f',    't',    'r',    '5',    0,      //0x28
-  0,    'n',    'b',    'h',    'g',    'y',    '6',    0,      //0x30
-  0,    0,      'm',    'j',    'u',    '7',    '8',    0,      //0x38
-  0,    ',',    'k',    'i',    'o',    '0',    '9',    0,      //0x40
-  0,    '.',    '/',    'l',    ';',    'p',    '-',    0,      //0x48
-  0,    0,      '\'',   0,      '[',    '=',    0,      0,      //0x50
-  CAPS, R_SHFT  ,ENTER, ']',    0,      0x5c,   0,      0,      //0x58
-  0,    0,      0,      0,      0,      0,      BKSP,   0,      //0x60
-  0,    '1',    0,      '4',    '7',    0,      0,      0,      //0x68
-  0,    '.',    '2',    '5',    '6',    '8',    ESC,    NUM,    //0x70
-  F11,  '+',    '3',    '-',    '*',    '9',    0,      0       //0x78
-};  /**< PS2 Keyboard ASCII Value LookUp Table. */
-
-const u8_t PS2_ShiftKeyCodes[128] = {
-  0,    F9,     0,      F5,     F3,     F1,     F2,     F12,    //0x00
-  0,    F10,    F8,     F6,     F4,     TAB,    '~',    0,      //0x08
-  0,    0,      L_SHFT, 0,      L_CTRL, 'Q',    '!',    0,      //0x10
-  0,    0,      'Z',    'S',    'A',    'W',    '@',    0,      //0x18
-  0,    'C',    'X',    'D',    'E',    '$',    '#',    0,      //0x20
-  0,    ' ',    'V',    'F',    'T',    'R',    '%',    0,      //0x28
-  0,    'N',    'B',    'H',    'G',    'Y',    '^',    0,      //0x30
-  0,    0,      'M',    'J',    'U',    '&',    '*',    0,      //0x38
-  0,    '<',    'K',    'I',    'O',    ')',    '(',    0,      //0x40
-  0,    '>',    '?',    'L',    ':',    'P',    '_',    0,      //0x48
-  0,    0,      '\"',   0,      '{',    '+',    0,      0,      //0x50
-  CAPS, R_SHFT, ENTER,  '}',    0,      '|',    0,      0,      //0x58
-  0,    0,      0,      0,      0,      0,      BKSP,   0,      //0x60
-  0,    '1',    0,      '4',    '7',    0,      0,      0,      //0x68
-  0,    '.',    '2',    '5',    '6',    '8',    ESC,    NUM,    //0x70
-  F11,  '+',    '3',    '-',    '*',    '9',    0,      0       //0x78
-};  /**< PS2 Keyboard ASCII Value LookUp Table when Shift Key is Pressed. */
-
-static Queue_s s_queue = {0,-1,{0}};
-static PS2_State_e PS2_State = PS2_START; /**<Track PS2 State in StateMachine.*/
-static PS2_Keyboard_s ps2 = {0, 0, 0, 0, 0, FALSE, FALSE, FALSE};
+const u8_t PS2_KeyMap[PS2_KEYMAP_ROWS][PS2_SET2_MAX] = {
+  { // Shift Released
+    0,    F9,     0,      F5,     F3,     F1,     F2,     F12,    //0x00
+    0,    F10,    F8,     F6,     F4,     TAB,    '`',    0,      //0x08
+    0,    0,      0,      0,      0,      'q',    '1',    0,      //0x10
+    0,    0,      'z',    's',    'a',    'w',    '2',    0,      //0x18
+    0,    'c',    'x',    'd',    'e',    '4',    '3',    0,      //0x20
+    0,    ' ',    'v',    'f',    't',    'r',    '5',    0,      //0x28
+    0,    'n',    'b',    'h',    'g',    'y',    '6',    0,      //0x30
+    0,    0,      'm',    'j',    'u',    '7',    '8',    0,      //0x38
+    0,    ',',    'k',    'i',    'o',    '0',    '9',    0,      //0x40
+    0,    '.',    '/',    'l',    ';',    'p',    '-',    0,      //0x48
+    0,    0,      '\'',   0,      '[',    '=',    0,      0,      //0x50
+    0,    0,      ENTER,  ']',    0,      0x5c,   0,      0,      //0x58
+    0,    0,      0,      0,      0,      0,      BKSP,   0,      //0x60
+    0,    '1',    0,      '4',    '7',    0,      0,      0,      //0x68
+    0,    '.',    '2',    '5',    '6',    '8',    ESC,    0,      //0x70
+    F11,  '+',    '3',    '-',    '*',    '9',    0,      0,      //0x78
+    0,    0,      0,      0                                       //0x80
+  },
+  { // Shift Pressed
+    0,    F9,     0,      F5,     F3,     F1,     F2,     F12,    //0x00
+    0,    F10,    F8,     F6,     F4,     TAB,    '~',    0,      //0x08
+    0,    0,      0,      0,      0,      'Q',    '!',    0,      //0x10
+    0,    0,      'Z',    'S',    'A',    'W',    '@',    0,      //0x18
+    0,    'C',    'X',    'D',    'E',    '$',    '#',    0,      //0x20
+    0,    ' ',    'V',    'F',    'T',    'R',    '%',    0,      //0x28
+    0,    'N',    'B',    'H',    'G',    'Y',    '^',    0,      //0x30
+    0,    0,      'M',    'J',    'U',    '&',    '*',    0,      //0x38
+    0,    '<',    'K',    'I',    'O',    ')',    '(',    0,      //0x40
+    0,    '>',    '?',    'L',    ':',    'P',    '_',    0,      //0x48
+    0,    0,      '\"',   0,      '{',    '+',    0,      0,      //0x50
+    0,    0,      ENTER,  '}',    0,      '|',    0,      0,      //0x58
+    0,    0,      0,      0,      0,      0,      BKSP,   0,      //0x60
+    0,    '1',    0,      '4',    '7',    0,      0,      0,      //0x68
+    0,    '.',    '2',    '5',    '6',    '8',    ESC,    0,      //0x70
+    F11,  '+',    '3',    '-',    '*',    '9',    0,      0,      //0x78
+    0,    0,      0,      0                                       //0x80
+  },
+  { // Extended, Shift Released
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x00
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x08
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x10
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x18
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x20
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x28
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x30
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x38
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x40
+    0,    0,      '/',    0,      0,      0,      0,      0,      //0x48
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x50
+    0,    0,      ENTER,  0,      0,      0,      0,      0,      //0x58
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x60
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x68
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x70
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x78
+    0,    0,      0,      0                                       //0x80
+  },
+  { // Extended, Shift Pressed
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x00
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x08
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x10
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x18
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x20
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x28
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x30
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x38
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x40
+    0,    0,      '/',    0,      0,      0,      0,      0,      //0x48
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x50
+    0,    0,      ENTER,  0,      0,      0,      0,      0,      //0x58
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x60
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x68
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x70
+    0,    0,      0,      0,      0,      0,      0,      0,      //0x78
+    0,    0,      0,      0                                       //0x80
+  }
+};  /**< PS2 Keyboard ASCII Value LookUp Table, see PS2_KEYMAP_xxx. */
+
+#if PS2_ALTGR_LATIN1
+/** AltGr Layer of US-International, Scan Code, Latin-1 without/with Shift. */
+static const u8_t PS2_AltGrMap[][3] = {
+  { 0x15, 0xE4, 0xC4 }, { 0x1D, 0xE5, 0xC5 }, { 0x24, 0xE9, 0xC9 }, // q w e
+  { 0x2D, 0xAE, 0xAE }, { 0x2C, 0xFE, 0xDE }, { 0x35, 0xFC, 0xDC }, // r t y
+  { 0x3C, 0xFA, 0xDA }, { 0x43, 0xED, 0xCD }, { 0x44, 0xF3, 0xD3 }, // u i o
+  { 0x4D, 0xF6, 0xD6 }, { 0x54, 0xAB, 0xAB }, { 0x5B, 0xBB, 0xBB }, // p [ ]
+  { 0x1C, 0xE1, 0xC1 }, { 0x1B, 0xDF, 0xA7 }, { 0x23, 0xF0, 0xD0 }, // a s d
+  { 0x4B, 0xF8, 0xD8 }, { 0x4C, 0xB6, 0xB0 }, { 0x52, 0xB4, 0xA8 }, // l ; '
+  { 0x1A, 0xE6, 0xC6 }, { 0x21, 0xA9, 0xA2 }, { 0x31, 0xF1, 0xD1 }, // z c n
+  { 0x3A, 0xB5, 0xB5 }, { 0x41, 0xE7, 0xC7 }, { 0x4A, 0xBF, 0xBF }, // m , /
+  { 0x16, 0xA1, 0xB9 }, { 0x1E, 0xB2, 0xB2 }, { 0x26, 0xB3, 0xB3 }, // 1 2 3
+  { 0x25, 0xA4, 0xA3 }, { 0x36, 0xBC, 0xBC }, { 0x3D, 0xBD, 0xBD }, // 4 6 7
+  { 0x3E, 0xBE, 0xBE }, { 0x4E, 0xA5, 0xA5 }, { 0x55, 0xD7, 0xF7 }  // 8 - =
+};
+#endif
+
+const u8_t PS2_HidMap[2][PS2_SET2_MAX] = {
+  { // Scan Codes without Prefix
+    0x00, 0x42, 0x00, 0x3E, 0x3C, 0x3A, 0x3B, 0x45,  //0x00
+    0x00, 0x43, 0x41, 0x3F, 0x3D, 0x2B, 0x35, 0x00,  //0x08
+    0x00, 0xE2, 0xE1, 0x00, 0xE0, 0x14, 0x1E, 0x00,  //0x10
+    0x00, 0x00, 0x1D, 0x16, 0x04, 0x1A, 0x1F, 0x00,  //0x18
+    0x00, 0x06, 0x1B, 0x07, 0x08, 0x21, 0x20, 0x00,  //0x20
+    0x00, 0x2C, 0x19, 0x09, 0x17, 0x15, 0x22, 0x00,  //0x28
+    0x00, 0x11, 0x05, 0x0B, 0x0A, 0x1C, 0x23, 0x00,  //0x30
+    0x00, 0x00, 0x10, 0x0D, 0x18, 0x24, 0x25, 0x00,  //0x38
+    0x00, 0x36, 0x0E, 0x0C, 0x12, 0x27, 0x26, 0x00,  //0x40
+    0x00, 0x37, 0x38, 0x0F, 0x33, 0x13, 0x2D, 0x00,  //0x48
+    0x00, 0x00, 0x34, 0x00, 0x2F, 0x2E, 0x00, 0x00,  //0x50
+    0x39, 0xE5, 0x28, 0x30, 0x00, 0x31, 0x00, 0x00,  //0x58
+    0x00, 0x64, 0x00, 0x00, 0x00, 0x00, 0x2A, 0x00,  //0x60
+    0x00, 0x59, 0x00, 0x5C, 0x5F, 0x00, 0x00, 0x00,  //0x68
+    0x62, 0x63, 0x5A, 0x5D, 0x5E, 0x60, 0x29, 0x53,  //0x70
+    0x44, 0x57, 0x5B, 0x56, 0x55, 0x61, 0x47, 0x00,  //0x78
+    0x00, 0x00, 0x00, 0x40                           //0x80
+  },
+  { // E0 Prefixed Scan Codes
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  //0x00
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  //0x08
+    0x00, 0xE6, 0x00, 0x00, 0xE4, 0x00, 0x00, 0x00,  //0x10
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE3,  //0x18
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE7,  //0x20
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x65,  //0x28
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  //0x30
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  //0x38
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  //0x40
+    0x00, 0x00, 0x54, 0x00, 0x00, 0x00, 0x00, 0x00,  //0x48
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  //0x50
+    0x00, 0x00, 0x58, 0x00, 0x00, 0x00, 0x00, 0x00,  //0x58
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  //0x60
+    0x00, 0x4D, 0x00, 0x50, 0x4A, 0x00, 0x00, 0x00,  //0x68
+    0x49, 0x4C, 0x51, 0x00, 0x4F, 0x52, 0x00, 0x00,  //0x70
+    0x00, 0x00, 0x4E, 0x00, 0x46, 0x4B, 0x00, 0x00,  //0x78
+    0x00, 0x00, 0x00, 0x00                           //0x80
+  }
+};  /**< Scan Code Set 2 to USB HID Usage ID LookUp Table. */
+
+const u8_t PS2_KeyClass[256] = {
+  0x00, 0x02, 0x00, 0x02, 0x02, 0x02, 0x02, 0x02,  //0x00
+  0x00, 0x02, 0x02, 0x02, 0x02, 0x01, 0x01, 0x00,  //0x08
+  0x00, 0x03, 0x03, 0x00, 0x03, 0x01, 0x01, 0x00,  //0x10
+  0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,  //0x18
+  0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,  //0x20
+  0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,  //0x28
+  0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,  //0x30
+  0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,  //0x38
+  0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,  //0x40
+  0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00,  //0x48
+  0x00, 0x00, 0x01, 0x00, 0x01, 0x01, 0x00, 0x00,  //0x50
+  0x14, 0x03, 0x01, 0x01, 0x00, 0x01, 0x00, 0x00,  //0x58
+  0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,  //0x60
+  0x00, 0x01, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00,  //0x68
+  0x02, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x24,  //0x70
+  0x02, 0x01, 0x01, 0x01, 0x01, 0x01, 0x44, 0x00,  //0x78
+  0x00, 0x00, 0x00, 0x02, 0x08, 0x08, 0x08, 0x08,  //0x80
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0x88
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0x90
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0x98
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xA0
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xA8
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xB0
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xB8
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xC0
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xC8
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xD0
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xD8
+  0x05, 0x07, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xE0
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xE8
+  0x06, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,  //0xF0
+  0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08   //0xF8
+};  /**< Class of each Byte from Keyboard, see PS2_CLASS_xxx. */
+
+/** PS2 Ports, everything not listed here starts as zero (PS2_START, idle). */
+static PS2_Port_s ports[PS2_PORTS] = {
+  { {PS2_CLK_PORT, PS2_CLK_PIN, PS2_DATA_PORT, PS2_DATA_PIN},
+    PS2_MODE_KEYBOARD },
+  { {PS2_AUX_CLK_PORT, PS2_AUX_CLK_PIN, PS2_AUX_DATA_PORT, PS2_AUX_DATA_PIN},
+    PS2_MODE_KEYBOARD }
+};
+/** PS2 Clock Pins of each GPIO Port, filled by PS2_Keyboard_Init(). */
+static u32_t clock_mask[PS2_GPIO_PORTS] = {0, 0, 0, 0};
 
 /**
  * @brief Initialize PS2 Keyboard.
  *
- * Initialize PS2 Keyboard pins as Input and Clock Pin is configured on falling
- * edge interrupt.
+ * Initialize pins of all PS2 Ports as Input and Clock Pins are configured on
+ * falling edge interrupt.
  */
 void PS2_Keyboard_Init( void )
 {
-  // Enable PS2 Keyboard Clock Interrupt for Port-3
-  NVIC_EnableIRQ(EINT3_IRQn);
-  // Set Keyboard Clock and Data Pin as Input
-  GPIO_SetDir( PS2_CLK_PORT, PS2_CLK_PIN, 0);
-  GPIO_SetDir( PS2_DATA_PORT, PS2_DATA_PIN, 0);
-  // Set External Interrupt Pin, single trigger, active high.
-  GPIO_SetInterrupt( PS2_CLK_PORT, PS2_CLK_PIN, 0, 0, 0);
-  // Enable Interrupt
-  GPIO_IntEnable( PS2_CLK_PORT, PS2_CLK_PIN );
+  u8_t port;
+  PS2_Pins_s *pins;
+  for( port = 0; port < PS2_PORTS; port++ )
+  {
+    pins = &ports[port].pins;
+    // Enable PS2 Clock Interrupt of the GPIO Port, EINT0 has highest number
+    NVIC_EnableIRQ( (IRQn_Type)(EINT0_IRQn - pins->clk_port) );
+    // Set Clock and Data Pin as Input
+    GPIO_SetDir( pins->clk_port, pins->clk_pin, 0);
+    GPIO_SetDir( pins->data_port, pins->data_pin, 0);
+    // Set External Interrupt Pin, single trigger, active high.
+    GPIO_SetInterrupt( pins->clk_port, pins->clk_pin, 0, 0, 0);
+    // Enable Interrupt
+    GPIO_IntEnable( pins->clk_port, pins->clk_pin );
+    clock_mask[pins->clk_port] |= (1ul << pins->clk_pin);
+  }
+}
+
+/**
+ * @brief PS2 GPIO Interrupt.
+ *
+ * Services all PS2 Ports whose Clock Pin is on this GPIO Port. The masked
+ * interrupt status is read once and every Port with a pending falling edge is
+ * run in the same pass, so two devices clocking together cost one interrupt.
+ * Call this function from the PIOINTx_IRQHandler of every GPIO Port which has
+ * a PS2 Clock Pin.
+ * @param gpio_port GPIO Port of the Interrupt, PORT0 to PORT3.
+ */
+void PS2_GPIO_IRQHandler( u8_t gpio_port )
+{
+  u8_t port;
+  u32_t status;
+  status = GPIO_IntMaskedStatus( gpio_port ) & clock_mask[gpio_port];
+  if( status )
+  {
+    GPIO_IntClearMask( gpio_port, status );
+    for( port = 0; port < PS2_PORTS; port++ )
+    {
+      if( ports[port].pins.clk_port == gpio_port &&
+          (status & (1ul << ports[port].pins.clk_pin)) )
+      {
+        PS2_State_Machine(port);
+      }
+    }
+  }
 }
 
 /**
@@ -83,11 +285,26 @@ void PS2_Keyboard_Init( void )
  *
  * Returns the TRUE or FALSE depending on the bus situation, if the bus is busy
  * in some processing of data coming from PS2 keyboard then TRUE will be return.
+ * @param port PS2 Port, see PS2_PORT_xxx.
  * @return True if Busy and False if Free.
  */
-boolean IS_PS2_Busy( void )
+boolean IS_PS2_Busy( u8_t port )
+{
+  PS2_Port_s *p = &ports[port];
+  return ( IS_Frame_In_Progress(p) || IS_Queue_Empty(p) );
+}
+
+/**
+ * @brief Frame Reception in Progress.
+ *
+ * A frame which is not completed within frame window will be discarded, so it
+ * is not considered in progress.
+ * @return TRUE if a frame is being received.
+ */
+static boolean IS_Frame_In_Progress( PS2_Port_s *p )
 {
-  return ( ps2.PS2_Busy || IS_Queue_Empty() );
+  return ( p->ps2.PS2_Busy &&
+           ((micros() - p->ps2.start_us) <= PS2_FRAME_TIMEOUT_US) );
 }
 
 /**
@@ -101,77 +318,242 @@ boolean IS_PS2_Busy( void )
  * @code
  * if( CLOCK PIN goes Low )
  * {
- *  PS2_State_Machine();
+ *  PS2_State_Machine(port);
  * }
  * @endcode
- * @note Call this function in Clock Pin Falling Interrupt.
+ * While a command is being sent to Keyboard, the edge clocks out the next
+ * bit of the command instead.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @note Call this function in Clock Pin Falling Interrupt, PS2_GPIO_IRQHandler()
+ * does this for all Ports.
  */
-void PS2_State_Machine( void )
+void PS2_State_Machine( u8_t port )
 {
-  u32_t regVal = 0;
-  switch (PS2_State)
+  PS2_Port_s *p = &ports[port];
+  if( p->tx.state == PS2_TX_SENDING )
+  {
+    PS2_Transmit_Bit(p);
+  }
+  else if( p->tx.state != PS2_TX_INHIBIT )
+  {
+    PS2_Receive_Bit( port, (u8_t)((GPIO_ReadValue(p->pins.data_port) >>
+                                   p->pins.data_pin) & 0x01) );
+  }
+}
+
+/**
+ * @brief PS2 Receive Bit.
+ *
+ * Runs the PS2 State Machine with the Data Line level sampled by the caller,
+ * used by receivers which sample the Data Line themselves (see ps2_capture.c).
+ * If the frame in progress is older than PS2_FRAME_TIMEOUT_US, an edge was
+ * lost, frame is discarded and this bit is treated as Start Bit.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param regVal Data Line level at the Clock falling edge, 0 or 1.
+ */
+void PS2_Receive_Bit( u8_t port, u8_t regVal )
+{
+  PS2_Port_s *p = &ports[port];
+  u32_t now = micros();
+  if( (p->state != PS2_START) &&
+      ((now - p->ps2.start_us) > PS2_FRAME_TIMEOUT_US) )
+  {
+    p->stats.timeouts++;
+    Port_Wake_Frame(p, FALSE);
+    Port_Resync(p);
+  }
+  switch (p->state)
   {
   default:
   case PS2_START:
-    ps2.parity_value = 0;
-    ps2.scan_code = 0;
-    regVal = (GPIO_ReadValue(PS2_DATA_PORT) >> PS2_DATA_PIN) & 0x01;
+    p->ps2.parity_value = 0;
+    p->ps2.scan_code = 0;
+    p->ps2.bit_pos = 0;
     if( regVal == 0x00 )
     {
       // Start Bit Received
-      PS2_State++;
-      ps2.PS2_Busy = TRUE;
+      p->state = PS2_DATA;
+      p->ps2.PS2_Busy = TRUE;
+      p->ps2.start_us = now;
     }
     break;
   case PS2_DATA:
-    regVal = (GPIO_ReadValue(PS2_DATA_PORT) >> PS2_DATA_PIN) & 0x01;
-    ps2.parity_value = regVal ? (++ps2.parity_value):(ps2.parity_value);
+    p->ps2.parity_value += regVal;
     // In PS2 0 Level Means Logic 1 and 5V Level means Logic 0
     /* Following If Else Logic can be simpilfied. I think*/
     if( regVal )
     {
-      SET_BIT(ps2.scan_code,ps2.bit_pos);
+      SET_BIT(p->ps2.scan_code,p->ps2.bit_pos);
     }
     else
     {
-      CLR_BIT(ps2.scan_code,ps2.bit_pos);
+      CLR_BIT(p->ps2.scan_code,p->ps2.bit_pos);
     }
-    ps2.bit_pos++;
-    if( ps2.bit_pos >= 8 )
+    p->ps2.bit_pos++;
+    if( p->ps2.bit_pos >= 8 )
     {
-      ps2.bit_pos = 0;
-      PS2_State++;
+      p->ps2.bit_pos = 0;
+      p->state++;
     }
     break;
   case PS2_PARITY:
-    regVal = (GPIO_ReadValue(PS2_DATA_PORT) >> PS2_DATA_PIN) & 0x01;
-    if( regVal != (ps2.parity_value%2) )
+    if( regVal != (p->ps2.parity_value%2) )
     {
-      PS2_State++;
+      p->state++;
     }
     else
     {
-      PS2_State = PS2_START;
+      p->stats.parity_errors++;
+      p->ps2.Resend = TRUE;
+      Port_Wake_Frame(p, FALSE);
+      Port_Resync(p);
     }
     break;
   case PS2_STOP:
-    regVal = (GPIO_ReadValue(PS2_DATA_PORT) >> PS2_DATA_PIN) & 0x01;
     if( regVal )
     {
-      if (ps2.last_scan_code != ps2.scan_code 
-          || ps2.penultimate_scan_code != ps2.scan_code )
+      p->stats.frames++;
+      Latency_Record(LATENCY_FRAME, p->ps2.start_us);
+      if( p->tx.state == PS2_TX_WAIT_REPLY && (p->ps2.scan_code == PS2_REPLY_ACK ||
+                                            p->ps2.scan_code == PS2_REPLY_RESEND) )
       {
-        ps2.penultimate_scan_code = ps2.last_scan_code;
-        ps2.last_scan_code = ps2.scan_code;
-        Insert_In_Queue(ps2.scan_code);
+        // Reply to Command is not a Key
+        p->tx.reply = p->ps2.scan_code;
+        p->tx.state = PS2_TX_REPLIED;
+      }
+      else if( p->mode == PS2_MODE_MOUSE )
+      {
+        // Packets are assembled here so a busy main loop can't lose them,
+        // other bytes (BAT, Device ID) are queued as they are
+        if( !PS2_Mouse_Receive_Byte(port, p->ps2.scan_code) &&
+            !Insert_In_Queue(p, p->ps2.scan_code, p->ps2.start_us) )
+        {
+          p->stats.overruns++;
+        }
+      }
+      else if( !Insert_In_Queue(p, p->ps2.scan_code, p->ps2.start_us) )
+      {
+        p->stats.overruns++;
       }
     }
-    PS2_State = PS2_START;
-    ps2.PS2_Busy = FALSE;
+    else
+    {
+      p->stats.framing_errors++;
+      p->ps2.Resend = TRUE;
+    }
+    Port_Wake_Frame(p, (boolean)regVal);
+    // Wake up main loop for the key, command reply or Resend
+    Event_Post(EVENT_PS2);
+    Port_Resync(p);
     break;
   }
 }
 
+/**
+ * @brief PS2 Resynchronize.
+ *
+ * Discards the partially received frame, next bit is treated as Start Bit.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ */
+void PS2_Resync( u8_t port )
+{
+  Port_Resync(&ports[port]);
+}
+
+/**
+ * @brief PS2 Port woke the Core from Deep-Sleep.
+ *
+ * Called after the falling clock edge of a start bit woke the core up. GPIO
+ * interrupts don't see edges during Deep-Sleep, so the start bit is given to
+ * the State Machine here if the GPIO interrupt didn't see the edge, the start
+ * bit is always 0. The first frame is timed from wake_us, see LATENCY_WAKE.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param wake_us Wake-Up Time, see micros().
+ * @param start_bit TRUE if the start bit must be given to the State Machine.
+ */
+void PS2_Wake( u8_t port, u32_t wake_us, boolean start_bit )
+{
+  PS2_Port_s *p = &ports[port];
+  p->stats.wakes++;
+  p->wake_us = wake_us;
+  p->waking = TRUE;
+  if( start_bit )
+  {
+    PS2_Receive_Bit(port, 0);
+  }
+}
+
+/**
+ * @brief PS2 Port Idle.
+ *
+ * A Port is idle if no frame is being received, all received bytes are taken
+ * and no command or resend is waiting. Core may go to Deep-Sleep only if all
+ * Ports are idle.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @return TRUE if Idle.
+ */
+boolean IS_PS2_Idle( u8_t port )
+{
+  PS2_Port_s *p = &ports[port];
+  return ( p->state == PS2_START && IS_Queue_Empty(p) && !p->ps2.Resend &&
+           !IS_PS2_Command_Pending(port) );
+}
+
+/**
+ * @brief First Frame after Wake-Up ended.
+ * @param ok TRUE if the Frame was received, FALSE if it was aborted.
+ */
+static void Port_Wake_Frame( PS2_Port_s *p, boolean ok )
+{
+  if( p->waking )
+  {
+    p->waking = FALSE;
+    if( ok )
+    {
+      Latency_Record(LATENCY_WAKE, p->wake_us);
+    }
+    else
+    {
+      p->stats.wake_errors++;
+    }
+  }
+}
+
+/**
+ * @brief Resynchronize Port.
+ */
+static void Port_Resync( PS2_Port_s *p )
+{
+  p->state = PS2_START;
+  p->ps2.bit_pos = 0;
+  p->ps2.PS2_Busy = FALSE;
+}
+
+/**
+ * @brief Set Device Type of PS2 Port.
+ *
+ * Partially received frame and queued bytes are discarded.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param mode PS2_MODE_KEYBOARD or PS2_MODE_MOUSE.
+ */
+void PS2_Set_Mode( u8_t port, u8_t mode )
+{
+  PS2_Port_s *p = &ports[port];
+  p->mode = mode;
+  Port_Resync(p);
+  p->queue.tail = p->queue.head;
+}
+
+/**
+ * @brief PS2 Port Pins.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @return Pointer to Pin Binding of Port.
+ */
+const PS2_Pins_s* PS2_Get_Pins( u8_t port )
+{
+  return &ports[port].pins;
+}
+
 /**
  * @brief Queue is Empty or Not.
  *
@@ -179,113 +561,336 @@ void PS2_State_Machine( void )
  * TRUE if empty.
  * @return TRUE is PS2 Data Queue is Empty, otherwise FALSE.
  */
-static boolean IS_Queue_Empty( void )
+static boolean IS_Queue_Empty( PS2_Port_s *p )
 {
-  boolean is_empty = FALSE;
-  if( (s_queue.front == 0) && (s_queue.rear == -1) )
-  {
-    // Queue is Empty
-    is_empty = TRUE;
-  }
-  return is_empty;
+  return ( p->queue.head == p->queue.tail );
 }
 
 /**
  * @brief Insert In Queue.
  *
- * The function will insert data into queue.
+ * The function will insert data into queue, it must only be called from the
+ * PS2 Interrupt (single producer).
  * @param scan_code Data to insert into Queue.
+ * @param timestamp Start Bit Time of Data in micro-seconds.
  * @return TRUE if insertion is successfull otherwise FALSE.
  */
-static boolean Insert_In_Queue( u8_t scan_code )
+static boolean Insert_In_Queue( PS2_Port_s *p, u8_t scan_code,
+                                u32_t timestamp )
 {
   boolean inserted = FALSE;
-  if ((s_queue.front == 0 && s_queue.rear == SCAN_CODE_MAX-1) ||
-      (s_queue.front > 0 && s_queue.rear == s_queue.front-1))
+  u8_t head = p->queue.head;
+  if( (u8_t)(head - p->queue.tail) < SCAN_CODE_MAX )
   {
-    // Queue is Full
-    inserted = FALSE;
+    p->queue.scan_codes_buffer[head & SCAN_CODE_MASK] = scan_code;
+    p->queue.timestamps[head & SCAN_CODE_MASK] = timestamp;
+    // Publish the data only after it is written in buffer
+    p->queue.head = (u8_t)(head + 1u);
+    inserted = TRUE;
   }
-  else
+  return inserted;
+}
+
+/**
+ * @brief Delete From Queue.
+ *
+ * The function will remove data from queue based on FIFO principle, it must
+ * only be called from main loop (single consumer). Interrupts are not disabled
+ * as ISR never writes the tail counter.
+ * @return Data removed from Queue, 0 if Queue is Empty.
+ */
+static u8_t Delete_From_Queue ( PS2_Port_s *p )
+{
+  u8_t data = 0;
+  u8_t tail = p->queue.tail;
+  if( tail != p->queue.head )
   {
-    if (s_queue.rear == SCAN_CODE_MAX-1 && s_queue.front > 0)
-    {
-      s_queue.rear = 0;
-      s_queue.scan_codes_buffer[s_queue.rear] = scan_code;
-    }
-    else
+    data = p->queue.scan_codes_buffer[tail & SCAN_CODE_MASK];
+    // Release the slot only after data is read from buffer
+    p->queue.tail = (u8_t)(tail + 1u);
+  }
+  return data;
+}
+
+/**
+ * @brief Get From Queue.
+ *
+ * The function will return data from queue based on FIFO principle, without 
+ * deleting it.
+ * @return Front Data in Queue.
+ */
+static u8_t Get_From_Queue ( PS2_Port_s *p )
+{
+  u8_t data = 0;
+  u8_t tail = p->queue.tail;
+  if( tail != p->queue.head )
+  {
+    data = p->queue.scan_codes_buffer[tail & SCAN_CODE_MASK];
+  }
+  return data;
+}
+
+/**
+ * @brief Get Received Byte.
+ *
+ * Removes one byte from the queue without decoding it, used for the replies
+ * of a mouse during its initialization.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param data Filled with the Byte.
+ * @return TRUE if a Byte was available, otherwise FALSE.
+ */
+boolean PS2_Get_Byte( u8_t port, u8_t *data )
+{
+  PS2_Port_s *p = &ports[port];
+  boolean got = FALSE;
+  if( !IS_Queue_Empty(p) )
+  {
+    *data = Delete_From_Queue(p);
+    got = TRUE;
+  }
+  return got;
+}
+
+/**
+ * @brief Key ASCII Value.
+ *
+ * Finds the ASCII value of a key, based on Shift Key and Caps Lock state. The
+ * row of the translation table is computed from the state bits, so the lookup
+ * doesn't branch on the key or on the modifiers.
+ * @param scan_code Scan Code without prefixes.
+ * @param extended TRUE if Scan Code had E0 prefix.
+ * @return ASCII Value of Key, 0 if key is not printable.
+ */
+static u8_t Key_To_Ascii( PS2_Port_s *p, u8_t scan_code, boolean extended )
+{
+  u8_t row;
+  // Right Shift is folded on Left Shift bit, Caps Lock inverts Shift
+  row = (u8_t)(((p->parser.modifiers | (p->parser.modifiers >> 4)) >> 1) & 1u);
+  row ^= (u8_t)((p->parser.locks >> 4) & 1u);
+  row |= (u8_t)(extended << 1);
+  return PS2_KeyMap[row][scan_code];
+}
+
+#if PS2_ALTGR_LATIN1
+/**
+ * @brief Key Latin-1 Value with AltGr.
+ *
+ * AltGr (Right Alt) types the Latin-1 characters of the US-International
+ * layout, Shift selects the second character. Caps Lock only shifts the
+ * letters.
+ * @param scan_code Scan Code without prefixes.
+ * @return Latin-1 Value of Key, 0 if the key has no AltGr character.
+ */
+static u8_t Key_To_Latin1( PS2_Port_s *p, u8_t scan_code )
+{
+  u8_t i, shift, latin1 = 0;
+  // Right Shift is folded on Left Shift bit like Key_To_Ascii()
+  shift = (u8_t)(((p->parser.modifiers | (p->parser.modifiers >> 4)) >> 1) &
+                 1u);
+  for( i = 0; i < sizeof(PS2_AltGrMap) / sizeof(PS2_AltGrMap[0]); i++ )
+  {
+    if( PS2_AltGrMap[i][0] == scan_code )
     {
-      if ((s_queue.front == 0 && s_queue.rear == -1) 
-          || (s_queue.rear != s_queue.front-1) )
+      if( PS2_AltGrMap[i][1] >= 0xE0u && PS2_AltGrMap[i][1] != 0xF7u )
       {
-        s_queue.rear++;
-        s_queue.scan_codes_buffer[s_queue.rear] = scan_code;
+        shift ^= (u8_t)((p->parser.locks >> 4) & 1u);
       }
-      inserted = TRUE;
+      latin1 = PS2_AltGrMap[i][1u + shift];
     }
   }
-  return inserted;
+  return latin1;
 }
+#endif
 
 /**
- * @brief Delete From Queue.
+ * @brief LED Mask of a Lock State.
+ * @param locks Lock State, see PS2_EVT_xxx.
+ * @return LED Mask of PS2_CMD_SET_LEDS.
+ */
+static u8_t Locks_To_Leds( u8_t locks )
+{
+  return (u8_t)(((locks & PS2_EVT_CAPS) ? PS2_LED_CAPS : 0) |
+                ((locks & PS2_EVT_NUM) ? PS2_LED_NUM : 0) |
+                ((locks & PS2_EVT_SCROLL) ? PS2_LED_SCROLL : 0));
+}
+
+/**
+ * @brief Make Key Event.
  *
- * The function will remove data from queue based on FIFO principle.
- * @return Data removed from Queue.
+ * Updates the pressed keys, modifiers and locks and fills the event.
  */
-static u8_t Delete_From_Queue ( void )
+static void Make_Key_Event( PS2_Port_s *p, u8_t scan_code, u8_t keycode,
+                            boolean extended, boolean release,
+                            PS2_Key_Event_s *event )
 {
-  u8_t data = 0;
-  __disable_interrupt();
-  if( (s_queue.front == 0) && (s_queue.rear == -1) )
+  u8_t mask = (u8_t)(1u << (keycode & 0x07u));
+  u8_t flags = 0;
+  if( release )
   {
-    // Queue is Empty
-    data = 0;
+    p->parser.key_down[keycode >> 3] &= (u8_t)~mask;
   }
-  if ( s_queue.front == s_queue.rear )
+  else
   {
-    data = s_queue.scan_codes_buffer[s_queue.front];
-    s_queue.scan_codes_buffer[s_queue.front] = 0;
-    // Deleting Last Element from Queue and Reseting the Queue Parameters
-    s_queue.rear = -1;
-    s_queue.front = 0;
+    flags = PS2_EVT_MAKE;
+    if( p->parser.key_down[keycode >> 3] & mask )
+    {
+      flags |= PS2_EVT_REPEAT;
+    }
+    p->parser.key_down[keycode >> 3] |= mask;
   }
-  else if( s_queue.front == SCAN_CODE_MAX-1 )
+  if( keycode >= PS2_KEY_LCTRL && keycode <= PS2_KEY_RGUI )
   {
-    data = s_queue.scan_codes_buffer[s_queue.front];
-    s_queue.scan_codes_buffer[s_queue.front] = 0x00;
-    s_queue.front = 0;
+    if( release )
+      CLR_BIT(p->parser.modifiers, keycode - PS2_KEY_LCTRL);
+    else
+      SET_BIT(p->parser.modifiers, keycode - PS2_KEY_LCTRL);
   }
-  else 
+  else if( flags == PS2_EVT_MAKE && !extended )
   {
-    data = s_queue.scan_codes_buffer[s_queue.front];
-    s_queue.scan_codes_buffer[s_queue.front] = 0x00;    // Empty this location
-    s_queue.front++;
+    // Lock keys toggle on press only, not on typematic repeat
+    // Lock State set by a USB host changes only when the host says so
+    u8_t lock = PS2_KeyClass[scan_code] & PS2_EVT_LOCKS;
+    if( lock && !p->parser.host_locks )
+    {
+      p->parser.locks ^= lock;
+      Port_Send_Command_Arg(p, PS2_CMD_SET_LEDS,
+                            Locks_To_Leds(p->parser.locks));
+    }
   }
-  __enable_interrupt();
-  return data;
+  event->keycode = keycode;
+  event->ascii = Key_To_Ascii(p, scan_code, extended);
+#if PS2_ALTGR_LATIN1
+  if( (p->parser.modifiers & PS2_MOD_RALT) && !extended )
+  {
+    event->ascii = Key_To_Latin1(p, scan_code);
+  }
+#endif
+  event->modifiers = p->parser.modifiers;
+  event->flags = (u8_t)(flags | p->parser.locks);
+  event->timestamp = p->parser.timestamp;
 }
 
 /**
- * @brief Get From Queue.
+ * @brief Parse PS2 Scan Code.
  *
- * The function will return data from queue based on FIFO principle, without 
- * deleting it.
- * @return Front Data in Queue.
+ * Incremental Scan Code Set 2 parser, one byte at a time. Prefixes (E0, F0)
+ * and the Pause Key sequence (E1 14 77 E1 F0 14 F0 77) are remembered between
+ * calls, so a sequence can arrive in parts.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param scan_code Byte received from Keyboard.
+ * @param event Filled with Key Event when a sequence is complete.
+ * @return TRUE if event is filled, otherwise FALSE.
+ * @note Event is stamped with the time the first byte of the sequence was
+ * given to this function, keys from the queue carry their Start Bit time.
  */
-static u8_t Get_From_Queue ( void )
+boolean PS2_Parse_Byte( u8_t port, u8_t scan_code, PS2_Key_Event_s *event )
 {
-  u8_t data = 0;
-  if( (s_queue.front == 0) && (s_queue.rear == -1) )
+  return Port_Parse_Byte(&ports[port], scan_code, micros(), event);
+}
+
+/**
+ * @brief Parse Scan Code of Port.
+ */
+static boolean Port_Parse_Byte( PS2_Port_s *p, u8_t scan_code,
+                                u32_t timestamp, PS2_Key_Event_s *event )
+{
+  boolean complete = FALSE;
+  boolean extended, release;
+  u8_t keycode = PS2_KEY_NONE;
+  if( p->parser.pause_count )
   {
-    // Queue is Empty
-    data = 0;
+    // Rest of Pause sequence has no information
+    p->parser.pause_count++;
+    if( p->parser.pause_count >= PS2_PAUSE_LEN )
+    {
+      // Pause has no release sequence, release event is given on next call
+      p->parser.pause_count = 0;
+      p->parser.pause_release = TRUE;
+      Make_Key_Event(p, scan_code, PS2_KEY_PAUSE, TRUE, FALSE, event);
+      complete = TRUE;
+    }
+    return complete;
   }
-  else
+  if( !p->parser.extended && !p->parser.release )
   {
-    data = s_queue.scan_codes_buffer[s_queue.front];
+    // Key is stamped with its first byte, prefixes included
+    p->parser.timestamp = timestamp;
   }
-  return data;
+  switch( PS2_KeyClass[scan_code] & PS2_CLASS_MASK )
+  {
+  case PS2_CLASS_EXTENDED:
+    p->parser.extended = TRUE;
+    break;
+  case PS2_CLASS_BREAK:
+    p->parser.release = TRUE;
+    break;
+  case PS2_CLASS_PAUSE:
+    p->parser.extended = FALSE;
+    p->parser.release = FALSE;
+    p->parser.pause_count = 1;
+    break;
+  case PS2_CLASS_INVALID:
+    // Keyboard replies (ACK, BAT) end any partial sequence
+    p->parser.extended = FALSE;
+    p->parser.release = FALSE;
+    break;
+  default:
+    extended = p->parser.extended;
+    release = p->parser.release;
+    p->parser.extended = FALSE;
+    p->parser.release = FALSE;
+    keycode = PS2_HidMap[extended][scan_code];
+    // Unknown codes and fake shifts are dropped
+    if( keycode != PS2_KEY_NONE )
+    {
+      Make_Key_Event(p, scan_code, keycode, extended, release, event);
+      complete = TRUE;
+    }
+    break;
+  }
+  return complete;
+}
+
+/**
+ * @brief Get Key Event.
+ *
+ * Parses the received Scan Codes until a key event is complete. If the queue
+ * runs empty in middle of a sequence, the partial sequence is kept and parsing
+ * continues on next call. Event carries the Start Bit time of its first byte,
+ * micros() - timestamp is the latency from the key to its handling.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param event Filled with Key Event.
+ * @return TRUE if event is filled, FALSE if no complete event is available.
+ */
+boolean PS2_Get_Event( u8_t port, PS2_Key_Event_s *event )
+{
+  return Port_Get_Event(&ports[port], event);
+}
+
+/**
+ * @brief Get Key Event of Port.
+ */
+static boolean Port_Get_Event( PS2_Port_s *p, PS2_Key_Event_s *event )
+{
+  boolean got = FALSE;
+  u32_t timestamp;
+  if( p->parser.pause_release )
+  {
+    p->parser.pause_release = FALSE;
+    Make_Key_Event(p, 0, PS2_KEY_PAUSE, TRUE, TRUE, event);
+    got = TRUE;
+  }
+  while( !got && !IS_Queue_Empty(p) )
+  {
+    timestamp = p->queue.timestamps[p->queue.tail & SCAN_CODE_MASK];
+    Latency_Record(LATENCY_DEQUEUE, timestamp);
+    got = Port_Parse_Byte( p, Delete_From_Queue(p), timestamp, event );
+  }
+  if( got )
+  {
+    Latency_Record(LATENCY_DECODE, event->timestamp);
+  }
+  return got;
 }
 
 /**
@@ -295,45 +900,15 @@ static u8_t Get_From_Queue ( void )
  * received from the PS2 Keyboard.
  * It handles the Shift Key and Caps Key Press.
  * @return ASCII Value of Key Pressed from PS2 Keyboard.
- * @note On Pressing Caps/Num/Scroll Keys, Keyboard LED will not glow.
+ * @note Caps/Num/Scroll LEDs are updated by PS2_Command_Task().
  */
-static u8_t Decode_PS2_Key( void )
+static u8_t Decode_PS2_Key( PS2_Port_s *p )
 {
   u8_t key_value = 0;
-  u8_t key_scan_code = 0u;
-  key_scan_code = Delete_From_Queue();
-  switch(key_scan_code)
-  {
-  case 0xF0:
-    // Discard Next Data, as this is already taken care
-    key_scan_code = Delete_From_Queue();
-    if( key_scan_code == L_SHFT || key_scan_code == R_SHFT )
-    {
-      if( ps2.ShiftKey )
-        ps2.ShiftKey = FALSE;
-    }
-    break;
-  default:
-    if( key_scan_code == L_SHFT || key_scan_code == R_SHFT )
-    {
-      ps2.ShiftKey = TRUE;
-      break;
-    }
-    if( key_scan_code == CAPS )
-    {
-      if( ps2.CapsLock )
-        ps2.CapsLock = FALSE;
-      else
-        ps2.CapsLock = TRUE;
-      break;
-    }
-    if( ps2.CapsLock )
-      key_value = ps2.ShiftKey ? PS2_KeyCodes[key_scan_code]
-        :PS2_ShiftKeyCodes[key_scan_code];
-    else
-      key_value = ps2.ShiftKey ? PS2_ShiftKeyCodes[key_scan_code]
-        :PS2_KeyCodes[key_scan_code];
-    break;
+  PS2_Key_Event_s event;
+  if( Port_Get_Event(p, &event) && (event.flags & PS2_EVT_MAKE) )
+  {
+    key_value = event.ascii;
   }
   return key_value;
 }
@@ -342,12 +917,389 @@ static u8_t Decode_PS2_Key( void )
  * @brief Get Pressed Key.
  *
  * This is a Public functions which returns the pressed Key ASCII Value
+ * @param port PS2 Port, see PS2_PORT_xxx.
  * @return ASCII Value of Key Pressed from PS2 Keyboard.
- * @note On Pressing Caps/Num/Scroll Keys, Keyboard LED will not glow.
+ * @note Caps/Num/Scroll LEDs are updated by PS2_Command_Task().
  */
-u8_t getKey( void )
+u8_t getKey( u8_t port )
 {
   u8_t key;
-  key = Decode_PS2_Key();
+  key = Decode_PS2_Key(&ports[port]);
   return key;
 }
+
+/**
+ * @brief Time of Pressed Key.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @return Start Bit Time of the Key last returned by getKey(), see micros().
+ */
+u32_t PS2_Get_Key_Time( u8_t port )
+{
+  return ports[port].parser.timestamp;
+}
+
+/**
+ * @brief Read Pressed Keys.
+ *
+ * Drains the PS2 queue and stores upto n decoded ASCII Values in buffer, Scan
+ * Codes which doesn't result in a key (break codes, shift etc.) are consumed
+ * but not stored.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param buf Buffer to store ASCII Values of Keys.
+ * @param n Size of Buffer.
+ * @return Number of Keys stored in buffer.
+ */
+u8_t PS2_ReadKeys( u8_t port, u8_t *buf, u8_t n )
+{
+  PS2_Port_s *p = &ports[port];
+  u8_t count = 0;
+  u8_t key;
+  while( (count < n) && !IS_Queue_Empty(p) )
+  {
+    key = Decode_PS2_Key(p);
+    if( key )
+    {
+      buf[count++] = key;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief PS2 Receiver Statistics.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @return Pointer to Statistics.
+ */
+const PS2_Stats_s* PS2_Get_Stats( u8_t port )
+{
+  return &ports[port].stats;
+}
+
+/**
+ * @brief Drive PS2 Data Line.
+ *
+ * PS2 lines are open collector, logic 0 is driven low and logic 1 is released
+ * to the pull-up by making the pin input. Pin Data Register must be 0.
+ * GPIO_SetDir() is a read-modify-write of DIR, which the clock interrupt of
+ * every Port also writes, so the main loop calls it with interrupts disabled.
+ * @param level 0 to drive Low, 1 to release.
+ */
+static void PS2_Data_Drive( PS2_Port_s *p, u8_t level )
+{
+  GPIO_SetDir( p->pins.data_port, p->pins.data_pin, level ? 0 : 1 );
+}
+
+/**
+ * @brief PS2 Transmit Bit.
+ *
+ * Called on Clock falling edges while a command byte is sent, Keyboard reads
+ * the Data Line on the following rising edge. After 8 Data Bits, Parity and
+ * Stop Bit, Keyboard pulls Data Low to Acknowledge the byte.
+ */
+static void PS2_Transmit_Bit( PS2_Port_s *p )
+{
+  u8_t bit;
+  if( p->tx.bit_pos < 8u )
+  {
+    bit = (u8_t)((p->tx.data >> p->tx.bit_pos) & 0x01u);
+    p->tx.parity += bit;
+    PS2_Data_Drive(p, bit);
+  }
+  else if( p->tx.bit_pos == 8u )
+  {
+    // Odd Parity
+    PS2_Data_Drive( p, (p->tx.parity & 0x01u) ? 0u : 1u );
+  }
+  else if( p->tx.bit_pos == 9u )
+  {
+    // Stop Bit
+    PS2_Data_Drive(p, 1u);
+  }
+  else
+  {
+    p->tx.acked = ((GPIO_ReadValue(p->pins.data_port) >> p->pins.data_pin) &
+                   0x01) ? FALSE : TRUE;
+    // Reply must be caught by the receiver, so switch state here itself
+    p->tx.state = (p->tx.acked && (p->tx.flags & PS2_CMDF_ACK)) ? PS2_TX_WAIT_REPLY
+                                                       : PS2_TX_SENT;
+  }
+  p->tx.bit_pos++;
+}
+
+/**
+ * @brief Queue Command Byte.
+ *
+ * Command is sent by PS2_Command_Task(), Caps/Num/Scroll LEDs are updated by
+ * the decoder itself.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param command Byte to send.
+ * @param flags PS2_CMDF_ACK if Keyboard acknowledges the byte.
+ * @return TRUE if queued, FALSE if Command Queue is Full.
+ */
+boolean PS2_Send_Command( u8_t port, u8_t command, u8_t flags )
+{
+  return Port_Send_Command(&ports[port], command, flags);
+}
+
+/**
+ * @brief Queue Command Byte on Port.
+ */
+static boolean Port_Send_Command( PS2_Port_s *p, u8_t command, u8_t flags )
+{
+  boolean queued = FALSE;
+  if( (u8_t)(p->tx.head - p->tx.tail) < PS2_CMD_QUEUE_SIZE )
+  {
+    p->tx.queue[p->tx.head & (PS2_CMD_QUEUE_SIZE-1u)].data = command;
+    p->tx.queue[p->tx.head & (PS2_CMD_QUEUE_SIZE-1u)].flags = flags;
+    p->tx.head++;
+    queued = TRUE;
+  }
+  return queued;
+}
+
+/**
+ * @brief Queue Command with Argument.
+ *
+ * Both bytes are queued or none, so that a command is never sent without its
+ * argument.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param command Command Byte.
+ * @param argument Argument Byte.
+ * @return TRUE if queued, FALSE if Command Queue is Full.
+ */
+boolean PS2_Send_Command_Arg( u8_t port, u8_t command, u8_t argument )
+{
+  return Port_Send_Command_Arg(&ports[port], command, argument);
+}
+
+/**
+ * @brief Queue Command with Argument on Port.
+ */
+static boolean Port_Send_Command_Arg( PS2_Port_s *p, u8_t command,
+                                      u8_t argument )
+{
+  boolean queued = FALSE;
+  if( (u8_t)(p->tx.head - p->tx.tail) < PS2_CMD_QUEUE_SIZE - 1u )
+  {
+    Port_Send_Command(p, command, PS2_CMDF_ACK);
+    Port_Send_Command(p, argument, PS2_CMDF_ACK | PS2_CMDF_ARG);
+    queued = TRUE;
+  }
+  return queued;
+}
+
+/**
+ * @brief Set Keyboard LEDs.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param leds LED Mask, PS2_LED_CAPS, PS2_LED_NUM and PS2_LED_SCROLL.
+ * @return TRUE if queued, FALSE if Command Queue is Full.
+ */
+boolean PS2_Set_Leds( u8_t port, u8_t leds )
+{
+  return Port_Send_Command_Arg(&ports[port], PS2_CMD_SET_LEDS,
+                               (u8_t)(leds & 0x07u));
+}
+
+/**
+ * @brief Set Lock State.
+ *
+ * A USB host keeps Caps, Num and Scroll Lock itself and sends their state in
+ * its LED report. From the first call lock keys no longer toggle the state of
+ * the port, ASCII Values follow the state set here and the LEDs show it.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param locks Lock State, PS2_EVT_CAPS, PS2_EVT_NUM and PS2_EVT_SCROLL.
+ * @return TRUE if LEDs are queued, FALSE if Command Queue is Full.
+ */
+boolean PS2_Set_Locks( u8_t port, u8_t locks )
+{
+  PS2_Port_s *p = &ports[port];
+  p->parser.host_locks = TRUE;
+  p->parser.locks = (u8_t)(locks & PS2_EVT_LOCKS);
+  return Port_Send_Command_Arg(p, PS2_CMD_SET_LEDS,
+                               Locks_To_Leds(p->parser.locks));
+}
+
+/**
+ * @brief Set Keyboard Typematic Rate and Delay.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param typematic Rate in bits 0-4 and Delay in bits 5-6, use
+ * PS2_TYPEMATIC_FASTEST for 30 cps after 250ms.
+ * @return TRUE if queued, FALSE if Command Queue is Full.
+ */
+boolean PS2_Set_Typematic( u8_t port, u8_t typematic )
+{
+  return Port_Send_Command_Arg(&ports[port], PS2_CMD_TYPEMATIC,
+                               (u8_t)(typematic & 0x7Fu));
+}
+
+/**
+ * @brief Enable or Disable Keyboard Scanning.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param enable TRUE to Enable, FALSE to Disable.
+ * @return TRUE if queued, FALSE if Command Queue is Full.
+ */
+boolean PS2_Enable_Scanning( u8_t port, boolean enable )
+{
+  return PS2_Send_Command(port, enable ? PS2_CMD_ENABLE : PS2_CMD_DISABLE,
+                          PS2_CMDF_ACK);
+}
+
+/**
+ * @brief Reset Keyboard.
+ *
+ * Keyboard acknowledges and runs its self test, LEDs and Typematic settings
+ * go back to default.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @return TRUE if queued, FALSE if Command Queue is Full.
+ */
+boolean PS2_Reset( u8_t port )
+{
+  return PS2_Send_Command(port, PS2_CMD_RESET, PS2_CMDF_ACK);
+}
+
+/**
+ * @brief PS2 Command Pending.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @return TRUE if a Command is queued or being sent.
+ */
+boolean IS_PS2_Command_Pending( u8_t port )
+{
+  PS2_Port_s *p = &ports[port];
+  return ( p->tx.head != p->tx.tail || p->tx.state != PS2_TX_IDLE );
+}
+
+/**
+ * @brief Command Byte Complete.
+ */
+static void PS2_Command_Done( PS2_Port_s *p )
+{
+  p->stats.commands++;
+  p->tx.tail++;
+  p->tx.retries = 0;
+  p->tx.state = PS2_TX_IDLE;
+}
+
+/**
+ * @brief Command Byte Failed.
+ *
+ * Byte is sent again, after PS2_CMD_RETRIES it is dropped along with its
+ * arguments.
+ */
+static void PS2_Command_Retry( PS2_Port_s *p )
+{
+  // Release the bus, DIR is shared with pins driven by the clock interrupt
+  __disable_interrupt();
+  PS2_Data_Drive(p, 1u);
+  GPIO_SetDir( p->pins.clk_port, p->pins.clk_pin, 0);
+  __enable_interrupt();
+  p->tx.retries++;
+  p->stats.resends++;
+  if( p->tx.retries > PS2_CMD_RETRIES )
+  {
+    p->stats.tx_errors++;
+    p->tx.retries = 0;
+    do
+    {
+      p->tx.tail++;
+    } while( p->tx.tail != p->tx.head &&
+             (p->tx.queue[p->tx.tail & (PS2_CMD_QUEUE_SIZE-1u)].flags & PS2_CMDF_ARG) );
+  }
+  p->tx.state = PS2_TX_IDLE;
+}
+
+/**
+ * @brief PS2 Command Task.
+ *
+ * Sends the queued commands to Keyboard, and asks Keyboard to resend a frame
+ * received with error. Call this function from the main loop, it never waits.
+ * Transmission is: Clock inhibited for PS2_INHIBIT_MS, Data pulled Low as
+ * Request to Send and Clock released, Keyboard then clocks in the byte (see
+ * PS2_Transmit_Bit()) and replies with ACK. All PS2 Ports are serviced.
+ * @note Only supported with the GPIO Interrupt Receiver.
+ */
+void PS2_Command_Task( void )
+{
+  u8_t port;
+  for( port = 0; port < PS2_PORTS; port++ )
+  {
+    Port_Command_Task(&ports[port]);
+  }
+}
+
+/**
+ * @brief Command Task of Port.
+ */
+static void Port_Command_Task( PS2_Port_s *p )
+{
+  u32_t now = millis();
+  PS2_Command_s *cmd;
+  switch( p->tx.state )
+  {
+  case PS2_TX_IDLE:
+    // Resend Request goes before any queued command, it stays pending while
+    // the queue is full or the next byte is the argument of a sent command
+    if( p->ps2.Resend &&
+        (u8_t)(p->tx.head - p->tx.tail) < PS2_CMD_QUEUE_SIZE &&
+        ( p->tx.head == p->tx.tail ||
+          !(p->tx.queue[p->tx.tail & (PS2_CMD_QUEUE_SIZE-1u)].flags & PS2_CMDF_ARG) ) )
+    {
+      p->ps2.Resend = FALSE;
+      p->tx.tail--;
+      p->tx.queue[p->tx.tail & (PS2_CMD_QUEUE_SIZE-1u)].data = PS2_CMD_RESEND;
+      p->tx.queue[p->tx.tail & (PS2_CMD_QUEUE_SIZE-1u)].flags = 0;
+    }
+    if( p->tx.head != p->tx.tail && !IS_Frame_In_Progress(p) )
+    {
+      cmd = &p->tx.queue[p->tx.tail & (PS2_CMD_QUEUE_SIZE-1u)];
+      p->tx.data = cmd->data;
+      p->tx.flags = cmd->flags;
+      p->tx.bit_pos = 0;
+      p->tx.parity = 0;
+      p->tx.acked = FALSE;
+      p->tx.timestamp = now;
+      // Inhibit, Keyboard aborts a frame in progress and sends it later
+      p->tx.state = PS2_TX_INHIBIT;
+      GPIO_ClearValue( p->pins.clk_port, p->pins.clk_pin);
+      __disable_interrupt();
+      GPIO_SetDir( p->pins.clk_port, p->pins.clk_pin, 1);
+      __enable_interrupt();
+      Port_Resync(p);
+    }
+    break;
+  case PS2_TX_INHIBIT:
+    if( (now - p->tx.timestamp) >= PS2_INHIBIT_MS )
+    {
+      // Request to Send, Data Low is the Start Bit
+      GPIO_ClearValue( p->pins.data_port, p->pins.data_pin);
+      p->tx.timestamp = now;
+      p->tx.state = PS2_TX_SENDING;
+      __disable_interrupt();
+      PS2_Data_Drive(p, 0u);
+      GPIO_SetDir( p->pins.clk_port, p->pins.clk_pin, 0);
+      __enable_interrupt();
+    }
+    break;
+  case PS2_TX_SENDING:
+  case PS2_TX_WAIT_REPLY:
+    if( (now - p->tx.timestamp) > (PS2_TX_TIMEOUT_MS + PS2_REPLY_TIMEOUT_MS) )
+    {
+      PS2_Command_Retry(p);
+    }
+    break;
+  case PS2_TX_SENT:
+    if( p->tx.acked )
+      PS2_Command_Done(p);
+    else
+      PS2_Command_Retry(p);
+    break;
+  case PS2_TX_REPLIED:
+    if( p->tx.reply == PS2_REPLY_ACK )
+      PS2_Command_Done(p);
+    else
+      PS2_Command_Retry(p);
+    break;
+  default:
+    p->tx.state = PS2_TX_IDLE;
+    break;
+  }
+}
@@ -21,6 +21,21 @@ extern "C" {
 
 #define PS2_DATA_PORT   3     /**< PS2 Data PORT. */
 #define PS2_DATA_PIN    2     /**< PS2 Data Pin. */
+
+// Second PS2 Port, Barcode Wedge or Mouse
+#define PS2_AUX_CLK_PORT    3     /**< Auxiliary PS2 Clock PORT. */
+#define PS2_AUX_CLK_PIN     0     /**< Auxiliary PS2 Clock Pin. */
+#define PS2_AUX_DATA_PORT   2     /**< Auxiliary PS2 Data PORT. */
+#define PS2_AUX_DATA_PIN    4     /**< Auxiliary PS2 Data Pin. */
+
+#define PS2_PORT_KEYBOARD   0u    /**< Keyboard PS2 Port. */
+#define PS2_PORT_AUX        1u    /**< Auxiliary PS2 Port. */
+#define PS2_PORTS           2u    /**< Number of PS2 Ports. */
+#define PS2_GPIO_PORTS      4u    /**< Number of GPIO Ports. */
+
+// Device connected to a PS2 Port
+#define PS2_MODE_KEYBOARD   0u    /**< Scan Codes are queued for Decoding. */
+#define PS2_MODE_MOUSE      1u    /**< Bytes are given to Mouse Packet Decoder. */
   
 /* Special Function Character */
 #define TAB             0x09  /**< TAB Scan Code. */
@@ -45,7 +60,120 @@ extern "C" {
 #define F11             0x0   /**< F11 Scan Code. */
 #define F12             0x0   /**< F12 Scan Code. */
 
-#define SCAN_CODE_MAX   20u   /**< Scan Codes Buffer Size. */
+/* Scan Code Set 2 Prefixes */
+#define PS2_EXTENDED    0xE0  /**< Extended Key Prefix. */
+#define PS2_PAUSE       0xE1  /**< Pause Key Prefix. */
+#define PS2_BREAK       0xF0  /**< Key Release Prefix. */
+#define PS2_PAUSE_LEN   8u    /**< Length of Pause Key Sequence. */
+#define PS2_SET2_MAX    0x84u /**< Single Byte Scan Codes are below this. */
+
+/* AltGr Layer, 0 Disabled, 1 Right Alt types Latin-1 like US-International */
+#ifndef PS2_ALTGR_LATIN1
+#define PS2_ALTGR_LATIN1      1
+#endif
+
+// Translation Table Rows, Row is selected with Shift and Extended bits
+#define PS2_KEYMAP_SHIFT      0x01  /**< Shift (XOR Caps Lock) Row Bit. */
+#define PS2_KEYMAP_EXTENDED   0x02  /**< E0 Prefix Row Bit. */
+#define PS2_KEYMAP_ROWS       4u    /**< Rows in Translation Table. */
+
+// Scan Code Classes, Lock Keys also carry their PS2_EVT_xxx Lock Flag
+#define PS2_CLASS_NONE        0x00  /**< Unused Scan Code. */
+#define PS2_CLASS_PRINTABLE   0x01  /**< Key with an ASCII Value. */
+#define PS2_CLASS_FUNCTION    0x02  /**< Key without an ASCII Value. */
+#define PS2_CLASS_MODIFIER    0x03  /**< Shift, Ctrl and Alt Keys. */
+#define PS2_CLASS_LOCK        0x04  /**< Caps, Num and Scroll Lock Keys. */
+#define PS2_CLASS_EXTENDED    0x05  /**< E0 Prefix. */
+#define PS2_CLASS_BREAK       0x06  /**< F0 Prefix. */
+#define PS2_CLASS_PAUSE       0x07  /**< E1 Prefix. */
+#define PS2_CLASS_INVALID     0x08  /**< Not a Scan Code, e.g. Keyboard Reply. */
+#define PS2_CLASS_MASK        0x0F  /**< Class without Lock Flag. */
+
+/* Key Codes, Keys are reported with their USB HID Usage ID */
+#define PS2_KEY_NONE          0x00  /**< No Key. */
+#define PS2_KEY_ENTER         0x28  /**< Enter Key Code. */
+#define PS2_KEY_ESC           0x29  /**< Escape Key Code. */
+#define PS2_KEY_BKSP          0x2A  /**< Backspace Key Code. */
+#define PS2_KEY_TAB           0x2B  /**< Tab Key Code. */
+#define PS2_KEY_CAPS          0x39  /**< Caps Lock Key Code. */
+#define PS2_KEY_F1            0x3A  /**< F1 Key Code, F2..F12 follow. */
+#define PS2_KEY_PRINTSCREEN   0x46  /**< Print Screen Key Code. */
+#define PS2_KEY_SCROLL        0x47  /**< Scroll Lock Key Code. */
+#define PS2_KEY_PAUSE         0x48  /**< Pause Key Code. */
+#define PS2_KEY_INSERT        0x49  /**< Insert Key Code. */
+#define PS2_KEY_HOME          0x4A  /**< Home Key Code. */
+#define PS2_KEY_PAGEUP        0x4B  /**< Page Up Key Code. */
+#define PS2_KEY_DELETE        0x4C  /**< Delete Key Code. */
+#define PS2_KEY_END           0x4D  /**< End Key Code. */
+#define PS2_KEY_PAGEDOWN      0x4E  /**< Page Down Key Code. */
+#define PS2_KEY_RIGHT         0x4F  /**< Right Arrow Key Code. */
+#define PS2_KEY_LEFT          0x50  /**< Left Arrow Key Code. */
+#define PS2_KEY_DOWN          0x51  /**< Down Arrow Key Code. */
+#define PS2_KEY_UP            0x52  /**< Up Arrow Key Code. */
+#define PS2_KEY_NUM           0x53  /**< Num Lock Key Code. */
+#define PS2_KEY_KP_ENTER      0x58  /**< Keypad Enter Key Code. */
+#define PS2_KEY_LCTRL         0xE0  /**< Left Ctrl, first Modifier Key Code. */
+#define PS2_KEY_RGUI          0xE7  /**< Right GUI, last Modifier Key Code. */
+
+/* Modifier Mask, same bit order as USB HID Boot Keyboard Report */
+#define PS2_MOD_LCTRL   0x01  /**< Left Ctrl is Pressed. */
+#define PS2_MOD_LSHIFT  0x02  /**< Left Shift is Pressed. */
+#define PS2_MOD_LALT    0x04  /**< Left Alt is Pressed. */
+#define PS2_MOD_LGUI    0x08  /**< Left GUI is Pressed. */
+#define PS2_MOD_RCTRL   0x10  /**< Right Ctrl is Pressed. */
+#define PS2_MOD_RSHIFT  0x20  /**< Right Shift is Pressed. */
+#define PS2_MOD_RALT    0x40  /**< Right Alt is Pressed. */
+#define PS2_MOD_RGUI    0x80  /**< Right GUI is Pressed. */
+#define PS2_MOD_SHIFT   (PS2_MOD_LSHIFT | PS2_MOD_RSHIFT) /**< Any Shift. */
+#define PS2_MOD_CTRL    (PS2_MOD_LCTRL | PS2_MOD_RCTRL)   /**< Any Ctrl. */
+#define PS2_MOD_ALT     (PS2_MOD_LALT | PS2_MOD_RALT)     /**< Any Alt. */
+
+/* Key Event Flags */
+#define PS2_EVT_MAKE    0x01  /**< Key Pressed, otherwise Released. */
+#define PS2_EVT_REPEAT  0x02  /**< Typematic Repeat of a Pressed Key. */
+#define PS2_EVT_CAPS    0x10  /**< Caps Lock is On. */
+#define PS2_EVT_NUM     0x20  /**< Num Lock is On. */
+#define PS2_EVT_SCROLL  0x40  /**< Scroll Lock is On. */
+#define PS2_EVT_LOCKS   (PS2_EVT_CAPS | PS2_EVT_NUM | PS2_EVT_SCROLL)
+
+/* Host to Keyboard Commands */
+#define PS2_CMD_SET_LEDS      0xED  /**< Set LEDs, followed by LED Mask. */
+#define PS2_CMD_ECHO          0xEE  /**< Echo. */
+#define PS2_CMD_TYPEMATIC     0xF3  /**< Set Typematic Rate and Delay. */
+#define PS2_CMD_ENABLE        0xF4  /**< Enable Scanning. */
+#define PS2_CMD_DISABLE       0xF5  /**< Disable Scanning. */
+#define PS2_CMD_RESEND        0xFE  /**< Resend Last Byte. */
+#define PS2_CMD_RESET         0xFF  /**< Reset and Self Test. */
+
+/* Keyboard Replies */
+#define PS2_REPLY_ACK         0xFA  /**< Command Acknowledged. */
+#define PS2_REPLY_RESEND      0xFE  /**< Resend Last Command Byte. */
+
+/* LED Mask of PS2_CMD_SET_LEDS */
+#define PS2_LED_SCROLL        0x01  /**< Scroll Lock LED. */
+#define PS2_LED_NUM           0x02  /**< Num Lock LED. */
+#define PS2_LED_CAPS          0x04  /**< Caps Lock LED. */
+
+/* Typematic Byte, bits 0-4 rate (0 is 30 cps), bits 5-6 delay (0 is 250ms) */
+#define PS2_TYPEMATIC_FASTEST 0x00  /**< 30 Characters/sec after 250ms. */
+
+#define PS2_CMDF_ACK          0x01  /**< Keyboard answers Byte with ACK. */
+#define PS2_CMDF_ARG          0x02  /**< Byte is Argument of previous Byte. */
+
+#define PS2_CMD_QUEUE_SIZE    8u    /**< Command Queue Size, power of two. */
+#define PS2_CMD_RETRIES       3u    /**< Command Byte Retries. */
+#define PS2_INHIBIT_MS        2u    /**< Clock Inhibit before Transmit. */
+#define PS2_TX_TIMEOUT_MS     20u   /**< Keyboard must clock in a Byte. */
+#define PS2_REPLY_TIMEOUT_MS  20u   /**< Keyboard must reply a Byte. */
+
+#define PS2_FRAME_TIMEOUT_US  2000u /**< Frame must complete in this Time. */
+
+#define SCAN_CODE_MAX   32u   /**< Scan Codes Buffer Size, power of two. */
+#define SCAN_CODE_MASK  (SCAN_CODE_MAX-1u)  /**< Scan Codes Buffer Index Mask. */
+
+#if ((SCAN_CODE_MAX & SCAN_CODE_MASK) != 0u) || (SCAN_CODE_MAX > 128u)
+#error "SCAN_CODE_MAX must be a power of two, not greater than 128"
+#endif
 
 /**
  * @brief PS2 Keyboard States
@@ -63,15 +191,66 @@ typedef enum _PS2_State_e
 /**
  * @brief Queue/FIFO
  *
- * Circular FIFO to store and retrieve data of PS2 Keyboard.
+ * Single Producer Single Consumer Ring to store and retrieve data of PS2
+ * Keyboard. Head and Tail are free running counters, head is only written by
+ * PS2 Interrupt and tail is only written by main loop, hence no interrupt
+ * masking is needed. Number of elements in queue is (head - tail).
  */
 typedef struct _Queue_s
 {
-  s8_t front;                             /**< Front Pointer of Queue. */
-  s8_t rear;                              /**< Rear Pointer of Queue. */
-  u8_t scan_codes_buffer[SCAN_CODE_MAX];  /**< Queue/FIFO Buffer. */
+  volatile u8_t head;                             /**< Write Counter (ISR). */
+  volatile u8_t tail;                             /**< Read Counter (Main). */
+  volatile u8_t scan_codes_buffer[SCAN_CODE_MAX]; /**< Queue/FIFO Buffer. */
+  volatile u32_t timestamps[SCAN_CODE_MAX];       /**< Start Bit Time (us). */
 } Queue_s;
 
+/**
+ * @brief PS2 Transmit States
+ *
+ * States of Host to Keyboard Transmission, states marked ISR are entered by
+ * the Clock Interrupt, others by PS2_Command_Task().
+ */
+typedef enum _PS2_TX_State_e
+{
+  PS2_TX_IDLE = 0,    /**< No Transmission. */
+  PS2_TX_INHIBIT,     /**< Clock is held Low by Host. */
+  PS2_TX_SENDING,     /**< Keyboard is clocking the Byte in. */
+  PS2_TX_SENT,        /**< Byte is sent, Ack Bit is sampled (ISR). */
+  PS2_TX_WAIT_REPLY,  /**< Waiting for Keyboard Reply Byte. */
+  PS2_TX_REPLIED      /**< Keyboard Reply Byte Received (ISR). */
+} PS2_TX_State_e;
+
+/**
+ * @brief PS2 Command Queue Entry.
+ */
+typedef struct _PS2_Command_s
+{
+  u8_t data;          /**< Byte to Send. */
+  u8_t flags;         /**< Byte Flags, see PS2_CMDF_xxx. */
+} PS2_Command_s;
+
+/**
+ * @brief PS2 Transmitter Structure
+ *
+ * Host to Keyboard Transmission, the Byte is clocked out by the Keyboard in
+ * the Clock Interrupt.
+ */
+typedef struct _PS2_Transmit_s
+{
+  volatile u8_t state;    /**< Transmit State, see PS2_TX_State_e. */
+  volatile u8_t reply;    /**< Reply Byte from Keyboard. */
+  volatile boolean acked; /**< Keyboard pulled Data Low on Ack Bit. */
+  u8_t data;              /**< Byte being sent. */
+  u8_t flags;             /**< Flags of Byte being sent, see PS2_CMDF_xxx. */
+  u8_t bit_pos;           /**< Bit Position being sent. */
+  u8_t parity;            /**< Number of One Bits sent. */
+  u8_t retries;           /**< Retries of current Byte. */
+  u32_t timestamp;        /**< Time of last State Change in milli-seconds. */
+  u8_t head;                                /**< Command Queue Write Index. */
+  u8_t tail;                                /**< Command Queue Read Index. */
+  PS2_Command_s queue[PS2_CMD_QUEUE_SIZE];  /**< Command Queue. */
+} PS2_Transmit_s;
+
 /**
  * @brief PS2 Keyboard Structure
  *
@@ -81,19 +260,129 @@ typedef struct _PS2_Keyboard_s
 {
   u8_t bit_pos;               /**< Bit Position of Data. */
   u8_t scan_code;             /**< Current Scan Code Received. */
-  u8_t last_scan_code;        /**< Last Scan Code Received. */
-  u8_t penultimate_scan_code; /**< Second Last Scan Code Received. */
   u8_t parity_value;          /**< Parity Bit Calculated. */
-  boolean PS2_Busy:1,         /**< PS2 Bus State. */
-          CapsLock:1,         /**< CAPS Lock Key State. */
-          ShiftKey:1;         /**< Shift Key State. */
+  u32_t start_us;             /**< Time of Start Bit in micro-seconds. */
+  boolean PS2_Busy;           /**< PS2 Bus State. */
+  volatile boolean Resend;    /**< Frame Error, Keyboard must Resend. */
 } PS2_Keyboard_s;
 
+/**
+ * @brief PS2 Key Event
+ *
+ * Decoded Key Press or Release.
+ */
+typedef struct _PS2_Key_Event_s
+{
+  u8_t keycode;     /**< USB HID Usage ID of Key, see PS2_KEY_xxx. */
+  u8_t ascii;       /**< ASCII, with AltGr Latin-1, 0 if not printable. */
+  u8_t modifiers;   /**< Modifier Mask after this event, see PS2_MOD_xxx. */
+  u8_t flags;       /**< Make/Break and Lock State, see PS2_EVT_xxx. */
+  u32_t timestamp;  /**< Start Bit Time of first Byte of Key, see micros(). */
+} PS2_Key_Event_s;
+
+/**
+ * @brief PS2 Scan Code Parser
+ *
+ * State of Scan Code Set 2 Parser, kept between calls so that a sequence can
+ * be received partially.
+ */
+typedef struct _PS2_Parser_s
+{
+  boolean extended;       /**< E0 Prefix Received. */
+  boolean release;        /**< F0 Prefix Received. */
+  u8_t pause_count;       /**< Bytes of Pause Sequence Received. */
+  boolean pause_release;  /**< Pause Release Event is Pending. */
+  u8_t modifiers;         /**< Modifier Mask, see PS2_MOD_xxx. */
+  u8_t locks;             /**< Lock State, see PS2_EVT_xxx. */
+  boolean host_locks;     /**< Lock State is set by PS2_Set_Locks() only. */
+  u8_t key_down[32];      /**< Pressed Keys, one bit per Key Code. */
+  u32_t timestamp;        /**< Start Bit Time of first Byte of Sequence. */
+} PS2_Parser_s;
+
+/**
+ * @brief PS2 Receiver Statistics
+ *
+ * Number of received and aborted frames.
+ */
+typedef struct _PS2_Stats_s
+{
+  u32_t frames;           /**< Frames Received Successfully. */
+  u32_t parity_errors;    /**< Frames Aborted due to Parity Error. */
+  u32_t framing_errors;   /**< Frames Aborted due to missing Stop Bit. */
+  u32_t timeouts;         /**< Frames Aborted due to Inter-Bit Timeout. */
+  u32_t overruns;         /**< Frames Lost as Queue was Full. */
+  u32_t commands;         /**< Command Bytes Acknowledged by Keyboard. */
+  u32_t resends;          /**< Command Bytes Sent again. */
+  u32_t tx_errors;        /**< Command Bytes Dropped after Retries. */
+  u32_t wakes;            /**< Wake-Ups from Deep-Sleep by this Port. */
+  u32_t wake_errors;      /**< First Frames after Wake-Up Aborted. */
+} PS2_Stats_s;
+
+// Lookup Tables
+extern const u8_t PS2_KeyMap[PS2_KEYMAP_ROWS][PS2_SET2_MAX];
+extern const u8_t PS2_HidMap[2][PS2_SET2_MAX];
+extern const u8_t PS2_KeyClass[256];
+
+/**
+ * @brief PS2 Port Pins
+ *
+ * GPIO Pins of one PS2 Port, Clock Pin must be able to interrupt.
+ */
+typedef struct _PS2_Pins_s
+{
+  u8_t clk_port;    /**< Clock PORT. */
+  u8_t clk_pin;     /**< Clock Pin. */
+  u8_t data_port;   /**< Data PORT. */
+  u8_t data_pin;    /**< Data Pin. */
+} PS2_Pins_s;
+
+/**
+ * @brief PS2 Port
+ *
+ * Everything needed to receive from and send to one PS2 device, each Port is
+ * decoded independently of the others.
+ */
+typedef struct _PS2_Port_s
+{
+  PS2_Pins_s pins;        /**< Pin Binding. */
+  u8_t mode;              /**< Device Type, see PS2_MODE_xxx. */
+  volatile u8_t state;    /**< Receive State, see PS2_State_e. */
+  PS2_Keyboard_s ps2;     /**< Frame being Received. */
+  Queue_s queue;          /**< Received Scan Codes. */
+  PS2_Parser_s parser;    /**< Scan Code Parser. */
+  PS2_Stats_s stats;      /**< Receiver Statistics. */
+  PS2_Transmit_s tx;      /**< Host to Device Transmitter. */
+  u32_t wake_us;          /**< Wake-Up Time, see PS2_Wake(). */
+  volatile boolean waking;  /**< First Frame after Wake-Up in Progress. */
+} PS2_Port_s;
+
 // Function Prototypes
 void PS2_Keyboard_Init( void );
-void PS2_State_Machine( void );
-boolean IS_PS2_Busy( void );
-u8_t getKey( void );
+void PS2_GPIO_IRQHandler( u8_t gpio_port );
+void PS2_State_Machine( u8_t port );
+void PS2_Receive_Bit( u8_t port, u8_t regVal );
+void PS2_Resync( u8_t port );
+void PS2_Wake( u8_t port, u32_t wake_us, boolean start_bit );
+boolean IS_PS2_Idle( u8_t port );
+void PS2_Set_Mode( u8_t port, u8_t mode );
+const PS2_Pins_s* PS2_Get_Pins( u8_t port );
+boolean PS2_Get_Byte( u8_t port, u8_t *data );
+boolean IS_PS2_Busy( u8_t port );
+u8_t getKey( u8_t port );
+u32_t PS2_Get_Key_Time( u8_t port );
+u8_t PS2_ReadKeys( u8_t port, u8_t *buf, u8_t n );
+boolean PS2_Get_Event( u8_t port, PS2_Key_Event_s *event );
+boolean PS2_Parse_Byte( u8_t port, u8_t scan_code, PS2_Key_Event_s *event );
+const PS2_Stats_s* PS2_Get_Stats( u8_t port );
+boolean PS2_Send_Command( u8_t port, u8_t command, u8_t flags );
+boolean PS2_Send_Command_Arg( u8_t port, u8_t command, u8_t argument );
+boolean PS2_Set_Leds( u8_t port, u8_t leds );
+boolean PS2_Set_Locks( u8_t port, u8_t locks );
+boolean PS2_Set_Typematic( u8_t port, u8_t typematic );
+boolean PS2_Enable_Scanning( u8_t port, boolean enable );
+boolean PS2_Reset( u8_t port );
+boolean IS_PS2_Command_Pending( u8_t port );
+void PS2_Command_Task( void );
 
 #ifdef	__cplusplus
 }
@@ -0,0 +1,385 @@
+/**
+ * @file ps2_mouse.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief PS2 Mouse Packet Decoder.
+ *
+ * PS2_Mouse_Task() resets the mouse, detects IntelliMouse (ID 3) and
+ * IntelliMouse Explorer (ID 4) with the sample rate sequences, then sets the
+ * sample rate to PS2_MOUSE_SAMPLE_RATE and enables Stream Mode. From there on
+ * packets are assembled byte by byte in the interrupt and the movement is
+ * accumulated, so the main loop can poll at any rate without losing packets.
+ */
+
+#include "ps2_mouse.h"
+
+/* Private Functions */
+static void Mouse_Reset( u8_t port );
+static void Mouse_Detect( u8_t port, u8_t rate1, u8_t rate2, u8_t rate3 );
+static void Mouse_Stream( u8_t port );
+static void Mouse_Sync( PS2_Mouse_s *m );
+static boolean IS_Packet_Valid( PS2_Mouse_s *m );
+static void Mouse_Decode( PS2_Mouse_s *m );
+static s16_t Saturate_Add( s16_t value, s16_t delta );
+static u32_t Frame_Errors( u8_t port );
+
+/** Mouse Decoder of each PS2 Port, PS2_MOUSE_OFF until PS2_Mouse_Init(). */
+static PS2_Mouse_s mice[PS2_PORTS];
+
+/**
+ * @brief Initialize Mouse on PS2 Port.
+ *
+ * Port is switched to PS2_MODE_MOUSE and the mouse is reset, the rest of the
+ * initialization is done by PS2_Mouse_Task().
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ */
+void PS2_Mouse_Init( u8_t port )
+{
+  PS2_Mouse_s *m = &mice[port];
+  m->state = PS2_MOUSE_OFF;
+  m->id = PS2_MOUSE_ID_STANDARD;
+  m->size = 3u;
+  m->count = 0;
+  m->report.dx = 0;
+  m->report.dy = 0;
+  m->report.wheel = 0;
+  m->report.buttons = 0;
+  m->report.packets = 0;
+  PS2_Set_Mode(port, PS2_MODE_MOUSE);
+  Mouse_Reset(port);
+}
+
+/**
+ * @brief Reset Mouse.
+ *
+ * Mouse acknowledges, runs its self test and replies with PS2_MOUSE_BAT_OK
+ * followed by Device ID 0.
+ */
+static void Mouse_Reset( u8_t port )
+{
+  PS2_Mouse_s *m = &mice[port];
+  m->stats.resets++;
+  m->state = PS2_MOUSE_RESET;
+  m->timestamp = millis();
+  PS2_Reset(port);
+}
+
+/**
+ * @brief Sample Rate Sequence and Get ID.
+ *
+ * 200, 100, 80 unlocks the scroll wheel (ID 3), 200, 200, 80 afterwards
+ * unlocks the 4th and 5th button (ID 4). Both fit in the Command Queue.
+ */
+static void Mouse_Detect( u8_t port, u8_t rate1, u8_t rate2, u8_t rate3 )
+{
+  PS2_Mouse_s *m = &mice[port];
+  PS2_Send_Command_Arg(port, PS2_MOUSE_CMD_SET_RATE, rate1);
+  PS2_Send_Command_Arg(port, PS2_MOUSE_CMD_SET_RATE, rate2);
+  PS2_Send_Command_Arg(port, PS2_MOUSE_CMD_SET_RATE, rate3);
+  PS2_Send_Command(port, PS2_MOUSE_CMD_GET_ID, PS2_CMDF_ACK);
+  m->state = PS2_MOUSE_DETECT;
+  m->timestamp = millis();
+}
+
+/**
+ * @brief Configure Mouse and Enable Stream Mode.
+ *
+ * Decoder is armed before the enable command, first packet can only come after
+ * the mouse acknowledged it.
+ */
+static void Mouse_Stream( u8_t port )
+{
+  PS2_Mouse_s *m = &mice[port];
+  m->size = (m->id >= PS2_MOUSE_ID_WHEEL) ? 4u : 3u;
+  m->count = 0;
+  m->byte_time = millis();
+  m->frame_errors = Frame_Errors(port);
+  m->state = PS2_MOUSE_STREAM;
+  PS2_Send_Command_Arg(port, PS2_MOUSE_CMD_SET_RATE, PS2_MOUSE_SAMPLE_RATE);
+  PS2_Send_Command_Arg(port, PS2_MOUSE_CMD_RESOLUTION, PS2_MOUSE_RESOLUTION);
+  PS2_Enable_Scanning(port, TRUE);
+}
+
+/**
+ * @brief PS2 Mouse Task.
+ *
+ * Runs the initialization of every port in PS2_MODE_MOUSE, a mouse which does
+ * not answer in time is reset again. Call this function from the main loop
+ * along with PS2_Command_Task(), it never waits.
+ */
+void PS2_Mouse_Task( void )
+{
+  u8_t port, data;
+  u32_t now = millis();
+  PS2_Mouse_s *m;
+  for( port = 0; port < PS2_PORTS; port++ )
+  {
+    m = &mice[port];
+    switch( m->state )
+    {
+    case PS2_MOUSE_RESET:
+      if( PS2_Get_Byte(port, &data) )
+      {
+        if( data == PS2_MOUSE_BAT_OK )
+        {
+          m->state = PS2_MOUSE_BAT_ID;
+          m->timestamp = now;
+        }
+        else if( data == PS2_MOUSE_BAT_ERROR )
+        {
+          Mouse_Reset(port);
+        }
+      }
+      else if( (now - m->timestamp) > PS2_MOUSE_RESET_MS )
+      {
+        Mouse_Reset(port);
+      }
+      break;
+    case PS2_MOUSE_BAT_ID:
+      if( PS2_Get_Byte(port, &data) )
+      {
+        m->id = PS2_MOUSE_ID_STANDARD;
+        Mouse_Detect(port, 200u, 100u, 80u);
+      }
+      else if( (now - m->timestamp) > PS2_MOUSE_REPLY_MS )
+      {
+        Mouse_Reset(port);
+      }
+      break;
+    case PS2_MOUSE_DETECT:
+      if( PS2_Get_Byte(port, &data) )
+      {
+        if( data == PS2_MOUSE_ID_WHEEL && m->id == PS2_MOUSE_ID_STANDARD )
+        {
+          m->id = PS2_MOUSE_ID_WHEEL;
+          Mouse_Detect(port, 200u, 200u, 80u);
+        }
+        else
+        {
+          if( data == PS2_MOUSE_ID_5BUTTON )
+          {
+            m->id = PS2_MOUSE_ID_5BUTTON;
+          }
+          Mouse_Stream(port);
+        }
+      }
+      else if( (now - m->timestamp) > (PS2_MOUSE_RESET_MS / 2u) )
+      {
+        // Both sequences are 7 command bytes, each one may take a while
+        Mouse_Reset(port);
+      }
+      break;
+    case PS2_MOUSE_STREAM:
+      // Mouse plugged again sends BAT_OK and ID, then stays silent
+      if( m->count == 2u && m->packet[0] == PS2_MOUSE_BAT_OK &&
+          m->packet[1] == PS2_MOUSE_ID_STANDARD &&
+          (now - m->byte_time) > PS2_MOUSE_BYTE_TIMEOUT_MS )
+      {
+        m->count = 0;
+        m->id = PS2_MOUSE_ID_STANDARD;
+        Mouse_Detect(port, 200u, 100u, 80u);
+      }
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Mouse Byte Received.
+ *
+ * Called by the PS2 State Machine (ISR) for every byte which is not a command
+ * reply. A packet is restarted if the gap to the previous byte is larger than
+ * PS2_MOUSE_BYTE_TIMEOUT_MS or a frame was lost in between.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param data Received Byte.
+ * @return TRUE if the Byte belongs to a Packet, FALSE if it must be queued.
+ */
+boolean PS2_Mouse_Receive_Byte( u8_t port, u8_t data )
+{
+  PS2_Mouse_s *m = &mice[port];
+  boolean taken = FALSE;
+  u32_t now, errors;
+  if( m->state == PS2_MOUSE_STREAM )
+  {
+    now = millis();
+    errors = Frame_Errors(port);
+    if( m->count &&
+        ( (now - m->byte_time) > PS2_MOUSE_BYTE_TIMEOUT_MS ||
+          errors != m->frame_errors ) )
+    {
+      m->stats.sync_errors += m->count;
+      m->count = 0;
+    }
+    m->byte_time = now;
+    m->frame_errors = errors;
+    m->packet[m->count++] = data;
+    Mouse_Sync(m);
+    while( m->count == m->size )
+    {
+      if( IS_Packet_Valid(m) )
+      {
+        Mouse_Decode(m);
+        m->count = 0;
+      }
+      else
+      {
+        // Drop the first byte and look for the next packet start
+        m->packet[0] = 0;
+        Mouse_Sync(m);
+      }
+    }
+    taken = TRUE;
+  }
+  return taken;
+}
+
+/**
+ * @brief Align Packet.
+ *
+ * Bytes are dropped until the first one has PS2_MOUSE_SYNC set.
+ */
+static void Mouse_Sync( PS2_Mouse_s *m )
+{
+  u8_t i;
+  while( m->count && !(m->packet[0] & PS2_MOUSE_SYNC) )
+  {
+    m->stats.sync_errors++;
+    m->count--;
+    for( i = 0; i < m->count; i++ )
+    {
+      m->packet[i] = m->packet[i+1u];
+    }
+  }
+}
+
+/**
+ * @brief Check Packet.
+ *
+ * First byte is already aligned by Mouse_Sync(), Explorer packets also have
+ * bits 6 and 7 of the last byte always cleared.
+ */
+static boolean IS_Packet_Valid( PS2_Mouse_s *m )
+{
+  return !( m->id == PS2_MOUSE_ID_5BUTTON && (m->packet[3] & 0xC0u) );
+}
+
+/**
+ * @brief Decode Packet.
+ *
+ * X and Y are 9 bit two's complement with the sign in the first byte, Y is
+ * positive upwards. Movement of a packet with overflow is not used.
+ */
+static void Mouse_Decode( PS2_Mouse_s *m )
+{
+  s16_t dx, dy, dz = 0;
+  u8_t buttons = m->packet[0] & (PS2_MOUSE_LEFT | PS2_MOUSE_RIGHT |
+                                 PS2_MOUSE_MIDDLE);
+  dx = (s16_t)m->packet[1] - (s16_t)((m->packet[0] & PS2_MOUSE_X_SIGN) << 4);
+  dy = (s16_t)m->packet[2] - (s16_t)((m->packet[0] & PS2_MOUSE_Y_SIGN) << 3);
+  if( m->id == PS2_MOUSE_ID_WHEEL )
+  {
+    dz = (s8_t)m->packet[3];
+  }
+  else if( m->id == PS2_MOUSE_ID_5BUTTON )
+  {
+    // Wheel is 4 bit two's complement, Button 4/5 in bits 4/5
+    dz = (s16_t)((m->packet[3] & 0x0Fu) ^ 0x08u) - 0x08;
+    buttons |= (m->packet[3] >> 1) & (PS2_MOUSE_BUTTON4 | PS2_MOUSE_BUTTON5);
+  }
+  if( m->packet[0] & PS2_MOUSE_OVERFLOW )
+  {
+    m->stats.overflows++;
+    dx = 0;
+    dy = 0;
+  }
+  m->report.dx = Saturate_Add(m->report.dx, dx);
+  m->report.dy = Saturate_Add(m->report.dy, dy);
+  m->report.wheel = Saturate_Add(m->report.wheel, dz);
+  m->report.buttons = buttons;
+  if( m->report.packets < 255u )
+  {
+    m->report.packets++;
+  }
+  m->stats.packets++;
+}
+
+/**
+ * @brief Add without wrap around.
+ */
+static s16_t Saturate_Add( s16_t value, s16_t delta )
+{
+  s32_t sum = (s32_t)value + delta;
+  if( sum > 32767 )
+  {
+    sum = 32767;
+  }
+  else if( sum < -32768 )
+  {
+    sum = -32768;
+  }
+  return (s16_t)sum;
+}
+
+/**
+ * @brief Frames Lost on Port.
+ */
+static u32_t Frame_Errors( u8_t port )
+{
+  const PS2_Stats_s *stats = PS2_Get_Stats(port);
+  return stats->parity_errors + stats->framing_errors + stats->timeouts +
+         stats->overruns;
+}
+
+/**
+ * @brief Read Mouse Movement.
+ *
+ * Movement accumulated since the previous call is returned and cleared,
+ * buttons show the state of the last packet.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param report Filled with Movement and Buttons.
+ * @return TRUE if Packets were received since previous call.
+ */
+boolean PS2_Mouse_Read( u8_t port, PS2_Mouse_Report_s *report )
+{
+  PS2_Mouse_s *m = &mice[port];
+  __disable_interrupt();
+  *report = m->report;
+  m->report.dx = 0;
+  m->report.dy = 0;
+  m->report.wheel = 0;
+  m->report.packets = 0;
+  __enable_interrupt();
+  return ( report->packets != 0 );
+}
+
+/**
+ * @brief Mouse is Initialized.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @return TRUE if Packets are being Decoded.
+ */
+boolean IS_PS2_Mouse_Streaming( u8_t port )
+{
+  return ( mice[port].state == PS2_MOUSE_STREAM );
+}
+
+/**
+ * @brief Mouse Device ID.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @return PS2_MOUSE_ID_STANDARD, PS2_MOUSE_ID_WHEEL or PS2_MOUSE_ID_5BUTTON.
+ */
+u8_t PS2_Mouse_Get_ID( u8_t port )
+{
+  return mice[port].id;
+}
+
+/**
+ * @brief PS2 Mouse Statistics.
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @return Pointer to Decoder Statistics of Port.
+ */
+const PS2_Mouse_Stats_s* PS2_Mouse_Get_Stats( u8_t port )
+{
+  return &mice[port].stats;
+}
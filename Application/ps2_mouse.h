@@ -0,0 +1,128 @@
+/**
+ * @file ps2_mouse.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief PS2 Mouse Header File.
+ *
+ * Mouse packet decoder for a PS2 Port in PS2_MODE_MOUSE. Standard mice send
+ * 3 byte packets, IntelliMouse (scroll wheel) and IntelliMouse Explorer
+ * (scroll wheel and 5 buttons) send 4 byte packets.
+ */
+
+#ifndef PS2_MOUSE_H
+#define PS2_MOUSE_H
+
+#include "ps2_keyboard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Auxiliary Port Device, 0 Keyboard or Barcode Wedge, 1 Mouse */
+#ifndef PS2_AUX_MOUSE
+#define PS2_AUX_MOUSE             0
+#endif
+
+/* Mouse Commands and Replies */
+#define PS2_MOUSE_CMD_SET_RATE    0xF3  /**< Set Sample Rate, followed by Rate. */
+#define PS2_MOUSE_CMD_GET_ID      0xF2  /**< Get Device ID. */
+#define PS2_MOUSE_CMD_RESOLUTION  0xE8  /**< Set Resolution, followed by Value. */
+#define PS2_MOUSE_BAT_OK          0xAA  /**< Self Test Passed. */
+#define PS2_MOUSE_BAT_ERROR       0xFC  /**< Self Test Failed. */
+
+/* Device IDs */
+#define PS2_MOUSE_ID_STANDARD     0x00  /**< 3 Buttons, no Wheel. */
+#define PS2_MOUSE_ID_WHEEL        0x03  /**< IntelliMouse, Scroll Wheel. */
+#define PS2_MOUSE_ID_5BUTTON      0x04  /**< IntelliMouse Explorer. */
+
+/* Configuration */
+#define PS2_MOUSE_SAMPLE_RATE     200u  /**< Reports per second in Stream Mode. */
+#define PS2_MOUSE_RESOLUTION      3u    /**< 8 counts/mm. */
+#define PS2_MOUSE_RESET_MS        1000u /**< Self Test Time after Reset. */
+#define PS2_MOUSE_REPLY_MS        100u  /**< Time to Reply with Device ID. */
+#define PS2_MOUSE_BYTE_TIMEOUT_MS 2u    /**< Max Gap between Bytes of Packet. */
+#define PS2_MOUSE_PACKET_MAX      4u    /**< Largest Packet Size. */
+
+/* First Packet Byte */
+#define PS2_MOUSE_LEFT            0x01  /**< Left Button. */
+#define PS2_MOUSE_RIGHT           0x02  /**< Right Button. */
+#define PS2_MOUSE_MIDDLE          0x04  /**< Middle Button. */
+#define PS2_MOUSE_BUTTON4         0x08  /**< 4th Button (ID 4 only). */
+#define PS2_MOUSE_BUTTON5         0x10  /**< 5th Button (ID 4 only). */
+#define PS2_MOUSE_SYNC            0x08  /**< Always 1 in First Byte. */
+#define PS2_MOUSE_X_SIGN          0x10  /**< X Movement is Negative. */
+#define PS2_MOUSE_Y_SIGN          0x20  /**< Y Movement is Negative. */
+#define PS2_MOUSE_OVERFLOW        0xC0  /**< X or Y Movement Overflow. */
+
+/**
+ * @brief PS2 Mouse States
+ *
+ * Initialization sequence run by PS2_Mouse_Task(), packets are only decoded
+ * in PS2_MOUSE_STREAM.
+ */
+typedef enum _PS2_Mouse_State_e
+{
+  PS2_MOUSE_OFF = 0,      /**< Port is not a Mouse. */
+  PS2_MOUSE_RESET,        /**< Waiting for Self Test Result. */
+  PS2_MOUSE_BAT_ID,       /**< Waiting for Device ID after Self Test. */
+  PS2_MOUSE_DETECT,       /**< Waiting for Device ID after Magic Rates. */
+  PS2_MOUSE_STREAM        /**< Stream Mode, Packets are Decoded. */
+} PS2_Mouse_State_e;
+
+/**
+ * @brief Mouse Movement
+ *
+ * Movement accumulated since it was last read, X is positive to the right and
+ * Y is positive upwards.
+ */
+typedef struct _PS2_Mouse_Report_s
+{
+  s16_t dx;         /**< X Movement. */
+  s16_t dy;         /**< Y Movement. */
+  s16_t wheel;      /**< Wheel Movement, positive towards user. */
+  u8_t buttons;     /**< Buttons Pressed now, see PS2_MOUSE_LEFT etc. */
+  u8_t packets;     /**< Packets Decoded, saturates at 255. */
+} PS2_Mouse_Report_s;
+
+/**
+ * @brief PS2 Mouse Statistics
+ */
+typedef struct _PS2_Mouse_Stats_s
+{
+  u32_t packets;      /**< Packets Decoded. */
+  u32_t sync_errors;  /**< Bytes Dropped to find start of Packet. */
+  u32_t overflows;    /**< Packets with X or Y Overflow. */
+  u32_t resets;       /**< Mouse Reset Sequences Started. */
+} PS2_Mouse_Stats_s;
+
+/**
+ * @brief PS2 Mouse Structure
+ */
+typedef struct _PS2_Mouse_s
+{
+  volatile u8_t state;                  /**< See PS2_Mouse_State_e. */
+  u8_t id;                              /**< Device ID. */
+  u8_t size;                            /**< Packet Size, 3 or 4. */
+  u32_t timestamp;                      /**< Time of last State Change. */
+  u8_t count;                           /**< Bytes of Packet Received. */
+  u8_t packet[PS2_MOUSE_PACKET_MAX];    /**< Packet being Received. */
+  u32_t byte_time;                      /**< Time of last Packet Byte. */
+  u32_t frame_errors;                   /**< Port Frame Errors seen. */
+  PS2_Mouse_Report_s report;            /**< Accumulated Movement (ISR). */
+  PS2_Mouse_Stats_s stats;              /**< Decoder Statistics. */
+} PS2_Mouse_s;
+
+// Function Prototypes
+void PS2_Mouse_Init( u8_t port );
+void PS2_Mouse_Task( void );
+boolean PS2_Mouse_Receive_Byte( u8_t port, u8_t data );
+boolean PS2_Mouse_Read( u8_t port, PS2_Mouse_Report_s *report );
+boolean IS_PS2_Mouse_Streaming( u8_t port );
+u8_t PS2_Mouse_Get_ID( u8_t port );
+const PS2_Mouse_Stats_s* PS2_Mouse_Get_Stats( u8_t port );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PS2_MOUSE_H */
@@ -0,0 +1,268 @@
+/**
+ * @file scrollback.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Scrollback History.
+ *
+ * Characters are written at head into the circular arena, the line index
+ * holds the position of the first character of every line. Positions and
+ * line numbers are free running counters, the arena and the index are
+ * addressed with their low bits. A line ends where the next one starts, the
+ * last line is open and ends at head. When the arena or the index is full,
+ * the oldest line is dropped before the new character or line is added.
+ */
+
+#include <string.h>
+#include "scrollback.h"
+#include "lcd_fb.h"
+
+#define HISTORY_MASK    (SCROLLBACK_SIZE - 1u)
+#define LINE_MASK       (SCROLLBACK_LINES - 1u)
+
+static char history[SCROLLBACK_SIZE];         // Characters of all Lines
+static u16_t line_start[SCROLLBACK_LINES];    // Position of each Line
+static u16_t head = 0;                        // Position of next Character
+static u16_t first_line = 0;                  // Oldest Line kept
+static u16_t last_line = 0;                   // Open Line, written at head
+static u16_t scroll = 0;                      // Lines scrolled back
+static u8_t window_row = 0;                   // First LCD Row of Window
+static u8_t window_rows = 1;                  // LCD Rows of Window
+static boolean dirty = FALSE;                 // Window must be drawn
+static Scrollback_Stats_s stats;
+
+static u16_t Scrollback_Length( u16_t line );
+static u16_t Scrollback_Bottom( void );
+static void Scrollback_New_Line( void );
+static void Scrollback_Clamp( void );
+
+/**
+ * @brief Initialize Scrollback History.
+ *
+ * Call it after LCD_FB_Init(), the history starts empty.
+ * @param row First LCD Row of the Window.
+ * @param rows LCD Rows of the Window.
+ */
+void Scrollback_Init( u8_t row, u8_t rows )
+{
+  window_row = row % LCD_FB_ROWS;
+  window_rows = ( rows == 0u || rows > LCD_FB_ROWS - window_row ) ?
+                (u8_t)(LCD_FB_ROWS - window_row) : rows;
+  head = 0;
+  first_line = 0;
+  last_line = 0;
+  line_start[0] = 0;
+  scroll = 0;
+  dirty = TRUE;
+  memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief Write a Character into the History.
+ *
+ * '\n' ends the line, a character after the last column starts a new line.
+ * Other control characters are ignored. A window scrolled back keeps showing
+ * the same lines.
+ * @param c Latin-1 Character.
+ */
+void Scrollback_Putc( char c )
+{
+  u16_t bottom = Scrollback_Bottom();
+  if( c == '\n' )
+  {
+    Scrollback_New_Line();
+  }
+  else if( (u8_t)c >= ' ' && (u8_t)c != 0x7Fu )
+  {
+    if( Scrollback_Length(last_line) >= SCROLLBACK_COLUMNS )
+    {
+      Scrollback_New_Line();
+    }
+    // Empty Lines start at the same Position, all of them are dropped
+    while( (u16_t)(head - line_start[first_line & LINE_MASK]) >=
+           SCROLLBACK_SIZE )
+    {
+      first_line++;
+      stats.dropped++;
+    }
+    history[head & HISTORY_MASK] = c;
+    head++;
+    stats.characters++;
+  }
+  if( scroll > 0u )
+  {
+    scroll = (u16_t)(scroll + (u16_t)(Scrollback_Bottom() - bottom));
+  }
+  dirty = TRUE;
+}
+
+/**
+ * @brief Write a String into the History.
+ *
+ * @param text String terminated by NULL Character.
+ */
+void Scrollback_Puts( const char *text )
+{
+  while( *text )
+  {
+    Scrollback_Putc(*text);
+    text++;
+  }
+}
+
+/**
+ * @brief Scroll the Window with a Key.
+ *
+ * Up and Down scroll by one line, Page Up and Page Down by SCROLLBACK_PAGE
+ * lines, the window stops at the oldest and the newest line.
+ * @param event Key Event of PS2_Get_Event().
+ * @return TRUE if the Key is a Scroll Key, its Release included.
+ */
+boolean Scrollback_Key( const PS2_Key_Event_s *event )
+{
+  boolean used = TRUE;
+  u16_t lines = scroll;
+  switch( event->keycode )
+  {
+    case PS2_KEY_UP:
+      lines++;
+      break;
+    case PS2_KEY_DOWN:
+      lines = ( lines > 0u ) ? (u16_t)(lines - 1u) : 0u;
+      break;
+    case PS2_KEY_PAGEUP:
+      lines = (u16_t)(lines + SCROLLBACK_PAGE);
+      break;
+    case PS2_KEY_PAGEDOWN:
+      lines = ( lines > SCROLLBACK_PAGE ) ?
+              (u16_t)(lines - SCROLLBACK_PAGE) : 0u;
+      break;
+    default:
+      used = FALSE;
+      break;
+  }
+  if( used && (event->flags & PS2_EVT_MAKE) )
+  {
+    // scroll is clamped below 32768, lines can't overflow
+    scroll = lines;
+    Scrollback_Clamp();
+    dirty = TRUE;
+  }
+  return used;
+}
+
+/**
+ * @brief Draw the Window into the Framebuffer.
+ *
+ * Nothing is drawn if the history and the window didn't change. The newest
+ * line shown is scroll lines above the newest line of the history, only the
+ * lines of the window are read from the arena.
+ */
+void Scrollback_Render( void )
+{
+  u16_t bottom, top, line, position, length;
+  u8_t row, column;
+  if( dirty )
+  {
+    Scrollback_Clamp();
+    // Lines counted from the oldest one
+    bottom = (u16_t)(Scrollback_Bottom() - first_line - scroll);
+    top = ( bottom >= window_rows - 1u ) ?
+          (u16_t)(bottom - (window_rows - 1u)) : 0u;
+    for( row = 0; row < window_rows; row++ )
+    {
+      LCD_FB_Goto((u8_t)(window_row + row), 0);
+      line = (u16_t)(first_line + top + row);
+      length = ( top + row <= bottom ) ? Scrollback_Length(line) : 0u;
+      position = line_start[line & LINE_MASK];
+      for( column = 0; column < SCROLLBACK_COLUMNS; column++ )
+      {
+        if( column < length )
+        {
+          LCD_FB_Putc(history[(u16_t)(position + column) & HISTORY_MASK]);
+        }
+        else
+        {
+          LCD_FB_Putc(' ');
+        }
+      }
+    }
+    stats.renders++;
+    dirty = FALSE;
+  }
+}
+
+/**
+ * @brief Lines in the History, an empty open Line not counted.
+ */
+u16_t Scrollback_Get_Lines( void )
+{
+  return (u16_t)(Scrollback_Bottom() - first_line + 1u);
+}
+
+/**
+ * @brief Lines the Window is scrolled back, 0 shows the newest Line.
+ */
+u16_t Scrollback_Get_Scroll( void )
+{
+  return scroll;
+}
+
+/**
+ * @brief Scrollback Statistics.
+ */
+const Scrollback_Stats_s* Scrollback_Get_Stats( void )
+{
+  return &stats;
+}
+
+/**
+ * @brief Characters of a Line.
+ */
+static u16_t Scrollback_Length( u16_t line )
+{
+  u16_t end;
+  end = ( line == last_line ) ? head
+                              : line_start[(u16_t)(line + 1u) & LINE_MASK];
+  return (u16_t)(end - line_start[line & LINE_MASK]);
+}
+
+/**
+ * @brief Newest Line shown, the open Line only if it isn't empty.
+ */
+static u16_t Scrollback_Bottom( void )
+{
+  u16_t bottom = last_line;
+  if( last_line != first_line && Scrollback_Length(last_line) == 0u )
+  {
+    bottom--;
+  }
+  return bottom;
+}
+
+/**
+ * @brief End the open Line and start the next one at head.
+ */
+static void Scrollback_New_Line( void )
+{
+  if( (u16_t)(last_line - first_line) == LINE_MASK )
+  {
+    first_line++;
+    stats.dropped++;
+  }
+  last_line++;
+  line_start[last_line & LINE_MASK] = head;
+  stats.lines++;
+}
+
+/**
+ * @brief Keep the Window within the History.
+ */
+static void Scrollback_Clamp( void )
+{
+  u16_t lines = Scrollback_Get_Lines();
+  u16_t limit = ( lines > window_rows ) ? (u16_t)(lines - window_rows) : 0u;
+  if( scroll > limit )
+  {
+    scroll = limit;
+  }
+}
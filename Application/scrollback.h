@@ -0,0 +1,78 @@
+/**
+ * @file scrollback.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief Scrollback History Header File.
+ *
+ * Text typed or received is kept in a circular history in a static arena,
+ * the oldest lines are dropped when it is full. Text is wrapped at the width
+ * of the LCD, every line of the history is one row. Rows of the LCD are a
+ * window on the history, Up and Down scroll it by one line, Page Up and Page
+ * Down by SCROLLBACK_PAGE lines. The start of every line is kept in a line
+ * index, so drawing the window reads only the lines shown, independent of
+ * the amount of history.
+ */
+
+#ifndef SCROLLBACK_H
+#define SCROLLBACK_H
+
+#include "config.h"
+#include "ps2_keyboard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* History Arena in Bytes, power of two */
+#ifndef SCROLLBACK_SIZE
+#define SCROLLBACK_SIZE       2048u
+#endif
+
+/* Lines in the Line Index, power of two */
+#ifndef SCROLLBACK_LINES
+#define SCROLLBACK_LINES      128u
+#endif
+
+/* Lines scrolled by Page Up and Page Down */
+#ifndef SCROLLBACK_PAGE
+#define SCROLLBACK_PAGE       8u
+#endif
+
+#define SCROLLBACK_COLUMNS    16u     /**< Characters per Line. */
+
+#if ((SCROLLBACK_SIZE & (SCROLLBACK_SIZE - 1u)) != 0u) || \
+    (SCROLLBACK_SIZE > 32768u) || (SCROLLBACK_SIZE < 64u)
+#error "SCROLLBACK_SIZE must be a power of two, 64 to 32768"
+#endif
+
+#if ((SCROLLBACK_LINES & (SCROLLBACK_LINES - 1u)) != 0u) || \
+    (SCROLLBACK_LINES > 32768u) || (SCROLLBACK_LINES < 2u)
+#error "SCROLLBACK_LINES must be a power of two, 2 to 32768"
+#endif
+
+/**
+ * @brief Scrollback Statistics.
+ */
+typedef struct _Scrollback_Stats_s
+{
+  u32_t characters;     /**< Characters written into the History. */
+  u32_t lines;          /**< Lines started, wrapped Lines included. */
+  u32_t dropped;        /**< Oldest Lines dropped, History was full. */
+  u32_t renders;        /**< Windows drawn into the Framebuffer. */
+} Scrollback_Stats_s;
+
+// Function Prototypes
+void Scrollback_Init( u8_t row, u8_t rows );
+void Scrollback_Putc( char c );
+void Scrollback_Puts( const char *text );
+boolean Scrollback_Key( const PS2_Key_Event_s *event );
+void Scrollback_Render( void );
+u16_t Scrollback_Get_Lines( void );
+u16_t Scrollback_Get_Scroll( void );
+const Scrollback_Stats_s* Scrollback_Get_Stats( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCROLLBACK_H */
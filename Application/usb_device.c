@@ -0,0 +1,450 @@
+/**
+ * @file usb_device.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief USB Device Layer.
+ *
+ * Control transfers on EP0 run in the USB interrupt: the setup packet is
+ * decoded, IN data stages are sent in packets of USB_EP0_MAXPACKET from the
+ * IN events, OUT data stages (SET_REPORT) are collected from the OUT events
+ * and then given to usb_hid.c. The device address is set after the status
+ * stage of SET_ADDRESS.
+ */
+
+#include <string.h>
+#include "usb_device.h"
+#include "usb_hid.h"
+#include "lpc13xx_usb.h"
+
+#if USB_HID_BRIDGE
+
+#define CONFIG_DESC_LEN     34u   /**< Configuration, Interface, HID, Endpoint. */
+#define HID_DESC_OFFSET     18u   /**< HID Descriptor in Configuration. */
+#define HID_DESC_LEN        9u    /**< Size of HID Descriptor. */
+
+/**
+ * @brief Control Transfer in Progress.
+ */
+typedef struct _USB_Control_s
+{
+  USB_Setup_s setup;      /**< Setup Packet. */
+  const u8_t *data;       /**< Rest of IN Data Stage. */
+  u16_t count;            /**< Bytes left in Data Stage. */
+  boolean zlp;            /**< IN Data Stage ends with Zero Length Packet. */
+  boolean out;            /**< OUT Data Stage in Progress. */
+  u8_t address;           /**< Address to set after Status Stage, 0 if none. */
+  u8_t buffer[USB_EP0_MAXPACKET];   /**< Built Descriptors and Data Stages. */
+} USB_Control_s;
+
+// Private Variables
+static USB_Control_s ctrl;
+static volatile u8_t configuration = 0;   // Selected Configuration, 0 if none
+static boolean hid_halted = FALSE;        // IN Endpoint halted by Host
+
+/** Device Descriptor. */
+static const u8_t device_descriptor[18] = {
+  18, USB_DESC_DEVICE,
+  0x00, 0x02,                 // USB 2.0, Full Speed
+  0x00, 0x00, 0x00,           // Class defined by Interface
+  USB_EP0_MAXPACKET,
+  (u8_t)USB_VENDOR_ID, (u8_t)(USB_VENDOR_ID >> 8),
+  (u8_t)USB_PRODUCT_ID, (u8_t)(USB_PRODUCT_ID >> 8),
+  (u8_t)USB_DEVICE_RELEASE, (u8_t)(USB_DEVICE_RELEASE >> 8),
+  1, 2, 0,                    // Manufacturer, Product, no Serial Number
+  1                           // Configurations
+};
+
+/** Configuration Descriptor with Interface, HID and Endpoint Descriptors. */
+static const u8_t config_descriptor[CONFIG_DESC_LEN] = {
+  9, USB_DESC_CONFIG,
+  CONFIG_DESC_LEN, 0x00,
+  1, USB_CONFIG_VALUE, 0,     // Interfaces, Value, no String
+  0x80,                       // Bus Powered
+  USB_MAX_POWER_MA / 2u,
+  // Interface 0, HID Boot Keyboard
+  9, USB_DESC_INTERFACE,
+  0, 0, 1,                    // Interface, Alternate Setting, Endpoints
+  0x03, 0x01, 0x01,           // HID, Boot Interface, Keyboard
+  0,
+  // HID Descriptor
+  HID_DESC_LEN, USB_DESC_HID,
+  0x11, 0x01,                 // HID 1.11
+  0, 1,                       // No Country, one Descriptor
+  USB_DESC_REPORT,
+  (u8_t)USB_HID_REPORT_DESC_LEN, (u8_t)(USB_HID_REPORT_DESC_LEN >> 8),
+  // Endpoint 1 IN, Interrupt
+  7, USB_DESC_ENDPOINT,
+  USB_HID_EP_IN, 0x03,
+  USB_HID_EP_PACKET, 0x00,
+  USB_HID_INTERVAL_MS
+};
+
+/** String Descriptors, index 0 is the Language. */
+static const char* const strings[] = {
+  "", "Embedded Laboratory", "PS2 Keyboard Bridge"
+};
+
+static void Control_Setup( void );
+static void Control_Request( void );
+static void Control_Send( void );
+static void Control_Status( boolean ok );
+static boolean Standard_Request( u8_t **data, u16_t *length );
+static boolean Get_Descriptor( u8_t **data, u16_t *length );
+static u16_t String_Descriptor( u8_t index, u8_t *buffer );
+
+/**
+ * @brief Initialize USB Device.
+ *
+ * Starts the USB clock and connects the pull-up, the host then enumerates the
+ * device in the USB interrupt.
+ */
+void USB_Device_Init( void )
+{
+  memset(&ctrl, 0, sizeof(ctrl));
+  configuration = 0;
+  USB_HID_Init();
+  USB_Init();
+  USB_Connect(ENABLE);
+}
+
+/**
+ * @brief Device is Configured.
+ * @return TRUE if the host selected the configuration.
+ */
+boolean IS_USB_Configured( void )
+{
+  return (boolean)( configuration != 0 );
+}
+
+/**
+ * @brief Bus Reset, from USB Interrupt.
+ */
+void USB_Reset_Event( void )
+{
+  memset(&ctrl, 0, sizeof(ctrl));
+  configuration = 0;
+  hid_halted = FALSE;
+  USB_HID_Configure(FALSE);
+}
+
+/**
+ * @brief Suspend changed, from USB Interrupt.
+ *
+ * Host doesn't poll while the bus is suspended, a report in the IN Endpoint
+ * is sent after resume. Remote Wake-Up is not supported.
+ */
+void USB_Suspend_Event( FunctionalState NewState )
+{
+  (void)NewState;
+}
+
+/**
+ * @brief Endpoint Event, from USB Interrupt.
+ * @param EPNum Endpoint Address.
+ * @param event USB_EVT_SETUP, USB_EVT_OUT or USB_EVT_IN.
+ */
+void USB_EP_Event( uint8_t EPNum, uint8_t event )
+{
+  u8_t packet[USB_EP0_MAXPACKET];
+  u32_t length;
+  u16_t request_length;
+  if( EPNum == USB_HID_EP_IN )
+  {
+    USB_HID_IN_Done();
+  }
+  else if( event == USB_EVT_SETUP )
+  {
+    Control_Setup();
+  }
+  else if( event == USB_EVT_OUT && EPNum == 0 )
+  {
+    if( ctrl.out )
+    {
+      // Data Stage of SET_REPORT, request is handled when it is complete.
+      // The packet is read whole, a host sending more than wLength is stalled
+      length = USB_ReadEP(0, packet);
+      if( length > ctrl.count )
+      {
+        ctrl.out = FALSE;
+        ctrl.count = 0;
+        Control_Status(FALSE);
+      }
+      else
+      {
+        memcpy(&ctrl.buffer[ctrl.setup.length - ctrl.count], packet, length);
+        ctrl.count = (u16_t)(ctrl.count - length);
+      }
+      if( ctrl.out && ctrl.count == 0 )
+      {
+        ctrl.out = FALSE;
+        request_length = ctrl.setup.length;
+        Control_Status( USB_HID_Request(&ctrl.setup, ctrl.buffer,
+                                        &request_length) );
+      }
+    }
+    else
+    {
+      // Status Stage of an IN transfer
+      USB_ReadEP(0, packet);
+    }
+  }
+  else if( event == USB_EVT_IN && EPNum == USB_EP_DIR_IN )
+  {
+    if( ctrl.count || ctrl.zlp )
+    {
+      Control_Send();
+    }
+    else if( ctrl.address )
+    {
+      // Status Stage of SET_ADDRESS is done with the old address
+      USB_SetAddress(ctrl.address);
+      ctrl.address = 0;
+    }
+  }
+}
+
+/**
+ * @brief Setup Packet received.
+ */
+static void Control_Setup( void )
+{
+  u8_t packet[USB_SETUP_LEN];
+  USB_ReadEP(0, packet);
+  ctrl.setup.request_type = packet[0];
+  ctrl.setup.request = packet[1];
+  ctrl.setup.value = (u16_t)(packet[2] | (packet[3] << 8));
+  ctrl.setup.index = (u16_t)(packet[4] | (packet[5] << 8));
+  ctrl.setup.length = (u16_t)(packet[6] | (packet[7] << 8));
+  ctrl.count = 0;
+  ctrl.zlp = FALSE;
+  ctrl.out = FALSE;
+  if( !(ctrl.setup.request_type & USB_REQ_DIR_IN) && ctrl.setup.length )
+  {
+    // OUT Data Stage follows, request is handled when it is complete
+    if( (ctrl.setup.request_type & USB_REQ_TYPE_MASK) == USB_REQ_CLASS &&
+        ctrl.setup.length <= USB_CTRL_OUT_MAX )
+    {
+      ctrl.out = TRUE;
+      ctrl.count = ctrl.setup.length;
+    }
+    else
+    {
+      Control_Status(FALSE);
+    }
+  }
+  else
+  {
+    Control_Request();
+  }
+}
+
+/**
+ * @brief Request without OUT Data Stage.
+ */
+static void Control_Request( void )
+{
+  u8_t *data = ctrl.buffer;
+  u16_t length = 0;
+  boolean ok = FALSE;
+  switch( ctrl.setup.request_type & USB_REQ_TYPE_MASK )
+  {
+  case USB_REQ_STANDARD:
+    ok = Standard_Request(&data, &length);
+    break;
+  case USB_REQ_CLASS:
+    ok = ( configuration != 0 ) &&
+         USB_HID_Request(&ctrl.setup, data, &length);
+    break;
+  default:
+    break;
+  }
+  if( ok && (ctrl.setup.request_type & USB_REQ_DIR_IN) )
+  {
+    // Host may ask for less, a short answer ends with a short packet
+    if( length > ctrl.setup.length )
+    {
+      length = ctrl.setup.length;
+    }
+    ctrl.data = data;
+    ctrl.count = length;
+    ctrl.zlp = (boolean)( length < ctrl.setup.length &&
+                          (length % USB_EP0_MAXPACKET) == 0 );
+    Control_Send();
+  }
+  else
+  {
+    Control_Status(ok);
+  }
+}
+
+/**
+ * @brief Send next Packet of IN Data Stage.
+ */
+static void Control_Send( void )
+{
+  u16_t length = ctrl.count;
+  if( length >= USB_EP0_MAXPACKET )
+  {
+    length = USB_EP0_MAXPACKET;
+  }
+  else
+  {
+    // Short Packet ends the Data Stage
+    ctrl.zlp = FALSE;
+  }
+  USB_WriteEP(USB_EP_DIR_IN, ctrl.data, length);
+  ctrl.data += length;
+  ctrl.count = (u16_t)(ctrl.count - length);
+}
+
+/**
+ * @brief Status Stage of a Request without IN Data Stage.
+ * @param ok TRUE to acknowledge, FALSE to stall the request.
+ */
+static void Control_Status( boolean ok )
+{
+  if( ok )
+  {
+    USB_WriteEP(USB_EP_DIR_IN, ctrl.buffer, 0);
+  }
+  else
+  {
+    // Both directions, the next Setup Packet clears it
+    ctrl.address = 0;
+    USB_SetStallEP(0, ENABLE);
+    USB_SetStallEP(USB_EP_DIR_IN, ENABLE);
+  }
+}
+
+/**
+ * @brief Standard Request.
+ * @param data IN Data Stage, may be pointed to a descriptor.
+ * @param length Size of IN Data Stage.
+ * @return FALSE if the request is not supported.
+ */
+static boolean Standard_Request( u8_t **data, u16_t *length )
+{
+  const USB_Setup_s *s = &ctrl.setup;
+  u8_t recipient = s->request_type & USB_REQ_RECIPIENT;
+  boolean ok = TRUE;
+  switch( s->request )
+  {
+  case USB_GET_STATUS:
+    // Bus Powered without Remote Wake-Up, only the IN Endpoint can halt
+    (*data)[0] = (u8_t)( recipient == USB_REQ_ENDPOINT &&
+                         s->index == USB_HID_EP_IN && hid_halted );
+    (*data)[1] = 0;
+    *length = 2u;
+    break;
+  case USB_CLEAR_FEATURE:
+  case USB_SET_FEATURE:
+    ok = ( recipient == USB_REQ_ENDPOINT && s->index == USB_HID_EP_IN &&
+           s->value == USB_FEATURE_HALT && configuration != 0 );
+    if( ok )
+    {
+      hid_halted = (boolean)( s->request == USB_SET_FEATURE );
+      USB_SetStallEP(USB_HID_EP_IN, hid_halted ? ENABLE : DISABLE);
+    }
+    break;
+  case USB_SET_ADDRESS:
+    ctrl.address = (u8_t)(s->value & 0x7Fu);
+    break;
+  case USB_GET_DESCRIPTOR:
+    ok = Get_Descriptor(data, length);
+    break;
+  case USB_GET_CONFIGURATION:
+    (*data)[0] = configuration;
+    *length = 1u;
+    break;
+  case USB_SET_CONFIGURATION:
+    ok = ( s->value <= USB_CONFIG_VALUE );
+    if( ok )
+    {
+      configuration = (u8_t)s->value;
+      hid_halted = FALSE;
+      USB_Configure(configuration ? ENABLE : DISABLE);
+      USB_HID_Configure((boolean)( configuration != 0 ));
+    }
+    break;
+  case USB_GET_INTERFACE:
+    (*data)[0] = 0;
+    *length = 1u;
+    ok = ( configuration != 0 && s->index == 0 );
+    break;
+  case USB_SET_INTERFACE:
+    ok = ( configuration != 0 && s->index == 0 && s->value == 0 );
+    break;
+  default:
+    ok = FALSE;
+    break;
+  }
+  return ok;
+}
+
+/**
+ * @brief GET_DESCRIPTOR Request.
+ *
+ * Type is in the high byte of wValue, index in the low byte. HID and Report
+ * Descriptors are asked from the interface.
+ */
+static boolean Get_Descriptor( u8_t **data, u16_t *length )
+{
+  u8_t type = (u8_t)(ctrl.setup.value >> 8);
+  u8_t index = (u8_t)ctrl.setup.value;
+  boolean ok = TRUE;
+  switch( type )
+  {
+  case USB_DESC_DEVICE:
+    *data = (u8_t*)device_descriptor;
+    *length = sizeof(device_descriptor);
+    break;
+  case USB_DESC_CONFIG:
+    *data = (u8_t*)config_descriptor;
+    *length = sizeof(config_descriptor);
+    break;
+  case USB_DESC_STRING:
+    ok = ( index < sizeof(strings) / sizeof(strings[0]) );
+    *length = ok ? String_Descriptor(index, *data) : 0;
+    break;
+  case USB_DESC_HID:
+    *data = (u8_t*)&config_descriptor[HID_DESC_OFFSET];
+    *length = HID_DESC_LEN;
+    break;
+  case USB_DESC_REPORT:
+    *data = (u8_t*)USB_HID_ReportDescriptor;
+    *length = sizeof(USB_HID_ReportDescriptor);
+    break;
+  default:
+    ok = FALSE;
+    break;
+  }
+  return ok;
+}
+
+/**
+ * @brief Build String Descriptor.
+ *
+ * Strings are kept as ASCII and sent as UTF-16, index 0 is the language list
+ * with US English only.
+ * @return Size of Descriptor.
+ */
+static u16_t String_Descriptor( u8_t index, u8_t *buffer )
+{
+  const char *text = strings[index];
+  u8_t length = 2u;
+  if( index == 0 )
+  {
+    buffer[length++] = 0x09;
+    buffer[length++] = 0x04;
+  }
+  while( *text && length < USB_EP0_MAXPACKET )
+  {
+    buffer[length++] = (u8_t)*text++;
+    buffer[length++] = 0;
+  }
+  buffer[0] = length;
+  buffer[1] = USB_DESC_STRING;
+  return length;
+}
+
+#endif /* USB_HID_BRIDGE */
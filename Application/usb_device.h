@@ -0,0 +1,81 @@
+/**
+ * @file usb_device.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief USB Device Layer Header File.
+ *
+ * Standard requests and descriptors of the USB keyboard on the control
+ * endpoint, class requests go to usb_hid.c. The endpoint layer is the
+ * lpc13xx_usb driver, which the Host Build replaces with a stub.
+ */
+
+#ifndef USB_DEVICE_H
+#define USB_DEVICE_H
+
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define USB_VENDOR_ID         0x1FC9u   /**< NXP, needs an own ID in a product. */
+#define USB_PRODUCT_ID        0x0100u   /**< PS2 Keyboard Bridge. */
+#define USB_DEVICE_RELEASE    0x0100u   /**< Device Release 1.00. */
+#define USB_MAX_POWER_MA      100u      /**< Bus Current of Board. */
+
+/* bmRequestType */
+#define USB_REQ_DIR_IN        0x80  /**< Data Stage Device to Host. */
+#define USB_REQ_TYPE_MASK     0x60  /**< Request Type Bits. */
+#define USB_REQ_STANDARD      0x00  /**< Standard Request. */
+#define USB_REQ_CLASS         0x20  /**< Class Request. */
+#define USB_REQ_RECIPIENT     0x1F  /**< Recipient Bits. */
+#define USB_REQ_DEVICE        0x00  /**< Recipient is Device. */
+#define USB_REQ_INTERFACE     0x01  /**< Recipient is Interface. */
+#define USB_REQ_ENDPOINT      0x02  /**< Recipient is Endpoint. */
+
+/* Standard Requests */
+#define USB_GET_STATUS        0x00  /**< Get Status. */
+#define USB_CLEAR_FEATURE     0x01  /**< Clear Feature. */
+#define USB_SET_FEATURE       0x03  /**< Set Feature. */
+#define USB_SET_ADDRESS       0x05  /**< Set Address. */
+#define USB_GET_DESCRIPTOR    0x06  /**< Get Descriptor. */
+#define USB_GET_CONFIGURATION 0x08  /**< Get Configuration. */
+#define USB_SET_CONFIGURATION 0x09  /**< Set Configuration. */
+#define USB_GET_INTERFACE     0x0A  /**< Get Interface. */
+#define USB_SET_INTERFACE     0x0B  /**< Set Interface. */
+#define USB_FEATURE_HALT      0x00  /**< Endpoint Halt Feature. */
+
+/* Descriptor Types */
+#define USB_DESC_DEVICE       0x01  /**< Device Descriptor. */
+#define USB_DESC_CONFIG       0x02  /**< Configuration Descriptor. */
+#define USB_DESC_STRING       0x03  /**< String Descriptor. */
+#define USB_DESC_INTERFACE    0x04  /**< Interface Descriptor. */
+#define USB_DESC_ENDPOINT     0x05  /**< Endpoint Descriptor. */
+#define USB_DESC_HID          0x21  /**< HID Descriptor. */
+#define USB_DESC_REPORT       0x22  /**< HID Report Descriptor. */
+
+#define USB_CONFIG_VALUE      1u    /**< Only Configuration. */
+#define USB_SETUP_LEN         8u    /**< Setup Packet Size. */
+#define USB_CTRL_OUT_MAX      8u    /**< Longest OUT Data Stage accepted. */
+
+/**
+ * @brief Setup Packet of a Control Transfer.
+ */
+typedef struct _USB_Setup_s
+{
+  u8_t request_type;    /**< bmRequestType, see USB_REQ_xxx. */
+  u8_t request;         /**< bRequest. */
+  u16_t value;          /**< wValue. */
+  u16_t index;          /**< wIndex. */
+  u16_t length;         /**< wLength, Size of Data Stage. */
+} USB_Setup_s;
+
+// Function Prototypes
+void USB_Device_Init( void );
+boolean IS_USB_Configured( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* USB_DEVICE_H */
@@ -0,0 +1,378 @@
+/**
+ * @file usb_hid.c
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief USB HID Keyboard.
+ *
+ * Pressed keys are kept as a bitmap per PS2 port, a report is built from the
+ * union of the ports. Only one report is in flight: while the IN endpoint is
+ * busy no key event is taken, the rest stays in the PS2 queue and the next
+ * report follows at the next 1 ms poll. So a key pressed and released within
+ * one poll is still seen by the host.
+ *
+ * Control requests are answered in the USB interrupt, reports are written by
+ * the main loop with the USB interrupt disabled, both use the SIE commands.
+ */
+
+#include <string.h>
+#include "usb_hid.h"
+#include "lpc13xx_usb.h"
+#include "latency.h"
+#include "events.h"
+
+#if USB_HID_BRIDGE
+
+// Private Variables
+static u8_t key_down[PS2_PORTS][32];      // Pressed Keys, one bit per Key Code
+static u8_t modifiers[PS2_PORTS];         // Modifier Mask, see PS2_MOD_xxx
+static u8_t last_report[USB_HID_REPORT_MAX];  // Last Report sent
+static u8_t last_length = 0;              // Size of Last Report, 0 if none
+static u32_t last_report_ms = 0;          // Time of Last Report
+static volatile boolean configured = FALSE;
+static volatile boolean busy = FALSE;     // Report in IN Endpoint
+static volatile boolean resend = FALSE;   // Report must be sent again
+static volatile u8_t protocol = USB_HID_PROTOCOL_REPORT;
+static volatile u8_t idle_rate = USB_HID_IDLE_DEFAULT;
+static volatile u8_t host_leds = 0;       // LED Report, see USB_HID_LED_xxx
+static volatile boolean leds_pending = FALSE;
+static USB_HID_Stats_s stats = {0, 0, 0, 0, 0};
+
+static boolean Send_Report( void );
+
+/** Report Descriptor, Modifiers and Key Bitmap in, LEDs out. */
+#if USB_HID_NKRO
+const u8_t USB_HID_ReportDescriptor[USB_HID_REPORT_DESC_LEN] = {
+  0x05, 0x01,         // Usage Page (Generic Desktop)
+  0x09, 0x06,         // Usage (Keyboard)
+  0xA1, 0x01,         // Collection (Application)
+  0x05, 0x07,         //   Usage Page (Keyboard)
+  0x19, 0xE0,         //   Usage Minimum (Left Ctrl)
+  0x29, 0xE7,         //   Usage Maximum (Right GUI)
+  0x15, 0x00,         //   Logical Minimum (0)
+  0x25, 0x01,         //   Logical Maximum (1)
+  0x75, 0x01,         //   Report Size (1)
+  0x95, 0x08,         //   Report Count (8)
+  0x81, 0x02,         //   Input (Data, Variable, Absolute)
+  0x05, 0x08,         //   Usage Page (LEDs)
+  0x19, 0x01,         //   Usage Minimum (Num Lock)
+  0x29, 0x05,         //   Usage Maximum (Kana)
+  0x95, 0x05,         //   Report Count (5)
+  0x91, 0x02,         //   Output (Data, Variable, Absolute)
+  0x95, 0x03,         //   Report Count (3)
+  0x91, 0x01,         //   Output (Constant)
+  0x05, 0x07,         //   Usage Page (Keyboard)
+  0x19, 0x00,         //   Usage Minimum (0)
+  0x29, USB_HID_NKRO_KEYS - 1u, //   Usage Maximum
+  0x95, USB_HID_NKRO_KEYS,      //   Report Count, one bit per Key
+  0x81, 0x02,         //   Input (Data, Variable, Absolute)
+  0xC0                // End Collection
+};
+#else
+const u8_t USB_HID_ReportDescriptor[USB_HID_REPORT_DESC_LEN] = {
+  0x05, 0x01,         // Usage Page (Generic Desktop)
+  0x09, 0x06,         // Usage (Keyboard)
+  0xA1, 0x01,         // Collection (Application)
+  0x05, 0x07,         //   Usage Page (Keyboard)
+  0x19, 0xE0,         //   Usage Minimum (Left Ctrl)
+  0x29, 0xE7,         //   Usage Maximum (Right GUI)
+  0x15, 0x00,         //   Logical Minimum (0)
+  0x25, 0x01,         //   Logical Maximum (1)
+  0x75, 0x01,         //   Report Size (1)
+  0x95, 0x08,         //   Report Count (8)
+  0x81, 0x02,         //   Input (Data, Variable, Absolute)
+  0x95, 0x01,         //   Report Count (1)
+  0x75, 0x08,         //   Report Size (8)
+  0x81, 0x01,         //   Input (Constant), Reserved Byte
+  0x95, 0x05,         //   Report Count (5)
+  0x75, 0x01,         //   Report Size (1)
+  0x05, 0x08,         //   Usage Page (LEDs)
+  0x19, 0x01,         //   Usage Minimum (Num Lock)
+  0x29, 0x05,         //   Usage Maximum (Kana)
+  0x91, 0x02,         //   Output (Data, Variable, Absolute)
+  0x95, 0x01,         //   Report Count (1)
+  0x75, 0x03,         //   Report Size (3)
+  0x91, 0x01,         //   Output (Constant)
+  0x95, 0x06,         //   Report Count (6)
+  0x75, 0x08,         //   Report Size (8)
+  0x15, 0x00,         //   Logical Minimum (0)
+  0x25, 0x65,         //   Logical Maximum (101)
+  0x05, 0x07,         //   Usage Page (Keyboard)
+  0x19, 0x00,         //   Usage Minimum (0)
+  0x29, 0x65,         //   Usage Maximum (101)
+  0x81, 0x00,         //   Input (Data, Array), Key Codes
+  0xC0                // End Collection
+};
+#endif
+
+/**
+ * @brief Initialize HID Keyboard.
+ *
+ * Clears the key state, the host sees the keyboard after USB_Device_Init().
+ */
+void USB_HID_Init( void )
+{
+  memset(key_down, 0, sizeof(key_down));
+  memset(modifiers, 0, sizeof(modifiers));
+  memset(&stats, 0, sizeof(stats));
+  USB_HID_Configure(FALSE);
+}
+
+/**
+ * @brief HID Keyboard can take a Key Event.
+ *
+ * Events are taken while the keyboard is not configured, only the key state
+ * is kept then, so the PS2 queue doesn't fill up without a host.
+ * @return TRUE if the IN Endpoint is free or the keyboard is not configured.
+ */
+boolean IS_USB_HID_Ready( void )
+{
+  return (boolean)( !configured || !busy );
+}
+
+/**
+ * @brief Key Event from a PS2 Port.
+ *
+ * Updates the key state of the port and writes a report if it changed,
+ * typematic repeats don't change it. Call it only if IS_USB_HID_Ready().
+ * @param port PS2 Port, see PS2_PORT_xxx.
+ * @param event Decoded Key Event.
+ * @return TRUE if a report was written.
+ */
+boolean USB_HID_Key_Event( u8_t port, const PS2_Key_Event_s *event )
+{
+  u8_t mask = (u8_t)(1u << (event->keycode & 0x07u));
+  boolean sent = FALSE;
+  stats.events++;
+  modifiers[port] = event->modifiers;
+  // Modifiers are only in the mask, not in the key bitmap
+  if( event->keycode < PS2_KEY_LCTRL )
+  {
+    if( event->flags & PS2_EVT_MAKE )
+    {
+      key_down[port][event->keycode >> 3] |= mask;
+    }
+    else
+    {
+      key_down[port][event->keycode >> 3] &= (u8_t)~mask;
+    }
+  }
+  if( configured && Send_Report() )
+  {
+    Latency_Record(LATENCY_USB, event->timestamp);
+    sent = TRUE;
+  }
+  return sent;
+}
+
+/**
+ * @brief HID Keyboard Task, call it from the main loop.
+ *
+ * LED reports of the host are sent to the PS2 keyboard, the last report is
+ * repeated when the idle rate has passed or the host changed the protocol.
+ */
+void USB_HID_Task( void )
+{
+  u8_t leds, locks;
+  if( leds_pending )
+  {
+    leds = host_leds;
+    locks = (u8_t)(((leds & USB_HID_LED_NUM) ? PS2_EVT_NUM : 0) |
+                   ((leds & USB_HID_LED_CAPS) ? PS2_EVT_CAPS : 0) |
+                   ((leds & USB_HID_LED_SCROLL) ? PS2_EVT_SCROLL : 0));
+    // Stays pending if the Command Queue is full
+    if( PS2_Set_Locks(PS2_PORT_KEYBOARD, locks) )
+    {
+      leds_pending = FALSE;
+    }
+  }
+  if( configured && !busy && (resend || (idle_rate &&
+      millis() - last_report_ms >= idle_rate * 4u)) )
+  {
+    // Forget the last report, so the same one is sent again
+    if( !resend )
+    {
+      stats.idle_reports++;
+    }
+    resend = FALSE;
+    last_length = 0;
+    Send_Report();
+  }
+}
+
+/**
+ * @brief Build Report of current Key State.
+ *
+ * In boot protocol (and without USB_HID_NKRO) the boot report is built:
+ * modifiers, a reserved byte and up to 6 key codes, with more keys pressed
+ * all 6 are USB_HID_ROLLOVER. In report protocol the modifiers are followed
+ * by a bitmap of key codes 0x00-0x67, any number of keys can be pressed.
+ * @param report Buffer of USB_HID_REPORT_MAX Bytes.
+ * @return Report Size.
+ */
+u8_t USB_HID_Build_Report( u8_t *report )
+{
+  u8_t length, port, i, bit, count = 0;
+  u8_t keys[32];
+  memset(keys, 0, sizeof(keys));
+  report[0] = 0;
+  for( port = 0; port < PS2_PORTS; port++ )
+  {
+    report[0] |= modifiers[port];
+    for( i = 0; i < sizeof(keys); i++ )
+    {
+      keys[i] |= key_down[port][i];
+    }
+  }
+  if( !USB_HID_NKRO || protocol == USB_HID_PROTOCOL_BOOT )
+  {
+    length = USB_HID_BOOT_LEN;
+    memset(&report[1], 0, USB_HID_BOOT_LEN - 1u);
+    for( i = 0; i < sizeof(keys); i++ )
+    {
+      for( bit = 0; keys[i] && bit < 8u; bit++ )
+      {
+        if( keys[i] & (1u << bit) )
+        {
+          if( count < USB_HID_BOOT_KEYS )
+          {
+            report[2u + count] = (u8_t)((i << 3) | bit);
+          }
+          count++;
+        }
+      }
+    }
+    if( count > USB_HID_BOOT_KEYS )
+    {
+      memset(&report[2], USB_HID_ROLLOVER, USB_HID_BOOT_KEYS);
+    }
+  }
+  else
+  {
+    length = USB_HID_NKRO_LEN;
+    memcpy(&report[1], keys, USB_HID_NKRO_LEN - 1u);
+  }
+  return length;
+}
+
+/**
+ * @brief Write Report if it differs from the last one.
+ * @return TRUE if a report was written.
+ */
+static boolean Send_Report( void )
+{
+  u8_t report[USB_HID_REPORT_MAX];
+  u8_t length;
+  boolean sent = FALSE;
+  length = USB_HID_Build_Report(report);
+  if( length != last_length || memcmp(report, last_report, length) )
+  {
+    if( report[2] == USB_HID_ROLLOVER && length == USB_HID_BOOT_LEN )
+    {
+      stats.rollovers++;
+    }
+    memcpy(last_report, report, length);
+    last_length = length;
+    last_report_ms = millis();
+    busy = TRUE;
+    NVIC_DisableIRQ(USB_IRQn);
+    USB_WriteEP(USB_HID_EP_IN, report, length);
+    NVIC_EnableIRQ(USB_IRQn);
+    stats.reports++;
+    sent = TRUE;
+  }
+  return sent;
+}
+
+/**
+ * @brief HID Keyboard Statistics.
+ * @return Pointer to Statistics.
+ */
+const USB_HID_Stats_s* USB_HID_Get_Stats( void )
+{
+  return &stats;
+}
+
+/**
+ * @brief Configuration changed, from USB Interrupt.
+ *
+ * A new configuration starts in report protocol with the default idle rate,
+ * USB_HID_Task() sends the current key state first.
+ * @param enable TRUE if configured, FALSE after Bus Reset.
+ */
+void USB_HID_Configure( boolean enable )
+{
+  busy = FALSE;
+  resend = TRUE;
+  protocol = USB_HID_PROTOCOL_REPORT;
+  idle_rate = USB_HID_IDLE_DEFAULT;
+  configured = enable;
+}
+
+/**
+ * @brief Report sent, from USB Interrupt.
+ */
+void USB_HID_IN_Done( void )
+{
+  busy = FALSE;
+  // Main loop takes the next key event
+  Event_Post(EVENT_USB);
+}
+
+/**
+ * @brief HID Class Request, from USB Interrupt.
+ *
+ * For requests with IN data stage the data is written to data, for SET_REPORT
+ * data holds the OUT data stage.
+ * @param setup Setup Packet.
+ * @param data Data Stage, USB_EP0_MAXPACKET Bytes.
+ * @param length Size of Data Stage, for IN requests it is set here.
+ * @return FALSE if the request is not supported, the endpoint is stalled.
+ */
+boolean USB_HID_Request( const USB_Setup_s *setup, u8_t *data,
+                         u16_t *length )
+{
+  boolean ok = TRUE;
+  switch( setup->request )
+  {
+  case USB_HID_GET_REPORT:
+    // Host gets the current key state, not the last sent report
+    *length = USB_HID_Build_Report(data);
+    break;
+  case USB_HID_GET_IDLE:
+    data[0] = idle_rate;
+    *length = 1u;
+    break;
+  case USB_HID_GET_PROTOCOL:
+    data[0] = protocol;
+    *length = 1u;
+    break;
+  case USB_HID_SET_REPORT:
+    if( (setup->value >> 8) == USB_HID_REPORT_OUTPUT && *length >= 1u )
+    {
+      host_leds = data[0];
+      leds_pending = TRUE;
+      stats.leds++;
+      Event_Post(EVENT_USB);
+    }
+    else
+    {
+      ok = FALSE;
+    }
+    break;
+  case USB_HID_SET_IDLE:
+    idle_rate = (u8_t)(setup->value >> 8);
+    break;
+  case USB_HID_SET_PROTOCOL:
+    protocol = (u8_t)(setup->value & 0x01u);
+    // Key state is sent again in the new format
+    resend = TRUE;
+    Event_Post(EVENT_USB);
+    break;
+  default:
+    ok = FALSE;
+    break;
+  }
+  return ok;
+}
+
+#endif /* USB_HID_BRIDGE */
@@ -0,0 +1,106 @@
+/**
+ * @file usb_hid.h
+ * @author Embedded Laboratory
+ * @date October 16, 2026
+ * @brief USB HID Keyboard Header File.
+ *
+ * Key events decoded from the PS2 ports are reported to a USB host on a 1 ms
+ * interrupt endpoint. The interface is a boot keyboard, in boot protocol the
+ * 8 byte boot report is sent (6 keys), in report protocol a bitmap of all
+ * keys (NKRO). LED reports of the host are sent back to the PS2 keyboard.
+ */
+
+#ifndef USB_HID_H
+#define USB_HID_H
+
+#include "config.h"
+#include "ps2_keyboard.h"
+#include "usb_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* PS2 to USB Bridge, 0 Disabled, 1 Enabled */
+#ifndef USB_HID_BRIDGE
+#define USB_HID_BRIDGE        1
+#endif
+
+/* Report Protocol Format, 0 Boot Report, 1 Key Bitmap (NKRO) */
+#ifndef USB_HID_NKRO
+#define USB_HID_NKRO          1
+#endif
+
+#define USB_HID_EP_IN         0x81u   /**< Interrupt IN Endpoint. */
+#define USB_HID_EP_PACKET     16u     /**< Packet Size of IN Endpoint. */
+#define USB_HID_INTERVAL_MS   1u      /**< Polling Interval of IN Endpoint. */
+#define USB_HID_IDLE_DEFAULT  125u    /**< Idle Rate after Reset, 4 ms units. */
+
+#define USB_HID_BOOT_KEYS     6u      /**< Keys in Boot Report. */
+#define USB_HID_BOOT_LEN      8u      /**< Boot Report Size. */
+#define USB_HID_NKRO_KEYS     0x68u   /**< Key Codes 0x00-0x67 in Bitmap. */
+#define USB_HID_NKRO_LEN      (1u + USB_HID_NKRO_KEYS / 8u) /**< Bitmap Report Size. */
+#define USB_HID_REPORT_MAX    USB_HID_NKRO_LEN  /**< Largest Report. */
+#if USB_HID_NKRO
+#define USB_HID_REPORT_DESC_LEN   47u /**< Size of Report Descriptor. */
+#else
+#define USB_HID_REPORT_DESC_LEN   63u /**< Size of Report Descriptor. */
+#endif
+
+#if (USB_HID_NKRO_KEYS % 8u) != 0u || USB_HID_NKRO_LEN > USB_HID_EP_PACKET
+#error "Key Bitmap must be whole bytes and fit in one packet"
+#endif
+
+/* HID Class Requests */
+#define USB_HID_GET_REPORT    0x01  /**< Get Report. */
+#define USB_HID_GET_IDLE      0x02  /**< Get Idle Rate. */
+#define USB_HID_GET_PROTOCOL  0x03  /**< Get Protocol. */
+#define USB_HID_SET_REPORT    0x09  /**< Set Report. */
+#define USB_HID_SET_IDLE      0x0A  /**< Set Idle Rate. */
+#define USB_HID_SET_PROTOCOL  0x0B  /**< Set Protocol. */
+
+#define USB_HID_REPORT_INPUT  0x01  /**< Report Type of Key Report. */
+#define USB_HID_REPORT_OUTPUT 0x02  /**< Report Type of LED Report. */
+#define USB_HID_PROTOCOL_BOOT   0u  /**< Boot Protocol. */
+#define USB_HID_PROTOCOL_REPORT 1u  /**< Report Protocol. */
+
+/* LED Report Bits */
+#define USB_HID_LED_NUM       0x01  /**< Num Lock LED. */
+#define USB_HID_LED_CAPS      0x02  /**< Caps Lock LED. */
+#define USB_HID_LED_SCROLL    0x04  /**< Scroll Lock LED. */
+
+#define USB_HID_ROLLOVER      0x01  /**< Key Code of too many Keys. */
+
+extern const u8_t USB_HID_ReportDescriptor[USB_HID_REPORT_DESC_LEN];
+
+/**
+ * @brief HID Keyboard Statistics.
+ */
+typedef struct _USB_HID_Stats_s
+{
+  u32_t events;         /**< Key Events taken. */
+  u32_t reports;        /**< Reports written to IN Endpoint. */
+  u32_t idle_reports;   /**< Reports repeated for the Idle Rate. */
+  u32_t rollovers;      /**< Boot Reports with too many Keys. */
+  u32_t leds;           /**< LED Reports received. */
+} USB_HID_Stats_s;
+
+// Function Prototypes
+void USB_HID_Init( void );
+boolean IS_USB_HID_Ready( void );
+boolean USB_HID_Key_Event( u8_t port, const PS2_Key_Event_s *event );
+void USB_HID_Task( void );
+u8_t USB_HID_Build_Report( u8_t *report );
+const USB_HID_Stats_s* USB_HID_Get_Stats( void );
+
+// USB Device Layer Interface
+void USB_HID_Configure( boolean configured );
+boolean USB_HID_Request( const USB_Setup_s *setup, u8_t *data,
+                         u16_t *length );
+void USB_HID_IN_Done( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* USB_HID_H */
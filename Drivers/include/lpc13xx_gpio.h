@@ -56,6 +56,8 @@ void GPIO_IntEnable( uint32_t portNum, uint32_t bitValue );
 void GPIO_IntDisable( uint32_t portNum, uint32_t bitValue );
 uint32_t GPIO_IntStatus( uint32_t portNum, uint32_t bitValue );
 void GPIO_IntClear( uint32_t portNum, uint32_t bitValue );
+uint32_t GPIO_IntMaskedStatus( uint32_t portNum );
+void GPIO_IntClearMask( uint32_t portNum, uint32_t mask );
 void GPIO_Init( void );
 
 /**
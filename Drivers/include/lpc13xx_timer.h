@@ -27,7 +27,7 @@
 
 /* Includes ------------------------------------------------------------------- */
 #include "LPC13xx.h"
-#include "LPC_types.h"
+#include "lpc_types.h"
 
 
 /* Private Macros ------------------------------------------------------------- */
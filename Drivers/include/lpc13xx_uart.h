@@ -73,10 +73,22 @@
 #define UART_ACR_ABTOINT_CLR		((uint32_t)(1<<9))	/**< UART Auto-baud time-out interrupt clear */
 #define UART_ACR_BITMASK			((uint32_t)(0x307))	/**< UART Auto Baudrate register bit mask */
 
-#define BUFSIZE		0x40
 #define UART_TX_FIFO_SIZE		(16)
 #define UART_BLOCKING_TIMEOUT			(0xFFFFFFFFUL)
 
+/* Ring buffers between the UART interrupt and the main loop, sizes must be
+ * powers of two. TX is sent from the THRE interrupt, RX is filled by the RDA
+ * and CTI interrupts. */
+#ifndef UART_TX_RING_SIZE
+#define UART_TX_RING_SIZE		(256)
+#endif
+#ifndef UART_RX_RING_SIZE
+#define UART_RX_RING_SIZE		(32)
+#endif
+#if (UART_TX_RING_SIZE & (UART_TX_RING_SIZE - 1)) || (UART_RX_RING_SIZE & (UART_RX_RING_SIZE - 1))
+#error "UART ring sizes must be powers of two"
+#endif
+
 
 /*-------------------------Type definition--------------------------------*/
 typedef enum {
@@ -142,6 +154,15 @@ typedef enum {
 	UART_AB_MODE1		/** Autobaud mode 1 */
 }UART_AB_MODE_Type;
 
+typedef struct {
+	uint32_t rx_bytes;			/* Bytes put in RX ring */
+	uint32_t rx_overruns;		/* Bytes lost, RX ring full */
+	uint32_t rx_fifo_overruns;	/* Bytes lost, RX FIFO overrun (LSR OE) */
+	uint32_t rx_errors;			/* Bytes dropped for parity, framing error or break */
+	uint32_t tx_bytes;			/* Bytes moved from TX ring to the FIFO */
+	uint32_t tx_dropped;		/* Bytes not queued, TX ring full */
+} UART_STATS_Type;
+
 /*-------------------------Function definition--------------------------------*/
 void UART_Init(void);
 void UART_DeInit(void);
@@ -162,6 +183,13 @@ void UART_ABDisable(void);
 
 uint32_t UART_Send(uint8_t *txbuf, uint32_t buflen, TRANSFER_BLOCK_Type flag);
 uint32_t UART_Receive(uint8_t *rxbuf, uint32_t buflen, TRANSFER_BLOCK_Type flag);
+uint32_t UART_TxFree(void);
+uint32_t UART_TxSpan(uint8_t **span);
+void UART_TxCommit(uint32_t len);
+uint32_t UART_RxCount(void);
+uint32_t UART_RxSpan(const uint8_t **span);
+void UART_RxRelease(uint32_t len);
+void UART_GetStats(UART_STATS_Type *stats);
 
 void UART_IRQHandler(void);
 
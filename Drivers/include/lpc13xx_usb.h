@@ -0,0 +1,107 @@
+/***********************************************************************//**
+ * @file	: lpc13xx_usb.h
+ * @brief	: Contains all macro definitions and function prototypes
+ * 				support for USB Device Controller firmware library on LPC13xx
+ * @version	: 1.0
+ * @date	: 16. Oct. 2026
+ * @author	: Embedded Laboratory
+ **************************************************************************
+ * Endpoint layer only: clocks, pins, the Serial Interface Engine commands
+ * and the endpoint buffers. Requests are handled by the USB device layer,
+ * which implements the USB_xxx_Event() functions called from
+ * USB_IRQHandler(). The Host Build replaces this driver with a stub.
+ **************************************************************************/
+
+/* Peripheral group ----------------------------------------------------------- */
+/** @defgroup USB
+ * @ingroup LPC1300CMSIS_FwLib_Drivers
+ * @{
+ */
+
+#ifndef LPC13XX_USB_H_
+#define LPC13XX_USB_H_
+
+/* Includes ------------------------------------------------------------------- */
+#include "lpc_types.h"
+
+/*-------------------------Macro definition--------------------------------*/
+/* Macro defines for USB Device Interrupt Status register */
+#define USB_INT_FRAME		((uint32_t)(1<<0))		/*!< Frame interrupt, every 1 ms */
+#define USB_INT_EP(n)		((uint32_t)(1<<((n)+1)))	/*!< Physical endpoint n interrupt */
+#define USB_INT_EP_ALL		((uint32_t)(0xFF<<1))	/*!< All physical endpoint interrupts */
+#define USB_INT_DEV_STAT	((uint32_t)(1<<9))		/*!< Device status changed */
+#define USB_INT_CC_EMPTY	((uint32_t)(1<<10))		/*!< Command code register empty */
+#define USB_INT_CD_FULL		((uint32_t)(1<<11))		/*!< Command data register full */
+
+/* Macro defines for USB Receive Packet Length register */
+#define USB_PKT_LNGTH_MASK	((uint32_t)(0x3FF))		/*!< Packet length */
+#define USB_PKT_DV			((uint32_t)(1<<10))		/*!< Data valid */
+#define USB_PKT_RDY			((uint32_t)(1<<11))		/*!< Packet length is ready */
+
+/* Macro defines for USB Control register */
+#define USB_CTRL_RD_EN		((uint32_t)(1<<0))		/*!< Read mode enable */
+#define USB_CTRL_WR_EN		((uint32_t)(1<<1))		/*!< Write mode enable */
+#define USB_CTRL_LOG_EP(n)	((uint32_t)((n)<<2))	/*!< Logical endpoint number */
+
+/* SIE command phases, written to the USB Command Code register */
+#define USB_CMD_PHASE_WRITE	((uint32_t)(0x01<<8))	/*!< Write data byte */
+#define USB_CMD_PHASE_READ	((uint32_t)(0x02<<8))	/*!< Read data byte */
+#define USB_CMD_PHASE_CMD	((uint32_t)(0x05<<8))	/*!< Command */
+#define USB_CMD(c)			((uint32_t)(((c)<<16) | USB_CMD_PHASE_CMD))
+#define USB_CMD_RD(c)		((uint32_t)(((c)<<16) | USB_CMD_PHASE_READ))
+#define USB_CMD_WR(d)		((uint32_t)(((d)<<16) | USB_CMD_PHASE_WRITE))
+
+/* SIE command codes */
+#define USB_SIE_SET_ADDR	0xD0	/*!< Set address */
+#define USB_SIE_CFG_DEV		0xD8	/*!< Configure device */
+#define USB_SIE_SET_MODE	0xF3	/*!< Set mode */
+#define USB_SIE_DEV_STAT	0xFE	/*!< Set/Get device status */
+#define USB_SIE_SEL_EP(n)	(0x00+(n))	/*!< Select physical endpoint n */
+#define USB_SIE_SEL_EP_CLRI(n)	(0x40+(n))	/*!< Select endpoint n, clear interrupt */
+#define USB_SIE_SET_EP_STAT(n)	(0x40+(n))	/*!< Set status of endpoint n */
+#define USB_SIE_CLR_BUF		0xF2	/*!< Clear buffer of selected endpoint */
+#define USB_SIE_VALID_BUF	0xFA	/*!< Validate buffer of selected endpoint */
+
+/* SIE data bits */
+#define USB_DEV_EN			((uint8_t)(1<<7))	/*!< Set address: device enable */
+#define USB_CONF_DEVICE		((uint8_t)(1<<0))	/*!< Configure device: configured */
+#define USB_DEV_CON			((uint8_t)(1<<0))	/*!< Device status: connected */
+#define USB_DEV_CON_CH		((uint8_t)(1<<1))	/*!< Device status: connect changed */
+#define USB_DEV_SUS			((uint8_t)(1<<2))	/*!< Device status: suspended */
+#define USB_DEV_SUS_CH		((uint8_t)(1<<3))	/*!< Device status: suspend changed */
+#define USB_DEV_RST			((uint8_t)(1<<4))	/*!< Device status: bus reset */
+#define USB_EP_SEL_STP		((uint8_t)(1<<2))	/*!< Select endpoint: setup packet */
+#define USB_EP_STAT_ST		((uint8_t)(1<<0))	/*!< Endpoint status: stalled */
+
+/* Endpoints */
+#define USB_LOGIC_EPS		4		/*!< Logical endpoints 0-3 */
+#define USB_PHY_EPS			8		/*!< Physical endpoints, OUT and IN of each */
+#define USB_EP_DIR_IN		0x80	/*!< IN bit of endpoint address */
+#define USB_EP0_MAXPACKET	64		/*!< Control endpoint packet size */
+
+/* Endpoint events given to USB_EP_Event() */
+#define USB_EVT_SETUP		1		/*!< Setup packet received on EP0 OUT */
+#define USB_EVT_OUT			2		/*!< OUT packet received */
+#define USB_EVT_IN			3		/*!< IN packet sent */
+
+/*-------------------------Function definition--------------------------------*/
+void USB_Init(void);
+void USB_Connect(FunctionalState NewState);
+void USB_SetAddress(uint8_t addr);
+void USB_Configure(FunctionalState NewState);
+void USB_SetStallEP(uint8_t EPNum, FunctionalState NewState);
+uint32_t USB_ReadEP(uint8_t EPNum, uint8_t *pData);
+uint32_t USB_WriteEP(uint8_t EPNum, const uint8_t *pData, uint32_t cnt);
+
+void USB_IRQHandler(void);
+
+/* Implemented by the USB device layer, called from USB_IRQHandler() */
+void USB_Reset_Event(void);
+void USB_Suspend_Event(FunctionalState NewState);
+void USB_EP_Event(uint8_t EPNum, uint8_t event);
+
+#endif /* LPC13XX_USB_H_ */
+
+/**
+ * @}
+ */
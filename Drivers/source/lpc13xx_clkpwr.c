@@ -160,6 +160,10 @@ void PMU_Sleep( uint32_t SleepMode, uint32_t SleepCtrl )
   {
 	SCB->SCR |= PMU_LP_SLEEPDEEP;
   }
+  else
+  {
+	SCB->SCR &= ~PMU_LP_SLEEPDEEP;
+  }
   __WFI();
   return;
 }
@@ -113,14 +113,16 @@ void GPIO_SetDir(uint8_t portNum, uint32_t bitValue, uint8_t dir)
  * @param[in]	portNum		Port number value, should be in range from 0 to 3
  * @param[in]	bitValue	Value that contains all bits on GPIO to set,
  * 							in range from 0 to 11.
+ * @note		The bit is written through the masked access address, the
+ * 				other pins of the port are not touched, so an interrupt
+ * 				writing the same port in between is not undone.
  **********************************************************************/
 void GPIO_SetValue(uint8_t portNum, uint32_t bitValue)
 {
 	LPC_GPIO_TypeDef *pGPIO = GPIO_GetPointer(portNum);
 
 	if (pGPIO != NULL) {
-		pGPIO->DATA |= (0x1<<bitValue);
-
+		pGPIO->MASKED_ACCESS[(0x1<<bitValue)] = (0x1<<bitValue);
 	}
 }
 /*********************************************************************//**
@@ -128,13 +130,15 @@ void GPIO_SetValue(uint8_t portNum, uint32_t bitValue)
  * @param[in]	portNum		Port number value, should be in range from 0 to 3
  * @param[in]	bitValue	Value that contains all bits on GPIO to clear,
  * 							in range from 0 to 11.
+ * @note		Written through the masked access address like
+ * 				GPIO_SetValue().
  **********************************************************************/
 void GPIO_ClearValue(uint8_t portNum, uint32_t bitValue)
 {
 	LPC_GPIO_TypeDef *pGPIO = GPIO_GetPointer(portNum);
 
 	if (pGPIO != NULL) {
-		pGPIO->DATA &= ~(0x1<<bitValue);
+		pGPIO->MASKED_ACCESS[(0x1<<bitValue)] = 0;
 	}
 }
 
@@ -365,6 +369,38 @@ void GPIO_IntClear( uint32_t portNum, uint32_t bitValue )
   return;
 }
 
+/*****************************************************************************
+ * @brief		Get masked interrupt status of all pins of a GPIO port
+ * @param[in]	portNum		Port number value, should be in range from 0 to 3
+ *
+ * @return	 	MIS register, one bit per pin with a pending interrupt
+*****************************************************************************/
+uint32_t GPIO_IntMaskedStatus( uint32_t portNum )
+{
+	LPC_GPIO_TypeDef *pGPIO = GPIO_GetPointer((uint8_t)portNum);
+	uint32_t regVal = 0;
+
+	if (pGPIO != NULL) {
+		regVal = pGPIO->MIS;
+	}
+	return ( regVal );
+}
+
+/*****************************************************************************
+ * @brief		Clear interrupts of several pins of a GPIO port
+ * @param[in]	portNum		Port number value, should be in range from 0 to 3
+ * @param[in]	mask		Pins to clear, one bit per pin, usually the value
+ * 							returned by GPIO_IntMaskedStatus().
+*****************************************************************************/
+void GPIO_IntClearMask( uint32_t portNum, uint32_t mask )
+{
+	LPC_GPIO_TypeDef *pGPIO = GPIO_GetPointer((uint8_t)portNum);
+
+	if (pGPIO != NULL) {
+		pGPIO->IC = mask;
+	}
+}
+
 /**
  * @}
  */
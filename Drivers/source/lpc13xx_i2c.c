@@ -19,6 +19,7 @@
 
 #include "lpc13xx_i2c.h"
 #include "lpc13xx_gpio.h"
+#include "isr_profile.h"
 
 
 /* If this source file built with example, the LPC13xx FW library configuration
@@ -1236,7 +1237,9 @@ uint8_t I2C_MonitorGetDatabuffer(LPC_I2C_TypeDef *i2c)
  **********************************************************************/
 void I2C_StdIntHandler(void)
 {
+	ISR_PROFILE_ENTER(ISR_PROFILE_I2C);
 	i2cdat.inthandler(LPC_I2C);
+	ISR_PROFILE_EXIT(ISR_PROFILE_I2C);
 }
 
 
@@ -18,6 +18,7 @@
  **********************************************************************/
 
 #include "lpc13xx_ssp.h"
+#include "isr_profile.h"
 //#include "lpc13xx_clkpwr.h"
 
 
@@ -731,8 +732,10 @@ void SSP_ClearIntPending(LPC_SSP_TypeDef *ssp_dev, uint32_t IntType)
  */
 void SSP_StdIntHandler(void)
 {
+	ISR_PROFILE_ENTER(ISR_PROFILE_SSP);
 	// Call relevant handler
 	sspdat.inthandler(LPC_SSP0);
+	ISR_PROFILE_EXIT(ISR_PROFILE_SSP);
 }
 
 
@@ -94,7 +94,7 @@ FlagStatus TIM_GetIntCaptureStatus(LPC_TMR_TypeDef *TIMx, uint8_t IntFlag)
  **********************************************************************/
 void TIM_ClearIntPending(LPC_TMR_TypeDef *TIMx, uint8_t IntFlag)
 {
-	TIMx->IR |= TIM_IR_CLR(IntFlag);
+	TIMx->IR = TIM_IR_CLR(IntFlag);
 }
 
 /*********************************************************************//**
@@ -105,7 +105,7 @@ void TIM_ClearIntPending(LPC_TMR_TypeDef *TIMx, uint8_t IntFlag)
  **********************************************************************/
 void TIM_ClearIntCapturePending(LPC_TMR_TypeDef *TIMx, uint8_t IntFlag)
 {
-	TIMx->IR |= (1<<(4+IntFlag));
+	TIMx->IR = (1<<(4+IntFlag));
 }
 
 /*********************************************************************//**
@@ -8,76 +8,120 @@
  *     constants for the LPC13xx chip family component: UART
  *
 ******************************************************************************/
+#include <string.h>
 #include "LPC13xx.h"
 #include "lpc13xx_uart.h"
+#include "isr_profile.h"
+#include "events.h"
+
+#define UART_TX_RING_MASK	(UART_TX_RING_SIZE - 1)
+#define UART_RX_RING_MASK	(UART_RX_RING_SIZE - 1)
 
 volatile uint32_t UARTStatus;
 volatile uint8_t  UARTTxEmpty = 1;
-volatile uint8_t  UARTBuffer[BUFSIZE];
-volatile uint32_t UARTCount = 0;
 volatile FlagStatus Synchronous;
 
+/* Ring counters run freely, head is only written by the producer and tail by
+ * the consumer, so the rings need no interrupt masking */
+static uint8_t UARTTxRing[UART_TX_RING_SIZE];
+static volatile uint32_t UARTTxHead, UARTTxTail;
+static uint8_t UARTRxRing[UART_RX_RING_SIZE];
+static volatile uint32_t UARTRxHead, UARTRxTail;
+static UART_STATS_Type UARTStats;
+
 /*********************************************************************//**
- * @brief		UART IRQ Handler
+ * @brief		Move received bytes from the RX FIFO to the RX ring
  * @param[in]	None
  * @return		None
+ *
+ * Note: bytes with parity or framing errors are dropped, LSR is read once
+ * per byte as reading it clears the error bits.
  **********************************************************************/
-void UART_IRQHandler(void)
+static void UART_RxFill(void)
 {
-	uint32_t IIRValue, LSRValue;
-	uint8_t Dummy = Dummy;
-	IIRValue = LPC_UART->IIR;
+	uint32_t LSRValue, head = UARTRxHead;
+	uint8_t data;
 
-	if ((IIRValue & 0x0F) == UART_IIR_INTID_RLS)		/* Receive Line Status */
+	LSRValue = LPC_UART->LSR;
+	while (LSRValue & UART_LSR_RDR)
+	{
+		data = LPC_UART->RBR;
+		if (LSRValue & UART_LSR_OE)
 		{
-		LSRValue = LPC_UART->LSR;
-		/* Receive Line Status */
-		if (LSRValue & (UART_LSR_OE | UART_LSR_PE | UART_LSR_FE | UART_LSR_RXFE | UART_LSR_BI))
+			UARTStats.rx_fifo_overruns++;
+		}
+		if (LSRValue & (UART_LSR_PE | UART_LSR_FE | UART_LSR_BI))
 		{
-			/* There are errors or break interrupt */
-			/* Read LSR will clear the interrupt */
 			UARTStatus = LSRValue;
-			Dummy = LPC_UART->RBR;		/* Dummy read on RX to clear
-							interrupt, then bail out */
-			return;
+			UARTStats.rx_errors++;
 		}
-		if (LSRValue & UART_LSR_RDR)	/* Receive Data Ready */
+		else if ((head - UARTRxTail) < UART_RX_RING_SIZE)
 		{
-			/* If no error on RLS, normal ready, save into the data buffer. */
-			/* Note: read RBR will clear the interrupt */
-			UARTBuffer[UARTCount++] = LPC_UART->RBR;
-			if (UARTCount == BUFSIZE)
-			{
-				UARTCount = 0;		/* buffer overflow */
-			}
+			UARTRxRing[head & UART_RX_RING_MASK] = data;
+			head++;
+			UARTStats.rx_bytes++;
 		}
-	}
-	else if ((IIRValue & 0x0F) == UART_IIR_INTID_RDA)	/* Receive Data Available */
-	{
-		/* Receive Data Available */
-		UARTBuffer[UARTCount++] = LPC_UART->RBR;
-		if (UARTCount == BUFSIZE)
+		else
 		{
-			UARTCount = 0;		/* buffer overflow */
+			UARTStats.rx_overruns++;	/* ring full */
 		}
+		LSRValue = LPC_UART->LSR;
 	}
-	else if ((IIRValue & 0x0F) == UART_IIR_INTID_CTI)	/* Character timeout indicator */
+	if (head != UARTRxHead)
 	{
-		/* Character Time-out indicator */
-		UARTStatus |= 0x100;		/* Bit 9 as the CTI error */
+		/* Publish the bytes only after they are written in the ring */
+		__DMB();
+		UARTRxHead = head;
+		Event_Post(EVENT_UART_RX);
+	}
+}
+
+/*********************************************************************//**
+ * @brief		Move bytes from the TX ring to the empty TX FIFO
+ * @param[in]	None
+ * @return		None
+ *
+ * Note: called from the THRE interrupt, or with the UART interrupt disabled
+ * when the transmitter is idle (UARTTxEmpty).
+ **********************************************************************/
+static void UART_TxFill(void)
+{
+	uint32_t tail = UARTTxTail, fifo_cnt = UART_TX_FIFO_SIZE;
+
+	while (fifo_cnt && (tail != UARTTxHead))
+	{
+		LPC_UART->THR = UARTTxRing[tail & UART_TX_RING_MASK];
+		tail++;
+		fifo_cnt--;
+	}
+	UARTStats.tx_bytes += UART_TX_FIFO_SIZE - fifo_cnt;
+	UARTTxTail = tail;
+	/* Nothing written, no THRE interrupt will follow */
+	UARTTxEmpty = (fifo_cnt == UART_TX_FIFO_SIZE);
+}
+
+/*********************************************************************//**
+ * @brief		UART IRQ Handler
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+void UART_IRQHandler(void)
+{
+	uint32_t IIRValue;
+	ISR_PROFILE_ENTER(ISR_PROFILE_UART);
+	IIRValue = LPC_UART->IIR;
+
+	if (((IIRValue & 0x0F) == UART_IIR_INTID_RLS) ||	/* Receive Line Status */
+		((IIRValue & 0x0F) == UART_IIR_INTID_RDA) ||	/* Receive Data Available */
+		((IIRValue & 0x0F) == UART_IIR_INTID_CTI))		/* Character timeout indicator */
+	{
+		/* Reading LSR clears RLS, reading RBR clears RDA and CTI */
+		UART_RxFill();
 	}
 	else if ((IIRValue & 0x0F) == UART_IIR_INTID_THRE)	/* THRE, transmit holding register empty */
 	{
-		/* THRE interrupt */
-		LSRValue = LPC_UART->LSR;		/* Check status in the LSR to see if valid data in U0THR or not */
-		if (LSRValue & UART_LSR_THRE)
-		{
-			UARTTxEmpty = 1;
-		}
-		else
-		{
-			UARTTxEmpty = 0;
-		}
+		/* Reading IIR cleared the interrupt, refill the FIFO */
+		UART_TxFill();
 	}
 	if ((IIRValue >> 8)& 0x01) /* End of Auto baud */
 	{
@@ -92,6 +136,7 @@ void UART_IRQHandler(void)
 		//clear bit ABTOInt in the U0IIR by set ABTOIntClr in the U0ACR register
 		LPC_UART->ACR |=(1<<9);
 	}
+	ISR_PROFILE_EXIT(ISR_PROFILE_UART);
 }
 
 /*********************************************************************//**
@@ -244,6 +289,13 @@ void UART_Init(void)
 
 	LPC_UART->FCR = 0x07;		/* Enable and reset TX and RX FIFO. */
 
+	/* Empty rings, TX and RX are interrupt driven */
+	UARTTxHead = UARTTxTail = 0;
+	UARTRxHead = UARTRxTail = 0;
+	UARTTxEmpty = 1;
+	memset(&UARTStats, 0, sizeof(UARTStats));
+	LPC_UART->IER = UART_IER_RBRINT_EN | UART_IER_THREINT_EN | UART_IER_RLSINT_EN;
+	NVIC_EnableIRQ(UART_IRQn);
 }
 
 /*********************************************************************//**
@@ -431,6 +483,119 @@ void UART_ABDisable(void)
 	LPC_UART->ACR = 0x00;
 }
 
+/*********************************************************************//**
+ * @brief		Free space in the TX ring
+ * @param[in]	None
+ * @return		Number of bytes which can be queued
+ **********************************************************************/
+uint32_t UART_TxFree(void)
+{
+	return UART_TX_RING_SIZE - (UARTTxHead - UARTTxTail);
+}
+
+/*********************************************************************//**
+ * @brief		Contiguous free region of the TX ring
+ *
+ * @param[out]	span 	Start of the region
+ * @return 		Size of the region, 0 if the ring is full
+ *
+ * Note: the caller writes up to the returned size of bytes at span and
+ * queues them with UART_TxCommit(). At the end of the ring the region is
+ * shorter than UART_TxFree(), a second span starts at the beginning.
+ **********************************************************************/
+uint32_t UART_TxSpan(uint8_t **span)
+{
+	uint32_t head = UARTTxHead;
+	uint32_t len = UART_TX_RING_SIZE - (head - UARTTxTail);
+
+	if (len > UART_TX_RING_SIZE - (head & UART_TX_RING_MASK))
+	{
+		len = UART_TX_RING_SIZE - (head & UART_TX_RING_MASK);
+	}
+	*span = &UARTTxRing[head & UART_TX_RING_MASK];
+	return len;
+}
+
+/*********************************************************************//**
+ * @brief		Queue bytes written to the span of UART_TxSpan()
+ *
+ * @param[in]	len 	Number of bytes written, at most the span size
+ * @return 		None
+ *
+ * Note: starts the transmitter if it is idle, the THRE interrupt sends the
+ * rest.
+ **********************************************************************/
+void UART_TxCommit(uint32_t len)
+{
+	/* Publish the bytes only after they are written in the ring */
+	__DMB();
+	UARTTxHead += len;
+	NVIC_DisableIRQ(UART_IRQn);
+	if (UARTTxEmpty)
+	{
+		UART_TxFill();
+	}
+	NVIC_EnableIRQ(UART_IRQn);
+}
+
+/*********************************************************************//**
+ * @brief		Number of bytes in the RX ring
+ * @param[in]	None
+ * @return		Number of received bytes not yet released
+ **********************************************************************/
+uint32_t UART_RxCount(void)
+{
+	return UARTRxHead - UARTRxTail;
+}
+
+/*********************************************************************//**
+ * @brief		Contiguous received region of the RX ring
+ *
+ * @param[out]	span 	Start of the region
+ * @return 		Size of the region, 0 if nothing is received
+ *
+ * Note: bytes stay in the ring until UART_RxRelease(), at the end of the
+ * ring the region is shorter than UART_RxCount().
+ **********************************************************************/
+uint32_t UART_RxSpan(const uint8_t **span)
+{
+	uint32_t tail = UARTRxTail;
+	uint32_t len = UARTRxHead - tail;
+
+	if (len > UART_RX_RING_SIZE - (tail & UART_RX_RING_MASK))
+	{
+		len = UART_RX_RING_SIZE - (tail & UART_RX_RING_MASK);
+	}
+	*span = &UARTRxRing[tail & UART_RX_RING_MASK];
+	return len;
+}
+
+/*********************************************************************//**
+ * @brief		Release bytes read from the span of UART_RxSpan()
+ *
+ * @param[in]	len 	Number of bytes read, at most the span size
+ * @return 		None
+ **********************************************************************/
+void UART_RxRelease(uint32_t len)
+{
+	/* Bytes are read before the interrupt may overwrite them */
+	__DMB();
+	UARTRxTail += len;
+}
+
+/*********************************************************************//**
+ * @brief		Ring statistics
+ *
+ * @param[out]	stats 	Counters since UART_Init()
+ * @return 		None
+ **********************************************************************/
+void UART_GetStats(UART_STATS_Type *stats)
+{
+	NVIC_DisableIRQ(UART_IRQn);
+	*stats = UARTStats;
+	NVIC_EnableIRQ(UART_IRQn);
+}
+
 /*********************************************************************//**
  * @brief		Send a block of data via UART peripheral
  *
@@ -438,55 +603,37 @@ void UART_ABDisable(void)
  * @param[in]	buflen 	Length of Transmit buffer
  * @param[in] 	flag 	Flag used in  UART transfer, should be
  * 						NONE_BLOCKING or BLOCKING
- * @return 		Number of bytes sent.
+ * @return 		Number of bytes queued.
  *
- * Note: when using UART in BLOCKING mode, a time-out condition is used
- * via defined symbol UART_BLOCKING_TIMEOUT.
+ * Note: data is copied to the TX ring and sent by the THRE interrupt. In
+ * NONE_BLOCKING mode bytes which don't fit in the ring are dropped and
+ * counted in tx_dropped, in BLOCKING mode it waits for room in the ring, so
+ * it must not be called with interrupts disabled.
  **********************************************************************/
 uint32_t UART_Send(uint8_t *txbuf, uint32_t buflen, TRANSFER_BLOCK_Type flag)
 {
-	uint32_t bToSend, bSent, timeOut, fifo_cnt;
-	uint8_t *pChar = txbuf;
-
-	bToSend = buflen;
-
-	// blocking mode
-	if (flag == BLOCKING) {
-		bSent = 0;
-		while (bToSend){
-			timeOut = UART_BLOCKING_TIMEOUT;
-			// Wait for THR empty with timeout
-			while (!(LPC_UART->LSR & (1<<5))) {
-				if (timeOut == 0) break;
-				timeOut--;
-			}
-			// Time out!
-			if(timeOut == 0) break;
-			fifo_cnt = UART_TX_FIFO_SIZE;
-			while (fifo_cnt && bToSend){
-				LPC_UART->THR = (*pChar++);
-				fifo_cnt--;
-				bToSend--;
-				bSent++;
-			}
+	uint32_t bSent = 0, len;
+	uint8_t *span;
+
+	while (bSent < buflen)
+	{
+		len = UART_TxSpan(&span);
+		if (len == 0)
+		{
+			if (flag == NONE_BLOCKING) break;
+			/* The THRE interrupt makes room */
+			__WFI();
+			continue;
 		}
-	}
-	// None blocking mode
-	else {
-		bSent = 0;
-		while (bToSend) {
-			if (!(LPC_UART->LSR & (1<<5))){
-				break;
-			}
-			fifo_cnt = UART_TX_FIFO_SIZE;
-			while (fifo_cnt && bToSend) {
-				LPC_UART->THR = (*pChar++);
-				bToSend--;
-				fifo_cnt--;
-				bSent++;
-			}
+		if (len > buflen - bSent)
+		{
+			len = buflen - bSent;
 		}
+		memcpy(span, &txbuf[bSent], len);
+		UART_TxCommit(len);
+		bSent += len;
 	}
+	UARTStats.tx_dropped += buflen - bSent;
 	return bSent;
 }
 
@@ -499,45 +646,30 @@ uint32_t UART_Send(uint8_t *txbuf, uint32_t buflen, TRANSFER_BLOCK_Type flag)
 
  * @return 		Number of bytes received
  *
- * Note: when using UART in BLOCKING mode, a time-out condition is used
- * via defined symbol UART_BLOCKING_TIMEOUT.
+ * Note: bytes are taken from the RX ring. When using UART in BLOCKING mode,
+ * a time-out condition is used via defined symbol UART_BLOCKING_TIMEOUT.
  **********************************************************************/
 uint32_t UART_Receive(uint8_t *rxbuf, uint32_t buflen, TRANSFER_BLOCK_Type flag)
 {
-	uint32_t bToRecv, bRecv, timeOut;
-	uint8_t *pChar = rxbuf;
-
-	bToRecv = buflen;
-
-	// Blocking mode
-	if (flag == BLOCKING) {
-		bRecv = 0;
-		while (bToRecv){
-			timeOut = UART_BLOCKING_TIMEOUT;
-			while (!(LPC_UART->LSR & 0x01)){ //check bit RDR
-				if (timeOut == 0) break;
-				timeOut--;
-			}
-			// Time out!
-			if(timeOut == 0) break;
-			// Get data from the buffer
-			(*pChar++) = LPC_UART->RBR ;
-			bToRecv--;
-			bRecv++;
+	uint32_t bRecv = 0, len, timeOut = UART_BLOCKING_TIMEOUT;
+	const uint8_t *span;
+
+	while (bRecv < buflen)
+	{
+		len = UART_RxSpan(&span);
+		if (len == 0)
+		{
+			if ((flag == NONE_BLOCKING) || (timeOut == 0)) break;
+			timeOut--;
+			continue;
 		}
-	}
-	// None blocking mode
-	else {
-		bRecv = 0;
-		while (bToRecv) {
-			if (!(LPC_UART->LSR & 0x01)) {
-				break;
-			} else {
-				(*pChar++) = LPC_UART->RBR;
-				bRecv++;
-				bToRecv--;
-			}
+		if (len > buflen - bRecv)
+		{
+			len = buflen - bRecv;
 		}
+		memcpy(&rxbuf[bRecv], span, len);
+		UART_RxRelease(len);
+		bRecv += len;
 	}
 	return bRecv;
 }
@@ -0,0 +1,297 @@
+/*****************************************************************************
+ * $Id: lpc13xx_usb.c $
+ *
+ * Project: LPC13xx USB Device Controller driver
+ *
+ * Description:
+ *     Endpoint layer of the USB Device Controller: SIE commands, endpoint
+ *     buffers and the interrupt handler. Standard and class requests are
+ *     handled by the USB device layer through the USB_xxx_Event() functions.
+ *
+******************************************************************************/
+#include "LPC13xx.h"
+#include "lpc13xx_usb.h"
+#include "isr_profile.h"
+
+static void USB_WrCmd(uint32_t cmd);
+static void USB_WrCmdDat(uint32_t cmd, uint32_t val);
+static uint32_t USB_RdCmdDat(uint32_t cmd, uint32_t dat);
+static void USB_Reset(void);
+
+/*********************************************************************//**
+ * @brief		Physical endpoint of an endpoint address
+ * @param[in]	EPNum: Endpoint address, bit 7 set for IN endpoints
+ * @return		Physical endpoint, OUT is even and IN is odd
+ **********************************************************************/
+static uint32_t USB_EPAdr(uint8_t EPNum)
+{
+	uint32_t val;
+	val = (EPNum & 0x0F) << 1;
+	if (EPNum & USB_EP_DIR_IN)
+	{
+		val += 1;
+	}
+	return (val);
+}
+
+/*********************************************************************//**
+ * @brief		Write a SIE command phase and wait until it is taken
+ * @param[in]	cmd: Command phase, see USB_CMD() and USB_CMD_WR()
+ * @return		None
+ **********************************************************************/
+static void USB_WrCmd(uint32_t cmd)
+{
+	LPC_USB->DevIntClr = USB_INT_CC_EMPTY;
+	LPC_USB->CmdCode = cmd;
+	while ((LPC_USB->DevIntSt & USB_INT_CC_EMPTY) == 0);
+}
+
+/*********************************************************************//**
+ * @brief		Write a SIE command with one data byte
+ * @param[in]	cmd: Command code
+ * @param[in]	val: Data byte
+ * @return		None
+ **********************************************************************/
+static void USB_WrCmdDat(uint32_t cmd, uint32_t val)
+{
+	USB_WrCmd(USB_CMD(cmd));
+	USB_WrCmd(USB_CMD_WR(val));
+}
+
+/*********************************************************************//**
+ * @brief		Write a SIE command and read its data byte
+ * @param[in]	cmd: Command code
+ * @param[in]	dat: Command code of the read phase, same as cmd
+ * @return		Data byte
+ **********************************************************************/
+static uint32_t USB_RdCmdDat(uint32_t cmd, uint32_t dat)
+{
+	USB_WrCmd(USB_CMD(cmd));
+	LPC_USB->DevIntClr = USB_INT_CC_EMPTY | USB_INT_CD_FULL;
+	LPC_USB->CmdCode = USB_CMD_RD(dat);
+	while ((LPC_USB->DevIntSt & USB_INT_CD_FULL) == 0);
+	return (LPC_USB->CmdData);
+}
+
+/*********************************************************************//**
+ * @brief		USB Init. Clocks, pins and interrupt of the USB device
+ * 				controller, device is not connected yet
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+void USB_Init(void)
+{
+	/* Enable USB register clock */
+	LPC_SYSCON->SYSAHBCLKCTRL |= (1<<14);
+
+	/* Setup pin select */
+	LPC_IOCON->PIO0_3 &= ~0x1F;
+	LPC_IOCON->PIO0_3 |= (0x01<<3) | 0x01;	/* USB VBUS, pull-down */
+	LPC_IOCON->PIO0_6 &= ~0x07;
+	LPC_IOCON->PIO0_6 |= 0x01;				/* USB SoftConnect */
+
+	/* Power-up USB PHY and USB PLL, 48 MHz from 12 MHz system oscillator */
+	LPC_SYSCON->PDRUNCFG &= ~((1<<10) | (1<<8));
+	LPC_SYSCON->USBPLLCLKSEL = 0x01;
+	LPC_SYSCON->USBPLLCLKUEN = 0x01;
+	LPC_SYSCON->USBPLLCLKUEN = 0x00;
+	LPC_SYSCON->USBPLLCLKUEN = 0x01;
+	while (!(LPC_SYSCON->USBPLLCLKUEN & 0x01));
+	LPC_SYSCON->USBPLLCTRL = 0x23;			/* M = 4, P = 2 */
+	while (!(LPC_SYSCON->USBPLLSTAT & 0x01));
+	LPC_SYSCON->USBCLKSEL = 0x00;			/* USB PLL output */
+	LPC_SYSCON->USBCLKUEN = 0x01;
+	LPC_SYSCON->USBCLKUEN = 0x00;
+	LPC_SYSCON->USBCLKUEN = 0x01;
+	LPC_SYSCON->USBCLKDIV = 0x01;
+
+	USB_Reset();
+	USB_SetAddress(0);
+	NVIC_EnableIRQ(USB_IRQn);
+}
+
+/*********************************************************************//**
+ * @brief		USB Reset. Clear pending interrupts and enable the device
+ * 				status and endpoint interrupts
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+static void USB_Reset(void)
+{
+	LPC_USB->DevIntClr = 0x000FFFFF;
+	LPC_USB->DevIntEn = USB_INT_DEV_STAT | USB_INT_EP_ALL;
+}
+
+/*********************************************************************//**
+ * @brief		Connect or disconnect the SoftConnect pull-up
+ * @param[in]	NewState: ENABLE to connect, DISABLE to disconnect
+ * @return		None
+ **********************************************************************/
+void USB_Connect(FunctionalState NewState)
+{
+	USB_WrCmdDat(USB_SIE_DEV_STAT, (NewState == ENABLE) ? USB_DEV_CON : 0);
+}
+
+/*********************************************************************//**
+ * @brief		Set device address, call it after the status stage of
+ * 				the SET_ADDRESS request
+ * @param[in]	addr: Device address, 0-127
+ * @return		None
+ **********************************************************************/
+void USB_SetAddress(uint8_t addr)
+{
+	USB_WrCmdDat(USB_SIE_SET_ADDR, USB_DEV_EN | (addr & 0x7F));
+}
+
+/*********************************************************************//**
+ * @brief		Configure device, endpoints other than EP0 respond only
+ * 				while the device is configured
+ * @param[in]	NewState: ENABLE when a configuration is selected
+ * @return		None
+ **********************************************************************/
+void USB_Configure(FunctionalState NewState)
+{
+	USB_WrCmdDat(USB_SIE_CFG_DEV, (NewState == ENABLE) ? USB_CONF_DEVICE : 0);
+}
+
+/*********************************************************************//**
+ * @brief		Stall or un-stall an endpoint, a stalled EP0 is cleared
+ * 				by the next setup packet
+ * @param[in]	EPNum: Endpoint address, bit 7 set for IN endpoints
+ * @param[in]	NewState: ENABLE to stall, DISABLE to un-stall
+ * @return		None
+ **********************************************************************/
+void USB_SetStallEP(uint8_t EPNum, FunctionalState NewState)
+{
+	USB_WrCmdDat(USB_SIE_SET_EP_STAT(USB_EPAdr(EPNum)),
+				 (NewState == ENABLE) ? USB_EP_STAT_ST : 0);
+}
+
+/*********************************************************************//**
+ * @brief		Read the received packet of an OUT endpoint and free its
+ * 				buffer
+ * @param[in]	EPNum: Endpoint address
+ * @param[out]	pData: Packet data, up to the endpoint packet size
+ * @return		Number of bytes read
+ **********************************************************************/
+uint32_t USB_ReadEP(uint8_t EPNum, uint8_t *pData)
+{
+	uint32_t cnt, n, word = 0;
+
+	LPC_USB->Ctrl = USB_CTRL_LOG_EP(EPNum & 0x0F) | USB_CTRL_RD_EN;
+	do
+	{
+		cnt = LPC_USB->RxPLen;
+	} while ((cnt & USB_PKT_RDY) == 0);
+	cnt &= USB_PKT_LNGTH_MASK;
+	/* Buffer is read in words, last word is only partly stored */
+	for (n = 0; n < cnt; n++)
+	{
+		if ((n & 3) == 0)
+		{
+			word = LPC_USB->RxData;
+		}
+		pData[n] = (uint8_t)(word >> ((n & 3) * 8));
+	}
+	LPC_USB->Ctrl = 0;
+
+	USB_WrCmd(USB_CMD(USB_SIE_SEL_EP(USB_EPAdr(EPNum))));
+	USB_WrCmd(USB_CMD(USB_SIE_CLR_BUF));
+	return (cnt);
+}
+
+/*********************************************************************//**
+ * @brief		Write a packet to an IN endpoint and validate its buffer
+ * @param[in]	EPNum: Endpoint address, bit 7 set
+ * @param[in]	pData: Packet data
+ * @param[in]	cnt: Number of bytes, up to the endpoint packet size
+ * @return		Number of bytes written
+ **********************************************************************/
+uint32_t USB_WriteEP(uint8_t EPNum, const uint8_t *pData, uint32_t cnt)
+{
+	uint32_t n, word = 0;
+
+	LPC_USB->Ctrl = USB_CTRL_LOG_EP(EPNum & 0x0F) | USB_CTRL_WR_EN;
+	LPC_USB->TxPLen = cnt;
+	for (n = 0; n < cnt; n++)
+	{
+		word |= (uint32_t)pData[n] << ((n & 3) * 8);
+		if ((n & 3) == 3)
+		{
+			LPC_USB->TxData = word;
+			word = 0;
+		}
+	}
+	/* Partial last word */
+	if ((cnt & 3) != 0)
+	{
+		LPC_USB->TxData = word;
+	}
+	LPC_USB->Ctrl = 0;
+
+	USB_WrCmd(USB_CMD(USB_SIE_SEL_EP(USB_EPAdr(EPNum))));
+	USB_WrCmd(USB_CMD(USB_SIE_VALID_BUF));
+	return (cnt);
+}
+
+/*********************************************************************//**
+ * @brief		USB IRQ Handler. Device status changes and endpoint
+ * 				events are given to the USB device layer
+ * @param[in]	None
+ * @return		None
+ **********************************************************************/
+void USB_IRQHandler(void)
+{
+	uint32_t disr, val, n;
+	uint8_t reset = 0;
+	ISR_PROFILE_ENTER(ISR_PROFILE_USB);
+	disr = LPC_USB->DevIntSt;
+	LPC_USB->DevIntClr = disr;
+
+	/* Device Status Interrupt (Reset, Connect change, Suspend/Resume) */
+	if (disr & USB_INT_DEV_STAT)
+	{
+		val = USB_RdCmdDat(USB_SIE_DEV_STAT, USB_SIE_DEV_STAT);
+		if (val & USB_DEV_RST)
+		{
+			USB_Reset();
+			USB_Reset_Event();
+			reset = 1;
+		}
+		else if (val & USB_DEV_SUS_CH)
+		{
+			USB_Suspend_Event((val & USB_DEV_SUS) ? ENABLE : DISABLE);
+		}
+	}
+	/* Endpoint Interrupts, physical endpoint 0 is EP0 OUT. Endpoint events
+	 * from before a bus reset are stale */
+	if ((disr & USB_INT_EP_ALL) && !reset)
+	{
+		for (n = 0; n < USB_PHY_EPS; n++)
+		{
+			if (disr & USB_INT_EP(n))
+			{
+				val = USB_RdCmdDat(USB_SIE_SEL_EP_CLRI(n), USB_SIE_SEL_EP_CLRI(n));
+				if (n & 1)
+				{
+					USB_EP_Event((uint8_t)((n >> 1) | USB_EP_DIR_IN), USB_EVT_IN);
+				}
+				else if (n == 0 && (val & USB_EP_SEL_STP))
+				{
+					USB_EP_Event(0, USB_EVT_SETUP);
+				}
+				else
+				{
+					USB_EP_Event((uint8_t)(n >> 1), USB_EVT_OUT);
+				}
+			}
+		}
+	}
+	ISR_PROFILE_EXIT(ISR_PROFILE_USB);
+}
+
+/**
+ * @}
+ */
+
+/* --------------------------------- End Of File ------------------------------ */
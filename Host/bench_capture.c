@@ -0,0 +1,124 @@
+/**
+ * @file bench_capture.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, PS2 Timer Capture Receiver.
+ *
+ * Converts a synthetic key stream into timer capture values of both clock
+ * edges and feeds them to PS2_Capture_Edge(). Three streams are checked, a
+ * clean one, one with short noise pulses on the clock line and one where a
+ * clock pulse is lost once in a while.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ps2_capture.h"
+#include "ps2_trace.h"
+#include "host_bench.h"
+
+#define BENCH_KEYS      20000ul   /**< Keys in Synthetic Stream. */
+#define CLOCK_LOW_US    40u       /**< Clock Low Time. */
+#define CLOCK_HIGH_US   40u       /**< Clock High Time. */
+#define GLITCH_EVERY    7u        /**< Insert a Glitch every n bits. */
+#define LOST_EVERY      997u      /**< Lose a Clock Pulse every n bits. */
+
+static const char bench_text[] = "scanner 0123456789 abcdefghijklmnopqrstuvwxyz";
+
+typedef enum { STREAM_CLEAN = 0, STREAM_GLITCH, STREAM_LOST } Stream_e;
+
+/**
+ * @brief Feed the Trace as capture edges.
+ * @return Number of keys decoded correctly.
+ */
+static unsigned long Run_Stream( const PS2_Trace_s *trace, Stream_e type,
+                                 uint64_t *ns, unsigned long *edges )
+{
+  size_t i;
+  u16_t t = 0;
+  u32_t last = 0;
+  u8_t keys[SCAN_CODE_MAX], got, k;
+  unsigned long ok = 0, expect = 0, skip;
+  uint64_t t0 = host_now_ns();
+  for( i = 0; i < trace->count; i++ )
+  {
+    const PS2_Edge_s *e = &trace->edges[i];
+    // Bus idle time between frames
+    if( i && e->time_us - last > 2u * PS2_TRACE_HALF_BIT_US )
+    {
+      t = (u16_t)(t + (e->time_us - last));
+    }
+    last = e->time_us;
+    if( type == STREAM_LOST && (i % LOST_EVERY) == LOST_EVERY - 1u )
+    {
+      t = (u16_t)(t + CLOCK_LOW_US + CLOCK_HIGH_US);
+      continue;
+    }
+    PS2_Capture_Edge(t, 0u, e->data);
+    t = (u16_t)(t + CLOCK_LOW_US);
+    PS2_Capture_Edge(t, 1u, e->data);
+    *edges += 2u;
+    if( type == STREAM_GLITCH && (i % GLITCH_EVERY) == 0u )
+    {
+      // Noise pulse in middle of clock high time, with wrong data
+      PS2_Capture_Edge((u16_t)(t + 15u), 0u, (u8_t)!e->data);
+      PS2_Capture_Edge((u16_t)(t + 18u), 1u, (u8_t)!e->data);
+      *edges += 2u;
+    }
+    t = (u16_t)(t + CLOCK_HIGH_US);
+    if( i + 1u == trace->count ||
+        trace->edges[i+1u].time_us - e->time_us > PS2_TRACE_IDLE_US )
+    {
+      got = PS2_ReadKeys(PS2_PORT_KEYBOARD, keys, SCAN_CODE_MAX);
+      for( k = 0; k < got; k++ )
+      {
+        // Lost frames may drop a key or give a wrong one, so look a few keys
+        // ahead to resynchronize the expectation
+        for( skip = 0; skip < 3u; skip++ )
+        {
+          if( keys[k] == (u8_t)bench_text[(expect + skip) %
+                                          (sizeof(bench_text) - 1u)] )
+          {
+            ok++;
+            expect += skip + 1u;
+            break;
+          }
+        }
+      }
+    }
+  }
+  *ns = host_now_ns() - t0;
+  return ok;
+}
+
+int main( void )
+{
+  static const char *names[] = { "clean", "glitch", "lost" };
+  PS2_Trace_s trace;
+  unsigned long k, ok, edges;
+  uint64_t ns;
+  int type, failed = 0;
+  PS2_Capture_Stats_s before;
+
+  PS2_Trace_Init(&trace);
+  for( k = 0; k < BENCH_KEYS; k++ )
+  {
+    PS2_Trace_Add_Key(&trace, bench_text[k % (sizeof(bench_text) - 1u)]);
+  }
+  for( type = STREAM_CLEAN; type <= STREAM_LOST; type++ )
+  {
+    before = *PS2_Capture_Get_Stats();
+    edges = 0;
+    ok = Run_Stream(&trace, (Stream_e)type, &ns, &edges);
+    printf("%-6s: %lu/%lu keys, %.2f ns/edge, glitches %lu, timing errors %lu\n",
+           names[type], ok, BENCH_KEYS, (double)ns / (double)edges,
+           (unsigned long)(PS2_Capture_Get_Stats()->glitches - before.glitches),
+           (unsigned long)(PS2_Capture_Get_Stats()->timing_errors -
+                           before.timing_errors));
+    // Clean and Noisy streams must be lossless, lost pulses may cost a key
+    if( (type != STREAM_LOST && ok != BENCH_KEYS) ||
+        (type == STREAM_LOST && ok < BENCH_KEYS * 9u / 10u) )
+      failed = 1;
+  }
+  PS2_Trace_Free(&trace);
+  return failed;
+}
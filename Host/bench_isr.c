@@ -0,0 +1,127 @@
+/**
+ * @file bench_isr.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, Interrupt Handler Profiler.
+ *
+ * Built with ISR_PROFILE set to 1. A key stream is replayed through a copy of
+ * PIOINT3_IRQHandler() of main.c while a SysTick handler runs every milli-
+ * second. In the second half every SysTick is preempted by the clock edges of
+ * a whole frame, the cycles of those edges must not be counted for SysTick.
+ * Cycles are Host Time Stamp Counter cycles, not LPC1343 cycles, the profiler
+ * bookkeeping is what is checked here. The dump is written to stdout.
+ */
+
+#include <stdio.h>
+#include "ps2_trace.h"
+#include "isr_profile.h"
+#include "host_bench.h"
+#include "host_gpio.h"
+#include "host_clock.h"
+
+#define BENCH_KEYS      4000u     /**< Keys in Stream. */
+#define SYSTICK_WORK    200u      /**< Loop Iterations of simulated SysTick. */
+
+static const char bench_text[] = "the quick brown fox jumps over the lazy dog";
+
+static PS2_Trace_s trace;
+static size_t edge = 0;
+
+/**
+ * @brief PIOINT3_IRQHandler() of main.c, for the next Edge of the Trace.
+ */
+static void PIOINT3_Handler( void )
+{
+  const PS2_Pins_s *pins = PS2_Get_Pins(PS2_PORT_KEYBOARD);
+  const PS2_Edge_s *e = &trace.edges[edge++];
+  host_time_us = e->time_us;
+  if( e->data )
+    host_gpio_data[pins->data_port] |= (1u << pins->data_pin);
+  else
+    host_gpio_data[pins->data_port] &= ~(1u << pins->data_pin);
+  host_gpio_mis[pins->clk_port] |= (1u << pins->clk_pin);
+  ISR_PROFILE_ENTER(ISR_PROFILE_PIOINT3);
+  PS2_GPIO_IRQHandler(PORT3);
+  ISR_PROFILE_EXIT(ISR_PROFILE_PIOINT3);
+}
+
+/**
+ * @brief Simulated SysTick_Handler(), preempted by a Frame if nested is set.
+ */
+static void SysTick_Handler( boolean nested )
+{
+  u32_t i, frame_end;
+  ISR_PROFILE_ENTER(ISR_PROFILE_SYSTICK);
+  for( i = 0; i < SYSTICK_WORK / 2u; i++ )
+    host_sink(i);
+  if( nested && edge < trace.count )
+  {
+    frame_end = trace.edges[edge].time_us + 1000u;
+    while( edge < trace.count && trace.edges[edge].time_us < frame_end )
+      PIOINT3_Handler();
+  }
+  for( ; i < SYSTICK_WORK; i++ )
+    host_sink(i);
+  ISR_PROFILE_EXIT(ISR_PROFILE_SYSTICK);
+}
+
+int main( void )
+{
+  ISR_Profile_Stats_s tick[2], pio;
+  u32_t next_tick, k, ticks = 0;
+  uint64_t t0, raw = 0;
+  u8_t buf[SCAN_CODE_MAX];
+  unsigned long keys = 0;
+  int phase, failed = 0;
+
+  PS2_Keyboard_Init();
+  ISR_Profile_Init();
+  PS2_Trace_Init(&trace);
+  trace.time_us = 10000u;
+  for( k = 0; k < BENCH_KEYS; k++ )
+  {
+    PS2_Trace_Idle(&trace, 2000u + host_random(3000u));
+    PS2_Trace_Add_Key(&trace, bench_text[k % (sizeof(bench_text) - 1u)]);
+  }
+
+  next_tick = 0;
+  for( phase = 0; phase < 2; phase++ )
+  {
+    ISR_Profile_Reset();
+    while( edge < trace.count && (phase || edge < trace.count / 2u) )
+    {
+      if( trace.edges[edge].time_us >= next_tick )
+      {
+        t0 = host_cycles();
+        SysTick_Handler(phase == 1);
+        raw += phase ? host_cycles() - t0 : 0;
+        next_tick += 1000u;
+        ticks++;
+      }
+      else
+      {
+        PIOINT3_Handler();
+      }
+      keys += PS2_ReadKeys(PS2_PORT_KEYBOARD, buf, SCAN_CODE_MAX);
+    }
+    ISR_Profile_Get(ISR_PROFILE_SYSTICK, &tick[phase]);
+  }
+  ISR_Profile_Get(ISR_PROFILE_PIOINT3, &pio);
+  ISR_Profile_Dump();
+  while( ISR_Profile_Dump_Task() )
+    ;
+
+  // At least half of the frame in the preempted SysTicks must be taken off
+  raw /= tick[1].count ? tick[1].count : 1u;
+  if( keys != BENCH_KEYS || !tick[0].count || !tick[1].count ||
+      tick[1].total_cycles / tick[1].count + 11u * pio.total_cycles /
+      pio.count / 2u > raw )
+    failed = 1;
+  fprintf(stderr, "isr profile : %lu keys, %lu ticks, overhead %lu cycles, "
+          "systick mean %lu alone, %lu preempted (%lu with frame) %s\n",
+          keys, (unsigned long)ticks, (unsigned long)ISR_Profile_Overhead(),
+          (unsigned long)(tick[0].total_cycles / tick[0].count),
+          (unsigned long)(tick[1].total_cycles / tick[1].count),
+          (unsigned long)raw, failed ? "FAIL" : "OK");
+  PS2_Trace_Free(&trace);
+  return failed;
+}
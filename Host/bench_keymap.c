@@ -0,0 +1,242 @@
+/**
+ * @file bench_keymap.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, Scan Code to ASCII translation.
+ *
+ * Compares the translation table indexed by shift state and scan code with
+ * the previous Key_To_Ascii(), which branched on the key code, the E0 prefix
+ * and on Shift/Caps Lock. Both are checked to give the same ASCII value for
+ * every key and state first, then the AltGr Latin-1 layer is checked.
+ * Key_To_Ascii() is private to ps2_keyboard.c, so the source file is included
+ * directly.
+ */
+
+#include <stdio.h>
+#include "../Application/ps2_keyboard.c"
+#include "host_bench.h"
+
+/** Keyboard Port, benchmarks only use this one. */
+static PS2_Port_s *const kbd = &ports[PS2_PORT_KEYBOARD];
+
+#define BENCH_KEYS    4096u     /**< Keys in Random Stream. */
+#define BENCH_ROUNDS  500u      /**< Passes over the Stream. */
+
+/**
+ * @brief Random Key with the Modifier State it is translated in.
+ */
+typedef struct
+{
+  u8_t scan_code;
+  u8_t keycode;
+  boolean extended;
+  u8_t modifiers;
+  u8_t locks;
+} Bench_Key_s;
+
+static Bench_Key_s keys[BENCH_KEYS];
+
+/* Legacy Translation, as it was before the table lookup ------------------ */
+static u8_t Legacy_Key_To_Ascii( u8_t scan_code, u8_t keycode, boolean extended )
+{
+  u8_t key_value = 0;
+  boolean shift = (kbd->parser.modifiers & PS2_MOD_SHIFT) ? TRUE : FALSE;
+  if( (kbd->parser.locks & PS2_EVT_CAPS) )
+  {
+    shift = !shift;
+  }
+  if( keycode >= PS2_KEY_LCTRL || keycode == PS2_KEY_CAPS ||
+      keycode == PS2_KEY_NUM || keycode == PS2_KEY_SCROLL )
+  {
+    key_value = 0;
+  }
+  else if( extended )
+  {
+    key_value = (keycode == PS2_KEY_KP_ENTER) ? ENTER :
+                ( (scan_code == 0x4A) ? '/' : 0 );
+  }
+  else if( scan_code < 128u )
+  {
+    key_value = shift ? PS2_KeyMap[PS2_KEYMAP_SHIFT][scan_code] :
+                        PS2_KeyMap[0][scan_code];
+  }
+  return key_value;
+}
+
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Fill the Key Stream, 1 in 8 keys is extended.
+ */
+static void Make_Keys( void )
+{
+  static const u8_t mods[4] = {0, PS2_MOD_LSHIFT, PS2_MOD_RSHIFT, PS2_MOD_LCTRL};
+  u32_t i = 0;
+  host_seed = 7u;
+  while( i < BENCH_KEYS )
+  {
+    boolean extended = host_random(8u) == 0u;
+    u8_t scan_code = (u8_t)host_random(PS2_SET2_MAX);
+    u8_t keycode = PS2_HidMap[extended][scan_code];
+    if( keycode != PS2_KEY_NONE )
+    {
+      keys[i].scan_code = scan_code;
+      keys[i].keycode = keycode;
+      keys[i].extended = extended;
+      keys[i].modifiers = mods[host_random(4u)];
+      keys[i].locks = host_random(2u) ? PS2_EVT_CAPS : 0;
+      i++;
+    }
+  }
+}
+
+/**
+ * @brief Both translations must agree for every Key and State.
+ * @return Number of mismatches.
+ */
+static u32_t Check_Keys( void )
+{
+  u32_t errors = 0;
+  u32_t state, code, extended;
+  for( state = 0; state < 8u; state++ )
+  {
+    kbd->parser.modifiers = (state & 1u) ? PS2_MOD_LSHIFT : 0;
+    kbd->parser.modifiers |= (state & 2u) ? PS2_MOD_RSHIFT : 0;
+    kbd->parser.locks = (state & 4u) ? PS2_EVT_CAPS : 0;
+    for( extended = 0; extended < 2u; extended++ )
+    {
+      for( code = 0; code < PS2_SET2_MAX; code++ )
+      {
+        u8_t keycode = PS2_HidMap[extended][code];
+        if( keycode != PS2_KEY_NONE &&
+            Legacy_Key_To_Ascii((u8_t)code, keycode, (boolean)extended) !=
+            Key_To_Ascii(kbd, (u8_t)code, (boolean)extended) )
+        {
+          printf("  mismatch: %s%02X state %u\n", extended ? "E0 " : "",
+                 (unsigned)code, (unsigned)state);
+          errors++;
+        }
+      }
+    }
+  }
+  return errors;
+}
+
+/**
+ * @brief AltGr Keys through the Parser.
+ * @return Number of wrong Latin-1 Values.
+ */
+static u32_t Check_AltGr( void )
+{
+  // Scan Code, Modifiers, Locks, expected Latin-1
+  static const u8_t altgr_keys[][4] = {
+    { 0x24, PS2_MOD_RALT, 0, 0xE9 },                          // e acute
+    { 0x24, PS2_MOD_RALT | PS2_MOD_LSHIFT, 0, 0xC9 },         // E acute
+    { 0x24, PS2_MOD_RALT, PS2_EVT_CAPS, 0xC9 },               // Caps Lock
+    { 0x24, PS2_MOD_RALT | PS2_MOD_RSHIFT, PS2_EVT_CAPS, 0xE9 },
+    { 0x55, PS2_MOD_RALT, PS2_EVT_CAPS, 0xD7 },               // not a letter
+    { 0x55, PS2_MOD_RALT | PS2_MOD_LSHIFT, 0, 0xF7 },
+    { 0x1B, PS2_MOD_RALT, PS2_EVT_CAPS, 0xDF },               // sharp s
+    { 0x2E, PS2_MOD_RALT, 0, 0x00 },                          // no AltGr
+    { 0x24, PS2_MOD_LALT, 0, 'e' }                            // Left Alt
+  };
+  PS2_Key_Event_s event;
+  u32_t i, errors = 0;
+  for( i = 0; i < sizeof(altgr_keys) / sizeof(altgr_keys[0]); i++ )
+  {
+    kbd->parser.modifiers = altgr_keys[i][1];
+    kbd->parser.locks = altgr_keys[i][2];
+    if( !PS2_Parse_Byte(PS2_PORT_KEYBOARD, altgr_keys[i][0], &event) ||
+        event.ascii != altgr_keys[i][3] )
+    {
+      printf("  altgr mismatch: %02X -> %02X\n", (unsigned)altgr_keys[i][0],
+             (unsigned)event.ascii);
+      errors++;
+    }
+    PS2_Parse_Byte(PS2_PORT_KEYBOARD, PS2_BREAK, &event);
+    PS2_Parse_Byte(PS2_PORT_KEYBOARD, altgr_keys[i][0], &event);
+  }
+  kbd->parser.modifiers = 0;
+  kbd->parser.locks = 0;
+  return errors;
+}
+
+static double Bench_Legacy( void )
+{
+  u32_t r, i, sum = 0;
+  uint64_t t0 = host_cycles();
+  for( r = 0; r < BENCH_ROUNDS; r++ )
+  {
+    for( i = 0; i < BENCH_KEYS; i++ )
+    {
+      kbd->parser.modifiers = keys[i].modifiers;
+      kbd->parser.locks = keys[i].locks;
+      sum += Legacy_Key_To_Ascii(keys[i].scan_code, keys[i].keycode,
+                                 keys[i].extended);
+    }
+  }
+  host_sink(sum);
+  return (double)(host_cycles() - t0) / ((double)BENCH_ROUNDS * BENCH_KEYS);
+}
+
+static double Bench_Table( void )
+{
+  u32_t r, i, sum = 0;
+  uint64_t t0 = host_cycles();
+  for( r = 0; r < BENCH_ROUNDS; r++ )
+  {
+    for( i = 0; i < BENCH_KEYS; i++ )
+    {
+      kbd->parser.modifiers = keys[i].modifiers;
+      kbd->parser.locks = keys[i].locks;
+      sum += Key_To_Ascii(kbd, keys[i].scan_code, keys[i].extended);
+    }
+  }
+  host_sink(sum);
+  return (double)(host_cycles() - t0) / ((double)BENCH_ROUNDS * BENCH_KEYS);
+}
+
+/**
+ * @brief Whole Parser, make and break of every key in the stream.
+ */
+static double Bench_Parse( void )
+{
+  PS2_Key_Event_s event;
+  u32_t r, i, sum = 0;
+  uint64_t t0 = host_cycles();
+  for( r = 0; r < BENCH_ROUNDS; r++ )
+  {
+    for( i = 0; i < BENCH_KEYS; i++ )
+    {
+      if( keys[i].extended )
+        PS2_Parse_Byte(PS2_PORT_KEYBOARD, PS2_EXTENDED, &event);
+      if( PS2_Parse_Byte(PS2_PORT_KEYBOARD, keys[i].scan_code, &event) )
+        sum += event.ascii;
+      if( keys[i].extended )
+        PS2_Parse_Byte(PS2_PORT_KEYBOARD, PS2_EXTENDED, &event);
+      PS2_Parse_Byte(PS2_PORT_KEYBOARD, PS2_BREAK, &event);
+      PS2_Parse_Byte(PS2_PORT_KEYBOARD, keys[i].scan_code, &event);
+    }
+  }
+  host_sink(sum);
+  return (double)(host_cycles() - t0) / ((double)BENCH_ROUNDS * BENCH_KEYS);
+}
+
+int main( void )
+{
+  u32_t errors;
+  double legacy, table;
+  Make_Keys();
+  errors = Check_Keys();
+  errors += Check_AltGr();
+  printf("Translation check: %s\n", errors ? "FAILED" : "OK");
+  if( errors )
+    return 1;
+  legacy = Bench_Legacy();
+  table = Bench_Table();
+  printf("Translation, random keys and modifiers (cycles/key):\n");
+  printf("  branching Key_To_Ascii : %6.2f\n", legacy);
+  printf("  keymap table lookup    : %6.2f\n", table);
+  // Lock keys in the stream send LED commands, they only fill the queue here
+  printf("Parse make+break (cycles/key): %6.2f\n", Bench_Parse());
+  return 0;
+}
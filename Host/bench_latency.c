@@ -0,0 +1,120 @@
+/**
+ * @file bench_latency.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, Keypress to LCD Latency.
+ *
+ * Keys are typed at a random pace and received by the PS2 State Machine, the
+ * main loop of main.c is simulated: it sleeps until the stop bit posts
+ * EVENT_PS2 and then writes all queued keys to the LCD. With poll_ms the old
+ * main loop is simulated instead, every poll period gives one key by getKey().
+ * The old LCD_Write() waited about 2 ms and a full row is cleared first, the
+ * simulated time is advanced accordingly. The event driven main loop only
+ * puts the commands into the LCD command queue. The latency histograms are dumped to stdout
+ * like Latency_Dump() does on target, pipe the output into latency_report.
+ *
+ * Usage:
+ * @code
+ * bench_latency [poll_ms] | latency_report
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ps2_trace.h"
+#include "latency.h"
+#include "events.h"
+#include "host_clock.h"
+#include "host_bench.h"
+
+#define BENCH_KEYS      2000u     /**< Keys Typed. */
+#define LCD_WRITE_US    2000u     /**< Old LCD_Write() Busy Wait. */
+#define LCD_CMD_US      2000u     /**< Old LCD_Cmd() Busy Wait. */
+#define LCD_QUEUE_US    1u        /**< LCD_Write() into Command Queue. */
+
+static const char bench_text[] = "the quick brown fox jumps over the lazy dog";
+static u8_t lcd_count = 0;
+static u32_t lcd_write_us = LCD_QUEUE_US, lcd_cmd_us = LCD_QUEUE_US;
+static unsigned long shown = 0;
+
+/**
+ * @brief Key written to the simulated LCD.
+ */
+static void LCD_Key( void )
+{
+  if( ++lcd_count > 15u )
+  {
+    lcd_count = 0;
+    host_time_us += 2u * lcd_cmd_us;
+  }
+  host_time_us += lcd_write_us;
+  Latency_Record(LATENCY_SINK, PS2_Get_Key_Time(PS2_PORT_KEYBOARD));
+  shown++;
+}
+
+int main( int argc, char **argv )
+{
+  u32_t poll_us = 1000u * (argc > 1 ? (u32_t)atoi(argv[1]) : 0u);
+  u32_t next_poll, now;
+  PS2_Trace_s trace;
+  size_t e = 0;
+  unsigned long k;
+
+  PS2_Keyboard_Init();
+  Latency_Init();
+  host_seed = 3u;
+  PS2_Trace_Init(&trace);
+  trace.time_us = 10000u;
+  for( k = 0; k < BENCH_KEYS; k++ )
+  {
+    // 40 to 200 ms between keys, fast typing with bursts
+    PS2_Trace_Idle(&trace, 40000u + host_random(160000u));
+    PS2_Trace_Add_Key(&trace, bench_text[k % (sizeof(bench_text) - 1u)]);
+  }
+
+  if( poll_us )
+  {
+    lcd_write_us = LCD_WRITE_US;
+    lcd_cmd_us = LCD_CMD_US;
+  }
+  next_poll = poll_us;
+  while( poll_us == 0u && e < trace.count )
+  {
+    // Edges which arrived while the main loop was busy with the LCD
+    now = host_time_us;
+    while( e < trace.count && trace.edges[e].time_us <= now )
+      PS2_Trace_Replay_Edge(&trace.edges[e++]);
+    // Sleep until a stop bit posts EVENT_PS2
+    while( e < trace.count && !(Event_Get() & EVENT_PS2) )
+      PS2_Trace_Replay_Edge(&trace.edges[e++]);
+    if( host_time_us < now )
+      host_time_us = now;
+    while( !IS_PS2_Busy(PS2_PORT_KEYBOARD) )
+    {
+      if( getKey(PS2_PORT_KEYBOARD) )
+        LCD_Key();
+    }
+  }
+  while( poll_us && (e < trace.count ||
+                     host_time_us < trace.time_us + 1000000u) )
+  {
+    // Edges arrive while main loop waits, or while it is busy with the LCD
+    while( e < trace.count && trace.edges[e].time_us <= next_poll )
+      PS2_Trace_Replay_Edge(&trace.edges[e++]);
+    if( host_time_us < next_poll )
+      host_time_us = next_poll;
+    next_poll = host_time_us + poll_us;
+    if( getKey(PS2_PORT_KEYBOARD) )
+      LCD_Key();
+  }
+  Latency_Dump();
+  while( Latency_Dump_Task() )
+    ;
+  if( poll_us )
+    fprintf(stderr, "latency: %lu / %u keys shown, poll %lu ms\n", shown,
+            BENCH_KEYS, (unsigned long)(poll_us / 1000u));
+  else
+    fprintf(stderr, "latency: %lu / %u keys shown, event driven\n", shown,
+            BENCH_KEYS);
+  PS2_Trace_Free(&trace);
+  return ( shown == BENCH_KEYS ) ? 0 : 1;
+}
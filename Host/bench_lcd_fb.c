@@ -0,0 +1,215 @@
+/**
+ * @file bench_lcd_fb.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, LCD Shadow Framebuffer.
+ *
+ * The LCD traffic of two screens is compared, once written the old way with
+ * LCD_CLEAR and all characters, once through the framebuffer. typing is the
+ * key echo of main.c, a row of 16 keys is cleared before the next key.
+ * status is a two row screen with counters redrawn completely every update.
+ * The host LCD model executes the commands, after every update its content
+ * is compared with the expected text, the time the LCD is kept busy is
+ * printed per update. latin1 types European text through the framebuffer,
+ * every accented cell must show the glyph of the font from CGRAM, the hit
+ * rate of the glyph cache is printed. A row of 16 distinct accented
+ * characters must show 8 of them from CGRAM and the rest as ASCII.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "lcd_16x2.h"
+#include "lcd_fb.h"
+#include "lcd_glyph.h"
+#include "host_lcd.h"
+#include "host_bench.h"
+
+#define BENCH_KEYS      2000u     /**< Keys of typing. */
+#define BENCH_UPDATES   1000u     /**< Updates of status. */
+
+static const char bench_text[] = "the quick brown fox jumps over the lazy dog";
+static const char latin1_text[] =
+  "Gr\xFC\xDF" "e aus K\xF6ln, caf\xE9 cr\xE8me, se\xF1or Mu\xF1oz, \xD8re, "
+  "\xC5lborg, \xDE\xF3r\xF0ur, na\xEFve fa\xE7" "ade, d\xE9j\xE0 vu, "
+  "\xBFqu\xE9? \xA1ol\xE9! ";
+static const char latin1_row[] =
+  "\xE0\xE1\xE2\xE3\xE5\xE8\xE9\xEA\xEB\xEC\xED\xEE\xEF\xF2\xF3\xF5";
+
+/**
+ * @brief Compare the LCD Model with the expected Rows.
+ */
+static void Check( const char *row0, const char *row1 )
+{
+  char text[17];
+  host_lcd_row(0, text);
+  host_check(strcmp(text, row0) == 0);
+  host_lcd_row(1, text);
+  host_check(strcmp(text, row1) == 0);
+}
+
+/**
+ * @brief Compare a Row of the LCD Model with Latin-1 Text.
+ *
+ * A cell with a CGRAM code must show the glyph of the font, other cells the
+ * ASCII character or, for Latin-1, the ROM code or ASCII fallback.
+ * @return Cells shown from CGRAM.
+ */
+static u32_t Check_Glyphs( u8_t row, const char *text )
+{
+  const u8_t *bitmap;
+  u8_t column, code, c;
+  u32_t cgram = 0;
+  for( column = 0; column < 16u; column++ )
+  {
+    code = host_lcd_ddram[(row ? 0x40u : 0x00u) + column];
+    c = (u8_t)text[column];
+    bitmap = LCD_Glyph_Bitmap(c);
+    if( code < LCD_GLYPH_SLOTS )
+    {
+      host_check(bitmap != NULL &&
+                 memcmp(&host_lcd_cgram[code * 8u], bitmap, 8u) == 0);
+      cgram++;
+    }
+    else if( c < 0x80u )
+      host_check(code == c);
+  }
+  return cgram;
+}
+
+/**
+ * @brief Print the LCD Traffic of one Run.
+ */
+static void Report( const char *name, unsigned long updates )
+{
+  printf("%-14s: %5lu updates, %6lu commands, %6lu characters, %lu clears, "
+         "%7.1f us/update\n", name, updates, (unsigned long)host_lcd_commands,
+         (unsigned long)host_lcd_characters, (unsigned long)host_lcd_clears,
+         (double)host_lcd_busy_us / updates);
+}
+
+/**
+ * @brief Key Echo of main.c, expected Row kept in row.
+ */
+static void Typing( int framebuffer )
+{
+  char row[17];
+  u32_t k, count = 0;
+  memset(row, ' ', 16u);
+  row[16] = 0;
+  LCD_Init();
+  LCD_FB_Init();
+  for( k = 0; k < BENCH_KEYS; k++ )
+  {
+    if( k == 0 || ++count > 15u )
+    {
+      count = 0;
+      memset(row, ' ', 16u);
+      if( framebuffer )
+        LCD_FB_Clear();
+      else
+      {
+        LCD_Cmd(LCD_CLEAR);
+        LCD_Cmd(LCD_FIRST_ROW);
+      }
+    }
+    row[count] = bench_text[k % (sizeof(bench_text) - 1u)];
+    if( framebuffer )
+    {
+      LCD_FB_Putc(row[count]);
+      LCD_FB_Flush();
+    }
+    else
+      LCD_Write((u8_t)row[count]);
+    Check(row, "                ");
+  }
+  Report(framebuffer ? "typing fb" : "typing clear", BENCH_KEYS);
+}
+
+/**
+ * @brief Status Screen with Counters.
+ */
+static void Status_Screen( int framebuffer )
+{
+  char row0[17], row1[17];
+  u32_t u, keys = 0, latency;
+  LCD_Init();
+  LCD_FB_Init();
+  for( u = 0; u < BENCH_UPDATES; u++ )
+  {
+    keys += 1u + u % 3u;
+    latency = 780u + (u * 37u) % 40u;
+    snprintf(row0, sizeof(row0), "keys %11lu", (unsigned long)keys);
+    snprintf(row1, sizeof(row1), "latency %5lu us", (unsigned long)latency);
+    if( framebuffer )
+    {
+      LCD_FB_Clear();
+      LCD_FB_Printf("%s%s", row0, row1);
+      LCD_FB_Flush();
+    }
+    else
+    {
+      LCD_Cmd(LCD_CLEAR);
+      LCD_Cmd(LCD_FIRST_ROW);
+      LCD_Write_Text((u8_t*)row0);
+      LCD_Cmd(LCD_SECOND_ROW);
+      LCD_Write_Text((u8_t*)row1);
+    }
+    Check(row0, row1);
+  }
+  Report(framebuffer ? "status fb" : "status clear", BENCH_UPDATES);
+}
+
+/**
+ * @brief Key Echo of European Text.
+ */
+static void Latin1( void )
+{
+  const LCD_Glyph_Stats_s *glyphs = LCD_Glyph_Get_Stats();
+  char row[17];
+  u32_t k, count = 0, cgram;
+  memset(row, ' ', 16u);
+  row[16] = 0;
+  LCD_Init();
+  LCD_FB_Init();
+  for( k = 0; k < BENCH_KEYS; k++ )
+  {
+    if( k == 0 || ++count > 15u )
+    {
+      count = 0;
+      memset(row, ' ', 16u);
+      LCD_FB_Clear();
+    }
+    row[count] = latin1_text[k % (sizeof(latin1_text) - 1u)];
+    LCD_FB_Putc(row[count]);
+    LCD_FB_Flush();
+    Check_Glyphs(0, row);
+  }
+  Report("latin1 fb", BENCH_KEYS);
+  printf("lcd glyphs    : %lu hits, %lu misses, %lu evictions, "
+         "%lu fallbacks, hit rate %.1f%%\n", (unsigned long)glyphs->hits,
+         (unsigned long)glyphs->misses, (unsigned long)glyphs->evictions,
+         (unsigned long)glyphs->fallbacks,
+         100.0 * glyphs->hits / (glyphs->hits + glyphs->misses));
+  host_check(host_lcd_clears == 0u);
+
+  // More distinct glyphs than slots on one screen
+  LCD_FB_Clear();
+  LCD_FB_Puts(latin1_row);
+  LCD_FB_Flush();
+  cgram = Check_Glyphs(0, latin1_row);
+  printf("lcd glyphs    : %lu of 16 distinct shown from CGRAM\n",
+         (unsigned long)cgram);
+  host_check(cgram == LCD_GLYPH_SLOTS);
+}
+
+int main( void )
+{
+  Typing(0);
+  Typing(1);
+  host_check(host_lcd_clears == 0u);
+  Status_Screen(0);
+  Status_Screen(1);
+  host_check(host_lcd_clears == 0u);
+  Latin1();
+  printf("lcd fb        : %s\n", host_failed ? "FAILED" : "OK");
+  return host_failed;
+}
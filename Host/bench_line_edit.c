@@ -0,0 +1,254 @@
+/**
+ * @file bench_line_edit.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, Input Line Editor.
+ *
+ * Random keys, mostly characters and cursor keys, edit a long part number.
+ * The same edits are done on a plain array, after every key the line of the
+ * editor, its cursor and the LCD model are compared with it: the second row
+ * must show 16 characters of the line starting at the window, the LCD cursor
+ * must be on the insert position. The LCD traffic per key is printed. The
+ * time of an insert and a backspace in the middle of a line of 8 and of 120
+ * characters is printed, the gap buffer makes both the same. Held keys are
+ * typed through the PS2 parser, their typematic repeats must edit again.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "lcd_16x2.h"
+#include "lcd_fb.h"
+#include "line_edit.h"
+#include "host_lcd.h"
+#include "ps2_trace.h"
+#include "host_bench.h"
+
+#define BENCH_KEYS      20000u    /**< Random Keys. */
+#define BENCH_EDITS     200000u   /**< Timed Insert and Backspace Pairs. */
+
+static char ref[LINE_EDIT_SIZE + 1u];
+static u8_t ref_length = 0, ref_cursor = 0;
+
+/**
+ * @brief Key Press to the Editor.
+ */
+static boolean Press( u8_t keycode, u8_t ascii )
+{
+  PS2_Key_Event_s event;
+  memset(&event, 0, sizeof(event));
+  event.keycode = keycode;
+  event.ascii = ascii;
+  event.flags = PS2_EVT_MAKE;
+  return Line_Edit_Key(&event);
+}
+
+/**
+ * @brief Same Key on the plain Array.
+ */
+static void Reference( u8_t keycode, u8_t ascii )
+{
+  switch( keycode )
+  {
+    case PS2_KEY_LEFT:
+      if( ref_cursor > 0u )
+        ref_cursor--;
+      break;
+    case PS2_KEY_RIGHT:
+      if( ref_cursor < ref_length )
+        ref_cursor++;
+      break;
+    case PS2_KEY_HOME:
+      ref_cursor = 0;
+      break;
+    case PS2_KEY_END:
+      ref_cursor = ref_length;
+      break;
+    case PS2_KEY_BKSP:
+      if( ref_cursor > 0u )
+      {
+        memmove(&ref[ref_cursor - 1u], &ref[ref_cursor],
+                ref_length - ref_cursor);
+        ref_cursor--;
+        ref_length--;
+      }
+      break;
+    case PS2_KEY_DELETE:
+      if( ref_cursor < ref_length )
+      {
+        memmove(&ref[ref_cursor], &ref[ref_cursor + 1u],
+                ref_length - ref_cursor - 1u);
+        ref_length--;
+      }
+      break;
+    case PS2_KEY_ESC:
+      ref_cursor = 0;
+      ref_length = 0;
+      break;
+    default:
+      if( ref_length < LINE_EDIT_SIZE )
+      {
+        memmove(&ref[ref_cursor + 1u], &ref[ref_cursor],
+                ref_length - ref_cursor);
+        ref[ref_cursor++] = (char)ascii;
+        ref_length++;
+      }
+      break;
+  }
+  ref[ref_length] = 0;
+}
+
+/**
+ * @brief Compare Editor and LCD Model with the plain Array.
+ */
+static void Check( void )
+{
+  char line[LINE_EDIT_SIZE + 1u], row[17], expected[17];
+  u8_t column, view;
+  Line_Edit_Get_Line(line, sizeof(line));
+  host_check(strcmp(line, ref) == 0 && Line_Edit_Get_Cursor() == ref_cursor);
+  if( !(host_lcd_display & HOST_LCD_CURSOR) ||
+      host_lcd_address < 0x40u || host_lcd_address >= 0x50u ||
+      host_lcd_address - 0x40u > ref_cursor )
+  {
+    host_check(0);
+    return;
+  }
+  view = (u8_t)(ref_cursor - (host_lcd_address - 0x40u));
+  for( column = 0; column < 16u; column++ )
+    expected[column] = ( view + column < ref_length ) ? ref[view + column]
+                                                      : ' ';
+  expected[16] = 0;
+  host_lcd_row(1, row);
+  host_check(strcmp(row, expected) == 0);
+}
+
+/**
+ * @brief Random Editing, checked after every Key.
+ */
+static void Random_Keys( void )
+{
+  static const u8_t keys[] = { PS2_KEY_LEFT, PS2_KEY_RIGHT, PS2_KEY_HOME,
+                               PS2_KEY_END, PS2_KEY_BKSP, PS2_KEY_DELETE };
+  const LCD_FB_Stats_s *fb = LCD_FB_Get_Stats();
+  u32_t k, r;
+  u8_t keycode, ascii;
+  LCD_Init();
+  LCD_FB_Init();
+  Line_Edit_Init(1);
+  LCD_FB_Flush();
+  for( k = 0; k < BENCH_KEYS; k++ )
+  {
+    r = host_random(100u);
+    ascii = 0;
+    if( r < 55u )
+    {
+      // Part Number Characters
+      keycode = 0x04;
+      ascii = (u8_t)("0123456789ABCDEF-"[host_random(17u)]);
+    }
+    else if( r < 99u )
+      keycode = keys[host_random(sizeof(keys))];
+    else
+      keycode = PS2_KEY_ESC;
+    Press(keycode, ascii);
+    Reference(keycode, ascii);
+    LCD_FB_Flush();
+    Check();
+  }
+  printf("line edit     : %lu keys, %.2f characters/key, %.2f moves/key, "
+         "%.1f us/key, %lu full\n", (unsigned long)BENCH_KEYS,
+         (double)fb->writes / BENCH_KEYS, (double)fb->moves / BENCH_KEYS,
+         (double)host_lcd_busy_us / BENCH_KEYS,
+         (unsigned long)Line_Edit_Get_Stats()->full);
+  host_check(host_lcd_clears == 0u);
+}
+
+/**
+ * @brief Held Keys, Scan Codes through the PS2 Parser.
+ *
+ * 'a' is held for six make codes, Left for three and Backspace for two, the
+ * typematic repeats must edit like single presses: "aaaa" with the cursor
+ * after the first character.
+ */
+static void Held_Keys( void )
+{
+  static const u8_t codes[] = {
+    0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0xF0, 0x1C,  // a
+    0xE0, 0x6B, 0xE0, 0x6B, 0xE0, 0x6B, 0xE0, 0xF0, 0x6B, // Left
+    0x66, 0x66, 0xF0, 0x66,                           // Backspace
+  };
+  PS2_Trace_s trace;
+  PS2_Key_Event_s event;
+  char line[LINE_EDIT_SIZE + 1u];
+  u32_t i, repeats = 0;
+  PS2_Keyboard_Init();
+  LCD_Init();
+  LCD_FB_Init();
+  Line_Edit_Init(1);
+  LCD_FB_Flush();
+  ref_length = ref_cursor = 0;
+  ref[0] = 0;
+  PS2_Trace_Init(&trace);
+  for( i = 0; i < sizeof(codes); i++ )
+    PS2_Trace_Add_Byte(&trace, codes[i]);
+  for( i = 0; i < trace.count; i++ )
+  {
+    PS2_Trace_Replay_Edge(&trace.edges[i]);
+    while( PS2_Get_Event(PS2_PORT_KEYBOARD, &event) )
+    {
+      Line_Edit_Key(&event);
+      if( event.flags & PS2_EVT_MAKE )
+        Reference(event.keycode, event.ascii);
+      if( event.flags & PS2_EVT_REPEAT )
+        repeats++;
+      LCD_FB_Flush();
+      Check();
+    }
+  }
+  PS2_Trace_Free(&trace);
+  Line_Edit_Get_Line(line, sizeof(line));
+  host_check(repeats == 8u && strcmp(line, "aaaa") == 0 &&
+             Line_Edit_Get_Cursor() == 1u);
+  printf("line edit     : held keys, %lu repeats, \"%s\"\n",
+         (unsigned long)repeats, line);
+}
+
+/**
+ * @brief Time of Insert and Backspace in the Middle of a Line.
+ * @return nano-seconds per Key.
+ */
+static double Edit_Time( u8_t length )
+{
+  uint64_t start, stop;
+  u32_t e;
+  u8_t i;
+  LCD_FB_Init();
+  Line_Edit_Init(1);
+  for( i = 0; i < length; i++ )
+    Press(0x04, (u8_t)('A' + i % 26u));
+  for( i = 0; i < length / 2u; i++ )
+    Press(PS2_KEY_LEFT, 0);
+  start = host_now_ns();
+  for( e = 0; e < BENCH_EDITS; e++ )
+  {
+    Press(0x04, 'x');
+    Press(PS2_KEY_BKSP, 0);
+  }
+  stop = host_now_ns();
+  host_sink(Line_Edit_Get_Cursor());
+  return (double)(stop - start) / (2.0 * BENCH_EDITS);
+}
+
+int main( void )
+{
+  double short_ns, long_ns;
+  Random_Keys();
+  host_check(Press(PS2_KEY_ENTER, ENTER) &&
+             Line_Edit_Get_Stats()->lines == 1u);
+  Held_Keys();
+  short_ns = Edit_Time(8u);
+  long_ns = Edit_Time(120u);
+  printf("line edit     : %.1f ns/key at 8 characters, %.1f ns/key at 120\n",
+         short_ns, long_ns);
+  printf("line edit     : %s\n", host_failed ? "FAILED" : "OK");
+  return host_failed;
+}
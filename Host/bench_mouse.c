@@ -0,0 +1,239 @@
+/**
+ * @file bench_mouse.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, PS2 Mouse Initialization and Packet Decoder.
+ *
+ * A simulated IntelliMouse Explorer on the Auxiliary Port answers the
+ * initialization done by PS2_Mouse_Task(). It then streams packets at the
+ * configured sample rate while the main loop only reads the mouse every
+ * BENCH_POLL_MS, like it does while it is busy with the LCD. The movement
+ * read must add up to the movement sent, packets hit by a parity error or a
+ * frame timeout are the only ones allowed to be missing.
+ */
+
+#include <stdio.h>
+#include "ps2_trace.h"
+#include "ps2_mouse.h"
+#include "host_bench.h"
+#include "host_clock.h"
+
+#define BENCH_PACKETS   20000ul   /**< Packets in Stream. */
+#define BENCH_POLL_MS   50u       /**< Main Loop reads Mouse this often. */
+#define BENCH_BYTE_GAP  100u      /**< Bus Idle between Bytes of a Packet. */
+#define FAULT_EVERY     97u       /**< Corrupt every n-th Packet. */
+
+/**
+ * @brief Simulated Mouse State.
+ */
+typedef struct
+{
+  u8_t id;          /**< Device ID, goes up with the magic sample rates. */
+  u8_t rates[3];    /**< Last three Sample Rates. */
+  u8_t rate;        /**< Sample Rate. */
+  u8_t pending;     /**< Command waiting for its Argument, else 0. */
+  boolean stream;   /**< Stream Mode Enabled. */
+} Mouse_Device_s;
+
+static Mouse_Device_s device;
+
+/**
+ * @brief Simulated Mouse answers one Command Byte.
+ */
+static void Device_Command( u8_t port, int command )
+{
+  PS2_Trace_Device_Send(port, PS2_REPLY_ACK);
+  if( device.pending == PS2_MOUSE_CMD_SET_RATE )
+  {
+    device.rates[0] = device.rates[1];
+    device.rates[1] = device.rates[2];
+    device.rates[2] = (u8_t)command;
+    device.rate = (u8_t)command;
+    device.pending = 0;
+  }
+  else if( device.pending )
+  {
+    device.pending = 0;
+  }
+  else if( command == PS2_CMD_RESET )
+  {
+    device.id = PS2_MOUSE_ID_STANDARD;
+    device.rate = 100u;
+    device.stream = FALSE;
+    PS2_Trace_Device_Send(port, PS2_MOUSE_BAT_OK);
+    PS2_Trace_Device_Send(port, device.id);
+  }
+  else if( command == PS2_MOUSE_CMD_GET_ID )
+  {
+    if( device.rates[0] == 200u && device.rates[2] == 80u )
+    {
+      if( device.rates[1] == 100u && device.id == PS2_MOUSE_ID_STANDARD )
+        device.id = PS2_MOUSE_ID_WHEEL;
+      else if( device.rates[1] == 200u && device.id == PS2_MOUSE_ID_WHEEL )
+        device.id = PS2_MOUSE_ID_5BUTTON;
+    }
+    PS2_Trace_Device_Send(port, device.id);
+  }
+  else if( command == PS2_CMD_ENABLE )
+  {
+    device.stream = TRUE;
+  }
+  else if( command == PS2_MOUSE_CMD_SET_RATE ||
+           command == PS2_MOUSE_CMD_RESOLUTION )
+  {
+    device.pending = (u8_t)command;
+  }
+}
+
+/**
+ * @brief Mouse Initialization.
+ * @return 0 if Explorer Mouse is detected and streams at the sample rate.
+ */
+static int Check_Init( void )
+{
+  u8_t port = PS2_PORT_AUX;
+  u32_t steps = 0;
+  int failed = 0, command;
+  PS2_Mouse_Init(port);
+  while( !(IS_PS2_Mouse_Streaming(port) && !IS_PS2_Command_Pending(port)) &&
+         steps++ < 100u )
+  {
+    PS2_Mouse_Task();
+    if( IS_PS2_Command_Pending(port) )
+    {
+      command = PS2_Trace_Device_Receive(port);
+      if( command < 0 )
+        failed = 1;
+      else
+        Device_Command(port, command);
+      PS2_Command_Task();
+    }
+  }
+  if( !device.stream || device.rate != PS2_MOUSE_SAMPLE_RATE ||
+      PS2_Mouse_Get_ID(port) != PS2_MOUSE_ID_5BUTTON )
+    failed = 1;
+  printf("mouse init   : ID %u, %u samples/s, %lu steps %s\n",
+         (unsigned)PS2_Mouse_Get_ID(port), (unsigned)device.rate,
+         (unsigned long)steps, failed ? "FAIL" : "OK");
+  return failed;
+}
+
+/**
+ * @brief Explorer Packet, 9 bit X/Y, 4 bit Wheel and 5 Buttons.
+ */
+static void Make_Packet( u8_t packet[4], int dx, int dy, int dz, u8_t buttons )
+{
+  packet[0] = (u8_t)(PS2_MOUSE_SYNC | (buttons & 0x07u) |
+                     ((dx < 0) ? PS2_MOUSE_X_SIGN : 0) |
+                     ((dy < 0) ? PS2_MOUSE_Y_SIGN : 0));
+  packet[1] = (u8_t)dx;
+  packet[2] = (u8_t)dy;
+  packet[3] = (u8_t)((dz & 0x0F) | ((buttons & 0x18u) << 1));
+}
+
+/**
+ * @brief Stream of Packets at the Sample Rate, read every BENCH_POLL_MS.
+ *
+ * Stream starts in the middle of a packet. Every FAULT_EVERY packets one
+ * byte either has a parity error or loses clock edges, the rest of that
+ * packet is aborted. The following packet must decode again.
+ * @return 0 if all movement of undamaged packets is read.
+ */
+static int Check_Stream( void )
+{
+  const u8_t port = PS2_PORT_AUX;
+  const u32_t period_us = 1000000u / PS2_MOUSE_SAMPLE_RATE;
+  PS2_Trace_s trace;
+  PS2_Mouse_Report_s report;
+  u8_t packet[4], buttons = 0;
+  long sent[3] = {0, 0, 0}, got[3] = {0, 0, 0};
+  u32_t start, next_poll;
+  unsigned long i, damaged = 0, polls = 0;
+  size_t e, b;
+  int dx, dy, dz, failed = 0;
+  uint64_t t0, ns;
+  const PS2_Mouse_Stats_s *stats = PS2_Mouse_Get_Stats(port);
+  u32_t packets = stats->packets;
+
+  host_seed = 11u;
+  PS2_Trace_Init(&trace);
+  trace.time_us = host_time_us + 10000u;
+  // Tail of a packet sent before the decoder was armed
+  PS2_Trace_Add_Byte(&trace, 0x40u);
+  PS2_Trace_Add_Byte(&trace, 0x01u);
+  start = trace.time_us + 2000u;
+  for( i = 0; i < BENCH_PACKETS; i++ )
+  {
+    dx = (int)host_random(511u) - 255;
+    dy = (int)host_random(511u) - 255;
+    dz = (int)host_random(16u) - 8;
+    buttons = (u8_t)host_random(32u);
+    Make_Packet(packet, dx, dy, dz, buttons);
+    if( trace.time_us < start + (u32_t)i * period_us )
+      trace.time_us = start + (u32_t)i * period_us;
+    for( b = 0; b < 4u; b++ )
+    {
+      PS2_Trace_Add_Byte(&trace, packet[b]);
+      if( (i % FAULT_EVERY) == FAULT_EVERY - 1u && b == (i / FAULT_EVERY) % 4u )
+      {
+        if( (i / FAULT_EVERY) & 1u )
+        {
+          // Clock edges lost, frame times out, mouse pauses
+          trace.count -= 5u;
+          PS2_Trace_Idle(&trace, 4000u);
+        }
+        else
+        {
+          // Flip the Parity Bit, it is the second last edge
+          trace.edges[trace.count - 2u].data ^= 1u;
+        }
+        // Host inhibits the bus to ask for Resend, rest of packet is aborted
+        break;
+      }
+      PS2_Trace_Idle(&trace, BENCH_BYTE_GAP);
+    }
+    if( (i % FAULT_EVERY) == FAULT_EVERY - 1u )
+    {
+      damaged++;
+      continue;
+    }
+    sent[0] += dx;
+    sent[1] += dy;
+    sent[2] += dz;
+  }
+
+  next_poll = start + BENCH_POLL_MS * 1000u;
+  t0 = host_now_ns();
+  for( e = 0; e < trace.count; e++ )
+  {
+    PS2_Trace_Replay_Port_Edge(port, &trace.edges[e]);
+    if( host_time_us >= next_poll || e + 1u == trace.count )
+    {
+      next_poll += BENCH_POLL_MS * 1000u;
+      PS2_Mouse_Task();
+      PS2_Mouse_Read(port, &report);
+      got[0] += report.dx;
+      got[1] += report.dy;
+      got[2] += report.wheel;
+      polls++;
+    }
+  }
+  ns = host_now_ns() - t0;
+  if( got[0] != sent[0] || got[1] != sent[1] || got[2] != sent[2] ||
+      stats->packets - packets != BENCH_PACKETS - damaged ||
+      report.buttons != buttons )
+    failed = 1;
+  printf("mouse stream : %lu packets, %lu damaged, %lu reads, "
+         "sum %ld/%ld/%ld %s\n", BENCH_PACKETS, damaged, polls,
+         got[0], got[1], got[2], failed ? "FAIL" : "OK");
+  printf("  sync errors %lu, %.1f ns/packet (state machine and reads)\n",
+         (unsigned long)stats->sync_errors,
+         (double)ns / (double)BENCH_PACKETS);
+  PS2_Trace_Free(&trace);
+  return failed;
+}
+
+int main( void )
+{
+  PS2_Keyboard_Init();
+  return Check_Init() | Check_Stream();
+}
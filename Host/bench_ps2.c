@@ -0,0 +1,629 @@
+/**
+ * @file bench_ps2.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, PS2 State Machine and Scan Code Decoder.
+ *
+ * Usage:
+ * @code
+ * bench_ps2                        synthetic throughput benchmark
+ * bench_ps2 file.trace ...         replay recorded traces, check decoding
+ * bench_ps2 -w file.trace "text"   write a synthetic trace for text
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ps2_trace.h"
+#include "host_bench.h"
+#include "host_gpio.h"
+#include "host_clock.h"
+
+#define BENCH_KEYS      200000ul  /**< Keys in Synthetic Stream. */
+#define BENCH_BATCH     8u        /**< Keys per Poll, must fit in Queue. */
+#define LOST_KEYS       2000ul    /**< Keys in Lost Edge Stream. */
+#define LOST_EVERY      331u      /**< Lose a Clock Edge every n edges. */
+#define WAKE_KEYS       40u       /**< Keys each after a Deep-Sleep. */
+#define REPEAT_CODES    10u       /**< Make Codes of a held Key. */
+
+static const char bench_text[] =
+  "the quick brown fox jumps over the lazy dog 0123456789 ,./;'[]-=";
+
+/**
+ * @brief Replay recorded Traces and compare the keys with expected keys.
+ * @return Number of failed Traces.
+ */
+static int Replay_Files( int argc, char **argv )
+{
+  int i, failed = 0;
+  char keys[PS2_TRACE_EXPECT_MAX];
+  PS2_Trace_s trace;
+  for( i = 0; i < argc; i++ )
+  {
+    PS2_Trace_Init(&trace);
+    if( PS2_Trace_Load(&trace, argv[i]) != 0 )
+    {
+      printf("%s: can't read\n", argv[i]);
+      failed++;
+      continue;
+    }
+    PS2_Trace_Replay(&trace, keys, sizeof(keys));
+    if( strcmp(keys, trace.expected) == 0 )
+    {
+      printf("%s: %lu edges, OK \"%s\"\n", argv[i],
+             (unsigned long)trace.count, keys);
+    }
+    else
+    {
+      printf("%s: %lu edges, FAIL got \"%s\" expected \"%s\"\n", argv[i],
+             (unsigned long)trace.count, keys, trace.expected);
+      failed++;
+    }
+    PS2_Trace_Free(&trace);
+  }
+  return failed;
+}
+
+/**
+ * @brief Write a Synthetic Trace as clock/data level samples.
+ */
+static int Write_Trace( const char *path, const char *text )
+{
+  size_t i;
+  PS2_Trace_s trace;
+  FILE *fp = fopen(path, "w");
+  if( fp == NULL )
+  {
+    perror(path);
+    return 1;
+  }
+  PS2_Trace_Init(&trace);
+  for( ; *text; text++ )
+  {
+    if( PS2_Trace_Add_Key(&trace, *text) != 0 )
+    {
+      fprintf(stderr, "can't type '%c'\n", *text);
+    }
+  }
+  fprintf(fp, "# PS2 trace: <time_us> <clock> <data>\n");
+  fprintf(fp, "# expect: %s\n", trace.expected);
+  fprintf(fp, "0 1 1\n");
+  for( i = 0; i < trace.count; i++ )
+  {
+    u32_t t = trace.edges[i].time_us + PS2_TRACE_HALF_BIT_US;
+    fprintf(fp, "%lu 1 %u\n", (unsigned long)(t - 20u), trace.edges[i].data);
+    fprintf(fp, "%lu 0 %u\n", (unsigned long)t, trace.edges[i].data);
+    fprintf(fp, "%lu 1 %u\n", (unsigned long)(t + PS2_TRACE_HALF_BIT_US),
+            trace.edges[i].data);
+  }
+  fprintf(fp, "%lu 1 1\n", (unsigned long)(trace.time_us + 1000u));
+  fclose(fp);
+  PS2_Trace_Free(&trace);
+  return 0;
+}
+
+/**
+ * @brief Synthetic Throughput Benchmark.
+ *
+ * A stream of key presses is generated, edges of BENCH_BATCH keys are fed to
+ * the State Machine and then the keys are decoded, both are timed separately.
+ */
+static int Bench_Synthetic( void )
+{
+  PS2_Trace_s trace;
+  size_t edge = 0, batch_end;
+  unsigned long k, errors = 0, frames;
+  uint64_t t0, edge_ns = 0, decode_ns = 0;
+  u8_t keys[SCAN_CODE_MAX];
+  u8_t got, i;
+  size_t expect = 0;
+
+  PS2_Trace_Init(&trace);
+  for( k = 0; k < BENCH_KEYS; k++ )
+  {
+    PS2_Trace_Add_Key(&trace, bench_text[k % (sizeof(bench_text) - 1u)]);
+  }
+  // Every Key is Make, Break and Scan Code frame, with 11 edges each
+  frames = (unsigned long)(trace.count / 11u);
+
+  while( edge < trace.count )
+  {
+    batch_end = edge + BENCH_BATCH * 3u * 11u;
+    if( batch_end > trace.count )
+      batch_end = trace.count;
+    t0 = host_now_ns();
+    for( ; edge < batch_end; edge++ )
+    {
+      PS2_Trace_Replay_Edge(&trace.edges[edge]);
+    }
+    edge_ns += host_now_ns() - t0;
+
+    t0 = host_now_ns();
+    got = PS2_ReadKeys(PS2_PORT_KEYBOARD, keys, SCAN_CODE_MAX);
+    decode_ns += host_now_ns() - t0;
+    for( i = 0; i < got; i++ )
+    {
+      if( keys[i] != (u8_t)bench_text[expect % (sizeof(bench_text) - 1u)] )
+        errors++;
+      expect++;
+    }
+  }
+  if( expect != BENCH_KEYS )
+    errors += (unsigned long)(expect > BENCH_KEYS ? expect - BENCH_KEYS
+                                                  : BENCH_KEYS - expect);
+
+  printf("edges        : %lu\n", (unsigned long)trace.count);
+  printf("frames       : %lu\n", frames);
+  printf("frames/sec   : %.0f\n", frames * 1e9 / (double)edge_ns);
+  printf("ns/edge      : %.2f\n", (double)edge_ns / (double)trace.count);
+  printf("ns/key decode: %.2f\n", (double)decode_ns / (double)BENCH_KEYS);
+  printf("decode errors: %lu / %lu keys\n", errors, BENCH_KEYS);
+  PS2_Trace_Free(&trace);
+  return errors ? 1 : 0;
+}
+
+/**
+ * @brief Lost Edge Recovery.
+ *
+ * One clock edge is removed every LOST_EVERY edges, the frame with missing
+ * edge must be discarded by the inter-bit timeout and the following keys must
+ * decode correctly.
+ */
+static int Bench_Lost_Edge( void )
+{
+  PS2_Trace_s trace, lossy;
+  size_t i, n, ok = 0;
+  unsigned long k;
+  static char keys[LOST_KEYS + 1u];
+  PS2_Stats_s before = *PS2_Get_Stats(PS2_PORT_KEYBOARD);
+
+  PS2_Trace_Init(&trace);
+  PS2_Trace_Init(&lossy);
+  for( k = 0; k < LOST_KEYS; k++ )
+  {
+    PS2_Trace_Add_Key(&trace, bench_text[k % (sizeof(bench_text) - 1u)]);
+  }
+  lossy.edges = malloc(trace.count * sizeof(PS2_Edge_s));
+  for( i = 0; i < trace.count; i++ )
+  {
+    if( (i % LOST_EVERY) != LOST_EVERY - 1u )
+      lossy.edges[lossy.count++] = trace.edges[i];
+  }
+  n = PS2_Trace_Replay(&lossy, keys, sizeof(keys));
+  // Keys are compared in order, a damaged key may be dropped or misdecoded
+  for( i = 0, k = 0; i < n && k < LOST_KEYS; i++ )
+  {
+    if( keys[i] == bench_text[k % (sizeof(bench_text) - 1u)] )
+    {
+      ok++;
+      k++;
+    }
+    else if( keys[i] == bench_text[(k + 1u) % (sizeof(bench_text) - 1u)] )
+    {
+      ok++;
+      k += 2u;
+    }
+  }
+  printf("lost edges   : %lu, aborted frames %lu, keys ok %lu / %lu\n",
+         (unsigned long)(trace.count - lossy.count),
+         (unsigned long)(PS2_Get_Stats(PS2_PORT_KEYBOARD)->timeouts - before.timeouts +
+                         PS2_Get_Stats(PS2_PORT_KEYBOARD)->parity_errors - before.parity_errors +
+                         PS2_Get_Stats(PS2_PORT_KEYBOARD)->framing_errors - before.framing_errors),
+         (unsigned long)ok, LOST_KEYS);
+  PS2_Trace_Free(&trace);
+  PS2_Trace_Free(&lossy);
+  return ( ok >= LOST_KEYS * 9u / 10u ) ? 0 : 1;
+}
+
+/**
+ * @brief Wake-Up from Deep-Sleep.
+ *
+ * Core sleeps before every key, the start bit edge wakes it up and edges
+ * within the wake-up time are lost like on target. PS2_Wake() gives the start
+ * bit to the State Machine, keys must decode while wake-up is faster than one
+ * bit period (2 * PS2_TRACE_HALF_BIT_US).
+ * @return 0 if every key decodes with a wake-up time below one bit period.
+ */
+static int Check_Wake( void )
+{
+  static const u32_t wake_us[] = { 10u, 40u, 70u, 100u };
+  static size_t first[WAKE_KEYS];
+  PS2_Trace_s trace;
+  char keys[PS2_TRACE_EXPECT_MAX];
+  u8_t buf[SCAN_CODE_MAX], got, i;
+  size_t e, n, d, k;
+  u32_t wake;
+  const PS2_Stats_s *stats = PS2_Get_Stats(PS2_PORT_KEYBOARD);
+  PS2_Stats_s before;
+  int failed = 0, bad;
+
+  for( d = 0; d < sizeof(wake_us) / sizeof(wake_us[0]); d++ )
+  {
+    before = *stats;
+    PS2_Trace_Init(&trace);
+    trace.time_us = host_time_us + 100000u;
+    for( k = 0; k < WAKE_KEYS; k++ )
+    {
+      // Idle long enough for Deep-Sleep before every key
+      PS2_Trace_Idle(&trace, 100000u);
+      first[k] = trace.count;
+      PS2_Trace_Add_Key(&trace, bench_text[k % (sizeof(bench_text) - 1u)]);
+    }
+    n = 0;
+    for( e = 0, k = 0; e < trace.count; e++ )
+    {
+      if( k < WAKE_KEYS && e == first[k] )
+      {
+        k++;
+        wake = trace.edges[e].time_us + wake_us[d];
+        while( e + 1u < trace.count && trace.edges[e + 1u].time_us < wake )
+          e++;
+        host_time_us = wake;
+        PS2_Wake(PS2_PORT_KEYBOARD, wake, TRUE);
+        continue;
+      }
+      PS2_Trace_Replay_Edge(&trace.edges[e]);
+      got = PS2_ReadKeys(PS2_PORT_KEYBOARD, buf, SCAN_CODE_MAX);
+      for( i = 0; i < got && n + 1u < PS2_TRACE_EXPECT_MAX; i++ )
+        keys[n++] = (char)buf[i];
+    }
+    keys[n] = '\0';
+    bad = strcmp(keys, trace.expected) != 0 ||
+          stats->wake_errors != before.wake_errors;
+    if( wake_us[d] < 2u * PS2_TRACE_HALF_BIT_US && bad )
+      failed = 1;
+    printf("wake %3lu us  : %lu wakes, %lu first frames lost, keys %s\n",
+           (unsigned long)wake_us[d],
+           (unsigned long)(stats->wakes - before.wakes),
+           (unsigned long)(stats->wake_errors - before.wake_errors),
+           bad ? "damaged" : "OK");
+    PS2_Trace_Free(&trace);
+  }
+  return failed;
+}
+
+/**
+ * @brief Extended Key Sequences.
+ *
+ * Extended keys, Print Screen and Pause are sent, events are polled after
+ * every edge so the parser sees each sequence in parts. Every event must be
+ * stamped with the Start Bit edge of its first byte.
+ * @return 0 if all events are as expected.
+ */
+static int Check_Events( void )
+{
+  static const u8_t codes[] = {
+    0xE0, 0x75, 0xE0, 0xF0, 0x75,                   // Up
+    0xE0, 0x14, 0x1C, 0xF0, 0x1C, 0xE0, 0xF0, 0x14, // Right Ctrl + a
+    0xE0, 0x12, 0xE0, 0x7C, 0xE0, 0xF0, 0x7C, 0xE0, 0xF0, 0x12, // PrtScr
+    0xE1, 0x14, 0x77, 0xE1, 0xF0, 0x14, 0xF0, 0x77, // Pause
+    0xE0, 0x5A, 0xE0, 0xF0, 0x5A,                   // Keypad Enter
+  };
+  // Timestamp is given as index of first byte of the key in codes
+  static const PS2_Key_Event_s expect[] = {
+    { PS2_KEY_UP, 0, 0, PS2_EVT_MAKE, 0 },
+    { PS2_KEY_UP, 0, 0, 0, 2 },
+    { 0xE4, 0, PS2_MOD_RCTRL, PS2_EVT_MAKE, 5 },
+    { 0x04, 'a', PS2_MOD_RCTRL, PS2_EVT_MAKE, 7 },
+    { 0x04, 'a', PS2_MOD_RCTRL, 0, 8 },
+    { 0xE4, 0, 0, 0, 10 },
+    { PS2_KEY_PRINTSCREEN, 0, 0, PS2_EVT_MAKE, 15 },
+    { PS2_KEY_PRINTSCREEN, 0, 0, 0, 17 },
+    { PS2_KEY_PAUSE, 0, 0, PS2_EVT_MAKE, 23 },
+    { PS2_KEY_PAUSE, 0, 0, 0, 23 },
+    { PS2_KEY_KP_ENTER, ENTER, 0, PS2_EVT_MAKE, 31 },
+    { PS2_KEY_KP_ENTER, ENTER, 0, 0, 33 },
+  };
+  PS2_Trace_s trace;
+  PS2_Key_Event_s event;
+  size_t i, n = 0;
+  int failed = 0;
+  PS2_Trace_Init(&trace);
+  for( i = 0; i < sizeof(codes); i++ )
+  {
+    PS2_Trace_Add_Byte(&trace, codes[i]);
+  }
+  for( i = 0; i < trace.count; i++ )
+  {
+    PS2_Trace_Replay_Edge(&trace.edges[i]);
+    while( PS2_Get_Event(PS2_PORT_KEYBOARD, &event) )
+    {
+      if( n >= NELEMENTS(expect) || event.keycode != expect[n].keycode ||
+          event.ascii != expect[n].ascii ||
+          event.modifiers != expect[n].modifiers ||
+          (event.flags & PS2_EVT_MAKE) != expect[n].flags ||
+          event.timestamp != trace.edges[expect[n].timestamp * 11u].time_us )
+      {
+        printf("event %lu: key 0x%02X ascii 0x%02X mod 0x%02X flags 0x%02X"
+               " time %lu unexpected\n", (unsigned long)n, event.keycode,
+               event.ascii, event.modifiers, event.flags,
+               (unsigned long)event.timestamp);
+        failed = 1;
+      }
+      n++;
+    }
+  }
+  if( n != NELEMENTS(expect) )
+    failed = 1;
+  printf("event check  : %lu / %lu events %s\n", (unsigned long)n,
+         (unsigned long)NELEMENTS(expect), failed ? "FAIL" : "OK");
+  PS2_Trace_Free(&trace);
+  return failed;
+}
+
+/**
+ * @brief Held Key with Typematic Repeats.
+ *
+ * The make code of 'a' is sent REPEAT_CODES times, then its break code. The
+ * first make is a press, every further one a repeat of the pressed key, the
+ * break releases it. No identical byte may be dropped on the way.
+ * @return 0 if all repeats are decoded.
+ */
+static int Check_Repeat( void )
+{
+  PS2_Trace_s trace;
+  PS2_Key_Event_s event;
+  size_t i;
+  u32_t n = 0, repeats = 0;
+  int failed = 0;
+  PS2_Trace_Init(&trace);
+  for( i = 0; i < REPEAT_CODES; i++ )
+  {
+    PS2_Trace_Add_Byte(&trace, 0x1C);
+  }
+  PS2_Trace_Add_Byte(&trace, PS2_BREAK);
+  PS2_Trace_Add_Byte(&trace, 0x1C);
+  for( i = 0; i < trace.count; i++ )
+  {
+    PS2_Trace_Replay_Edge(&trace.edges[i]);
+    while( PS2_Get_Event(PS2_PORT_KEYBOARD, &event) )
+    {
+      u8_t flags = event.flags & (PS2_EVT_MAKE | PS2_EVT_REPEAT);
+      u8_t expect = ( n == 0u ) ? PS2_EVT_MAKE :
+                    ( n < REPEAT_CODES ) ? (PS2_EVT_MAKE | PS2_EVT_REPEAT) : 0;
+      if( event.keycode != 0x04 || event.ascii != 'a' || flags != expect )
+        failed = 1;
+      if( flags & PS2_EVT_REPEAT )
+        repeats++;
+      n++;
+    }
+  }
+  if( n != REPEAT_CODES + 1u )
+    failed = 1;
+  printf("repeat check : %lu events, %lu repeats %s\n", (unsigned long)n,
+         (unsigned long)repeats, failed ? "FAIL" : "OK");
+  PS2_Trace_Free(&trace);
+  return failed;
+}
+
+/**
+ * @brief Replay one Frame with a given Bit Period.
+ * @return Number of key events decoded.
+ */
+static u32_t Frame_Replay( u8_t code, u32_t start_us, u32_t period_us )
+{
+  PS2_Trace_s trace;
+  PS2_Key_Event_s event;
+  size_t i;
+  u32_t n = 0;
+  PS2_Trace_Init(&trace);
+  PS2_Trace_Add_Byte(&trace, code);
+  for( i = 0; i < trace.count; i++ )
+  {
+    trace.edges[i].time_us = start_us + (u32_t)i * period_us;
+    PS2_Trace_Replay_Edge(&trace.edges[i]);
+  }
+  PS2_Trace_Free(&trace);
+  while( PS2_Get_Event(PS2_PORT_KEYBOARD, &event) )
+    n++;
+  return n;
+}
+
+/**
+ * @brief Stale Frame Timeout.
+ *
+ * A slow frame (100 us bits) which starts just before a milli-second tick
+ * must be received, a frame whose last bit comes more than
+ * PS2_FRAME_TIMEOUT_US after its start bit must be discarded, wherever it
+ * falls within the milli-second.
+ * @return 0 if the timeout is exact.
+ */
+static int Check_Frame_Timeout( void )
+{
+  u32_t timeouts = PS2_Get_Stats(PS2_PORT_KEYBOARD)->timeouts;
+  u32_t tick = (host_time_us / 1000u + 10u) * 1000u;
+  int failed = 0;
+  // Make and Break of 'a', 1 ms each
+  if( Frame_Replay(0x1C, tick + 999u, 100u) != 1u ||
+      Frame_Replay(PS2_BREAK, tick + 5999u, 100u) != 0u ||
+      Frame_Replay(0x1C, tick + 10999u, 100u) != 1u ||
+      PS2_Get_Stats(PS2_PORT_KEYBOARD)->timeouts != timeouts )
+    failed = 1;
+  // 2.5 ms Frame starting on a tick is stale
+  if( Frame_Replay(0x1C, tick + 20000u, 250u) != 0u ||
+      PS2_Get_Stats(PS2_PORT_KEYBOARD)->timeouts != timeouts + 1u )
+    failed = 1;
+  PS2_Resync(PS2_PORT_KEYBOARD);
+  printf("frame timeout: %u us, slow frame received, stale frame %s\n",
+         (unsigned)PS2_FRAME_TIMEOUT_US, failed ? "FAIL" : "discarded");
+  return failed;
+}
+
+/**
+ * @brief Host to Keyboard Command.
+ *
+ * Set LEDs is sent, first byte is answered with Resend and must be sent
+ * again, both bytes are answered with ACK afterwards.
+ * @return 0 if bytes are sent as expected.
+ */
+static int Check_Command( void )
+{
+  static const int expect[] = { PS2_CMD_SET_LEDS, PS2_CMD_SET_LEDS, PS2_LED_CAPS };
+  static const u8_t reply[] = { PS2_REPLY_RESEND, PS2_REPLY_ACK, PS2_REPLY_ACK };
+  size_t i;
+  int failed = 0, value;
+  u32_t commands = PS2_Get_Stats(PS2_PORT_KEYBOARD)->commands;
+  PS2_Set_Leds(PS2_PORT_KEYBOARD, PS2_LED_CAPS);
+  for( i = 0; i < NELEMENTS(expect); i++ )
+  {
+    value = PS2_Trace_Device_Receive(PS2_PORT_KEYBOARD);
+    if( value != expect[i] )
+      failed = 1;
+    PS2_Trace_Device_Send(PS2_PORT_KEYBOARD, reply[i]);
+    PS2_Command_Task();
+  }
+  if( IS_PS2_Command_Pending(PS2_PORT_KEYBOARD) || PS2_Get_Stats(PS2_PORT_KEYBOARD)->commands - commands != 2u )
+    failed = 1;
+  printf("command check: %s\n", failed ? "FAIL" : "OK");
+  return failed;
+}
+
+/**
+ * @brief Resend Request with a full Command Queue.
+ *
+ * Four Set LEDs commands fill the queue, then a frame with parity error is
+ * received. The Resend request must wait until a slot is free and must not
+ * split a command from its argument, no queued byte may be dropped.
+ * @return 0 if bytes are sent as expected.
+ */
+static int Check_Resend_Full( void )
+{
+  static const int expect[] = {
+    PS2_CMD_SET_LEDS, 1, PS2_CMD_RESEND, PS2_CMD_SET_LEDS, 2,
+    PS2_CMD_SET_LEDS, 3, PS2_CMD_SET_LEDS, 4
+  };
+  PS2_Trace_s trace;
+  size_t i;
+  int failed = 0, value;
+  u8_t leds;
+  for( leds = 1; leds <= 4u; leds++ )
+  {
+    if( !PS2_Set_Leds(PS2_PORT_KEYBOARD, leds) )
+      failed = 1;
+  }
+  if( PS2_Set_Leds(PS2_PORT_KEYBOARD, 5u) )
+    failed = 1;
+  // Frame with wrong Parity Bit
+  PS2_Trace_Init(&trace);
+  trace.time_us = host_time_us;
+  PS2_Trace_Add_Byte(&trace, 0x1C);
+  trace.edges[9].data ^= 1u;
+  for( i = 0; i < trace.count; i++ )
+    PS2_Trace_Replay_Edge(&trace.edges[i]);
+  PS2_Trace_Free(&trace);
+  for( i = 0; i < NELEMENTS(expect); i++ )
+  {
+    value = PS2_Trace_Device_Receive(PS2_PORT_KEYBOARD);
+    if( value != expect[i] )
+      failed = 1;
+    if( value != PS2_CMD_RESEND )
+      PS2_Trace_Device_Send(PS2_PORT_KEYBOARD, PS2_REPLY_ACK);
+    PS2_Command_Task();
+  }
+  if( IS_PS2_Command_Pending(PS2_PORT_KEYBOARD) )
+    failed = 1;
+  printf("resend check : %s\n", failed ? "FAIL" : "OK");
+  return failed;
+}
+
+/**
+ * @brief Keyboard and Barcode Wedge typing at the same time.
+ *
+ * Both traces are replayed through PS2_GPIO_IRQHandler() with the simulated
+ * interrupt status. Auxiliary trace starts a few bits later, so the edges of
+ * both Ports coincide in a part of the trace and interleave in the rest.
+ * Coinciding edges must be serviced by a single interrupt.
+ * @return 0 if both Ports decode their own keys.
+ */
+static int Check_Multi_Port( void )
+{
+  static const char kbd_text[] = "Hello World";
+  static const char aux_text[] = "4711-0042-99";
+  PS2_Trace_s trace[PS2_PORTS];
+  const PS2_Pins_s pins[PS2_PORTS] = {
+    {PS2_CLK_PORT, PS2_CLK_PIN, PS2_DATA_PORT, PS2_DATA_PIN},
+    {PS2_AUX_CLK_PORT, PS2_AUX_CLK_PIN, PS2_AUX_DATA_PORT, PS2_AUX_DATA_PIN}
+  };
+  char keys[PS2_PORTS][PS2_TRACE_EXPECT_MAX];
+  size_t edge[PS2_PORTS] = {0, 0}, n[PS2_PORTS] = {0, 0};
+  u8_t buf[SCAN_CODE_MAX];
+  u8_t port, got, k, gpio;
+  u32_t now;
+  unsigned long irqs = 0;
+  int failed = 0;
+  for( port = 0; port < PS2_PORTS; port++ )
+  {
+    const char *text = port ? aux_text : kbd_text;
+    PS2_Trace_Init(&trace[port]);
+    trace[port].time_us = host_time_us + 10000u + (port ? 400u : 0u);
+    while( *text )
+      PS2_Trace_Add_Key(&trace[port], *text++);
+  }
+  while( edge[0] < trace[0].count || edge[1] < trace[1].count )
+  {
+    // Next Edge time of any Port, all Ports with an edge now are pending
+    now = 0xFFFFFFFFu;
+    for( port = 0; port < PS2_PORTS; port++ )
+    {
+      if( edge[port] < trace[port].count &&
+          trace[port].edges[edge[port]].time_us < now )
+        now = trace[port].edges[edge[port]].time_us;
+    }
+    host_time_us = now;
+    for( port = 0; port < PS2_PORTS; port++ )
+    {
+      if( edge[port] < trace[port].count &&
+          trace[port].edges[edge[port]].time_us == now )
+      {
+        if( trace[port].edges[edge[port]].data )
+          host_gpio_data[pins[port].data_port] |= (1u << pins[port].data_pin);
+        else
+          host_gpio_data[pins[port].data_port] &= ~(1u << pins[port].data_pin);
+        host_gpio_mis[pins[port].clk_port] |= (1u << pins[port].clk_pin);
+        edge[port]++;
+      }
+    }
+    for( gpio = 0; gpio < PS2_GPIO_PORTS; gpio++ )
+    {
+      if( host_gpio_mis[gpio] )
+      {
+        PS2_GPIO_IRQHandler(gpio);
+        irqs++;
+      }
+    }
+    for( port = 0; port < PS2_PORTS; port++ )
+    {
+      got = PS2_ReadKeys(port, buf, SCAN_CODE_MAX);
+      for( k = 0; k < got && n[port] + 1u < PS2_TRACE_EXPECT_MAX; k++ )
+        keys[port][n[port]++] = (char)buf[k];
+    }
+  }
+  for( port = 0; port < PS2_PORTS; port++ )
+  {
+    keys[port][n[port]] = '\0';
+    if( strcmp(keys[port], trace[port].expected) != 0 )
+      failed = 1;
+  }
+  printf("multi port   : \"%s\" / \"%s\" %s, %lu edges in %lu interrupts\n",
+         keys[0], keys[1], failed ? "FAIL" : "OK",
+         (unsigned long)(trace[0].count + trace[1].count), irqs);
+  for( port = 0; port < PS2_PORTS; port++ )
+    PS2_Trace_Free(&trace[port]);
+  return failed;
+}
+
+int main( int argc, char **argv )
+{
+  PS2_Keyboard_Init();
+  if( argc == 4 && strcmp(argv[1], "-w") == 0 )
+  {
+    return Write_Trace(argv[2], argv[3]);
+  }
+  if( argc > 1 )
+  {
+    return Replay_Files(argc - 1, argv + 1) ? 1 : 0;
+  }
+  return Check_Events() | Check_Repeat() | Check_Frame_Timeout() |
+         Check_Command() | Check_Resend_Full() | Check_Multi_Port() |
+         Check_Wake() | Bench_Synthetic() | Bench_Lost_Edge();
+}
@@ -0,0 +1,172 @@
+/**
+ * @file bench_queue.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, PS2 scan code queue.
+ *
+ * Compares the lock-free SPSC ring used by ps2_keyboard.c with the previous
+ * signed front/rear Queue implementation. The queue functions are private to
+ * ps2_keyboard.c, so the source file is included directly.
+ * The ring is not faster on the host, the speedup is about 1.0x. Its gain is
+ * safety: the interrupt only writes head and the main loop only tail, so no
+ * interrupt masking is needed.
+ * @note On target the old Delete_From_Queue(kbd) also disabled and enabled the
+ * interrupts on every call, that cost is not visible on the host.
+ */
+
+#include <stdio.h>
+#include "../Application/ps2_keyboard.c"
+#include "host_bench.h"
+
+/** Keyboard Port, benchmarks only use this one. */
+static PS2_Port_s *const kbd = &ports[PS2_PORT_KEYBOARD];
+
+#define LEGACY_SCAN_CODE_MAX  20  /**< Old Queue Size. */
+#define BENCH_ROUNDS          2000000ul
+#define BENCH_BURST           16u
+
+/* Legacy Queue, as it was before the SPSC ring -------------------------- */
+typedef struct
+{
+  s8_t front;
+  s8_t rear;
+  u8_t scan_codes_buffer[LEGACY_SCAN_CODE_MAX];
+} Legacy_Queue_s;
+
+static Legacy_Queue_s l_queue = {0,-1,{0}};
+
+static boolean Legacy_Insert( u8_t scan_code )
+{
+  boolean inserted = FALSE;
+  if ((l_queue.front == 0 && l_queue.rear == LEGACY_SCAN_CODE_MAX-1) ||
+      (l_queue.front > 0 && l_queue.rear == l_queue.front-1))
+  {
+    inserted = FALSE;
+  }
+  else
+  {
+    if (l_queue.rear == LEGACY_SCAN_CODE_MAX-1 && l_queue.front > 0)
+    {
+      l_queue.rear = 0;
+      l_queue.scan_codes_buffer[l_queue.rear] = scan_code;
+    }
+    else
+    {
+      if ((l_queue.front == 0 && l_queue.rear == -1) 
+          || (l_queue.rear != l_queue.front-1) )
+      {
+        l_queue.rear++;
+        l_queue.scan_codes_buffer[l_queue.rear] = scan_code;
+      }
+      inserted = TRUE;
+    }
+  }
+  return inserted;
+}
+
+static u8_t Legacy_Delete( void )
+{
+  u8_t data = 0;
+  __disable_interrupt();
+  if ( l_queue.front == l_queue.rear )
+  {
+    data = l_queue.scan_codes_buffer[l_queue.front];
+    l_queue.scan_codes_buffer[l_queue.front] = 0;
+    l_queue.rear = -1;
+    l_queue.front = 0;
+  }
+  else if( l_queue.front == LEGACY_SCAN_CODE_MAX-1 )
+  {
+    data = l_queue.scan_codes_buffer[l_queue.front];
+    l_queue.scan_codes_buffer[l_queue.front] = 0x00;
+    l_queue.front = 0;
+  }
+  else 
+  {
+    data = l_queue.scan_codes_buffer[l_queue.front];
+    l_queue.scan_codes_buffer[l_queue.front] = 0x00;
+    l_queue.front++;
+  }
+  __enable_interrupt();
+  return data;
+}
+
+/* Benchmarks -------------------------------------------------------------- */
+static double Bench_Legacy( void )
+{
+  u32_t sum = 0;
+  uint64_t start, stop;
+  unsigned long r;
+  u8_t i;
+  start = host_now_ns();
+  for( r = 0; r < BENCH_ROUNDS; r++ )
+  {
+    for( i = 0; i < BENCH_BURST; i++ )
+      Legacy_Insert( (u8_t)(r + i) );
+    for( i = 0; i < BENCH_BURST; i++ )
+      sum += Legacy_Delete();
+  }
+  stop = host_now_ns();
+  host_sink(sum);
+  return (2.0 * BENCH_ROUNDS * BENCH_BURST) * 1e9 / (double)(stop - start);
+}
+
+static double Bench_Ring( void )
+{
+  u32_t sum = 0;
+  uint64_t start, stop;
+  unsigned long r;
+  u8_t i;
+  start = host_now_ns();
+  for( r = 0; r < BENCH_ROUNDS; r++ )
+  {
+    for( i = 0; i < BENCH_BURST; i++ )
+      Insert_In_Queue( kbd, (u8_t)(r + i), i );
+    for( i = 0; i < BENCH_BURST; i++ )
+      sum += Delete_From_Queue(kbd);
+  }
+  stop = host_now_ns();
+  host_sink(sum);
+  return (2.0 * BENCH_ROUNDS * BENCH_BURST) * 1e9 / (double)(stop - start);
+}
+
+/**
+ * @brief Checks that both queues give back the same FIFO order, including
+ * the wrap around of the indices.
+ */
+static int Check_Order( void )
+{
+  u32_t r;
+  u8_t i, a, b;
+  for( r = 0; r < 1000u; r++ )
+  {
+    for( i = 0; i < 7u; i++ )
+    {
+      Legacy_Insert( (u8_t)(r*7u + i) );
+      Insert_In_Queue( kbd, (u8_t)(r*7u + i), i );
+    }
+    for( i = 0; i < 7u; i++ )
+    {
+      a = Legacy_Delete();
+      b = Delete_From_Queue(kbd);
+      if( a != b || b != (u8_t)(r*7u + i) )
+        return 0;
+    }
+  }
+  return IS_Queue_Empty(kbd);
+}
+
+int main( void )
+{
+  double legacy, ring;
+  if( !Check_Order() )
+  {
+    printf("queue: FIFO order mismatch\n");
+    return 1;
+  }
+  legacy = Bench_Legacy();
+  ring = Bench_Ring();
+  printf("queue legacy : %12.0f ops/sec\n", legacy);
+  printf("queue ring   : %12.0f ops/sec\n", ring);
+  printf("speedup      : %12.2fx\n", ring / legacy);
+  return 0;
+}
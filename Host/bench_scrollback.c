@@ -0,0 +1,199 @@
+/**
+ * @file bench_scrollback.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, Scrollback History.
+ *
+ * Lines of random length are written into the history until it has wrapped
+ * many times, every line is also kept wrapped at 16 columns in a large
+ * array. After every few lines the window on both rows of the LCD model is
+ * scrolled with Up, Down, Page Up and Page Down and compared with the array.
+ * The history must keep at least as many lines as fit in the arena and the
+ * line index. The time to scroll and draw the window is printed with a
+ * nearly empty and with a full history, the line index makes both the same.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "lcd_16x2.h"
+#include "lcd_fb.h"
+#include "scrollback.h"
+#include "host_lcd.h"
+#include "host_bench.h"
+
+#define BENCH_LINES     20000u    /**< Lines written. */
+#define BENCH_SCROLLS   200000u   /**< Timed Scroll Keys. */
+#define REF_LINES       (BENCH_LINES * 4u)
+
+static char ref[REF_LINES][17];
+static u32_t ref_lines = 0;
+
+/**
+ * @brief Key Press to the Scrollback.
+ */
+static void Press( u8_t keycode )
+{
+  PS2_Key_Event_s event;
+  memset(&event, 0, sizeof(event));
+  event.keycode = keycode;
+  event.flags = PS2_EVT_MAKE;
+  host_check(Scrollback_Key(&event));
+}
+
+/**
+ * @brief Write a Line into the History and the Array.
+ */
+static void Write_Line( u32_t length )
+{
+  char c;
+  u32_t i, column = 0;
+  for( i = 0; i < length; i++ )
+  {
+    c = (char)('a' + host_random(26u));
+    if( column == 16u || i == 0u )
+    {
+      memset(ref[ref_lines], 0, 17u);
+      ref_lines++;
+      column = 0;
+    }
+    ref[ref_lines - 1u][column++] = c;
+    Scrollback_Putc(c);
+  }
+  if( length == 0u )
+  {
+    memset(ref[ref_lines], 0, 17u);
+    ref_lines++;
+  }
+  Scrollback_Putc('\n');
+}
+
+/**
+ * @brief Compare the LCD Model with the Array.
+ * @param scroll Lines the Window is expected to be scrolled back.
+ */
+static void Check( u32_t scroll )
+{
+  char row[17], expected[17];
+  u32_t r, line;
+  Scrollback_Render();
+  LCD_FB_Flush();
+  host_check(Scrollback_Get_Scroll() == scroll);
+  for( r = 0; r < 2u; r++ )
+  {
+    line = ref_lines - 2u - scroll + r;
+    snprintf(expected, sizeof(expected), "%-16s", ref[line]);
+    host_lcd_row((u8_t)r, row);
+    host_check(strcmp(row, expected) == 0);
+  }
+}
+
+/**
+ * @brief Random Lines and Scrolling, checked against the Array.
+ */
+static void Random_History( void )
+{
+  const Scrollback_Stats_s *stats = Scrollback_Get_Stats();
+  u32_t l, lines, scroll, limit, k, keys, min_lines = 0xFFFFFFFFu;
+  u8_t keycode;
+  LCD_Init();
+  LCD_FB_Init();
+  Scrollback_Init(0, 2);
+  // Two Lines, the Window is full
+  Write_Line(5u);
+  Write_Line(5u);
+  for( l = 0; l < BENCH_LINES; l++ )
+  {
+    Write_Line(host_random(40u));
+    lines = Scrollback_Get_Lines();
+    host_check(lines <= ref_lines);
+    if( ref_lines > 2u * SCROLLBACK_LINES && lines < min_lines )
+      min_lines = lines;
+    if( l % 7u == 0u )
+    {
+      scroll = 0;
+      limit = lines - 2u;
+      Check(0);
+      keys = host_random(12u);
+      for( k = 0; k < keys; k++ )
+      {
+        keycode = PS2_KEY_PAGEUP;
+        switch( host_random(4u) )
+        {
+          case 0:
+            keycode = PS2_KEY_UP;
+            scroll = ( scroll < limit ) ? scroll + 1u : limit;
+            break;
+          case 1:
+            keycode = PS2_KEY_DOWN;
+            scroll = ( scroll > 0u ) ? scroll - 1u : 0u;
+            break;
+          case 2:
+            scroll = ( scroll + SCROLLBACK_PAGE < limit ) ?
+                     scroll + SCROLLBACK_PAGE : limit;
+            break;
+          default:
+            keycode = PS2_KEY_PAGEDOWN;
+            scroll = ( scroll > SCROLLBACK_PAGE ) ?
+                     scroll - SCROLLBACK_PAGE : 0u;
+            break;
+        }
+        Press(keycode);
+        Check(scroll);
+      }
+      // New Lines keep the Window on the same Lines, unless they are dropped
+      if( scroll > 0u )
+      {
+        Write_Line(3u);
+        limit = Scrollback_Get_Lines() - 2u;
+        Check(( scroll + 1u < limit ) ? scroll + 1u : limit);
+      }
+      while( Scrollback_Get_Scroll() > 0u )
+        Press(PS2_KEY_PAGEDOWN);
+    }
+  }
+  printf("scrollback    : %lu lines, %lu wrapped, %lu dropped, at least %lu "
+         "kept, %lu renders\n", (unsigned long)BENCH_LINES,
+         (unsigned long)stats->lines, (unsigned long)stats->dropped,
+         (unsigned long)min_lines, (unsigned long)stats->renders);
+  // Every Line has 16 Characters at most
+  host_check(min_lines >= SCROLLBACK_SIZE / 16u - 1u ||
+             min_lines >= SCROLLBACK_LINES - 1u);
+  host_check(host_lcd_clears == 0u);
+}
+
+/**
+ * @brief Time of a Scroll Key and drawing the Window.
+ * @return nano-seconds per Key.
+ */
+static double Scroll_Time( u32_t lines )
+{
+  uint64_t start, stop;
+  u32_t s;
+  LCD_FB_Init();
+  Scrollback_Init(0, 2);
+  ref_lines = 0;
+  for( s = 0; s < lines; s++ )
+    Write_Line(16u);
+  start = host_now_ns();
+  for( s = 0; s < BENCH_SCROLLS; s++ )
+  {
+    Press(( s & 1u ) ? PS2_KEY_DOWN : PS2_KEY_UP);
+    Scrollback_Render();
+  }
+  stop = host_now_ns();
+  host_sink(Scrollback_Get_Scroll());
+  return (double)(stop - start) / BENCH_SCROLLS;
+}
+
+int main( void )
+{
+  double empty_ns, full_ns;
+  host_seed = 4711u;
+  Random_History();
+  empty_ns = Scroll_Time(3u);
+  full_ns = Scroll_Time(10u * SCROLLBACK_LINES);
+  printf("scrollback    : %.1f ns/scroll with 3 lines, %.1f ns/scroll with "
+         "%lu lines\n", empty_ns, full_ns,
+         (unsigned long)Scrollback_Get_Lines());
+  printf("scrollback    : %s\n", host_failed ? "FAILED" : "OK");
+  return host_failed;
+}
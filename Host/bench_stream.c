@@ -0,0 +1,104 @@
+/**
+ * @file bench_stream.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, Binary Key Event Stream.
+ *
+ * A barcode scanner on the auxiliary port sends codes with the bytes back to
+ * back, the fastest a PS2 device sends. The main loop of main.c is simulated,
+ * every key event goes to the key stream, which is written to stdout. The
+ * share of a 115200 baud UART needed during the burst is printed, pipe the
+ * stream into key_stream_decode to check it. With drop_every every n-th frame
+ * is lost on the line, the decoder has to report the lost frames.
+ *
+ * Usage:
+ * @code
+ * bench_stream [drop_every] | key_stream_decode
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "ps2_trace.h"
+#include "key_stream.h"
+#include "host_clock.h"
+#include "host_uart.h"
+
+#define BENCH_CODES     200u      /**< Barcodes scanned. */
+#define CODE_GAP_US     20000u    /**< Time between Barcodes. */
+#define UART_BITS       10u       /**< Start, 8 Data and Stop Bit. */
+
+static const char barcode[] = "4711-0042-99";
+
+/**
+ * @brief Scan Code of a Character, unshifted Keys only.
+ */
+static u8_t Scan_Code( char c )
+{
+  u8_t code;
+  for( code = 1; code < PS2_SET2_MAX && PS2_KeyMap[0][code] != (u8_t)c; code++ )
+    ;
+  return code;
+}
+
+/**
+ * @brief Main Loop of main.c, key events go to the stream.
+ */
+static void Main_Loop( void )
+{
+  PS2_Key_Event_s event;
+  while( PS2_Get_Event(PS2_PORT_AUX, &event) )
+    Key_Stream_Event(PS2_PORT_AUX, &event);
+  Key_Stream_Task();
+}
+
+int main( int argc, char **argv )
+{
+  const Key_Stream_Stats_s *stats = Key_Stream_Get_Stats();
+  PS2_Trace_s trace;
+  u32_t start, burst_us = 0, code_start;
+  unsigned long keys = 0;
+  size_t e = 0, i;
+  u32_t c;
+
+  host_uart_drop_every = (argc > 1) ? (u32_t)atoi(argv[1]) : 0u;
+  PS2_Keyboard_Init();
+  Key_Stream_Init();
+  PS2_Trace_Init(&trace);
+  trace.time_us = host_time_us + 1000u;
+  start = trace.time_us;
+  for( c = 0; c < BENCH_CODES; c++ )
+  {
+    code_start = trace.time_us;
+    for( i = 0; barcode[i]; i++ )
+    {
+      u8_t code = Scan_Code(barcode[i]);
+      PS2_Trace_Add_Byte(&trace, code);
+      PS2_Trace_Add_Byte(&trace, PS2_BREAK);
+      PS2_Trace_Add_Byte(&trace, code);
+      keys++;
+    }
+    burst_us += trace.time_us - code_start;
+    PS2_Trace_Idle(&trace, CODE_GAP_US);
+  }
+  while( e < trace.count )
+  {
+    PS2_Trace_Replay_Port_Edge(PS2_PORT_AUX, &trace.edges[e++]);
+    Main_Loop();
+  }
+  host_time_us += KEY_STREAM_WINDOW_US + 1u;
+  Main_Loop();
+  fflush(stdout);
+
+  fprintf(stderr, "stream: %lu keys, %lu events, %lu frames, %.2f bytes/event,"
+          " window %u us\n", keys, (unsigned long)stats->events,
+          (unsigned long)stats->frames,
+          (double)stats->bytes / (stats->events ? stats->events : 1u),
+          (unsigned)KEY_STREAM_WINDOW_US);
+  fprintf(stderr, "stream: %.1f%% of %u baud during bursts, %.1f%% overall\n",
+          100.0 * stats->bytes * UART_BITS * 1e6 / burst_us /
+          KEY_STREAM_BAUDRATE, (unsigned)KEY_STREAM_BAUDRATE,
+          100.0 * stats->bytes * UART_BITS * 1e6 / (host_time_us - start) /
+          KEY_STREAM_BAUDRATE);
+  PS2_Trace_Free(&trace);
+  return ( stats->events == 2u * keys && stats->dropped == 0u ) ? 0 : 1;
+}
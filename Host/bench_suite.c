@@ -0,0 +1,90 @@
+/**
+ * @file bench_suite.c
+ * @author Embedded Laboratory
+ * @brief Host Runner of the Benchmark Suite on the Virtual Board.
+ *
+ * The firmware is built with BENCH_SUITE set to 1, so main() runs
+ * Bench_Suite_Run() (Application/bench_suite.c) on the virtual board. The
+ * JSON lines of its UART output are written to stdout, other lines are
+ * dropped. Built with BENCH_SUITE_NS the suite times with the wall clock of
+ * the host in nano-seconds, driver times then include the register models.
+ * Built without, it reports the DWT cycles of the virtual board, where only
+ * register accesses, interrupts and waiting take time; these lines carry
+ * "clock":"vboard", they are simulated and not cycle accurate.
+ * Exit status is 1 if the suite didn't finish or a benchmark had errors.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "bench_suite.h"
+#include "vboard.h"
+#include "host_bench.h"
+
+#define SUITE_SLICE_US      1000000u  /**< Virtual Time between Checks. */
+#define SUITE_TIMEOUT_US    60000000u /**< Longest Run of the Suite. */
+
+#if BENCH_SUITE_NS
+/**
+ * @brief Time Base of the Suite, Wall Clock of the Host.
+ */
+u32_t Bench_Suite_Clock( void )
+{
+  return (u32_t)host_now_ns();
+}
+#endif
+
+/**
+ * @brief Text in a Span of the UART Output.
+ */
+static int Contains( const u8_t *data, u32_t length, const char *text )
+{
+  u32_t i, n = (u32_t)strlen(text);
+  for( i = 0; i + n <= length; i++ )
+  {
+    if( memcmp(data + i, text, n) == 0 )
+      return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Last Line of the Suite received.
+ */
+static int Suite_Done( void )
+{
+  u32_t length;
+  const u8_t *output = vboard_uart_output(&length);
+  return Contains(output, length, "\"suite\":\"end\"");
+}
+
+int main( void )
+{
+  const u8_t *output;
+  u32_t length, us, start, i;
+  int failed = 0;
+  vboard_boot();
+  for( us = 0; us < SUITE_TIMEOUT_US && !Suite_Done(); us += SUITE_SLICE_US )
+    vboard_run_us(SUITE_SLICE_US);
+  if( !Suite_Done() )
+  {
+    printf("suite not finished\n");
+    return 1;
+  }
+  // JSON lines end with CR LF on the UART
+  output = vboard_uart_output(&length);
+  for( start = 0, i = 0; i < length; i++ )
+  {
+    if( output[i] != '\n' )
+      continue;
+    if( output[start] == '{' )
+    {
+      fwrite(output + start, 1, i - start - 1u, stdout);
+      fputc('\n', stdout);
+      if( Contains(output + start, i - start, "\"errors\":") &&
+          !Contains(output + start, i - start, "\"errors\":0}") )
+        failed = 1;
+    }
+    start = i + 1u;
+  }
+  return failed;
+}
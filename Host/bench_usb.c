@@ -0,0 +1,350 @@
+/**
+ * @file bench_usb.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, USB HID Keyboard Bridge.
+ *
+ * The benchmark is the USB host: it enumerates the keyboard through the host
+ * USB stub, then keys are typed on the PS2 port while the host polls the
+ * interrupt endpoint every poll period. The main loop of main.c is simulated,
+ * it takes key events only while the endpoint is free. Reports are decoded
+ * like a host does, every report must change exactly one key and the typed
+ * text must come out in both report formats and with a slow host. Rollover,
+ * LED reports, an OUT packet longer than wLength and the idle rate are
+ * checked on their own.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "ps2_trace.h"
+#include "usb_hid.h"
+#include "host_usb.h"
+#include "host_clock.h"
+#include "host_bench.h"
+
+#define BENCH_KEYS      200u      /**< Keys Typed per Run. */
+#define ROLL_KEYS       8u        /**< Keys held down in Rollover Check. */
+
+static const char bench_text[] = "the quick brown fox jumps over the lazy dog";
+static const u8_t roll_codes[ROLL_KEYS] = {     // a s d f g h j k
+  0x1C, 0x1B, 0x23, 0x2B, 0x34, 0x33, 0x3B, 0x42
+};
+
+/**
+ * @brief Key State seen by the Host.
+ */
+typedef struct
+{
+  u8_t keys[32];        /**< Pressed Keys from the Reports. */
+  u8_t modifiers;       /**< Modifiers from the Reports. */
+  char text[BENCH_KEYS + 1u];   /**< Letters pressed. */
+  u32_t length;         /**< Letters in text. */
+  u32_t reports;        /**< Reports received. */
+  u32_t bad_reports;    /**< Reports which changed not exactly one key. */
+  u32_t rollovers;      /**< Boot Reports with too many Keys. */
+  u32_t max_keys;       /**< Most Keys pressed at once. */
+  u32_t key_start[BENCH_KEYS];  /**< Start Bit Time of each typed Key. */
+  u64_t latency_us;     /**< Start Bit to Host Poll, all Keys. */
+  u32_t max_latency_us; /**< Start Bit to Host Poll, slowest Key. */
+} Host_Keyboard_s;
+
+static Host_Keyboard_s host;
+
+/**
+ * @brief Check a Condition, failures are counted.
+ */
+static void Check( int ok, const char *what )
+{
+  if( !ok )
+  {
+    printf("  FAIL %s\n", what);
+    host_check(0);
+  }
+}
+
+/**
+ * @brief Main Loop of main.c with the Bridge enabled.
+ */
+static void Main_Loop( void )
+{
+  PS2_Key_Event_s event;
+  while( IS_USB_HID_Ready() && PS2_Get_Event(PS2_PORT_KEYBOARD, &event) )
+    USB_HID_Key_Event(PS2_PORT_KEYBOARD, &event);
+  USB_HID_Task();
+}
+
+/**
+ * @brief Host decodes a Report.
+ */
+static void Host_Report( const u8_t *report, int length )
+{
+  u8_t keys[32];
+  u32_t i, changes = 0, count = 0, usage;
+  memset(keys, 0, sizeof(keys));
+  if( length == USB_HID_BOOT_LEN )
+  {
+    if( report[2] == USB_HID_ROLLOVER )
+    {
+      // Host keeps the previous state on ErrorRollOver
+      host.rollovers++;
+      host.reports++;
+      return;
+    }
+    for( i = 2; i < USB_HID_BOOT_LEN; i++ )
+      if( report[i] )
+        keys[report[i] >> 3] |= (u8_t)(1u << (report[i] & 7u));
+  }
+  else
+  {
+    memcpy(keys, &report[1], (size_t)length - 1u);
+  }
+  changes += (u32_t)__builtin_popcount(report[0] ^ host.modifiers);
+  for( usage = 0; usage < 256u; usage++ )
+  {
+    u8_t mask = (u8_t)(1u << (usage & 7u));
+    u8_t now = keys[usage >> 3] & mask, before = host.keys[usage >> 3] & mask;
+    if( now )
+      count++;
+    if( now == before )
+      continue;
+    changes++;
+    if( now && host.length < BENCH_KEYS )
+    {
+      // Letters and Space of the bench text
+      u32_t latency = host_time_us - host.key_start[host.length];
+      host.text[host.length++] = (char)(( usage == 0x2Cu ) ? ' ' :
+                                        'a' + (usage - 0x04u));
+      host.latency_us += latency;
+      if( latency > host.max_latency_us )
+        host.max_latency_us = latency;
+    }
+  }
+  if( host.reports && changes != 1u )
+    host.bad_reports++;
+  if( count > host.max_keys )
+    host.max_keys = count;
+  memcpy(host.keys, keys, sizeof(keys));
+  host.modifiers = report[0];
+  host.reports++;
+}
+
+/**
+ * @brief Replay a Trace while the Host polls every poll_us.
+ *
+ * Host keeps polling after the last edge until nothing is left.
+ */
+static void Run( const PS2_Trace_s *trace, u32_t poll_us )
+{
+  u8_t report[HOST_USB_PACKET];
+  u32_t next_poll = host_time_us + poll_us, idle = 0;
+  size_t e = 0;
+  int length;
+  while( e < trace->count || idle < 100u )
+  {
+    if( e < trace->count && trace->edges[e].time_us < next_poll )
+    {
+      PS2_Trace_Replay_Edge(&trace->edges[e++]);
+    }
+    else
+    {
+      host_time_us = next_poll;
+      next_poll += poll_us;
+      length = host_usb_poll(USB_HID_EP_IN, report);
+      if( length > 0 )
+        Host_Report(report, length);
+      idle = ( length > 0 || e < trace->count ) ? 0 : idle + 1u;
+    }
+    Main_Loop();
+  }
+}
+
+/**
+ * @brief Enumerate the Keyboard like a Host does.
+ */
+static void Enumerate( void )
+{
+  u8_t buf[256];
+  int n;
+  n = host_usb_control(0x80, USB_GET_DESCRIPTOR, USB_DESC_DEVICE << 8, 0, 64,
+                       buf);
+  Check(n == 18 && buf[1] == USB_DESC_DEVICE && buf[7] == USB_EP0_MAXPACKET,
+        "device descriptor");
+  n = host_usb_control(0x00, USB_SET_ADDRESS, 5, 0, 0, buf);
+  Check(n == 0 && host_usb_address == 5u, "set address");
+  n = host_usb_control(0x80, USB_GET_DESCRIPTOR, USB_DESC_CONFIG << 8, 0, 9,
+                       buf);
+  Check(n == 9, "configuration header");
+  n = host_usb_control(0x80, USB_GET_DESCRIPTOR, USB_DESC_CONFIG << 8, 0,
+                       (u16_t)(buf[2] | (buf[3] << 8)), buf);
+  // Boot Keyboard Interface, HID Descriptor and 1 ms Interrupt Endpoint
+  Check(n == 34 && buf[9 + 5] == 0x03 && buf[9 + 6] == 0x01 &&
+        buf[9 + 7] == 0x01, "boot keyboard interface");
+  Check(buf[18 + 1] == USB_DESC_HID &&
+        buf[18 + 7] == USB_HID_REPORT_DESC_LEN, "hid descriptor");
+  Check(buf[27 + 2] == USB_HID_EP_IN && buf[27 + 3] == 0x03 &&
+        buf[27 + 6] == 1u, "interrupt endpoint, 1 ms");
+  n = host_usb_control(0x80, USB_GET_DESCRIPTOR, USB_DESC_STRING << 8 | 2,
+                       0x0409, 255, buf);
+  Check(n == 2 + 2 * (int)strlen("PS2 Keyboard Bridge") && buf[2] == 'P',
+        "product string");
+  n = host_usb_control(0x80, USB_GET_DESCRIPTOR, 0x0700, 0, 10, buf);
+  Check(n < 0, "unknown descriptor stalls");
+  n = host_usb_control(0x00, USB_SET_CONFIGURATION, 1, 0, 0, buf);
+  Check(n == 0 && host_usb_configured && IS_USB_Configured(),
+        "set configuration");
+  n = host_usb_control(0x81, USB_GET_DESCRIPTOR, USB_DESC_REPORT << 8, 0,
+                       USB_HID_REPORT_DESC_LEN + 64u, buf);
+  Check(n == USB_HID_REPORT_DESC_LEN && buf[n - 1] == 0xC0,
+        "report descriptor");
+  // Linux turns the idle reports off
+  n = host_usb_control(0x21, USB_HID_SET_IDLE, 0, 0, 0, buf);
+  Check(n == 0, "set idle");
+  // Current key state is sent right after configuration
+  Main_Loop();
+  n = host_usb_poll(USB_HID_EP_IN, buf);
+  Check(n == USB_HID_NKRO_LEN, "first report after configuration");
+}
+
+/**
+ * @brief Type the Bench Text and decode it from the Reports.
+ */
+static void Type_Text( u32_t poll_us, const char *name )
+{
+  PS2_Trace_s trace;
+  u32_t k;
+  memset(&host, 0, sizeof(host));
+  host.reports = 1;   // Empty state is known
+  PS2_Trace_Init(&trace);
+  trace.time_us = host_time_us + 1000u;
+  for( k = 0; k < BENCH_KEYS; k++ )
+  {
+    PS2_Trace_Idle(&trace, 1000u + host_random(20000u));
+    host.key_start[k] = trace.time_us;
+    PS2_Trace_Add_Key(&trace, bench_text[k % (sizeof(bench_text) - 1u)]);
+  }
+  Run(&trace, poll_us);
+  Check(host.length == BENCH_KEYS &&
+        !strncmp(host.text, trace.expected, BENCH_KEYS), "typed text");
+  Check(host.bad_reports == 0, "one key change per report");
+  printf("usb %-8s: %lu keys, %lu reports, poll %lu us, latency mean %lu us "
+         "max %lu us\n", name, (unsigned long)host.length,
+         (unsigned long)host.reports - 1ul, (unsigned long)poll_us,
+         (unsigned long)(host.latency_us / (host.length ? host.length : 1u)),
+         (unsigned long)host.max_latency_us);
+  PS2_Trace_Free(&trace);
+}
+
+/**
+ * @brief Hold down ROLL_KEYS Keys at once.
+ */
+static void Roll_Over( void )
+{
+  PS2_Trace_s trace;
+  u32_t k;
+  memset(&host, 0, sizeof(host));
+  host.reports = 1;
+  PS2_Trace_Init(&trace);
+  trace.time_us = host_time_us + 1000u;
+  for( k = 0; k < ROLL_KEYS; k++ )
+    PS2_Trace_Add_Byte(&trace, roll_codes[k]);
+  PS2_Trace_Idle(&trace, 10000u);
+  for( k = 0; k < ROLL_KEYS; k++ )
+  {
+    PS2_Trace_Add_Byte(&trace, PS2_BREAK);
+    PS2_Trace_Add_Byte(&trace, roll_codes[k]);
+  }
+  Run(&trace, 1000u);
+  PS2_Trace_Free(&trace);
+}
+
+/**
+ * @brief LED Report of the Host goes to the Keyboard.
+ */
+static void Leds( void )
+{
+  PS2_Key_Event_s event;
+  u8_t packet[HOST_USB_PACKET];
+  u8_t leds = USB_HID_LED_CAPS;
+  int n;
+  n = host_usb_control(0x21, USB_HID_SET_REPORT,
+                       USB_HID_REPORT_OUTPUT << 8, 0, 1, &leds);
+  Check(n == 0 && USB_HID_Get_Stats()->leds == 1u, "set report");
+  Check(!IS_PS2_Command_Pending(PS2_PORT_KEYBOARD), "no command before task");
+  USB_HID_Task();
+  Check(IS_PS2_Command_Pending(PS2_PORT_KEYBOARD), "set leds queued");
+  // Caps Lock of the host applies, the Caps Lock key doesn't toggle it
+  PS2_Parse_Byte(PS2_PORT_KEYBOARD, 0x1C, &event);
+  Check(event.ascii == 'A' && (event.flags & PS2_EVT_CAPS), "host caps lock");
+  PS2_Parse_Byte(PS2_PORT_KEYBOARD, PS2_BREAK, &event);
+  PS2_Parse_Byte(PS2_PORT_KEYBOARD, 0x1C, &event);
+  PS2_Parse_Byte(PS2_PORT_KEYBOARD, CAPS, &event);
+  PS2_Parse_Byte(PS2_PORT_KEYBOARD, PS2_BREAK, &event);
+  PS2_Parse_Byte(PS2_PORT_KEYBOARD, CAPS, &event);
+  Check((event.flags & PS2_EVT_CAPS) != 0, "caps key leaves host lock");
+  // Packet longer than wLength is stalled, the buffer of EP0 is not overrun
+  memset(packet, 0xFF, sizeof(packet));
+  n = host_usb_control_out(0x21, USB_HID_SET_REPORT,
+                           USB_HID_REPORT_OUTPUT << 8, 0, 1, packet,
+                           sizeof(packet));
+  Check(n == -1 && USB_HID_Get_Stats()->leds == 1u, "long report stalled");
+  n = host_usb_control_out(0x21, USB_HID_SET_REPORT,
+                           USB_HID_REPORT_OUTPUT << 8, 0, 1, &leds, 1u);
+  Check(n == 0 && USB_HID_Get_Stats()->leds == 2u, "report after stall");
+  printf("usb leds    : caps lock report queued for the keyboard, long report "
+         "stalled\n");
+}
+
+int main( void )
+{
+  u8_t buf[HOST_USB_PACKET];
+  u32_t idle;
+  int n;
+
+  host_seed = 5u;
+  PS2_Keyboard_Init();
+  host_time_us = 10000u;
+  USB_Device_Init();
+  Check(host_usb_connected, "connect");
+  Enumerate();
+
+  // Report protocol (NKRO), then a slow host, then boot protocol
+  Type_Text(1000u, "nkro");
+  Type_Text(4000u, "slow");
+  Roll_Over();
+  Check(host.max_keys == ROLL_KEYS && host.bad_reports == 0,
+        "nkro holds all keys");
+  printf("usb rollover: nkro %lu keys at once\n",
+         (unsigned long)host.max_keys);
+
+  n = host_usb_control(0x21, USB_HID_SET_PROTOCOL, USB_HID_PROTOCOL_BOOT, 0,
+                       0, buf);
+  Main_Loop();
+  n = ( n == 0 ) ? host_usb_poll(USB_HID_EP_IN, buf) : -1;
+  Check(n == USB_HID_BOOT_LEN, "boot report after set protocol");
+  Type_Text(1000u, "boot");
+  Roll_Over();
+  Check(host.rollovers > 0 && host.max_keys == USB_HID_BOOT_KEYS &&
+        USB_HID_Get_Stats()->rollovers == host.rollovers, "boot rollover");
+  printf("usb rollover: boot %lu keys, %lu rollover reports\n",
+         (unsigned long)host.max_keys, (unsigned long)host.rollovers);
+  n = host_usb_control(0xA1, USB_HID_GET_PROTOCOL, 0, 0, 1, buf);
+  Check(n == 1 && buf[0] == USB_HID_PROTOCOL_BOOT, "get protocol");
+
+  // Idle rate of 500 ms repeats the report without keys
+  n = host_usb_control(0x21, USB_HID_SET_IDLE, 125u << 8, 0, 0, buf);
+  idle = USB_HID_Get_Stats()->idle_reports;
+  host_time_us += 600000u;
+  Main_Loop();
+  Check(n == 0 && host_usb_poll(USB_HID_EP_IN, buf) == USB_HID_BOOT_LEN &&
+        USB_HID_Get_Stats()->idle_reports == idle + 1u, "idle report");
+
+  Leds();
+
+  // Bus reset, reports stop until configured again
+  USB_Reset_Event();
+  Check(!IS_USB_Configured() && IS_USB_HID_Ready(), "bus reset");
+
+  printf("usb hid     : %lu events, %lu reports %s\n",
+         (unsigned long)USB_HID_Get_Stats()->events,
+         (unsigned long)USB_HID_Get_Stats()->reports, host_failed ? "FAIL" : "OK");
+  return host_failed;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file bench_vboard.c
+ * @author Embedded Laboratory
+ * @brief Host Benchmark, whole Firmware on the Virtual Board.
+ *
+ * main.c, the Application and the Drivers run unchanged on the virtual
+ * LPC1343 of vboard/. The board boots until the LCD shows the welcome line
+ * and the keyboard got its typematic command. Then single keys are typed one
+ * at a time, the latency from the start bit of the make code to the
+ * character on the LCD is measured on the virtual clock. A long text is
+ * typed at the full rate of the keyboard, every line must reach the history
+ * on the first row and the throughput is printed. The LCD must never be
+ * written while busy. The UART output of the key stream and the latency
+ * dumps is written to the file of the first argument, key_stream_decode
+ * checks it.
+ *
+ * Usage:
+ * @code
+ * bench_vboard [uart.bin]
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ps2_keyboard.h"
+#include "vboard.h"
+#include "host_bench.h"
+
+#define BENCH_KEYS        200u      /**< Keys typed one at a time. */
+#define BENCH_LINES       100u      /**< Lines of the long Text. */
+#define BENCH_TIMEOUT_US  1000000u  /**< Longest Wait for one Step. */
+
+static u64_t start_us;              // Start Bit of the first Byte typed
+static char expected;
+static u64_t shown_us;              // Expected Character written to the LCD
+static char last_line[17];
+
+static void Fail( const char *what )
+{
+  printf("FAIL: %s\n", what);
+  host_check(0);
+}
+
+static void Start_Hook( u8_t port, u8_t byte )
+{
+  (void)byte;
+  if( port == PS2_PORT_KEYBOARD && start_us == 0u )
+    start_us = vboard_us();
+}
+
+static void LCD_Hook( u8_t address, u8_t c )
+{
+  (void)address;
+  if( expected && c == (u8_t)expected && shown_us == 0u )
+    shown_us = vboard_us();
+}
+
+static int Booted( void )
+{
+  char row[17];
+  vboard_lcd_row(0, row);
+  return strncmp(row, "PS2 Board Exmple", 16u) == 0;
+}
+
+static int Key_Shown( void )
+{
+  return shown_us != 0u;
+}
+
+/**
+ * @brief Last entered Line on the first Row, all Keys sent.
+ */
+static int Line_Shown( void )
+{
+  char row[17];
+  if( vboard_ps2_pending(PS2_PORT_KEYBOARD) )
+    return 0;
+  vboard_lcd_row(0, row);
+  return strncmp(row, last_line, 16u) == 0;
+}
+
+/**
+ * @brief Type a Line, Enter and wait until it is in the History.
+ */
+static int Type_Line( const char *line )
+{
+  memset(last_line, ' ', 16u);
+  memcpy(last_line, line, strlen(line));
+  last_line[16] = '\0';
+  vboard_ps2_type(PS2_PORT_KEYBOARD, line);
+  vboard_ps2_type(PS2_PORT_KEYBOARD, "\n");
+  return vboard_run_until(Line_Shown, BENCH_TIMEOUT_US);
+}
+
+int main( int argc, char **argv )
+{
+  static const char letters[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+  char line[17];
+  u8_t commands[16];
+  u32_t i, j, n, count = 0, length = 0;
+  u64_t latency, total = 0, worst = 0, best = ~0ull, t0, t1, wall;
+  const vboard_stats_t *stats;
+  const vboard_lcd_stats_t *lcd;
+  const vboard_ps2_stats_t *kbd;
+  const u8_t *output;
+  FILE *f;
+
+  wall = host_now_ns();
+  vboard_boot();
+  if( !vboard_run_until(Booted, BENCH_TIMEOUT_US) )
+    Fail("welcome line not shown");
+  printf("boot: welcome line after %llu us\n",
+         (unsigned long long)vboard_us());
+  vboard_run_us(10000u);
+  n = vboard_ps2_commands(PS2_PORT_KEYBOARD, commands, sizeof(commands));
+  for( i = 0; i + 1u < n; i++ )
+  {
+    if( commands[i] == PS2_CMD_TYPEMATIC &&
+        commands[i + 1u] == PS2_TYPEMATIC_FASTEST )
+      break;
+  }
+  if( i + 1u >= n )
+    Fail("typematic command not received");
+
+  // Latency of single Keys, the Board is idle before each
+  vboard_ps2_hook(Start_Hook);
+  vboard_lcd_hook(LCD_Hook);
+  for( i = 0; i < BENCH_KEYS; i++ )
+  {
+    if( i % 12u == 11u )
+    {
+      vboard_ps2_type(PS2_PORT_KEYBOARD, "\n");
+      vboard_run_us(20000u);
+    }
+    expected = letters[i % (sizeof(letters) - 1u)];
+    line[0] = expected;
+    line[1] = '\0';
+    start_us = 0;
+    shown_us = 0;
+    vboard_ps2_type(PS2_PORT_KEYBOARD, line);
+    if( !vboard_run_until(Key_Shown, BENCH_TIMEOUT_US) )
+    {
+      Fail("typed key not shown");
+      break;
+    }
+    latency = shown_us - start_us;
+    total += latency;
+    if( latency > worst )
+      worst = latency;
+    if( latency < best )
+      best = latency;
+    count++;
+    // Let the break code pass before the next key
+    vboard_run_us(5000u);
+  }
+  expected = 0;
+  vboard_lcd_hook(NULL);
+  vboard_ps2_hook(NULL);
+  vboard_ps2_type(PS2_PORT_KEYBOARD, "\n");
+  vboard_run_us(20000u);
+  if( count )
+  {
+    printf("key to LCD: %u keys, best %llu us, mean %llu us, worst %llu us\n",
+           count, (unsigned long long)best,
+           (unsigned long long)(total / count), (unsigned long long)worst);
+  }
+
+  // Lines at the full Rate of the Keyboard
+  t0 = vboard_us();
+  for( i = 0; i < BENCH_LINES && !host_failed; i++ )
+  {
+    n = 4u + i % 12u;
+    for( j = 0; j < n; j++ )
+      line[j] = letters[(i * 7u + j * 3u) % (sizeof(letters) - 1u)];
+    line[n] = '\0';
+    length += n + 1u;
+    if( !Type_Line(line) )
+      Fail("typed line not in the history");
+  }
+  t1 = vboard_us();
+  if( t1 > t0 )
+  {
+    printf("typing: %u keys in %llu us, %llu keys/s\n", length,
+           (unsigned long long)(t1 - t0),
+           (unsigned long long)((u64_t)length * 1000000u / (t1 - t0)));
+  }
+
+  lcd = vboard_lcd_get_stats();
+  kbd = vboard_ps2_get_stats(PS2_PORT_KEYBOARD);
+  printf("lcd: %u commands, %u characters, %u busy reads, %u violations\n",
+         lcd->commands, lcd->characters, lcd->busy_reads, lcd->violations);
+  printf("keyboard: %u bytes sent, %u aborted, %u received\n", kbd->sent,
+         kbd->aborted, kbd->received);
+  if( lcd->violations )
+    Fail("LCD written while busy");
+  if( !vboard_lcd_backlight() )
+    Fail("back light off while typing");
+
+  output = vboard_uart_output(&length);
+  printf("uart: %u bytes\n", length);
+  if( argc > 1 )
+  {
+    f = fopen(argv[1], "wb");
+    if( f == NULL || fwrite(output, 1, length, f) != length )
+      Fail("can't write the UART output");
+    if( f != NULL )
+      fclose(f);
+  }
+
+  stats = vboard_get_stats();
+  wall = host_now_ns() - wall;
+  printf("board: %llu us virtual, %llu accesses, %llu interrupts, "
+         "%llu%% asleep\n", (unsigned long long)vboard_us(),
+         (unsigned long long)stats->accesses,
+         (unsigned long long)stats->interrupts,
+         (unsigned long long)(stats->sleep_cycles * 100u /
+                              (vboard_cycles() ? vboard_cycles() : 1u)));
+  printf("board: %.1f ms wall, %.1fx real time\n", wall / 1e6,
+         vboard_us() * 1e3 / (wall ? wall : 1u));
+  printf("%s\n", ( host_failed ) ? "FAILED" : "OK");
+  return host_failed;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file host_bench.h
+ * @author Embedded Laboratory
+ * @brief Timing, Random and Check Helpers shared by the Host Benchmarks.
+ */
+
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Monotonic Time in nano-seconds.
+ */
+static inline uint64_t host_now_ns( void )
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief CPU Cycle Counter.
+ *
+ * Time Stamp Counter on x86, falls back to nano-seconds elsewhere.
+ */
+static inline uint64_t host_cycles( void )
+{
+#if defined(__x86_64__) || defined(__i386__)
+  // Builtin, x86intrin.h clashes with the __I macro of core_cm3.h
+  return __builtin_ia32_rdtsc();
+#else
+  return host_now_ns();
+#endif
+}
+
+/**
+ * @brief Keeps the compiler from optimizing away a benchmark result.
+ */
+static inline void host_sink( uint32_t value )
+{
+  static volatile uint32_t sink;
+  sink += value;
+}
+
+/** Set by host_check() on a Mismatch, Exit Status of the Benchmark. */
+static int host_failed __attribute__((unused)) = 0;
+
+/** State of host_random(), a Benchmark may start its own Sequence. */
+static uint32_t host_seed __attribute__((unused)) = 12345u;
+
+/**
+ * @brief Pseudo Random Number below range, same Sequence every Run.
+ *
+ * The range is scaled from the upper bits of the state, the low bits of the
+ * generator repeat with short periods.
+ */
+static inline uint32_t host_random( uint32_t range )
+{
+  host_seed = host_seed * 1103515245u + 12345u;
+  return (uint32_t)(((uint64_t)host_seed * range) >> 32);
+}
+
+/**
+ * @brief Check a Condition, a Mismatch fails the Benchmark.
+ */
+static inline void host_check( int ok )
+{
+  if( !ok )
+    host_failed = 1;
+}
+
+#endif /* HOST_BENCH_H */
@@ -0,0 +1,35 @@
+/**
+ * @file host_clock.c
+ * @author Embedded Laboratory
+ * @brief Host Clock Stub.
+ *
+ * Replaces the SysTick based time keeping of config.c in the Host Build, time
+ * only moves when a benchmark writes host_time_us.
+ */
+
+#include "config.h"
+#include "host_clock.h"
+#include "lpc13xx_clkpwr.h"
+
+volatile uint32_t host_time_us;   /**< Simulated Time in micro-seconds. */
+
+u32_t millis( void )
+{
+  return host_time_us / 1000u;
+}
+
+u32_t micros( void )
+{
+  return host_time_us;
+}
+
+u64_t micros64( void )
+{
+  return host_time_us;
+}
+
+void PMU_Sleep( uint32_t SleepMode, uint32_t SleepCtrl )
+{
+  (void)SleepMode;
+  (void)SleepCtrl;
+}
@@ -0,0 +1,14 @@
+/**
+ * @file host_clock.h
+ * @author Embedded Laboratory
+ * @brief Host Clock Stub, benchmarks set the time seen by the Application.
+ */
+
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+#include <stdint.h>
+
+extern volatile uint32_t host_time_us;
+
+#endif /* HOST_CLOCK_H */
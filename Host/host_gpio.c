@@ -0,0 +1,85 @@
+/**
+ * @file host_gpio.c
+ * @author Embedded Laboratory
+ * @brief Host GPIO Stub.
+ *
+ * Replaces Drivers/source/lpc13xx_gpio.c in the Host Build, pin values are
+ * kept in host_gpio_data[] which is set by the benchmark before calling the
+ * code under test.
+ */
+
+#include "lpc13xx_gpio.h"
+#include "host_gpio.h"
+
+volatile uint32_t host_gpio_data[HOST_GPIO_PORTS];  /**< Simulated Port Data. */
+volatile uint32_t host_gpio_dir[HOST_GPIO_PORTS];   /**< Simulated Direction. */
+volatile uint32_t host_gpio_mis[HOST_GPIO_PORTS];   /**< Simulated Interrupts. */
+
+void GPIO_Init( void )
+{
+}
+
+void GPIO_SetDir(uint8_t portNum, uint32_t bitValue, uint8_t dir)
+{
+  if( portNum >= HOST_GPIO_PORTS )
+    return;
+  if( dir )
+    host_gpio_dir[portNum] |= (0x1u<<bitValue);
+  else
+    host_gpio_dir[portNum] &= ~(0x1u<<bitValue);
+}
+
+void GPIO_SetValue(uint8_t portNum, uint32_t bitValue)
+{
+  if( portNum < HOST_GPIO_PORTS )
+    host_gpio_data[portNum] |= (0x1u<<bitValue);
+}
+
+void GPIO_ClearValue(uint8_t portNum, uint32_t bitValue)
+{
+  if( portNum < HOST_GPIO_PORTS )
+    host_gpio_data[portNum] &= ~(0x1u<<bitValue);
+}
+
+uint32_t GPIO_ReadValue(uint8_t portNum)
+{
+  return ( portNum < HOST_GPIO_PORTS ) ? host_gpio_data[portNum] : 0u;
+}
+
+void GPIO_SetInterrupt( uint32_t portNum, uint32_t bitValue, uint32_t sense,
+                        uint32_t single, uint32_t event )
+{
+  (void)portNum; (void)bitValue; (void)sense; (void)single; (void)event;
+}
+
+void GPIO_IntEnable( uint32_t portNum, uint32_t bitValue )
+{
+  (void)portNum; (void)bitValue;
+}
+
+void GPIO_IntDisable( uint32_t portNum, uint32_t bitValue )
+{
+  (void)portNum; (void)bitValue;
+}
+
+uint32_t GPIO_IntStatus( uint32_t portNum, uint32_t bitValue )
+{
+  (void)portNum; (void)bitValue;
+  return 1u;
+}
+
+void GPIO_IntClear( uint32_t portNum, uint32_t bitValue )
+{
+  (void)portNum; (void)bitValue;
+}
+
+uint32_t GPIO_IntMaskedStatus( uint32_t portNum )
+{
+  return ( portNum < HOST_GPIO_PORTS ) ? host_gpio_mis[portNum] : 0u;
+}
+
+void GPIO_IntClearMask( uint32_t portNum, uint32_t mask )
+{
+  if( portNum < HOST_GPIO_PORTS )
+    host_gpio_mis[portNum] &= ~mask;
+}
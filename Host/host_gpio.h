@@ -0,0 +1,19 @@
+/**
+ * @file host_gpio.h
+ * @author Embedded Laboratory
+ * @brief Host GPIO Stub, lets the benchmarks drive the input pins read by the
+ * Application code through GPIO_ReadValue().
+ */
+
+#ifndef HOST_GPIO_H
+#define HOST_GPIO_H
+
+#include <stdint.h>
+
+#define HOST_GPIO_PORTS   4u    /**< Number of GPIO Ports. */
+
+extern volatile uint32_t host_gpio_data[HOST_GPIO_PORTS];
+extern volatile uint32_t host_gpio_dir[HOST_GPIO_PORTS];
+extern volatile uint32_t host_gpio_mis[HOST_GPIO_PORTS];
+
+#endif /* HOST_GPIO_H */
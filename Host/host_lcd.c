@@ -0,0 +1,119 @@
+/**
+ * @file host_lcd.c
+ * @author Embedded Laboratory
+ * @brief Host LCD Stub.
+ *
+ * Replaces Application/lcd_16x2.c in the Host Build. Commands and characters
+ * are executed right away on a model of the DDRAM and CGRAM of a 16x2
+ * HD44780, every one adds its execution time of lcd_16x2.h to
+ * host_lcd_busy_us, the time the command queue keeps the LCD busy.
+ */
+
+#include <string.h>
+#include "lcd_16x2.h"
+#include "host_lcd.h"
+
+uint8_t host_lcd_ddram[HOST_LCD_DDRAM];   /**< Display Data RAM. */
+uint8_t host_lcd_cgram[HOST_LCD_CGRAM];   /**< Character Generator RAM. */
+uint8_t host_lcd_address = 0;             /**< Address Counter. */
+uint8_t host_lcd_display = 0;             /**< Display, Cursor and Blink. */
+static uint8_t cgram_mode = 0;            /**< Address Counter in CGRAM. */
+uint32_t host_lcd_commands = 0;           /**< Commands executed. */
+uint32_t host_lcd_characters = 0;         /**< Characters written. */
+uint32_t host_lcd_clears = 0;             /**< LCD_CLEAR executed. */
+uint32_t host_lcd_busy_us = 0;            /**< Execution Time of all. */
+
+/**
+ * @brief Cleared LCD, Counters reset.
+ */
+void host_lcd_reset( void )
+{
+  memset(host_lcd_ddram, ' ', sizeof(host_lcd_ddram));
+  memset(host_lcd_cgram, 0, sizeof(host_lcd_cgram));
+  host_lcd_address = 0;
+  host_lcd_display = 0;
+  cgram_mode = 0;
+  host_lcd_commands = 0;
+  host_lcd_characters = 0;
+  host_lcd_clears = 0;
+  host_lcd_busy_us = 0;
+}
+
+/**
+ * @brief Visible Characters of a Row.
+ * @param text 17 Characters with the NULL Character.
+ */
+void host_lcd_row( uint8_t row, char *text )
+{
+  memcpy(text, &host_lcd_ddram[row ? 0x40u : 0x00u], 16u);
+  text[16] = 0;
+}
+
+void LCD_Init( void )
+{
+  host_lcd_reset();
+  // Display On, Cursor Off
+  host_lcd_display = 0x04u;
+}
+
+void LCD_Cmd( u8_t command )
+{
+  host_lcd_commands++;
+  if( command & 0x80u )
+  {
+    host_lcd_address = command & 0x7Fu;
+    cgram_mode = 0;
+    host_lcd_busy_us += LCD_EXEC_US;
+  }
+  else if( command & 0x40u )
+  {
+    host_lcd_address = command & 0x3Fu;
+    cgram_mode = 1;
+    host_lcd_busy_us += LCD_EXEC_US;
+  }
+  else if( command == LCD_CLEAR )
+  {
+    memset(host_lcd_ddram, ' ', sizeof(host_lcd_ddram));
+    host_lcd_address = 0;
+    cgram_mode = 0;
+    host_lcd_clears++;
+    host_lcd_busy_us += LCD_HOME_US;
+  }
+  else if( (command & 0xF8u) == 0x08u )
+  {
+    host_lcd_display = command & 0x07u;
+    host_lcd_busy_us += LCD_EXEC_US;
+  }
+  else if( command <= LCD_RETURN_HOME + 1u )
+  {
+    host_lcd_address = 0;
+    cgram_mode = 0;
+    host_lcd_busy_us += LCD_HOME_US;
+  }
+  else
+  {
+    host_lcd_busy_us += LCD_EXEC_US;
+  }
+}
+
+void LCD_Write( u8_t Data )
+{
+  if( cgram_mode )
+  {
+    host_lcd_cgram[host_lcd_address] = Data & 0x1Fu;
+    host_lcd_address = (host_lcd_address + 1u) & (HOST_LCD_CGRAM - 1u);
+  }
+  else
+  {
+    host_lcd_ddram[host_lcd_address] = Data;
+    host_lcd_address = (host_lcd_address + 1u) & (HOST_LCD_DDRAM - 1u);
+  }
+  host_lcd_characters++;
+  host_lcd_busy_us += LCD_EXEC_US;
+}
+
+void LCD_Write_Text( u8_t *msg )
+{
+  while( *msg )
+    LCD_Write(*msg++);
+}
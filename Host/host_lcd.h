@@ -0,0 +1,29 @@
+/**
+ * @file host_lcd.h
+ * @author Embedded Laboratory
+ * @brief Host LCD Stub, a HD44780 model which executes the queued commands
+ * and characters and adds up their execution times.
+ */
+
+#ifndef HOST_LCD_H
+#define HOST_LCD_H
+
+#include <stdint.h>
+
+#define HOST_LCD_DDRAM    0x80u   /**< DDRAM Addresses. */
+#define HOST_LCD_CGRAM    0x40u   /**< CGRAM Addresses, 8 Glyphs. */
+#define HOST_LCD_CURSOR   0x02u   /**< Cursor Bit of host_lcd_display. */
+
+extern uint8_t host_lcd_ddram[HOST_LCD_DDRAM];
+extern uint8_t host_lcd_cgram[HOST_LCD_CGRAM];
+extern uint8_t host_lcd_address;
+extern uint8_t host_lcd_display;
+extern uint32_t host_lcd_commands;
+extern uint32_t host_lcd_characters;
+extern uint32_t host_lcd_clears;
+extern uint32_t host_lcd_busy_us;
+
+void host_lcd_reset( void );
+void host_lcd_row( uint8_t row, char *text );
+
+#endif /* HOST_LCD_H */
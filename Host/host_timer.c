@@ -0,0 +1,47 @@
+/**
+ * @file host_timer.c
+ * @author Embedded Laboratory
+ * @brief Host Timer Stub.
+ *
+ * Replaces Drivers/source/lpc13xx_timer.c in the Host Build, capture values
+ * are given directly to the Application code by the benchmarks.
+ */
+
+#include "lpc13xx_timer.h"
+
+void TIM_Init(LPC_TMR_TypeDef *TIMx, uint8_t TimerCounterMode, void *TIM_ConfigStruct)
+{
+  (void)TIMx; (void)TimerCounterMode; (void)TIM_ConfigStruct;
+}
+
+void TIM_Cmd(LPC_TMR_TypeDef *TIMx, FunctionalState NewState)
+{
+  (void)TIMx; (void)NewState;
+}
+
+void TIM_ConfigCapture(LPC_TMR_TypeDef *TIMx, TIM_CAPTURECFG_Type *TIM_CaptureConfigStruct)
+{
+  (void)TIMx; (void)TIM_CaptureConfigStruct;
+}
+
+void TIM_ConfigMatch(LPC_TMR_TypeDef *TIMx, TIM_MATCHCFG_Type *TIM_MatchConfigStruct)
+{
+  (void)TIMx; (void)TIM_MatchConfigStruct;
+}
+
+uint32_t TIM_GetCaptureValue(LPC_TMR_TypeDef *TIMx)
+{
+  (void)TIMx;
+  return 0u;
+}
+
+FlagStatus TIM_GetIntCaptureStatus(LPC_TMR_TypeDef *TIMx, uint8_t IntFlag)
+{
+  (void)TIMx; (void)IntFlag;
+  return RESET;
+}
+
+void TIM_ClearIntCapturePending(LPC_TMR_TypeDef *TIMx, uint8_t IntFlag)
+{
+  (void)TIMx; (void)IntFlag;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file host_uart.c
+ * @author Embedded Laboratory
+ * @brief Host UART Stub.
+ *
+ * Replaces Drivers/source/lpc13xx_uart.c in the Host Build, sent bytes are
+ * written to stdout so they can be piped into the host tools. The TX ring
+ * never fills up, a lossy line can be simulated by dropping every n-th write.
+ */
+
+#include <stdio.h>
+#include "lpc13xx_uart.h"
+#include "host_uart.h"
+
+uint32_t host_uart_sent = 0;
+uint32_t host_uart_drop_every = 0;
+
+static uint8_t tx_span[UART_TX_RING_SIZE];
+static uint32_t writes = 0;
+
+/**
+ * @brief Bytes leave the simulated UART, or get lost on the line.
+ */
+static void Host_UART_Write( const uint8_t *data, uint32_t length )
+{
+  writes++;
+  if( host_uart_drop_every == 0u || (writes % host_uart_drop_every) != 0u )
+  {
+    host_uart_sent += length;
+    fwrite(data, 1u, length, stdout);
+  }
+}
+
+void UART_Init(void)
+{
+}
+
+void UART_SetBaudrate(uint32_t baudrate)
+{
+  (void)baudrate;
+}
+
+uint32_t UART_Send(uint8_t *txbuf, uint32_t buflen, TRANSFER_BLOCK_Type flag)
+{
+  (void)flag;
+  Host_UART_Write(txbuf, buflen);
+  return buflen;
+}
+
+uint32_t UART_TxFree(void)
+{
+  return UART_TX_RING_SIZE;
+}
+
+uint32_t UART_TxSpan(uint8_t **span)
+{
+  *span = tx_span;
+  return UART_TX_RING_SIZE;
+}
+
+void UART_TxCommit(uint32_t len)
+{
+  Host_UART_Write(tx_span, len);
+}
@@ -0,0 +1,15 @@
+/**
+ * @file host_uart.h
+ * @author Embedded Laboratory
+ * @brief Host UART Stub, counts the sent bytes and simulates a lossy line.
+ */
+
+#ifndef HOST_UART_H
+#define HOST_UART_H
+
+#include <stdint.h>
+
+extern uint32_t host_uart_sent;         /**< Bytes written to stdout. */
+extern uint32_t host_uart_drop_every;   /**< Every n-th write is lost, 0 none. */
+
+#endif /* HOST_UART_H */
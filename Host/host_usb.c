@@ -0,0 +1,163 @@
+/**
+ * @file host_usb.c
+ * @author Embedded Laboratory
+ * @brief Host USB Stub.
+ *
+ * Replaces Drivers/source/lpc13xx_usb.c in the Host Build. Packets written by
+ * the device are kept per IN endpoint, the benchmark takes them like a host
+ * would and gives the endpoint events to the device layer, as the USB
+ * interrupt does.
+ */
+
+#include <string.h>
+#include "host_usb.h"
+
+Host_USB_Packet_s host_usb_in[USB_LOGIC_EPS];   /**< Packets to the Host. */
+uint8_t host_usb_address;       /**< Address set by the Device. */
+uint8_t host_usb_configured;    /**< Device is Configured. */
+uint8_t host_usb_connected;     /**< Pull-Up is Connected. */
+uint32_t host_usb_stalled;      /**< Stalled Physical Endpoints. */
+
+static uint8_t out_data[HOST_USB_PACKET];   // Next Packet read by the Device
+static uint32_t out_length;
+
+static uint32_t host_usb_phy( uint8_t EPNum )
+{
+  return ((EPNum & 0x0Fu) << 1) | ((EPNum & USB_EP_DIR_IN) ? 1u : 0u);
+}
+
+void USB_Init(void)
+{
+  memset(host_usb_in, 0, sizeof(host_usb_in));
+  host_usb_address = 0;
+  host_usb_configured = 0;
+  host_usb_stalled = 0;
+}
+
+void USB_Connect(FunctionalState NewState)
+{
+  host_usb_connected = (NewState == ENABLE);
+}
+
+void USB_SetAddress(uint8_t addr)
+{
+  host_usb_address = addr & 0x7Fu;
+}
+
+void USB_Configure(FunctionalState NewState)
+{
+  host_usb_configured = (NewState == ENABLE);
+}
+
+void USB_SetStallEP(uint8_t EPNum, FunctionalState NewState)
+{
+  if( NewState == ENABLE )
+    host_usb_stalled |= (1u << host_usb_phy(EPNum));
+  else
+    host_usb_stalled &= ~(1u << host_usb_phy(EPNum));
+}
+
+uint32_t USB_ReadEP(uint8_t EPNum, uint8_t *pData)
+{
+  (void)EPNum;
+  memcpy(pData, out_data, out_length);
+  return out_length;
+}
+
+uint32_t USB_WriteEP(uint8_t EPNum, const uint8_t *pData, uint32_t cnt)
+{
+  Host_USB_Packet_s *p = &host_usb_in[EPNum & 0x0Fu];
+  memcpy(p->data, pData, cnt);
+  p->length = cnt;
+  p->pending = 1;
+  p->count++;
+  return cnt;
+}
+
+/**
+ * @brief Control Transfer on EP0.
+ * @param data IN Data Stage is stored here, OUT Data Stage is taken from here.
+ * @return Size of IN Data Stage, -1 if the Device stalled the request.
+ */
+int host_usb_control( uint8_t type, uint8_t request, uint16_t value,
+                      uint16_t index, uint16_t length, uint8_t *data )
+{
+  return host_usb_control_out(type, request, value, index, length, data,
+                              length);
+}
+
+/**
+ * @brief Control Transfer on EP0, OUT Data Stage of a given Packet Size.
+ *
+ * A broken host sends a packet of sent bytes, which may be longer than
+ * wLength, up to HOST_USB_PACKET.
+ * @return Size of IN Data Stage, -1 if the Device stalled the request.
+ */
+int host_usb_control_out( uint8_t type, uint8_t request, uint16_t value,
+                          uint16_t index, uint16_t length, uint8_t *data,
+                          uint16_t sent )
+{
+  Host_USB_Packet_s *ep0 = &host_usb_in[0];
+  int total = 0;
+  uint8_t setup[8] = { type, request, (uint8_t)value, (uint8_t)(value >> 8),
+                       (uint8_t)index, (uint8_t)(index >> 8),
+                       (uint8_t)length, (uint8_t)(length >> 8) };
+  // Setup Packet clears a stall of EP0
+  host_usb_stalled &= ~3u;
+  ep0->pending = 0;
+  memcpy(out_data, setup, sizeof(setup));
+  out_length = sizeof(setup);
+  USB_EP_Event(0, USB_EVT_SETUP);
+  if( !(type & 0x80u) && length )
+  {
+    memcpy(out_data, data, sent);
+    out_length = sent;
+    USB_EP_Event(0, USB_EVT_OUT);
+  }
+  if( host_usb_stalled & 3u )
+    return -1;
+  if( type & 0x80u )
+  {
+    // IN Data Stage until a short packet, then OUT Status Stage
+    while( ep0->pending )
+    {
+      ep0->pending = 0;
+      if( total + ep0->length > length )
+        return -1;
+      memcpy(&data[total], ep0->data, ep0->length);
+      total += (int)ep0->length;
+      USB_EP_Event(USB_EP_DIR_IN, USB_EVT_IN);
+      if( ep0->length < USB_EP0_MAXPACKET )
+        break;
+    }
+    out_length = 0;
+    USB_EP_Event(0, USB_EVT_OUT);
+  }
+  else
+  {
+    // IN Status Stage is a Zero Length Packet
+    if( !ep0->pending || ep0->length )
+      return -1;
+    ep0->pending = 0;
+    USB_EP_Event(USB_EP_DIR_IN, USB_EVT_IN);
+  }
+  return total;
+}
+
+/**
+ * @brief Poll an IN Endpoint like the Host does every bInterval.
+ * @return Size of Packet, -1 if the Device has nothing to send (NAK).
+ */
+int host_usb_poll( uint8_t ep, uint8_t *data )
+{
+  Host_USB_Packet_s *p = &host_usb_in[ep & 0x0Fu];
+  int length = -1;
+  if( p->pending && !(host_usb_stalled & (1u << host_usb_phy(ep))) )
+  {
+    p->pending = 0;
+    memcpy(data, p->data, p->length);
+    length = (int)p->length;
+    USB_EP_Event(ep, USB_EVT_IN);
+  }
+  return length;
+}
@@ -0,0 +1,40 @@
+/**
+ * @file host_usb.h
+ * @author Embedded Laboratory
+ * @brief Host USB Stub, benchmarks act as the USB host: they send control
+ * transfers and poll the IN endpoints of the USB device layer.
+ */
+
+#ifndef HOST_USB_H
+#define HOST_USB_H
+
+#include <stdint.h>
+#include "lpc13xx_usb.h"
+
+#define HOST_USB_PACKET   64u   /**< Largest Packet. */
+
+/**
+ * @brief Last Packet written to an IN Endpoint.
+ */
+typedef struct
+{
+  uint8_t data[HOST_USB_PACKET];  /**< Packet Data. */
+  uint32_t length;                /**< Packet Size. */
+  uint8_t pending;                /**< Written and not yet polled. */
+  uint32_t count;                 /**< Packets written. */
+} Host_USB_Packet_s;
+
+extern Host_USB_Packet_s host_usb_in[USB_LOGIC_EPS];
+extern uint8_t host_usb_address;
+extern uint8_t host_usb_configured;
+extern uint8_t host_usb_connected;
+extern uint32_t host_usb_stalled;
+
+int host_usb_control( uint8_t type, uint8_t request, uint16_t value,
+                      uint16_t index, uint16_t length, uint8_t *data );
+int host_usb_control_out( uint8_t type, uint8_t request, uint16_t value,
+                          uint16_t index, uint16_t length, uint8_t *data,
+                          uint16_t sent );
+int host_usb_poll( uint8_t ep, uint8_t *data );
+
+#endif /* HOST_USB_H */
@@ -0,0 +1,93 @@
+/**
+ * @file core_cm3.h
+ * @author Embedded Laboratory
+ * @brief Host replacement of CMSIS Cortex-M3 Core Header.
+ *
+ * Only used by the Linux Host Build (see Host/Makefile), it provides the core
+ * definitions required by LPC13xx.h and the Application code, so that the
+ * Application sources can be compiled and benchmarked on a PC. Intrinsics
+ * which has no meaning on PC are empty.
+ */
+
+#ifndef HOST_CORE_CM3_H
+#define HOST_CORE_CM3_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __I     volatile const  /**< Read Only Register. */
+#define __O     volatile        /**< Write Only Register. */
+#define __IO    volatile        /**< Read Write Register. */
+
+/* IAR and CMSIS Intrinsics */
+#define __disable_interrupt()   do { } while(0)
+#define __enable_interrupt()    do { } while(0)
+#define __disable_irq()         do { } while(0)
+#define __enable_irq()          do { } while(0)
+#define __WFI()                 do { } while(0)
+#define __DSB()                 do { } while(0)
+#define __ISB()                 do { } while(0)
+#define __DMB()                 do { } while(0)
+#define __CLZ(x)                ((uint8_t)((x) ? __builtin_clz(x) : 32))
+
+/**
+ * @brief Data Watchpoint and Trace Unit, only the Cycle Counter.
+ */
+typedef struct
+{
+  __IO uint32_t CTRL;     /**< Control Register. */
+  __IO uint32_t CYCCNT;   /**< Cycle Counter. */
+} DWT_Type;
+
+/**
+ * @brief Core Debug Registers.
+ */
+typedef struct
+{
+  __IO uint32_t DHCSR;
+  __O  uint32_t DCRSR;
+  __IO uint32_t DCRDR;
+  __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk        (1ul << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk    (1ul << 24)
+
+/**
+ * @brief Cycle Counter reads the Host Time Stamp Counter.
+ */
+static inline DWT_Type* host_dwt( void )
+{
+  static DWT_Type dwt;
+#if defined(__x86_64__) || defined(__i386__)
+  dwt.CYCCNT = (uint32_t)__builtin_ia32_rdtsc();
+#endif
+  return &dwt;
+}
+
+static inline CoreDebug_Type* host_core_debug( void )
+{
+  static CoreDebug_Type core_debug;
+  return &core_debug;
+}
+
+#define DWT         (host_dwt())
+#define CoreDebug   (host_core_debug())
+
+static inline void NVIC_EnableIRQ( IRQn_Type IRQn )  { (void)IRQn; }
+static inline void NVIC_DisableIRQ( IRQn_Type IRQn ) { (void)IRQn; }
+static inline void NVIC_ClearPendingIRQ( IRQn_Type IRQn ) { (void)IRQn; }
+static inline uint32_t SysTick_Config( uint32_t ticks )
+{
+  (void)ticks;
+  return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_CORE_CM3_H */
@@ -0,0 +1,256 @@
+/**
+ * @file key_stream_decode.c
+ * @author Embedded Laboratory
+ * @brief Host Tool, Binary Key Event Stream Decoder.
+ *
+ * Reads the UART output of the board (see key_stream.h) from a file or stdin.
+ * The stream is split at the 0x00 delimiters, every frame is COBS decoded and
+ * its CRC-8 checked. Gaps in the sequence numbers are reported as lost
+ * frames. Text lines of the other dumps on the same UART are skipped. With -v
+ * every event is printed:
+ * @code
+ * <time_us> <port> make|break|repeat <usage> <modifiers> <flags>
+ * @endcode
+ * The last keys of every port are printed as text, letters, digits, space
+ * and '-' only.
+ *
+ * Usage:
+ * @code
+ * key_stream_decode [-v] [stream.bin]
+ * @endcode
+ * Exit status is 1 if a frame was lost or broken.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_MAX     256     /**< Longest Chunk between Delimiters. */
+#define PORTS_MAX     4       /**< Ports in the Info Byte. */
+#define TEXT_TAIL     24      /**< Last Keys shown per Port. */
+
+/* Record Info Byte, see key_stream.h */
+#define EVT_MAKE      0x01
+#define EVT_REPEAT    0x02
+#define EVT_FLAGS     0x72    /**< Repeat and Lock Flags. */
+#define PORT_SHIFT    2
+#define PORT_MASK     0x0C
+#define INFO_MODS     0x80
+
+/**
+ * @brief Decoder State.
+ */
+typedef struct
+{
+  unsigned long frames, events, lost, bad, text;
+  int have_seq;
+  unsigned char seq;
+  unsigned long keys[PORTS_MAX];
+  char tail[PORTS_MAX][TEXT_TAIL + 1];
+} Decoder_s;
+
+static Decoder_s d;
+static int verbose = 0;
+
+/**
+ * @brief CRC-8, Polynomial 0x07, computed bit by bit to cross-check the
+ * table of the firmware.
+ */
+static unsigned char CRC8( const unsigned char *data, int length )
+{
+  unsigned char crc = 0;
+  int bit;
+  while( length-- > 0 )
+  {
+    crc ^= *data++;
+    for( bit = 0; bit < 8; bit++ )
+      crc = (unsigned char)(( crc & 0x80 ) ? (crc << 1) ^ 0x07 : crc << 1);
+  }
+  return crc;
+}
+
+/**
+ * @brief COBS Decoding.
+ * @return Decoded Length, -1 if the Chunk is not valid COBS.
+ */
+static int COBS_Decode( const unsigned char *in, int length,
+                        unsigned char *out )
+{
+  int i = 0, n = 0, code, k;
+  while( i < length )
+  {
+    code = in[i++];
+    if( code == 0 || i + code - 1 > length )
+      return -1;
+    for( k = 1; k < code; k++ )
+      out[n++] = in[i++];
+    if( code < 0xFF && i < length )
+      out[n++] = 0;
+  }
+  return n;
+}
+
+/**
+ * @brief Character of a HID Usage, 0 if not shown.
+ */
+static char Usage_Char( unsigned char usage, unsigned char modifiers )
+{
+  char c = 0;
+  if( usage >= 0x04 && usage <= 0x1D )
+    c = (char)((( modifiers & 0x22 ) ? 'A' : 'a') + usage - 0x04);
+  else if( usage >= 0x1E && usage <= 0x26 )
+    c = (char)('1' + usage - 0x1E);
+  else if( usage == 0x27 )
+    c = '0';
+  else if( usage == 0x2C )
+    c = ' ';
+  else if( usage == 0x2D )
+    c = '-';
+  return c;
+}
+
+/**
+ * @brief Read a Varint.
+ * @return Bytes used, 0 if the Record ends before the Varint.
+ */
+static int Get_Varint( const unsigned char *in, int length,
+                       unsigned long *value )
+{
+  int n = 0, shift = 0;
+  *value = 0;
+  while( n < length && n < 5 )
+  {
+    *value |= (unsigned long)(in[n] & 0x7F) << shift;
+    shift += 7;
+    if( !(in[n++] & 0x80) )
+      return n;
+  }
+  return 0;
+}
+
+/**
+ * @brief Decode the Records of a checked Frame.
+ * @return 0, -1 if a Record is cut off.
+ */
+static int Decode_Records( const unsigned char *frame, int length )
+{
+  static unsigned long time_us = 0;
+  static unsigned char modifiers = 0;
+  int i = 1, n, first = 1, port;
+  unsigned char usage, info;
+  unsigned long time;
+  char *tail, c;
+  while( i < length )
+  {
+    if( i + 2 > length )
+      return -1;
+    usage = frame[i++];
+    info = frame[i++];
+    if( info & INFO_MODS )
+    {
+      if( i >= length )
+        return -1;
+      modifiers = frame[i++];
+    }
+    n = Get_Varint(&frame[i], length - i, &time);
+    if( n == 0 )
+      return -1;
+    i += n;
+    time_us = first ? time : (time_us + time) & 0xFFFFFFFFul;
+    first = 0;
+    port = (info & PORT_MASK) >> PORT_SHIFT;
+    d.events++;
+    if( verbose )
+      printf("%lu %d %s 0x%02X 0x%02X 0x%02X\n", time_us, port,
+             ( info & EVT_MAKE ) ? (( info & EVT_REPEAT ) ? "repeat" : "make")
+                                 : "break",
+             usage, modifiers, info & EVT_FLAGS);
+    c = Usage_Char(usage, modifiers);
+    if( (info & EVT_MAKE) && c )
+    {
+      tail = d.tail[port];
+      if( strlen(tail) == TEXT_TAIL )
+        memmove(tail, tail + 1, TEXT_TAIL);
+      n = (int)strlen(tail);
+      tail[n] = c;
+      tail[n + 1] = 0;
+      d.keys[port]++;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Handle a Chunk between two Delimiters.
+ */
+static void Decode_Chunk( const unsigned char *chunk, int length )
+{
+  unsigned char frame[FRAME_MAX];
+  int n, i, text = 1;
+  if( length == 0 )
+    return;
+  n = COBS_Decode(chunk, length, frame);
+  if( n >= 2 && CRC8(frame, n - 1) == frame[n - 1] &&
+      Decode_Records(frame, n - 1) == 0 )
+  {
+    if( d.have_seq && frame[0] != d.seq )
+      d.lost += (unsigned char)(frame[0] - d.seq);
+    d.seq = (unsigned char)(frame[0] + 1);
+    d.have_seq = 1;
+    d.frames++;
+  }
+  else
+  {
+    // Latency and profiler dumps are printable lines
+    for( i = 0; i < length; i++ )
+      if( (chunk[i] < 0x20 || chunk[i] > 0x7E) && chunk[i] != '\r' &&
+          chunk[i] != '\n' )
+        text = 0;
+    if( text )
+      d.text++;
+    else
+      d.bad++;
+  }
+}
+
+int main( int argc, char **argv )
+{
+  FILE *fp = stdin;
+  unsigned char chunk[FRAME_MAX];
+  int ch, length = 0, arg, port, overflow = 0;
+  for( arg = 1; arg < argc; arg++ )
+  {
+    if( strcmp(argv[arg], "-v") == 0 )
+      verbose = 1;
+    else if( (fp = fopen(argv[arg], "rb")) == NULL )
+    {
+      perror(argv[arg]);
+      return 1;
+    }
+  }
+  while( (ch = fgetc(fp)) != EOF )
+  {
+    if( ch == 0 )
+    {
+      if( overflow )
+        d.bad++;
+      else
+        Decode_Chunk(chunk, length);
+      length = 0;
+      overflow = 0;
+    }
+    else if( length < FRAME_MAX )
+      chunk[length++] = (unsigned char)ch;
+    else
+      overflow = 1;
+  }
+  if( fp != stdin )
+    fclose(fp);
+  printf("frames %lu, events %lu, lost frames %lu, bad frames %lu, "
+         "text lines %lu\n", d.frames, d.events, d.lost, d.bad, d.text);
+  for( port = 0; port < PORTS_MAX; port++ )
+    if( d.keys[port] )
+      printf("port %d: %lu keys, last \"%s\"\n", port, d.keys[port],
+             d.tail[port]);
+  return ( d.lost || d.bad ) ? 1 : 0;
+}
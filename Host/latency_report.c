@@ -0,0 +1,156 @@
+/**
+ * @file latency_report.c
+ * @author Embedded Laboratory
+ * @brief Host Tool, Latency Dump to Percentiles.
+ *
+ * Reads the UART output of the board (see Latency_Dump()) from a file or
+ * stdin, other lines are ignored. The last complete dump is reported, a time
+ * within a bucket is interpolated linearly.
+ *
+ * Usage:
+ * @code
+ * latency_report [dump.txt]
+ * @endcode
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STAGES_MAX    8       /**< Stages in a Dump. */
+#define BUCKETS_MAX   128     /**< Buckets per Stage. */
+#define NAME_MAX_LEN  16      /**< Stage Name Length. */
+
+/**
+ * @brief Histogram of a Stage as read from the Dump.
+ */
+typedef struct
+{
+  char name[NAME_MAX_LEN];
+  unsigned long count;
+  unsigned long max_us;
+  int buckets;
+  unsigned long low[BUCKETS_MAX];
+  unsigned long n[BUCKETS_MAX];
+} Stage_s;
+
+static Stage_s stages[STAGES_MAX], report[STAGES_MAX];
+static int stage_count, report_count;
+
+/**
+ * @brief Upper end of a Bucket, must match Latency_Bucket() of the target.
+ */
+static unsigned long Bucket_High( unsigned long low )
+{
+  unsigned long width = 1;
+  while( low >= 8u * width )
+    width *= 2u;
+  return low + width;
+}
+
+static Stage_s* Find_Stage( const char *name )
+{
+  int i;
+  for( i = 0; i < stage_count; i++ )
+  {
+    if( strcmp(stages[i].name, name) == 0 )
+      return &stages[i];
+  }
+  return NULL;
+}
+
+/**
+ * @brief Time below which a fraction q of the samples are.
+ */
+static double Percentile( const Stage_s *s, double q )
+{
+  double target = q * (double)s->count, sum = 0, high;
+  int i;
+  for( i = 0; i < s->buckets; i++ )
+  {
+    if( sum + (double)s->n[i] >= target )
+    {
+      high = (double)Bucket_High(s->low[i]);
+      if( high > (double)s->max_us + 1.0 )
+        high = (double)s->max_us + 1.0;
+      high = (double)s->low[i] +
+             (high - (double)s->low[i]) * (target - sum) / (double)s->n[i];
+      return ( high < (double)s->max_us ) ? high : (double)s->max_us;
+    }
+    sum += (double)s->n[i];
+  }
+  return (double)s->max_us;
+}
+
+int main( int argc, char **argv )
+{
+  static const double q[] = { 0.5, 0.9, 0.99, 0.999 };
+  FILE *fp = stdin;
+  char line[256], name[NAME_MAX_LEN];
+  unsigned long a, b;
+  Stage_s *s;
+  int i, k, in_dump = 0;
+  if( argc > 1 && (fp = fopen(argv[1], "r")) == NULL )
+  {
+    perror(argv[1]);
+    return 1;
+  }
+  while( fgets(line, sizeof(line), fp) )
+  {
+    if( strncmp(line, "LAT BEGIN", 9) == 0 )
+    {
+      in_dump = 1;
+      stage_count = 0;
+    }
+    else if( !in_dump )
+    {
+      continue;
+    }
+    else if( sscanf(line, "LAT STAGE %15s %lu %lu", name, &a, &b) == 3 &&
+             stage_count < STAGES_MAX )
+    {
+      s = &stages[stage_count++];
+      memset(s, 0, sizeof(*s));
+      strcpy(s->name, name);
+      s->count = a;
+      s->max_us = b;
+    }
+    else if( sscanf(line, "LAT BUCKET %15s %lu %lu", name, &a, &b) == 3 )
+    {
+      s = Find_Stage(name);
+      if( s && s->buckets < BUCKETS_MAX )
+      {
+        s->low[s->buckets] = a;
+        s->n[s->buckets++] = b;
+      }
+    }
+    else if( strncmp(line, "LAT END", 7) == 0 )
+    {
+      in_dump = 0;
+      memcpy(report, stages, sizeof(stages));
+      report_count = stage_count;
+    }
+  }
+  if( fp != stdin )
+    fclose(fp);
+  if( report_count == 0 )
+  {
+    fprintf(stderr, "latency_report: no complete dump found\n");
+    return 1;
+  }
+  printf("%-8s %8s %9s %9s %9s %9s %9s\n", "stage", "count", "p50 us",
+         "p90 us", "p99 us", "p99.9 us", "max us");
+  for( i = 0; i < report_count; i++ )
+  {
+    printf("%-8s %8lu", report[i].name, report[i].count);
+    for( k = 0; k < 4; k++ )
+    {
+      if( report[i].count )
+        printf(" %9.0f", Percentile(&report[i], q[k]));
+      else
+        printf(" %9s", "-");
+    }
+    printf(" %9lu\n", report[i].max_us);
+  }
+  return 0;
+}
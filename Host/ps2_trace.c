@@ -0,0 +1,299 @@
+/**
+ * @file ps2_trace.c
+ * @author Embedded Laboratory
+ * @brief PS2 Trace Replay Engine for the Host Build.
+ *
+ * Recorded traces are plain text, one sample per line as exported from the
+ * logic analyzer: "<time_us> <clock> <data>". Lines starting with '#' are
+ * comments, except "# expect: <keys>" which gives the keys that the trace
+ * must decode to.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ps2_trace.h"
+#include "host_gpio.h"
+#include "host_clock.h"
+
+/**
+ * @brief Append one Falling Edge to the Trace.
+ */
+static void Trace_Push( PS2_Trace_s *trace, u32_t time_us, u8_t data )
+{
+  if( trace->count == trace->capacity )
+  {
+    trace->capacity = trace->capacity ? trace->capacity * 2u : 1024u;
+    trace->edges = realloc(trace->edges, trace->capacity * sizeof(PS2_Edge_s));
+    if( trace->edges == NULL )
+    {
+      perror("ps2_trace");
+      exit(1);
+    }
+  }
+  trace->edges[trace->count].time_us = time_us;
+  trace->edges[trace->count].data = data;
+  trace->count++;
+}
+
+/**
+ * @brief Initialize an empty Trace.
+ */
+void PS2_Trace_Init( PS2_Trace_s *trace )
+{
+  memset(trace, 0, sizeof(*trace));
+}
+
+/**
+ * @brief Release memory used by Trace.
+ */
+void PS2_Trace_Free( PS2_Trace_s *trace )
+{
+  free(trace->edges);
+  PS2_Trace_Init(trace);
+}
+
+/**
+ * @brief Load a recorded Trace.
+ *
+ * Only the clock high to low transitions are kept, with the data level
+ * sampled at that time.
+ * @return 0 on success, -1 if file can't be read.
+ */
+int PS2_Trace_Load( PS2_Trace_s *trace, const char *path )
+{
+  char line[512];
+  unsigned long t;
+  unsigned int clk, data, last_clk = 1u;
+  FILE *fp = fopen(path, "r");
+  if( fp == NULL )
+  {
+    return -1;
+  }
+  while( fgets(line, sizeof(line), fp) )
+  {
+    if( line[0] == '#' )
+    {
+      if( strncmp(line, "# expect: ", 10) == 0 )
+      {
+        snprintf(trace->expected, PS2_TRACE_EXPECT_MAX, "%.255s", line + 10);
+        trace->expected[strcspn(trace->expected, "\r\n")] = '\0';
+      }
+      continue;
+    }
+    if( sscanf(line, "%lu %u %u", &t, &clk, &data) != 3 )
+    {
+      continue;
+    }
+    if( last_clk && !clk )
+    {
+      Trace_Push(trace, (u32_t)t, (u8_t)(data ? 1u : 0u));
+    }
+    last_clk = clk;
+    trace->time_us = (u32_t)t;
+  }
+  fclose(fp);
+  return 0;
+}
+
+/**
+ * @brief Append one PS2 Frame to a Trace.
+ *
+ * Frame is Start Bit (0), 8 Data Bits LSB first, Odd Parity and Stop Bit (1).
+ */
+void PS2_Trace_Add_Byte( PS2_Trace_s *trace, u8_t scan_code )
+{
+  u8_t bit, ones = 0;
+  Trace_Push(trace, trace->time_us, 0u);
+  trace->time_us += 2u * PS2_TRACE_HALF_BIT_US;
+  for( bit = 0; bit < 8u; bit++ )
+  {
+    u8_t value = (u8_t)((scan_code >> bit) & 0x01u);
+    ones += value;
+    Trace_Push(trace, trace->time_us, value);
+    trace->time_us += 2u * PS2_TRACE_HALF_BIT_US;
+  }
+  Trace_Push(trace, trace->time_us, (u8_t)((ones & 0x01u) ? 0u : 1u));
+  trace->time_us += 2u * PS2_TRACE_HALF_BIT_US;
+  Trace_Push(trace, trace->time_us, 1u);
+  trace->time_us += 2u * PS2_TRACE_HALF_BIT_US;
+}
+
+/**
+ * @brief Advance the Synthetic Trace Time, bus stays idle.
+ */
+void PS2_Trace_Idle( PS2_Trace_s *trace, u32_t us )
+{
+  trace->time_us += us;
+}
+
+/**
+ * @brief Append Press and Release of a Key to a Trace.
+ *
+ * Scan Code is looked up in the same tables used by the decoder, Shift is
+ * pressed around the key if it is only found in the Shift table.
+ * @return 0 on success, -1 if key can't be typed.
+ */
+int PS2_Trace_Add_Key( PS2_Trace_s *trace, char key )
+{
+  u8_t code;
+  size_t len = strlen(trace->expected);
+  boolean shift = FALSE;
+  for( code = 1; code < PS2_SET2_MAX; code++ )
+  {
+    if( PS2_KeyMap[0][code] == (u8_t)key )
+      break;
+  }
+  if( code == PS2_SET2_MAX )
+  {
+    for( code = 1; code < PS2_SET2_MAX; code++ )
+    {
+      if( PS2_KeyMap[PS2_KEYMAP_SHIFT][code] == (u8_t)key )
+        break;
+    }
+    if( code == PS2_SET2_MAX )
+      return -1;
+    shift = TRUE;
+  }
+  if( shift )
+  {
+    PS2_Trace_Add_Byte(trace, L_SHFT);
+    PS2_Trace_Idle(trace, PS2_TRACE_KEY_GAP_US);
+  }
+  PS2_Trace_Add_Byte(trace, code);
+  PS2_Trace_Idle(trace, PS2_TRACE_KEY_GAP_US);
+  PS2_Trace_Add_Byte(trace, 0xF0);
+  PS2_Trace_Add_Byte(trace, code);
+  PS2_Trace_Idle(trace, PS2_TRACE_KEY_GAP_US);
+  if( shift )
+  {
+    PS2_Trace_Add_Byte(trace, 0xF0);
+    PS2_Trace_Add_Byte(trace, L_SHFT);
+    PS2_Trace_Idle(trace, PS2_TRACE_KEY_GAP_US);
+  }
+  if( len + 1u < PS2_TRACE_EXPECT_MAX )
+  {
+    trace->expected[len] = key;
+    trace->expected[len + 1u] = '\0';
+  }
+  return 0;
+}
+
+/**
+ * @brief Replay one Edge.
+ *
+ * Drives the simulated Data pin and runs the PS2 State Machine, this is what
+ * the PS2 Clock pin interrupt does on target.
+ */
+void PS2_Trace_Replay_Edge( const PS2_Edge_s *edge )
+{
+  PS2_Trace_Replay_Port_Edge(PS2_PORT_KEYBOARD, edge);
+}
+
+/**
+ * @brief Replay one Edge on any PS2 Port.
+ */
+void PS2_Trace_Replay_Port_Edge( u8_t port, const PS2_Edge_s *edge )
+{
+  const PS2_Pins_s *pins = PS2_Get_Pins(port);
+  host_time_us = edge->time_us;
+  if( edge->data )
+    host_gpio_data[pins->data_port] |= (1u << pins->data_pin);
+  else
+    host_gpio_data[pins->data_port] &= ~(1u << pins->data_pin);
+  PS2_State_Machine(port);
+}
+
+/**
+ * @brief Simulated Device sends one Byte.
+ *
+ * Byte is sent right away at the current time, replies to commands are sent
+ * this way.
+ */
+void PS2_Trace_Device_Send( u8_t port, u8_t data )
+{
+  PS2_Trace_s trace;
+  size_t e;
+  PS2_Trace_Init(&trace);
+  trace.time_us = host_time_us;
+  PS2_Trace_Add_Byte(&trace, data);
+  for( e = 0; e < trace.count; e++ )
+    PS2_Trace_Replay_Port_Edge(port, &trace.edges[e]);
+  PS2_Trace_Free(&trace);
+}
+
+/**
+ * @brief Simulated Device clocks in one Command Byte.
+ *
+ * Host drives a line Low by making the pin an output, a released line is
+ * High due to pull-up. PS2_Command_Task() is run to start the transmission.
+ * @return Received Byte, or -1 on protocol error.
+ */
+int PS2_Trace_Device_Receive( u8_t port )
+{
+  const PS2_Pins_s *pins = PS2_Get_Pins(port);
+  int bit, value = 0, ones = 0;
+  u32_t data_mask = 1u << pins->data_pin;
+  host_gpio_data[pins->data_port] |= data_mask;
+  host_time_us += 3000u;
+  PS2_Command_Task();
+  if( !(host_gpio_dir[pins->clk_port] & (1u << pins->clk_pin)) )
+    return -1;                  // Clock not inhibited
+  host_time_us += 3000u;
+  PS2_Command_Task();
+  if( (host_gpio_dir[pins->clk_port] & (1u << pins->clk_pin)) ||
+      !(host_gpio_dir[pins->data_port] & data_mask) )
+    return -1;                  // No Request to Send
+  for( bit = 0; bit < 10; bit++ )
+  {
+    PS2_State_Machine(port);
+    if( !(host_gpio_dir[pins->data_port] & data_mask) )
+    {
+      ones += (bit < 9);
+      value |= (bit < 8) ? (1 << bit) : 0;
+    }
+    else if( bit == 9 )
+      return -1;                // Stop Bit must be High
+  }
+  if( (ones & 1) == 0 )
+    return -1;                  // Odd Parity
+  // Ack Bit
+  host_gpio_data[pins->data_port] &= ~data_mask;
+  PS2_State_Machine(port);
+  host_gpio_data[pins->data_port] |= data_mask;
+  return value;
+}
+
+/**
+ * @brief Replay a complete Trace.
+ *
+ * Keys are polled whenever the bus is idle for more than PS2_TRACE_IDLE_US,
+ * like the main loop polls the keyboard in between key presses.
+ * @param keys Buffer to store the decoded keys, NULL terminated.
+ * @param max Size of keys buffer.
+ * @return Number of decoded keys.
+ */
+size_t PS2_Trace_Replay( const PS2_Trace_s *trace, char *keys, size_t max )
+{
+  size_t i, n = 0;
+  u8_t buf[SCAN_CODE_MAX];
+  u8_t got, k;
+  for( i = 0; i < trace->count; i++ )
+  {
+    PS2_Trace_Replay_Edge(&trace->edges[i]);
+    if( (i + 1u == trace->count) ||
+        (trace->edges[i+1u].time_us - trace->edges[i].time_us >
+         PS2_TRACE_IDLE_US) )
+    {
+      got = PS2_ReadKeys(PS2_PORT_KEYBOARD, buf, SCAN_CODE_MAX);
+      for( k = 0; k < got; k++ )
+      {
+        if( n + 1u < max )
+          keys[n++] = (char)buf[k];
+      }
+    }
+  }
+  if( max )
+    keys[n] = '\0';
+  return n;
+}
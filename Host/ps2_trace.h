@@ -0,0 +1,58 @@
+/**
+ * @file ps2_trace.h
+ * @author Embedded Laboratory
+ * @brief PS2 Trace Replay Engine for the Host Build.
+ *
+ * A trace is a list of PS2 Clock falling edges along with the Data level at
+ * that edge, it is either loaded from a logic analyzer recording or generated
+ * from a string of keys. Replaying an edge drives the simulated Data pin and
+ * calls PS2_State_Machine() of the Keyboard Port, like PS2_GPIO_IRQHandler()
+ * does on target. A simulated device on any Port can also send single bytes
+ * and clock in the command bytes sent by PS2_Command_Task().
+ */
+
+#ifndef PS2_TRACE_H
+#define PS2_TRACE_H
+
+#include <stddef.h>
+#include "ps2_keyboard.h"
+
+#define PS2_TRACE_EXPECT_MAX  256u    /**< Expected Keys Buffer Size. */
+#define PS2_TRACE_HALF_BIT_US 40u     /**< Synthetic Clock Half Period. */
+#define PS2_TRACE_IDLE_US     1000u   /**< Bus Idle Time to Poll Keys. */
+#define PS2_TRACE_KEY_GAP_US  5000u   /**< Synthetic Time between Keys. */
+
+/**
+ * @brief PS2 Clock Falling Edge.
+ */
+typedef struct _PS2_Edge_s
+{
+  u32_t time_us;    /**< Time of Edge in micro-seconds. */
+  u8_t data;        /**< Data Line Level at Edge. */
+} PS2_Edge_s;
+
+/**
+ * @brief PS2 Trace.
+ */
+typedef struct _PS2_Trace_s
+{
+  PS2_Edge_s *edges;                    /**< Falling Edges. */
+  size_t count;                         /**< Number of Edges. */
+  size_t capacity;                      /**< Allocated Edges. */
+  u32_t time_us;                        /**< Time of next Synthetic Edge. */
+  char expected[PS2_TRACE_EXPECT_MAX];  /**< Keys expected after Decoding. */
+} PS2_Trace_s;
+
+void PS2_Trace_Init( PS2_Trace_s *trace );
+void PS2_Trace_Free( PS2_Trace_s *trace );
+int PS2_Trace_Load( PS2_Trace_s *trace, const char *path );
+void PS2_Trace_Add_Byte( PS2_Trace_s *trace, u8_t scan_code );
+int PS2_Trace_Add_Key( PS2_Trace_s *trace, char key );
+void PS2_Trace_Idle( PS2_Trace_s *trace, u32_t us );
+void PS2_Trace_Replay_Edge( const PS2_Edge_s *edge );
+void PS2_Trace_Replay_Port_Edge( u8_t port, const PS2_Edge_s *edge );
+void PS2_Trace_Device_Send( u8_t port, u8_t data );
+int PS2_Trace_Device_Receive( u8_t port );
+size_t PS2_Trace_Replay( const PS2_Trace_s *trace, char *keys, size_t max );
+
+#endif /* PS2_TRACE_H */
@@ -0,0 +1,162 @@
+/**
+ * @file LPC13xx.h
+ * @author Embedded Laboratory
+ * @brief Virtual Board wrapper of the LPC13xx Peripheral Access Layer.
+ *
+ * Only used by the Virtual Board Build, found before LPC13xx/Include. The
+ * vendor header gives the register layouts, the peripheral pointers are
+ * replaced by accessors of the models in Host/vboard which sync the board on
+ * every access. Registers which are polled through a pointer kept by the
+ * driver, or whose read has a side effect (UART RBR, IIR and LSR, SSP DR),
+ * get their own accessor through a member macro, so their structures are
+ * declared here with the same layout.
+ */
+
+#ifndef VBOARD_LPC13XX_H
+#define VBOARD_LPC13XX_H
+
+#define LPC_UART_TypeDef      LPC_UART_Vendor_TypeDef
+#define LPC_SSP_TypeDef       LPC_SSP_Vendor_TypeDef
+#define LPC_I2C_TypeDef       LPC_I2C_Vendor_TypeDef
+#include_next "LPC13xx.h"
+#undef LPC_UART_TypeDef
+#undef LPC_SSP_TypeDef
+#undef LPC_I2C_TypeDef
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief UART, offsets shared by the vendor header are separate here.
+ */
+typedef struct
+{
+  __I  uint32_t RBR_v[1];     /**< Receiver Buffer, read through RBR. */
+  __O  uint32_t THR;          /**< Transmit Holding Register. */
+  __IO uint32_t DLL;          /**< Divisor Latch LSB. */
+  __IO uint32_t DLM;          /**< Divisor Latch MSB. */
+  __IO uint32_t IER;          /**< Interrupt Enable Register. */
+  __I  uint32_t IIR_v[1];     /**< Interrupt ID, read through IIR. */
+  __O  uint32_t FCR;          /**< FIFO Control Register. */
+  __IO uint32_t LCR;          /**< Line Control Register. */
+  __IO uint32_t MCR;          /**< Modem Control Register. */
+  __I  uint32_t LSR_v[1];     /**< Line Status, read through LSR. */
+  __I  uint32_t MSR;          /**< Modem Status Register. */
+  __IO uint32_t SCR;          /**< Scratch Pad Register. */
+  __IO uint32_t ACR;          /**< Auto-baud Control Register. */
+  __IO uint32_t FDR;          /**< Fractional Divider Register. */
+  __IO uint32_t TER;          /**< Transmit Enable Register. */
+  __IO uint32_t RS485CTRL;    /**< RS-485 Control Register. */
+  __IO uint32_t ADRMATCH;     /**< RS-485 Address Match Register. */
+  __IO uint32_t RS485DLY;     /**< RS-485 Direction Delay Register. */
+} LPC_UART_TypeDef;
+
+/**
+ * @brief SSP, DR and SR are read through their accessors.
+ */
+typedef struct
+{
+  __IO uint32_t CR0;          /**< Control Register 0. */
+  __IO uint32_t CR1;          /**< Control Register 1. */
+  __IO uint32_t DR_v[1];      /**< Data Register, accessed through DR. */
+  __I  uint32_t SR_v[1];      /**< Status Register, read through SR. */
+  __IO uint32_t CPSR;         /**< Clock Prescale Register. */
+  __IO uint32_t IMSC;         /**< Interrupt Mask Set and Clear Register. */
+  __I  uint32_t RIS;          /**< Raw Interrupt Status Register. */
+  __I  uint32_t MIS;          /**< Masked Interrupt Status Register. */
+  __O  uint32_t ICR;          /**< Interrupt Clear Register. */
+} LPC_SSP_TypeDef;
+
+/**
+ * @brief I2C, CONSET, STAT, DAT and CONCLR are accessed through their
+ * accessors.
+ */
+typedef struct
+{
+  __IO uint32_t CONSET_v[1];  /**< Control Set, accessed through CONSET. */
+  __I  uint32_t STAT_v[1];    /**< Status, read through STAT. */
+  __IO uint32_t DAT_v[1];     /**< Data, accessed through DAT. */
+  __IO uint32_t ADR0;         /**< Slave Address Register 0. */
+  __IO uint32_t SCLH;         /**< SCL Duty Cycle High Half Word. */
+  __IO uint32_t SCLL;         /**< SCL Duty Cycle Low Half Word. */
+  __O  uint32_t CONCLR_v[1];  /**< Control Clear, written through CONCLR. */
+  __IO uint32_t MMCTRL;       /**< Monitor Mode Control Register. */
+  __IO uint32_t ADR1;         /**< Slave Address Register 1. */
+  __IO uint32_t ADR2;         /**< Slave Address Register 2. */
+  __IO uint32_t ADR3;         /**< Slave Address Register 3. */
+  __I  uint32_t DATA_BUFFER;  /**< Data Buffer Register. */
+  __IO uint32_t MASK0;        /**< Slave Address Mask Register 0. */
+  __IO uint32_t MASK1;        /**< Slave Address Mask Register 1. */
+  __IO uint32_t MASK2;        /**< Slave Address Mask Register 2. */
+  __IO uint32_t MASK3;        /**< Slave Address Mask Register 3. */
+} LPC_I2C_TypeDef;
+
+#define VBOARD_UART_RBR       0u    /**< RBR read, pops the RX FIFO. */
+#define VBOARD_UART_IIR       1u    /**< IIR read, clears THRE Interrupt. */
+#define VBOARD_UART_LSR       2u    /**< LSR read, clears Overrun. */
+
+/* Accessors of the Models, each one syncs the Board */
+LPC_GPIO_TypeDef* vboard_gpio( uint32_t port );
+LPC_TMR_TypeDef* vboard_timer( uint32_t timer );
+LPC_UART_TypeDef* vboard_uart( void );
+LPC_SSP_TypeDef* vboard_ssp( void );
+LPC_I2C_TypeDef* vboard_i2c( void );
+LPC_SYSCON_TypeDef* vboard_syscon( void );
+LPC_IOCON_TypeDef* vboard_iocon( void );
+LPC_PMU_TypeDef* vboard_pmu( void );
+uint32_t vboard_uart_read( uint32_t reg );
+uint32_t vboard_ssp_data( void );
+uint32_t vboard_ssp_status( void );
+uint32_t vboard_i2c_reg( void );
+
+#undef LPC_I2C
+#undef LPC_WWDT
+#undef LPC_UART
+#undef LPC_TMR16B0
+#undef LPC_TMR16B1
+#undef LPC_TMR32B0
+#undef LPC_TMR32B1
+#undef LPC_ADC
+#undef LPC_PMU
+#undef LPC_SSP0
+#undef LPC_SSP1
+#undef LPC_IOCON
+#undef LPC_SYSCON
+#undef LPC_USB
+#undef LPC_GPIO0
+#undef LPC_GPIO1
+#undef LPC_GPIO2
+#undef LPC_GPIO3
+
+#define LPC_I2C               (vboard_i2c())
+#define LPC_UART              (vboard_uart())
+#define LPC_TMR16B0           (vboard_timer(0))
+#define LPC_TMR16B1           (vboard_timer(1))
+#define LPC_TMR32B0           (vboard_timer(2))
+#define LPC_TMR32B1           (vboard_timer(3))
+#define LPC_PMU               (vboard_pmu())
+#define LPC_SSP0              (vboard_ssp())
+#define LPC_IOCON             (vboard_iocon())
+#define LPC_SYSCON            (vboard_syscon())
+#define LPC_GPIO0             (vboard_gpio(0))
+#define LPC_GPIO1             (vboard_gpio(1))
+#define LPC_GPIO2             (vboard_gpio(2))
+#define LPC_GPIO3             (vboard_gpio(3))
+
+/* Registers with Accessors */
+#define RBR       RBR_v[vboard_uart_read(VBOARD_UART_RBR)]
+#define IIR       IIR_v[vboard_uart_read(VBOARD_UART_IIR)]
+#define LSR       LSR_v[vboard_uart_read(VBOARD_UART_LSR)]
+#define DR        DR_v[vboard_ssp_data()]
+#define SR        SR_v[vboard_ssp_status()]
+#define CONSET    CONSET_v[vboard_i2c_reg()]
+#define STAT      STAT_v[vboard_i2c_reg()]
+#define DAT       DAT_v[vboard_i2c_reg()]
+#define CONCLR    CONCLR_v[vboard_i2c_reg()]
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VBOARD_LPC13XX_H */
@@ -0,0 +1,151 @@
+/**
+ * @file core_cm3.h
+ * @author Embedded Laboratory
+ * @brief Virtual Board replacement of CMSIS Cortex-M3 Core Header.
+ *
+ * Only used by the Virtual Board Build (see Host/Makefile), it is found before
+ * Host/include/core_cm3.h. Interrupt masking, WFI, NVIC and SysTick go to the
+ * core model of vboard.c, the DWT Cycle Counter counts the virtual clock.
+ */
+
+#ifndef VBOARD_CORE_CM3_H
+#define VBOARD_CORE_CM3_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define __I     volatile const  /**< Read Only Register. */
+#define __O     volatile        /**< Write Only Register. */
+#define __IO    volatile        /**< Read Write Register. */
+
+/**
+ * @brief System Timer.
+ */
+typedef struct
+{
+  __IO uint32_t CTRL;     /**< Control and Status Register. */
+  __IO uint32_t LOAD;     /**< Reload Value Register. */
+  __IO uint32_t VAL;      /**< Current Value Register. */
+  __I  uint32_t CALIB;    /**< Calibration Register. */
+} SysTick_Type;
+
+#define SysTick_CTRL_ENABLE_Msk       (1ul << 0)
+#define SysTick_CTRL_TICKINT_Msk      (1ul << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk    (1ul << 2)
+#define SysTick_CTRL_COUNTFLAG_Msk    (1ul << 16)
+#define SysTick_LOAD_RELOAD_Msk       (0xFFFFFFul)
+
+/**
+ * @brief System Control Block, only the Registers used by the Drivers.
+ */
+typedef struct
+{
+  __I  uint32_t CPUID;    /**< CPU ID Base Register. */
+  __IO uint32_t ICSR;     /**< Interrupt Control State Register. */
+  __IO uint32_t VTOR;     /**< Vector Table Offset Register. */
+  __IO uint32_t AIRCR;    /**< Application Interrupt and Reset Control. */
+  __IO uint32_t SCR;      /**< System Control Register. */
+  __IO uint32_t CCR;      /**< Configuration Control Register. */
+} SCB_Type;
+
+/**
+ * @brief Data Watchpoint and Trace Unit, only the Cycle Counter.
+ */
+typedef struct
+{
+  __IO uint32_t CTRL;     /**< Control Register. */
+  __IO uint32_t CYCCNT;   /**< Cycle Counter. */
+} DWT_Type;
+
+/**
+ * @brief Core Debug Registers.
+ */
+typedef struct
+{
+  __IO uint32_t DHCSR;
+  __O  uint32_t DCRSR;
+  __IO uint32_t DCRDR;
+  __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk        (1ul << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk    (1ul << 24)
+
+/* Core Model, see vboard.c */
+void vboard_primask( uint32_t set );
+void vboard_wfi( void );
+void vboard_nvic_enable( IRQn_Type IRQn, uint32_t enable );
+void vboard_nvic_pend( IRQn_Type IRQn, uint32_t pend );
+void vboard_nvic_priority( IRQn_Type IRQn, uint32_t priority );
+SysTick_Type* vboard_systick( void );
+SCB_Type* vboard_scb( void );
+DWT_Type* vboard_dwt( void );
+CoreDebug_Type* vboard_core_debug( void );
+
+#define SysTick     (vboard_systick())
+#define SCB         (vboard_scb())
+#define DWT         (vboard_dwt())
+#define CoreDebug   (vboard_core_debug())
+
+/* IAR and CMSIS Intrinsics */
+#define __disable_interrupt()   vboard_primask(1u)
+#define __enable_interrupt()    vboard_primask(0u)
+#define __disable_irq()         vboard_primask(1u)
+#define __enable_irq()          vboard_primask(0u)
+#define __WFI()                 vboard_wfi()
+#define __NOP()                 do { } while(0)
+#define __DSB()                 do { } while(0)
+#define __ISB()                 do { } while(0)
+#define __DMB()                 do { } while(0)
+#define __CLZ(x)                ((uint8_t)((x) ? __builtin_clz(x) : 32))
+
+static inline void NVIC_EnableIRQ( IRQn_Type IRQn )
+{
+  vboard_nvic_enable(IRQn, 1u);
+}
+
+static inline void NVIC_DisableIRQ( IRQn_Type IRQn )
+{
+  vboard_nvic_enable(IRQn, 0u);
+}
+
+static inline void NVIC_SetPendingIRQ( IRQn_Type IRQn )
+{
+  vboard_nvic_pend(IRQn, 1u);
+}
+
+static inline void NVIC_ClearPendingIRQ( IRQn_Type IRQn )
+{
+  vboard_nvic_pend(IRQn, 0u);
+}
+
+static inline void NVIC_SetPriority( IRQn_Type IRQn, uint32_t priority )
+{
+  vboard_nvic_priority(IRQn, priority);
+}
+
+/**
+ * @brief SysTick Configuration, same as CMSIS.
+ *
+ * SysTick gets the lowest priority and interrupts every ticks cycles.
+ */
+static inline uint32_t SysTick_Config( uint32_t ticks )
+{
+  if( ticks - 1u > SysTick_LOAD_RELOAD_Msk )
+    return 1u;
+  SysTick->LOAD = ticks - 1u;
+  NVIC_SetPriority(SysTick_IRQn, (1u << __NVIC_PRIO_BITS) - 1u);
+  SysTick->VAL = 0;
+  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk |
+                  SysTick_CTRL_ENABLE_Msk;
+  return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VBOARD_CORE_CM3_H */
@@ -0,0 +1,659 @@
+/**
+ * @file vboard.c
+ * @author Embedded Laboratory
+ * @brief Virtual Board, Core Model and Scheduler.
+ *
+ * The firmware runs on its own stack, the bench switches to it for a virtual
+ * time and gets control back once the clock reaches the end of that time.
+ * Every register access syncs the board (see vboard_model.h) and costs
+ * VBOARD_ACCESS_CYCLES, code between two accesses takes no time. A sync
+ * only commits and publishes the models the firmware touched, an access
+ * costs the host about the same whatever else is on the board. WFI jumps
+ * the clock to the next event of a model. The NVIC takes the pending
+ * interrupt of highest priority, ties go to the lower exception number, and
+ * a handler is preempted only by a higher priority. SysTick, SCB, DWT,
+ * SYSCON, IOCON and PMU are modeled here, SYSCON is plain registers with the
+ * PLLs always locked.
+ */
+
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include "vboard_model.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE   0x100000
+#endif
+
+/* Stack of the Firmware */
+#ifndef VBOARD_STACK_SIZE
+#define VBOARD_STACK_SIZE     (256u * 1024u)
+#endif
+
+#define VB_EVENTS_MAX         32u       /**< Registered Events. */
+#define VB_EXCEPTIONS         (16u + 58u)   /**< Exceptions up to SSP1. */
+#define VB_THREAD_PRIO        0x100u    /**< Execution Priority of main(). */
+#define VB_RUN_SLICE_US       100u      /**< Step of vboard_run_until(). */
+#define VB_FLASHCFG_PAGE      0x4003C000ul  /**< Written by SystemInit(). */
+
+uint64_t vb_now = 0;
+LPC_SYSCON_TypeDef vb_syscon;
+
+/* Handlers of the Firmware, missing ones are NULL */
+#define VB_WEAK   __attribute__((weak))
+void SysTick_Handler( void ) VB_WEAK;
+void WAKEUP_IRQHandler( void ) VB_WEAK;
+void I2C_IRQHandler( void ) VB_WEAK;
+void TIMER16_0_IRQHandler( void ) VB_WEAK;
+void TIMER16_1_IRQHandler( void ) VB_WEAK;
+void TIMER32_0_IRQHandler( void ) VB_WEAK;
+void TIMER32_1_IRQHandler( void ) VB_WEAK;
+void SSP_IRQHandler( void ) VB_WEAK;
+void UART_IRQHandler( void ) VB_WEAK;
+void PIOINT3_IRQHandler( void ) VB_WEAK;
+void PIOINT2_IRQHandler( void ) VB_WEAK;
+void PIOINT1_IRQHandler( void ) VB_WEAK;
+void PIOINT0_IRQHandler( void ) VB_WEAK;
+
+static void vb_core_reset( void );
+static void vb_core_commit( void );
+static void vb_core_publish( void );
+
+static const vb_model_t vb_core_model =
+{
+  vb_core_reset, vb_core_commit, vb_core_publish
+};
+
+/* Indexed by VB_MODEL_xxx */
+static const vb_model_t *const models[VB_MODELS] =
+{
+  &vb_core_model, &vb_gpio_model, &vb_timer_model, &vb_uart_model,
+  &vb_ssp_model, &vb_i2c_model
+};
+#define VB_MODELS_ALL   ((1u << VB_MODELS) - 1u)
+
+// Scheduler
+static vb_event_t *events[VB_EVENTS_MAX];
+static uint32_t event_count = 0;
+static vb_event_t *next_event = NULL;   // Earliest armed Event
+static uint64_t stop_at = VB_NEVER;     // End of the Run, back to the bench
+static ucontext_t bench_context, firmware_context;
+static uint8_t firmware_stack[VBOARD_STACK_SIZE] __attribute__((aligned(16)));
+static uint8_t booted = 0, halted = 0;
+static uint32_t dirty = 0;              // Models accessed since their Sync
+static vboard_stats_t stats;
+
+// NVIC, bit n is IRQn n
+static uint64_t nvic_enabled, nvic_latched, nvic_lines;
+static uint8_t nvic_priority[64];
+static uint8_t systick_priority, systick_pending;
+static uint32_t primask, exec_priority = VB_THREAD_PRIO;
+static void (*handlers[VB_EXCEPTIONS])( void );
+
+// Core Peripherals, pub is the value last published
+static SysTick_Type systick, systick_pub;
+static uint64_t systick_base;
+static vb_event_t systick_event;
+static DWT_Type dwt, dwt_pub;
+static uint64_t dwt_offset;
+static SCB_Type scb;
+static CoreDebug_Type core_debug;
+static LPC_IOCON_TypeDef iocon;
+static LPC_PMU_TypeDef pmu;
+
+static void vb_next_scan( void );
+static void vb_advance( uint64_t target );
+static void vb_flush( uint32_t mask );
+static int32_t vb_next_exception( void );
+static void vb_take_irqs( void );
+static void vb_check_irqs( void );
+static void vb_exception( int32_t exception );
+static void vb_yield( void );
+static void vb_systick_fire( vb_event_t *ev );
+static void vb_systick_start( void );
+static void vb_firmware_entry( void );
+
+/**
+ * @brief Abort the Bench, the Board is in a state it can't leave.
+ */
+void vb_fatal( const char *format, ... )
+{
+  va_list args;
+  fprintf(stderr, "vboard: ");
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fprintf(stderr, " (cycle %llu)\n", (unsigned long long)vb_now);
+  exit(2);
+}
+
+/**
+ * @brief Register an Event, it is not armed.
+ */
+void vb_event_init( vb_event_t *ev, void (*fire)( vb_event_t *ev ),
+                    void *owner )
+{
+  uint32_t i;
+  ev->when = VB_NEVER;
+  ev->fire = fire;
+  ev->owner = owner;
+  for( i = 0; i < event_count && events[i] != ev; i++ )
+    ;
+  if( i == event_count )
+  {
+    if( event_count == VB_EVENTS_MAX )
+      vb_fatal("more than %u events", VB_EVENTS_MAX);
+    events[event_count++] = ev;
+  }
+  vb_next_scan();
+}
+
+/**
+ * @brief Arm an Event, a time in the past fires at the next Sync.
+ */
+void vb_event_at( vb_event_t *ev, uint64_t when )
+{
+  ev->when = when;
+  if( next_event == ev )
+    vb_next_scan();
+  else if( next_event == NULL || when < next_event->when )
+    next_event = ev;
+}
+
+/**
+ * @brief Disarm an Event.
+ */
+void vb_event_cancel( vb_event_t *ev )
+{
+  ev->when = VB_NEVER;
+  if( next_event == ev )
+    vb_next_scan();
+}
+
+/**
+ * @brief Find the earliest armed Event.
+ */
+static void vb_next_scan( void )
+{
+  uint32_t i;
+  next_event = NULL;
+  for( i = 0; i < event_count; i++ )
+  {
+    if( events[i]->when != VB_NEVER &&
+        (next_event == NULL || events[i]->when < next_event->when) )
+    {
+      next_event = events[i];
+    }
+  }
+}
+
+/**
+ * @brief Run the Clock to target, firing the Events on the way.
+ */
+static void vb_advance( uint64_t target )
+{
+  vb_event_t *ev;
+  while( (ev = next_event) != NULL && ev->when <= target )
+  {
+    if( ev->when > vb_now )
+      vb_now = ev->when;
+    ev->when = VB_NEVER;
+    vb_next_scan();
+    ev->fire(ev);
+  }
+  if( target > vb_now )
+    vb_now = target;
+}
+
+/**
+ * @brief Interrupt Line of a Peripheral.
+ *
+ * A rising line sets the pending state, the interrupt is pending as long as
+ * the line is high and pending again if the line rises during its handler.
+ */
+void vb_irq_line( IRQn_Type IRQn, uint32_t level )
+{
+  uint64_t bit = 1ull << (uint32_t)IRQn;
+  if( level )
+  {
+    if( !(nvic_lines & bit) )
+    {
+      nvic_lines |= bit;
+      nvic_latched |= bit;
+    }
+  }
+  else
+  {
+    nvic_lines &= ~bit;
+  }
+}
+
+/**
+ * @brief Sync the Board, called by every Register Accessor.
+ *
+ * The models written since their last sync are committed and published, the
+ * accessed model is committed before and published after the clock
+ * advances. It is published again if a handler ran meanwhile.
+ * @param model Accessed Model, VB_MODEL_xxx.
+ */
+void vb_sync( uint32_t model )
+{
+  uint32_t bit = 1u << model;
+  uint64_t interrupts = stats.interrupts;
+  vb_flush(dirty & ~bit);
+  dirty = 0;
+  models[model]->commit();
+  stats.accesses++;
+  vb_advance(vb_now + VBOARD_ACCESS_CYCLES);
+  if( vb_now >= stop_at )
+    vb_yield();
+  models[model]->publish();
+  vb_take_irqs();
+  if( stats.interrupts != interrupts )
+    models[model]->publish();
+  dirty |= bit;
+}
+
+/**
+ * @brief Commit the Writes of the Firmware and refresh the Registers.
+ * @param mask Models, bit n is VB_MODEL n.
+ */
+static void vb_flush( uint32_t mask )
+{
+  uint32_t i;
+  while( mask )
+  {
+    i = (uint32_t)__builtin_ctz(mask);
+    mask &= mask - 1u;
+    models[i]->commit();
+    models[i]->publish();
+  }
+}
+
+static void vb_core_reset( void )
+{
+  vb_event_init(&systick_event, vb_systick_fire, NULL);
+  vb_core_publish();
+}
+
+/**
+ * @brief Apply the Writes of the Firmware to SysTick and DWT.
+ */
+static void vb_core_commit( void )
+{
+  // SysTick, a write to VAL clears it and restarts the count
+  if( systick.CTRL != systick_pub.CTRL || systick.VAL != systick_pub.VAL ||
+      systick.LOAD != systick_pub.LOAD )
+  {
+    systick.LOAD &= SysTick_LOAD_RELOAD_Msk;
+    vb_systick_start();
+  }
+  if( dwt.CYCCNT != dwt_pub.CYCCNT )
+  {
+    dwt_offset = vb_now - dwt.CYCCNT;
+  }
+}
+
+/**
+ * @brief Refresh SysTick, DWT and the PLL Status read by the Firmware.
+ */
+static void vb_core_publish( void )
+{
+  uint64_t period;
+  if( (systick.CTRL & SysTick_CTRL_ENABLE_Msk) && systick.LOAD )
+  {
+    period = (uint64_t)systick.LOAD + 1u;
+    systick.VAL = (uint32_t)((period - (vb_now - systick_base) % period) %
+                             period);
+  }
+  systick_pub.CTRL = systick.CTRL;
+  systick_pub.LOAD = systick.LOAD;
+  systick_pub.VAL = systick.VAL;
+  dwt.CYCCNT = (uint32_t)(vb_now - dwt_offset);
+  dwt_pub = dwt;
+  VB_SET(vb_syscon.SYSPLLSTAT, 1u);
+  VB_SET(vb_syscon.USBPLLSTAT, 1u);
+}
+
+/**
+ * @brief SysTick configured, first interrupt after LOAD + 1 cycles.
+ */
+static void vb_systick_start( void )
+{
+  systick_base = vb_now;
+  if( (systick.CTRL & SysTick_CTRL_ENABLE_Msk) && systick.LOAD )
+    vb_event_at(&systick_event, systick_base + systick.LOAD + 1u);
+  else
+    vb_event_cancel(&systick_event);
+}
+
+/**
+ * @brief SysTick counted to 0.
+ */
+static void vb_systick_fire( vb_event_t *ev )
+{
+  systick_base = vb_now;
+  if( systick.CTRL & SysTick_CTRL_TICKINT_Msk )
+    systick_pending = 1;
+  vb_event_at(ev, vb_now + systick.LOAD + 1u);
+}
+
+/**
+ * @brief Pending Exception which preempts the Execution Priority.
+ * @return Exception Number, -1 if none.
+ */
+static int32_t vb_next_exception( void )
+{
+  uint64_t pending = (nvic_latched | nvic_lines) & nvic_enabled;
+  uint32_t n, best_priority = exec_priority;
+  int32_t best = -1;
+  if( systick_pending && systick_priority < best_priority )
+  {
+    best = 15;
+    best_priority = systick_priority;
+  }
+  while( pending )
+  {
+    n = (uint32_t)__builtin_ctzll(pending);
+    pending &= pending - 1u;
+    if( nvic_priority[n] < best_priority )
+    {
+      best = (int32_t)(16u + n);
+      best_priority = nvic_priority[n];
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief Take pending Interrupts unless PRIMASK is set.
+ */
+static void vb_take_irqs( void )
+{
+  int32_t exception;
+  while( !primask && (exception = vb_next_exception()) >= 0 )
+    vb_exception(exception);
+}
+
+/**
+ * @brief Run the Handler of an Exception.
+ */
+static void vb_exception( int32_t exception )
+{
+  uint32_t saved = exec_priority;
+  void (*handler)( void ) = handlers[exception];
+  if( exception == 15 )
+  {
+    systick_pending = 0;
+    exec_priority = systick_priority;
+  }
+  else
+  {
+    nvic_latched &= ~(1ull << (uint32_t)(exception - 16));
+    exec_priority = nvic_priority[exception - 16];
+  }
+  if( handler == NULL )
+    vb_fatal("no handler for exception %d", (int)exception);
+  stats.interrupts++;
+  vb_flush(VB_MODELS_ALL);
+  dirty = 0;
+  vb_advance(vb_now + VBOARD_IRQ_CYCLES);
+  handler();
+  vb_flush(VB_MODELS_ALL);
+  dirty = 0;
+  exec_priority = saved;
+}
+
+/**
+ * @brief Back to the Bench, returns when it runs the Board again.
+ */
+static void vb_yield( void )
+{
+  swapcontext(&firmware_context, &bench_context);
+}
+
+/**
+ * @brief Start of the Firmware Stack.
+ */
+static void vb_firmware_entry( void )
+{
+  vboard_firmware_main();
+  halted = 1;
+  for( ;; )
+    vb_yield();
+}
+
+/**
+ * @brief Take the Interrupts which became pending without a Sync.
+ */
+static void vb_check_irqs( void )
+{
+  if( !primask )
+  {
+    vb_flush(dirty);
+    dirty = 0;
+    vb_take_irqs();
+  }
+}
+
+/**
+ * @brief PRIMASK, interrupts pending meanwhile are taken when it is cleared.
+ */
+void vboard_primask( uint32_t set )
+{
+  primask = set;
+  vb_check_irqs();
+}
+
+/**
+ * @brief Wait for Interrupt.
+ *
+ * The clock jumps from event to event until an interrupt of higher priority
+ * than the execution priority is pending, PRIMASK only delays its handler.
+ */
+void vboard_wfi( void )
+{
+  uint64_t target;
+  vb_flush(VB_MODELS_ALL);
+  dirty = 0;
+  while( vb_next_exception() < 0 )
+  {
+    target = ( next_event != NULL ) ? next_event->when : VB_NEVER;
+    if( target > stop_at )
+      target = stop_at;
+    if( target == VB_NEVER )
+      vb_fatal("WFI with no event to wake up");
+    if( target > vb_now )
+      stats.sleep_cycles += target - vb_now;
+    vb_advance(target);
+    if( vb_now >= stop_at )
+      vb_yield();
+  }
+  vb_flush(VB_MODELS_ALL);
+  vb_take_irqs();
+}
+
+void vboard_nvic_enable( IRQn_Type IRQn, uint32_t enable )
+{
+  if( IRQn < 0 )
+    return;
+  if( enable )
+  {
+    nvic_enabled |= 1ull << (uint32_t)IRQn;
+    vb_check_irqs();
+  }
+  else
+  {
+    nvic_enabled &= ~(1ull << (uint32_t)IRQn);
+  }
+}
+
+void vboard_nvic_pend( IRQn_Type IRQn, uint32_t pend )
+{
+  if( IRQn == SysTick_IRQn )
+    systick_pending = (uint8_t)(pend != 0u);
+  else if( IRQn >= 0 && pend )
+    nvic_latched |= 1ull << (uint32_t)IRQn;
+  else if( IRQn >= 0 )
+    nvic_latched &= ~(1ull << (uint32_t)IRQn);
+  if( pend )
+    vb_check_irqs();
+}
+
+void vboard_nvic_priority( IRQn_Type IRQn, uint32_t priority )
+{
+  priority &= (1u << __NVIC_PRIO_BITS) - 1u;
+  if( IRQn == SysTick_IRQn )
+    systick_priority = (uint8_t)priority;
+  else if( IRQn >= 0 )
+    nvic_priority[IRQn] = (uint8_t)priority;
+}
+
+SysTick_Type* vboard_systick( void )
+{
+  vb_sync(VB_MODEL_CORE);
+  return &systick;
+}
+
+SCB_Type* vboard_scb( void )
+{
+  vb_sync(VB_MODEL_CORE);
+  return &scb;
+}
+
+DWT_Type* vboard_dwt( void )
+{
+  vb_sync(VB_MODEL_CORE);
+  return &dwt;
+}
+
+CoreDebug_Type* vboard_core_debug( void )
+{
+  vb_sync(VB_MODEL_CORE);
+  return &core_debug;
+}
+
+LPC_SYSCON_TypeDef* vboard_syscon( void )
+{
+  vb_sync(VB_MODEL_CORE);
+  return &vb_syscon;
+}
+
+LPC_IOCON_TypeDef* vboard_iocon( void )
+{
+  vb_sync(VB_MODEL_CORE);
+  return &iocon;
+}
+
+LPC_PMU_TypeDef* vboard_pmu( void )
+{
+  vb_sync(VB_MODEL_CORE);
+  return &pmu;
+}
+
+/**
+ * @brief Power On, the firmware starts with the first Run.
+ *
+ * SystemInit() writes the Flash Configuration Register at its address, the
+ * page is mapped there. Only one boot per process, the static variables of
+ * the firmware are not reset.
+ */
+void vboard_boot( void )
+{
+  void *page;
+  uint32_t i;
+  if( booted )
+    vb_fatal("board booted twice");
+  page = mmap((void *)VB_FLASHCFG_PAGE, 4096, PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+  if( page != (void *)VB_FLASHCFG_PAGE )
+    vb_fatal("can't map the flash configuration register");
+  booted = 1;
+  vb_now = 0;
+  memset(&vb_syscon, 0, sizeof(vb_syscon));
+  vb_syscon.SYSAHBCLKDIV = 1u;
+  vb_syscon.UARTCLKDIV = 1u;
+  vb_syscon.SSP0CLKDIV = 1u;
+  for( i = 0; i < VB_MODELS; i++ )
+    models[i]->reset();
+  vb_lcd_reset();
+  vb_ps2_reset();
+  for( i = 0; i < 40u; i++ )
+    handlers[16u + i] = WAKEUP_IRQHandler;
+  handlers[15] = SysTick_Handler;
+  handlers[16 + I2C_IRQn] = I2C_IRQHandler;
+  handlers[16 + TIMER_16_0_IRQn] = TIMER16_0_IRQHandler;
+  handlers[16 + TIMER_16_1_IRQn] = TIMER16_1_IRQHandler;
+  handlers[16 + TIMER_32_0_IRQn] = TIMER32_0_IRQHandler;
+  handlers[16 + TIMER_32_1_IRQn] = TIMER32_1_IRQHandler;
+  handlers[16 + SSP0_IRQn] = SSP_IRQHandler;
+  handlers[16 + UART_IRQn] = UART_IRQHandler;
+  handlers[16 + EINT3_IRQn] = PIOINT3_IRQHandler;
+  handlers[16 + EINT2_IRQn] = PIOINT2_IRQHandler;
+  handlers[16 + EINT1_IRQn] = PIOINT1_IRQHandler;
+  handlers[16 + EINT0_IRQn] = PIOINT0_IRQHandler;
+  getcontext(&firmware_context);
+  firmware_context.uc_stack.ss_sp = firmware_stack;
+  firmware_context.uc_stack.ss_size = sizeof(firmware_stack);
+  firmware_context.uc_link = NULL;
+  makecontext(&firmware_context, vb_firmware_entry, 0);
+}
+
+/**
+ * @brief Run the Firmware for a virtual Time.
+ * @param us Micro-seconds of the virtual Clock.
+ */
+void vboard_run_us( uint32_t us )
+{
+  if( !booted )
+    vb_fatal("board not booted");
+  if( halted )
+    return;
+  stop_at = vb_now + (uint64_t)us * VB_US;
+  swapcontext(&bench_context, &firmware_context);
+}
+
+/**
+ * @brief Run the Firmware until a Condition of the Bench holds.
+ * @param done Checked every VB_RUN_SLICE_US.
+ * @param timeout_us Longest virtual Time.
+ * @return 1 if done, 0 on timeout or if the firmware halted.
+ */
+int vboard_run_until( int (*done)( void ), uint32_t timeout_us )
+{
+  uint64_t end = vb_now + (uint64_t)timeout_us * VB_US;
+  while( !done() )
+  {
+    if( vb_now >= end || halted )
+      return 0;
+    vboard_run_us(VB_RUN_SLICE_US);
+  }
+  return 1;
+}
+
+/**
+ * @brief Firmware returned from main.
+ */
+int vboard_halted( void )
+{
+  return halted;
+}
+
+uint64_t vboard_cycles( void )
+{
+  return vb_now;
+}
+
+uint64_t vboard_us( void )
+{
+  return vb_now / VB_US;
+}
+
+const vboard_stats_t* vboard_get_stats( void )
+{
+  return &stats;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file vboard.h
+ * @author Embedded Laboratory
+ * @brief Virtual Board, the whole Firmware on a simulated LPC1343.
+ *
+ * Application/ and Drivers/ are built unchanged for Linux, LPC13xx.h and
+ * core_cm3.h of Host/vboard/include back the registers with models of the
+ * GPIO, Timer, UART, SSP, I2C, SYSCON, NVIC, SysTick and DWT. The board has
+ * a HD44780 LCD, a PS2 Keyboard on the keyboard port and an I2C EEPROM. The
+ * firmware runs on its own stack against a virtual clock of 72 MHz which
+ * advances with every register access and jumps ahead while the core sleeps,
+ * a bench runs it for a virtual time, injects keys and UART bytes and reads
+ * back the LCD and the UART output.
+ */
+
+#ifndef VBOARD_H
+#define VBOARD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VBOARD_CLOCK_HZ     72000000u   /**< Core Clock. */
+
+/* Cycles of one Register Access, firmware code in between is not timed */
+#ifndef VBOARD_ACCESS_CYCLES
+#define VBOARD_ACCESS_CYCLES    6u
+#endif
+
+/* Cycles of Interrupt Entry and Exit */
+#ifndef VBOARD_IRQ_CYCLES
+#define VBOARD_IRQ_CYCLES       24u
+#endif
+
+/**
+ * @brief Virtual Board Statistics.
+ */
+typedef struct
+{
+  uint64_t accesses;        /**< Register Accesses, Syncs. */
+  uint64_t interrupts;      /**< Interrupts taken. */
+  uint64_t sleep_cycles;    /**< Cycles the Core slept in WFI. */
+} vboard_stats_t;
+
+/**
+ * @brief LCD Statistics.
+ */
+typedef struct
+{
+  uint32_t commands;        /**< Instructions executed. */
+  uint32_t characters;      /**< Characters written to DDRAM or CGRAM. */
+  uint32_t busy_reads;      /**< Busy Flag read. */
+  uint32_t violations;      /**< Written while busy, or in 4-bit Mode. */
+} vboard_lcd_stats_t;
+
+/**
+ * @brief PS2 Device Statistics.
+ */
+typedef struct
+{
+  uint32_t sent;            /**< Bytes sent to the Host. */
+  uint32_t aborted;         /**< Bytes aborted by Host Inhibit, sent again. */
+  uint32_t received;        /**< Bytes received from the Host. */
+  uint32_t parity_errors;   /**< Received with bad Parity or Stop Bit. */
+  uint8_t leds;             /**< Argument of the last Set LEDs Command. */
+  uint8_t typematic;        /**< Argument of the last Typematic Command. */
+} vboard_ps2_stats_t;
+
+/** Called when a Character is written to the DDRAM of the LCD. */
+typedef void (*vboard_lcd_hook_t)( uint8_t address, uint8_t c );
+/** Called when the Start Bit of a Byte is put on the PS2 Data Line. */
+typedef void (*vboard_ps2_hook_t)( uint8_t port, uint8_t byte );
+/** SSP Slave, returns the Frame sent back for a Frame received. */
+typedef uint16_t (*vboard_ssp_slave_t)( uint16_t frame );
+
+// Board
+void vboard_boot( void );
+void vboard_run_us( uint32_t us );
+int vboard_run_until( int (*done)( void ), uint32_t timeout_us );
+int vboard_halted( void );
+uint64_t vboard_cycles( void );
+uint64_t vboard_us( void );
+const vboard_stats_t* vboard_get_stats( void );
+
+// LCD
+void vboard_lcd_row( uint8_t row, char *text );
+void vboard_lcd_hook( vboard_lcd_hook_t hook );
+uint8_t vboard_lcd_backlight( void );
+const vboard_lcd_stats_t* vboard_lcd_get_stats( void );
+
+// UART
+const uint8_t* vboard_uart_output( uint32_t *length );
+void vboard_uart_input( const uint8_t *data, uint32_t length );
+
+// PS2 Devices, port is PS2_PORT_KEYBOARD or PS2_PORT_AUX
+void vboard_ps2_bytes( uint8_t port, const uint8_t *bytes, uint32_t length );
+void vboard_ps2_key( uint8_t port, uint8_t code, uint8_t extended,
+                     uint8_t make );
+uint32_t vboard_ps2_type( uint8_t port, const char *text );
+uint32_t vboard_ps2_pending( uint8_t port );
+void vboard_ps2_gap_us( uint8_t port, uint32_t us );
+void vboard_ps2_hook( vboard_ps2_hook_t hook );
+uint32_t vboard_ps2_commands( uint8_t port, uint8_t *log, uint32_t size );
+const vboard_ps2_stats_t* vboard_ps2_get_stats( uint8_t port );
+
+// SSP and I2C
+void vboard_ssp_slave( vboard_ssp_slave_t slave );
+uint8_t* vboard_i2c_eeprom( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VBOARD_H */
@@ -0,0 +1,268 @@
+/**
+ * @file vboard_gpio.c
+ * @author Embedded Laboratory
+ * @brief Virtual Board, GPIO Model.
+ *
+ * Pin level is the output latch for outputs and the external level for
+ * inputs, devices on the board drive the external level and listen to pin
+ * changes. Unconnected inputs are pulled up. Edge and level interrupts set
+ * the raw status as on the LPC1343, PIOINTn is high while any masked status
+ * bit is set.
+ *
+ * MASKED_ACCESS has 4096 addresses per port, only watched addresses are
+ * checked for writes: the single pins, DATA and the masks added with
+ * vb_gpio_watch(). Watched addresses read the masked level with VB_TAG, so
+ * writing the same value again is seen. DATA reads the plain level. A sync
+ * commits and publishes only the ports accessed since the last one.
+ */
+
+#include <string.h>
+#include "vboard_model.h"
+
+#define VB_GPIO_PORTS       4u
+#define VB_GPIO_PINS        0xFFFu    /**< Pins of a Port. */
+#define VB_GPIO_DATA        0xFFFu    /**< MASKED_ACCESS Address of DATA. */
+#define VB_GPIO_WATCH_MAX   24u       /**< Watched Addresses per Port. */
+#define VB_GPIO_LISTEN_MAX  4u        /**< Listeners per Port. */
+
+/**
+ * @brief Port State, the Registers hold what the firmware last wrote.
+ */
+typedef struct
+{
+  uint32_t out;                 /**< Output Latch. */
+  uint32_t dir;                 /**< Direction, 1 Output. */
+  uint32_t is, ibe, iev, ie;    /**< Interrupt Configuration. */
+  uint32_t ris;                 /**< Raw Interrupt Status. */
+  uint32_t ext;                 /**< Level driven by the Board. */
+  uint32_t level;               /**< Pin Level. */
+  uint32_t pub_level;           /**< Pin Level last published. */
+  uint32_t watch[VB_GPIO_WATCH_MAX];  /**< Checked MASKED_ACCESS Addresses. */
+  uint32_t watch_count;
+  uint32_t listen_mask[VB_GPIO_LISTEN_MAX];
+  vb_pin_listener_t listener[VB_GPIO_LISTEN_MAX];
+  uint32_t listen_count;
+} vb_gpio_t;
+
+static LPC_GPIO_TypeDef regs[VB_GPIO_PORTS];
+static vb_gpio_t ports[VB_GPIO_PORTS];
+static uint32_t touched;            // Ports accessed, bit n is port n
+
+static void vb_gpio_reset( void );
+static void vb_gpio_commit( void );
+static void vb_gpio_publish( void );
+static void vb_gpio_eval( uint8_t port );
+static void vb_gpio_irq( uint8_t port );
+
+const vb_model_t vb_gpio_model =
+{
+  vb_gpio_reset, vb_gpio_commit, vb_gpio_publish
+};
+
+/**
+ * @brief Power On, all Pins Inputs pulled up.
+ */
+static void vb_gpio_reset( void )
+{
+  uint8_t port;
+  uint32_t pin;
+  memset(regs, 0, sizeof(regs));
+  memset(ports, 0, sizeof(ports));
+  for( port = 0; port < VB_GPIO_PORTS; port++ )
+  {
+    ports[port].ext = VB_GPIO_PINS;
+    ports[port].level = VB_GPIO_PINS;
+    for( pin = 0; pin < 12u; pin++ )
+      vb_gpio_watch(port, 1u << pin);
+    vb_gpio_watch(port, VB_GPIO_DATA);
+  }
+  touched = (1u << VB_GPIO_PORTS) - 1u;
+  vb_gpio_publish();
+  touched = 0;
+}
+
+/**
+ * @brief Check a MASKED_ACCESS Address for Writes.
+ */
+void vb_gpio_watch( uint8_t port, uint32_t mask )
+{
+  vb_gpio_t *g = &ports[port];
+  uint32_t i;
+  for( i = 0; i < g->watch_count && g->watch[i] != mask; i++ )
+    ;
+  if( i == g->watch_count )
+  {
+    if( g->watch_count == VB_GPIO_WATCH_MAX )
+      vb_fatal("too many watched GPIO addresses");
+    g->watch[g->watch_count++] = mask & VB_GPIO_PINS;
+  }
+}
+
+/**
+ * @brief Call listener when a Pin of mask changes its Level.
+ */
+void vb_gpio_listen( uint8_t port, uint32_t mask, vb_pin_listener_t listener )
+{
+  vb_gpio_t *g = &ports[port];
+  if( g->listen_count == VB_GPIO_LISTEN_MAX )
+    vb_fatal("too many GPIO listeners");
+  g->listen_mask[g->listen_count] = mask;
+  g->listener[g->listen_count] = listener;
+  g->listen_count++;
+}
+
+/**
+ * @brief Drive the external Level of Pins, 1 releases them to the Pull-Up.
+ */
+void vb_gpio_drive( uint8_t port, uint32_t mask, uint32_t level )
+{
+  vb_gpio_t *g = &ports[port];
+  g->ext = (g->ext & ~mask) | (level & mask);
+  vb_gpio_eval(port);
+}
+
+/**
+ * @brief Pin Levels of a Port.
+ */
+uint32_t vb_gpio_level( uint8_t port )
+{
+  return ports[port].level;
+}
+
+/**
+ * @brief Pins driven by the Firmware, 1 is an Output.
+ */
+uint32_t vb_gpio_output( uint8_t port )
+{
+  return ports[port].dir;
+}
+
+/**
+ * @brief Apply Writes of the Firmware.
+ */
+static void vb_gpio_commit( void )
+{
+  vb_gpio_t *g;
+  LPC_GPIO_TypeDef *r;
+  uint32_t i, mask, value, out;
+  uint8_t port, config;
+  for( port = 0; port < VB_GPIO_PORTS; port++ )
+  {
+    if( !(touched & (1u << port)) )
+      continue;
+    g = &ports[port];
+    r = &regs[port];
+    out = g->out;
+    for( i = 0; i < g->watch_count; i++ )
+    {
+      mask = g->watch[i];
+      value = r->MASKED_ACCESS[mask];
+      if( mask == VB_GPIO_DATA )
+      {
+        if( value != g->pub_level )
+          out = value;
+      }
+      else if( value != ((g->pub_level & mask) | VB_TAG) )
+      {
+        out = (out & ~mask) | (value & mask);
+      }
+    }
+    config = ( r->DIR != g->dir || r->IS != g->is || r->IBE != g->ibe ||
+               r->IEV != g->iev || r->IE != g->ie );
+    if( r->IC )
+    {
+      g->ris &= ~r->IC;
+      r->IC = 0;
+      config = 1;
+    }
+    if( config || out != g->out )
+    {
+      g->out = out & VB_GPIO_PINS;
+      g->dir = r->DIR & VB_GPIO_PINS;
+      g->is = r->IS & VB_GPIO_PINS;
+      g->ibe = r->IBE & VB_GPIO_PINS;
+      g->iev = r->IEV & VB_GPIO_PINS;
+      g->ie = r->IE & VB_GPIO_PINS;
+      vb_gpio_eval(port);
+    }
+  }
+}
+
+/**
+ * @brief Refresh the Registers read by the Firmware.
+ */
+static void vb_gpio_publish( void )
+{
+  vb_gpio_t *g;
+  LPC_GPIO_TypeDef *r;
+  uint32_t i;
+  uint8_t port;
+  for( port = 0; port < VB_GPIO_PORTS; port++ )
+  {
+    if( !(touched & (1u << port)) )
+      continue;
+    g = &ports[port];
+    r = &regs[port];
+    g->pub_level = g->level;
+    for( i = 0; i < g->watch_count; i++ )
+    {
+      if( g->watch[i] == VB_GPIO_DATA )
+        r->DATA = g->level;
+      else
+        r->MASKED_ACCESS[g->watch[i]] = (g->level & g->watch[i]) | VB_TAG;
+    }
+    r->DIR = g->dir;
+    r->IS = g->is;
+    r->IBE = g->ibe;
+    r->IEV = g->iev;
+    r->IE = g->ie;
+    VB_SET(r->RIS, g->ris);
+    VB_SET(r->MIS, g->ris & g->ie);
+  }
+}
+
+/**
+ * @brief New Pin Levels, Interrupt Status and Listeners.
+ */
+static void vb_gpio_eval( uint8_t port )
+{
+  vb_gpio_t *g = &ports[port];
+  uint32_t old = g->level, level, changed, edge, i;
+  level = ((g->ext & ~g->dir) | (g->out & g->dir)) & VB_GPIO_PINS;
+  changed = level ^ old;
+  g->level = level;
+  edge = changed & ~g->is & (g->ibe | (g->iev & level) | (~g->iev & old));
+  g->ris |= edge;
+  // Level sensitive Pins follow the Level
+  g->ris = (g->ris & ~g->is) | (g->is & ~(level ^ g->iev));
+  vb_gpio_irq(port);
+  if( changed )
+  {
+    for( i = 0; i < g->listen_count; i++ )
+    {
+      if( changed & g->listen_mask[i] )
+        g->listener[i](port, changed, level);
+    }
+  }
+}
+
+/**
+ * @brief PIOINTn Line.
+ */
+static void vb_gpio_irq( uint8_t port )
+{
+  vb_gpio_t *g = &ports[port];
+  vb_irq_line((IRQn_Type)(EINT0_IRQn - port), (g->ris & g->ie) != 0u);
+}
+
+/**
+ * @brief GPIO Registers, syncs the Board.
+ */
+LPC_GPIO_TypeDef* vboard_gpio( uint32_t port )
+{
+  // Ports of earlier accesses are synced by this one, then only this port
+  touched |= 1u << port;
+  vb_sync(VB_MODEL_GPIO);
+  touched = 1u << port;
+  return &regs[port];
+}
@@ -0,0 +1,222 @@
+/**
+ * @file vboard_i2c.c
+ * @author Embedded Laboratory
+ * @brief Virtual Board, I2C Master Model with an EEPROM.
+ *
+ * The master state machine of the LPC1343 with the status codes of the
+ * master transmitter and receiver. Half a SCL period after SI is cleared, or
+ * START or STOP is set, the control bits and the state decide the next bus
+ * action, SI and STAT follow when it is done: START and STOP take one SCL
+ * period of SCLH + SCLL cycles, a byte with its acknowledge nine. A 256 byte
+ * EEPROM at address 0x50 acknowledges, the first byte written after its
+ * address sets the memory pointer. Slave mode and arbitration are not
+ * modeled.
+ */
+
+#include <string.h>
+#include "vboard_model.h"
+
+#define VB_I2C_EEPROM_ADDR  0x50u
+#define VB_I2C_EEPROM_SIZE  256u
+
+#define VB_CON_AA           0x04u
+#define VB_CON_SI           0x08u
+#define VB_CON_STO          0x10u
+#define VB_CON_STA          0x20u
+#define VB_CON_I2EN         0x40u
+#define VB_CON_MASK         0x7Cu
+#define VB_STAT_IDLE        0xF8u
+
+static LPC_I2C_TypeDef regs;
+static uint32_t conset, stat, dat;
+static uint32_t pub_conset, pub_dat;
+static uint8_t owned;               // Bus is owned by the Master
+static uint8_t addressed;           // EEPROM acknowledged its Address
+static uint8_t pointer_set;         // Memory Pointer written
+static uint8_t done_stat, done_dat;
+static vb_event_t sample_event, done_event;
+static uint8_t eeprom[VB_I2C_EEPROM_SIZE];
+static uint8_t pointer;
+
+static void vb_i2c_reset( void );
+static void vb_i2c_commit( void );
+static void vb_i2c_publish( void );
+static void vb_i2c_sample( vb_event_t *ev );
+static void vb_i2c_done( vb_event_t *ev );
+
+const vb_model_t vb_i2c_model =
+{
+  vb_i2c_reset, vb_i2c_commit, vb_i2c_publish
+};
+
+static void vb_i2c_reset( void )
+{
+  memset(&regs, 0, sizeof(regs));
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  conset = 0;
+  stat = VB_STAT_IDLE;
+  dat = 0;
+  owned = addressed = pointer_set = 0;
+  pointer = 0;
+  vb_event_init(&sample_event, vb_i2c_sample, NULL);
+  vb_event_init(&done_event, vb_i2c_done, NULL);
+  vb_i2c_publish();
+}
+
+/**
+ * @brief SCL Period in Cycles.
+ */
+static uint64_t vb_i2c_period( void )
+{
+  uint64_t period = (uint64_t)(regs.SCLH & 0xFFFFu) + (regs.SCLL & 0xFFFFu);
+  return ( period < 8u ) ? 8u : period;
+}
+
+/**
+ * @brief Bus Action finishes after periods, then SI is set.
+ */
+static void vb_i2c_finish( uint32_t periods, uint8_t new_stat, uint8_t data )
+{
+  done_stat = new_stat;
+  done_dat = data;
+  vb_event_at(&done_event, vb_now + periods * vb_i2c_period());
+}
+
+/**
+ * @brief Sample the Control Bits and start the next Bus Action.
+ */
+static void vb_i2c_sample( vb_event_t *ev )
+{
+  uint8_t byte = (uint8_t)dat;
+  (void)ev;
+  if( (conset & VB_CON_SI) || !(conset & VB_CON_I2EN) )
+    return;
+  if( conset & VB_CON_STO )
+  {
+    conset &= ~VB_CON_STO;
+    owned = 0;
+    addressed = 0;
+    stat = VB_STAT_IDLE;
+    if( conset & VB_CON_STA )
+      vb_event_at(&sample_event, vb_now + vb_i2c_period());
+    return;
+  }
+  if( conset & VB_CON_STA )
+  {
+    vb_i2c_finish(1u, ( owned ) ? 0x10u : 0x08u, byte);
+    owned = 1;
+    return;
+  }
+  switch( stat )
+  {
+    case 0x08u:
+    case 0x10u:
+      // Address and Direction
+      addressed = ( (byte >> 1) == VB_I2C_EEPROM_ADDR );
+      pointer_set = 0;
+      if( byte & 0x01u )
+        vb_i2c_finish(9u, ( addressed ) ? 0x40u : 0x48u, byte);
+      else
+        vb_i2c_finish(9u, ( addressed ) ? 0x18u : 0x20u, byte);
+      break;
+    case 0x18u:
+    case 0x28u:
+      if( pointer_set )
+        eeprom[pointer++] = byte;
+      else
+        pointer = byte;
+      pointer_set = 1;
+      vb_i2c_finish(9u, 0x28u, byte);
+      break;
+    case 0x20u:
+    case 0x30u:
+      vb_i2c_finish(9u, 0x30u, byte);
+      break;
+    case 0x40u:
+    case 0x50u:
+      byte = eeprom[pointer++];
+      vb_i2c_finish(9u, ( conset & VB_CON_AA ) ? 0x50u : 0x58u, byte);
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Bus Action done.
+ */
+static void vb_i2c_done( vb_event_t *ev )
+{
+  (void)ev;
+  stat = done_stat;
+  dat = done_dat;
+  conset |= VB_CON_SI;
+  vb_irq_line(I2C_IRQn, 1u);
+}
+
+/**
+ * @brief Apply Writes of the Firmware, CONSET, DAT and then CONCLR.
+ */
+static void vb_i2c_commit( void )
+{
+  if( regs.CONSET_v[0] != (pub_conset | VB_TAG) )
+    conset |= regs.CONSET_v[0] & VB_CON_MASK;
+  if( regs.DAT_v[0] != (pub_dat | VB_TAG) )
+    dat = regs.DAT_v[0] & 0xFFu;
+  if( regs.CONCLR_v[0] )
+  {
+    conset &= ~(regs.CONCLR_v[0] & (VB_CON_MASK & ~VB_CON_STO));
+    regs.CONCLR_v[0] = 0;
+  }
+  if( !(conset & VB_CON_I2EN) )
+  {
+    conset &= VB_CON_AA;
+    owned = 0;
+    stat = VB_STAT_IDLE;
+  }
+  // Next Bus Action once SI is clear
+  if( (conset & VB_CON_I2EN) && !(conset & VB_CON_SI) &&
+      (owned || (conset & (VB_CON_STA | VB_CON_STO))) &&
+      sample_event.when == VB_NEVER && done_event.when == VB_NEVER )
+  {
+    vb_event_at(&sample_event, vb_now + vb_i2c_period() / 2u);
+  }
+  vb_irq_line(I2C_IRQn, (conset & (VB_CON_SI | VB_CON_I2EN)) ==
+              (VB_CON_SI | VB_CON_I2EN));
+}
+
+static void vb_i2c_publish( void )
+{
+  pub_conset = conset;
+  pub_dat = dat;
+  regs.CONSET_v[0] = conset | VB_TAG;
+  VB_SET(regs.STAT_v[0], stat);
+  regs.DAT_v[0] = dat | VB_TAG;
+}
+
+/**
+ * @brief I2C Registers, syncs the Board.
+ */
+LPC_I2C_TypeDef* vboard_i2c( void )
+{
+  vb_sync(VB_MODEL_I2C);
+  return &regs;
+}
+
+/**
+ * @brief Access of CONSET, STAT, DAT or CONCLR, syncs the Board.
+ * @return Index of the Register in its Array, always 0.
+ */
+uint32_t vboard_i2c_reg( void )
+{
+  vb_sync(VB_MODEL_I2C);
+  return 0;
+}
+
+/**
+ * @brief Memory of the EEPROM, the Bench may fill or check it.
+ */
+uint8_t* vboard_i2c_eeprom( void )
+{
+  return eeprom;
+}
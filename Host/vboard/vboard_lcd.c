@@ -0,0 +1,263 @@
+/**
+ * @file vboard_lcd.c
+ * @author Embedded Laboratory
+ * @brief Virtual Board, HD44780 16x2 LCD in 8-bit Mode.
+ *
+ * Wired as in lcd_16x2.h: EN P1.0, RW P1.1, RS P1.2, D0-D3 P2.0-P2.3, D4-D7
+ * P2.7-P2.10 and the backlight on P3.1. A write is latched on the falling
+ * edge of EN, a read drives the busy flag and address counter while EN is
+ * high. Instructions take 37 us, data 41 us and clear and home 1.52 ms, the
+ * controller is busy for 40 ms after power on. Writes while busy and 4-bit
+ * mode count as violations, the instruction is still executed. The edge of
+ * EN when it becomes an output is ignored.
+ */
+
+#include <string.h>
+#include "vboard_model.h"
+
+#define VB_LCD_EN           0x01u     /**< P1.0 */
+#define VB_LCD_RW           0x02u     /**< P1.1 */
+#define VB_LCD_RS           0x04u     /**< P1.2 */
+#define VB_LCD_BUS          0x78Fu    /**< D0-D7 on Port 2. */
+#define VB_LCD_BACKLIGHT    0x02u     /**< P3.1 */
+#define VB_LCD_COLUMNS      16u
+#define VB_LCD_LINE         40u       /**< DDRAM Characters per Line. */
+
+#define VB_LCD_EXEC         (37u * VB_US)
+#define VB_LCD_DATA         (41u * VB_US)
+#define VB_LCD_HOME         (1520u * VB_US)
+#define VB_LCD_POWER_ON     (40000u * VB_US)
+
+static uint8_t ddram[2][VB_LCD_LINE];
+static uint8_t cgram[64];
+static uint8_t address;             // Address Counter
+static uint8_t cgram_mode;          // Address Counter points into CGRAM
+static uint8_t increment, shift_display, display_on;
+static uint8_t shift;               // First DDRAM Column shown
+static uint8_t reading;             // Busy Flag driven on the Bus
+static uint8_t driven;              // EN is an Output
+static uint64_t busy_until;
+static vboard_lcd_stats_t stats;
+static vboard_lcd_hook_t hook = NULL;
+
+static void vb_lcd_control( uint8_t port, uint32_t changed, uint32_t level );
+
+/**
+ * @brief Power On, display off and busy with its initialization.
+ */
+void vb_lcd_reset( void )
+{
+  memset(ddram, ' ', sizeof(ddram));
+  memset(cgram, 0, sizeof(cgram));
+  memset(&stats, 0, sizeof(stats));
+  address = 0;
+  cgram_mode = 0;
+  increment = 1;
+  shift_display = 0;
+  display_on = 0;
+  shift = 0;
+  reading = 0;
+  driven = 0;
+  busy_until = vb_now + VB_LCD_POWER_ON;
+  vb_gpio_watch(2, VB_LCD_BUS);
+  vb_gpio_listen(1, VB_LCD_EN | VB_LCD_RW | VB_LCD_RS, vb_lcd_control);
+}
+
+/**
+ * @brief Byte on the Bus to Port 2 Pins.
+ */
+static uint32_t vb_lcd_to_pins( uint8_t byte )
+{
+  return (uint32_t)(byte & 0x0Fu) | ((uint32_t)(byte & 0xF0u) << 3);
+}
+
+static uint8_t vb_lcd_from_pins( uint32_t pins )
+{
+  return (uint8_t)((pins & 0x0Fu) | ((pins >> 3) & 0xF0u));
+}
+
+/**
+ * @brief Next DDRAM Address, the lines wrap into each other.
+ */
+static uint8_t vb_lcd_step( uint8_t ac, uint8_t up )
+{
+  if( up )
+  {
+    if( ac == 0x27u )
+      return 0x40u;
+    if( ac == 0x67u )
+      return 0x00u;
+    return (uint8_t)(ac + 1u);
+  }
+  if( ac == 0x00u )
+    return 0x67u;
+  if( ac == 0x40u )
+    return 0x27u;
+  return (uint8_t)(ac - 1u);
+}
+
+static void vb_lcd_shift( uint8_t left )
+{
+  shift = (uint8_t)((shift + (( left ) ? 1u : VB_LCD_LINE - 1u)) %
+                    VB_LCD_LINE);
+}
+
+/**
+ * @brief Instruction, RS low.
+ */
+static void vb_lcd_instruction( uint8_t cmd )
+{
+  uint64_t time = VB_LCD_EXEC;
+  stats.commands++;
+  if( cmd & 0x80u )
+  {
+    address = cmd & 0x7Fu;
+    cgram_mode = 0;
+  }
+  else if( cmd & 0x40u )
+  {
+    address = cmd & 0x3Fu;
+    cgram_mode = 1;
+  }
+  else if( cmd & 0x20u )
+  {
+    // Function Set, only the 8-bit interface is wired
+    if( !(cmd & 0x10u) )
+      stats.violations++;
+  }
+  else if( cmd & 0x10u )
+  {
+    if( cmd & 0x08u )
+      vb_lcd_shift( !(cmd & 0x04u) );
+    else
+      address = vb_lcd_step(address, (cmd & 0x04u) != 0u);
+  }
+  else if( cmd & 0x08u )
+  {
+    display_on = (cmd & 0x04u) != 0u;
+  }
+  else if( cmd & 0x04u )
+  {
+    increment = (cmd & 0x02u) != 0u;
+    shift_display = (cmd & 0x01u) != 0u;
+  }
+  else if( cmd & 0x02u )
+  {
+    address = 0;
+    cgram_mode = 0;
+    shift = 0;
+    time = VB_LCD_HOME;
+  }
+  else if( cmd & 0x01u )
+  {
+    memset(ddram, ' ', sizeof(ddram));
+    address = 0;
+    cgram_mode = 0;
+    shift = 0;
+    increment = 1;
+    time = VB_LCD_HOME;
+  }
+  busy_until = vb_now + time;
+}
+
+/**
+ * @brief Data, RS high.
+ */
+static void vb_lcd_data( uint8_t c )
+{
+  uint8_t ac = address;
+  stats.characters++;
+  if( cgram_mode )
+  {
+    cgram[ac & 0x3Fu] = c;
+    address = (uint8_t)((ac + (( increment ) ? 1u : 0x3Fu)) & 0x3Fu);
+  }
+  else
+  {
+    ddram[(ac >> 6) & 0x01u][(ac & 0x3Fu) % VB_LCD_LINE] = c;
+    address = vb_lcd_step(ac, increment);
+    if( shift_display )
+      vb_lcd_shift(increment);
+    if( hook != NULL )
+      hook(ac, c);
+  }
+  busy_until = vb_now + VB_LCD_DATA;
+}
+
+/**
+ * @brief EN, RW or RS changed.
+ */
+static void vb_lcd_control( uint8_t port, uint32_t changed, uint32_t level )
+{
+  uint8_t status;
+  (void)port;
+  if( !(changed & VB_LCD_EN) )
+    return;
+  // The pull-up holds EN high until the firmware drives it, that edge is
+  // no write
+  if( !driven )
+  {
+    driven = (vb_gpio_output(1) & VB_LCD_EN) != 0u;
+    return;
+  }
+  if( level & VB_LCD_EN )
+  {
+    if( (level & (VB_LCD_RW | VB_LCD_RS)) == VB_LCD_RW )
+    {
+      status = (uint8_t)(address & 0x7Fu);
+      if( vb_now < busy_until )
+        status |= 0x80u;
+      stats.busy_reads++;
+      reading = 1;
+      vb_gpio_drive(2, VB_LCD_BUS, vb_lcd_to_pins(status));
+    }
+    return;
+  }
+  if( reading )
+  {
+    reading = 0;
+    vb_gpio_drive(2, VB_LCD_BUS, VB_LCD_BUS);
+    return;
+  }
+  if( level & VB_LCD_RW )
+    return;
+  if( vb_now < busy_until )
+    stats.violations++;
+  if( level & VB_LCD_RS )
+    vb_lcd_data(vb_lcd_from_pins(vb_gpio_level(2)));
+  else
+    vb_lcd_instruction(vb_lcd_from_pins(vb_gpio_level(2)));
+}
+
+/**
+ * @brief Characters shown on a Row, blank while the display is off.
+ * @param text 16 Characters and the terminating 0.
+ */
+void vboard_lcd_row( uint8_t row, char *text )
+{
+  uint32_t i;
+  for( i = 0; i < VB_LCD_COLUMNS; i++ )
+  {
+    text[i] = ( display_on ) ?
+      (char)ddram[row & 0x01u][(shift + i) % VB_LCD_LINE] : ' ';
+  }
+  text[VB_LCD_COLUMNS] = '\0';
+}
+
+void vboard_lcd_hook( vboard_lcd_hook_t new_hook )
+{
+  hook = new_hook;
+}
+
+/**
+ * @brief Backlight on, P3.1 is an Output and high.
+ */
+uint8_t vboard_lcd_backlight( void )
+{
+  return ( vb_gpio_output(3) & vb_gpio_level(3) & VB_LCD_BACKLIGHT ) ? 1u : 0u;
+}
+
+const vboard_lcd_stats_t* vboard_lcd_get_stats( void )
+{
+  return &stats;
+}
@@ -0,0 +1,11 @@
+/**
+ * @file vboard_main.c
+ * @author Embedded Laboratory
+ * @brief Virtual Board, main() of the Application as Firmware Entry.
+ *
+ * main.c is built unchanged, its main() becomes the function the core model
+ * starts on the firmware stack.
+ */
+
+#define main    vboard_firmware_main
+#include "main.c"
@@ -0,0 +1,96 @@
+/**
+ * @file vboard_model.h
+ * @author Embedded Laboratory
+ * @brief Virtual Board, Interface between the Core and the Peripheral Models.
+ *
+ * Registers are plain memory which the firmware reads and writes through the
+ * pointers of LPC13xx.h. Every accessor call syncs the board: the models
+ * written since their last sync and the accessed model are committed, the
+ * virtual clock advances, fresh values of the accessed model are published
+ * and pending interrupts are taken. Models which are not accessed are left
+ * alone, WFI and interrupt entry and exit sync all models, so writes through
+ * a pointer kept by a driver are seen before the firmware waits. A register
+ * whose writes must be seen even if the same value is written again is
+ * published with VB_TAG set, the firmware never writes that bit.
+ */
+
+#ifndef VBOARD_MODEL_H
+#define VBOARD_MODEL_H
+
+#include <stdint.h>
+#include "LPC13xx.h"
+#include "vboard.h"
+
+#define VB_TAG        0x80000000u     /**< Published, not written. */
+#define VB_NEVER      UINT64_MAX      /**< Event not armed. */
+#define VB_US         (VBOARD_CLOCK_HZ / 1000000u)  /**< Cycles per us. */
+
+/** Store into a Register which is read only for the firmware. */
+#define VB_SET(reg, value)    (*(volatile uint32_t *)&(reg) = (uint32_t)(value))
+
+/**
+ * @brief Event at a Cycle of the Virtual Clock.
+ */
+typedef struct vb_event_s
+{
+  uint64_t when;                        /**< Cycle, VB_NEVER if not armed. */
+  void (*fire)( struct vb_event_s *ev );  /**< Called at when. */
+  void *owner;                          /**< Model of the Event. */
+} vb_event_t;
+
+/* Models, index of the Sync */
+#define VB_MODEL_CORE   0u    /**< SysTick, DWT, SCB, SYSCON, IOCON, PMU. */
+#define VB_MODEL_GPIO   1u
+#define VB_MODEL_TIMER  2u
+#define VB_MODEL_UART   3u
+#define VB_MODEL_SSP    4u
+#define VB_MODEL_I2C    5u
+#define VB_MODELS       6u
+
+/**
+ * @brief Peripheral Model, committed and published by the Syncs.
+ */
+typedef struct
+{
+  void (*reset)( void );      /**< Power On. */
+  void (*commit)( void );     /**< Apply Writes of the Firmware. */
+  void (*publish)( void );    /**< Refresh Registers read by the Firmware. */
+} vb_model_t;
+
+typedef void (*vb_pin_listener_t)( uint8_t port, uint32_t changed,
+                                   uint32_t level );
+
+extern uint64_t vb_now;       /**< Virtual Clock in Cycles. */
+extern LPC_SYSCON_TypeDef vb_syscon;  /**< SYSCON, plain Registers. */
+
+/* Firmware, main() of the Application or of a Benchmark */
+int vboard_firmware_main( void );
+
+/* Core, vboard.c */
+void vb_sync( uint32_t model );
+void vb_event_init( vb_event_t *ev, void (*fire)( vb_event_t *ev ),
+                    void *owner );
+void vb_event_at( vb_event_t *ev, uint64_t when );
+void vb_event_cancel( vb_event_t *ev );
+void vb_irq_line( IRQn_Type IRQn, uint32_t level );
+void vb_fatal( const char *format, ... );
+
+/* GPIO, vboard_gpio.c */
+extern const vb_model_t vb_gpio_model;
+void vb_gpio_watch( uint8_t port, uint32_t mask );
+void vb_gpio_listen( uint8_t port, uint32_t mask, vb_pin_listener_t listener );
+void vb_gpio_drive( uint8_t port, uint32_t mask, uint32_t level );
+uint32_t vb_gpio_level( uint8_t port );
+uint32_t vb_gpio_output( uint8_t port );
+
+/* Peripherals */
+extern const vb_model_t vb_timer_model;
+extern const vb_model_t vb_uart_model;
+extern const vb_model_t vb_ssp_model;
+extern const vb_model_t vb_i2c_model;
+
+/* Devices on the Board */
+void vb_lcd_reset( void );
+void vb_ps2_reset( void );
+
+#endif /* VBOARD_MODEL_H */
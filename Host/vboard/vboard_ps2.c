@@ -0,0 +1,462 @@
+/**
+ * @file vboard_ps2.c
+ * @author Embedded Laboratory
+ * @brief Virtual Board, PS2 Keyboards on the Keyboard and Auxiliary Port.
+ *
+ * Each device drives its open collector Clock and Data lines through the
+ * external level of the GPIO model. Bytes to the host are clocked at
+ * 12.5 kHz: data is set 20 us before the clock falls and the clock is low
+ * for 40 us. Holding the clock low inhibits the device, a byte in progress is
+ * aborted and sent again when the clock is released. A release with data low
+ * is a request to send, the device clocks the command in, samples each bit
+ * on the rising edge and acknowledges it by pulling data low after the stop
+ * bit. Commands are answered as a keyboard does, replies go before the keys
+ * still queued.
+ */
+
+#include <string.h>
+#include "vboard_model.h"
+#include "ps2_keyboard.h"
+
+#define VB_PS2_QUEUE        16384u    /**< Bytes queued per Device. */
+#define VB_PS2_LOG          64u       /**< Commands logged per Device. */
+#define VB_PS2_GAP_US       200u      /**< Default Gap between Bytes. */
+#define VB_PS2_SETUP        (20u * VB_US)
+#define VB_PS2_HALF         (40u * VB_US)
+#define VB_PS2_RTS_DELAY    (100u * VB_US)
+
+#define VB_PS2_SHIFT        0x12u
+#define VB_PS2_ENTER        0x5Au
+
+/**
+ * @brief Device State.
+ */
+typedef enum
+{
+  VB_PS2_IDLE = 0,      /**< Nothing on the Bus. */
+  VB_PS2_SEND,          /**< Byte to the Host. */
+  VB_PS2_RECEIVE        /**< Command from the Host. */
+} vb_ps2_state_t;
+
+typedef struct
+{
+  uint8_t clk_port, data_port;
+  uint32_t clk_mask, data_mask;
+  vb_ps2_state_t state;
+  uint8_t phase;            // 0 Data set, 1 Clock low, 2 Clock high
+  uint8_t bit;              // Bit of the Frame, 0 Start .. 10 Stop
+  uint8_t clk_low;          // Device drives the Clock Line low
+  uint8_t byte, last_sent;
+  uint16_t frame;           // Bits received from the Host
+  uint8_t argument;         // Command waiting for its Argument
+  uint8_t queue[VB_PS2_QUEUE];
+  uint32_t tail, count;
+  uint8_t log[VB_PS2_LOG];
+  uint32_t log_count;
+  uint64_t gap;
+  vb_event_t event;
+  vboard_ps2_stats_t stats;
+} vb_ps2_t;
+
+static vb_ps2_t devices[PS2_PORTS];
+static vboard_ps2_hook_t hook = NULL;
+
+static void vb_ps2_step( vb_event_t *ev );
+static void vb_ps2_lines( uint8_t port, uint32_t changed, uint32_t level );
+
+static void vb_ps2_setup( vb_ps2_t *d, uint8_t clk_port, uint8_t clk_pin,
+                          uint8_t data_port, uint8_t data_pin )
+{
+  memset(d, 0, sizeof(*d));
+  d->clk_port = clk_port;
+  d->clk_mask = 1u << clk_pin;
+  d->data_port = data_port;
+  d->data_mask = 1u << data_pin;
+  d->gap = VB_PS2_GAP_US * VB_US;
+  vb_event_init(&d->event, vb_ps2_step, d);
+  vb_gpio_listen(clk_port, d->clk_mask, vb_ps2_lines);
+}
+
+/**
+ * @brief Power On, both Devices idle with their Lines released.
+ */
+void vb_ps2_reset( void )
+{
+  vb_ps2_setup(&devices[PS2_PORT_KEYBOARD], PS2_CLK_PORT, PS2_CLK_PIN,
+               PS2_DATA_PORT, PS2_DATA_PIN);
+  vb_ps2_setup(&devices[PS2_PORT_AUX], PS2_AUX_CLK_PORT, PS2_AUX_CLK_PIN,
+               PS2_AUX_DATA_PORT, PS2_AUX_DATA_PIN);
+}
+
+static void vb_ps2_clock( vb_ps2_t *d, uint8_t low )
+{
+  d->clk_low = low;
+  vb_gpio_drive(d->clk_port, d->clk_mask, ( low ) ? 0u : d->clk_mask);
+}
+
+static void vb_ps2_data( vb_ps2_t *d, uint8_t level )
+{
+  vb_gpio_drive(d->data_port, d->data_mask, ( level ) ? d->data_mask : 0u);
+}
+
+static uint8_t vb_ps2_clock_level( const vb_ps2_t *d )
+{
+  return (vb_gpio_level(d->clk_port) & d->clk_mask) != 0u;
+}
+
+static uint8_t vb_ps2_data_level( const vb_ps2_t *d )
+{
+  return (vb_gpio_level(d->data_port) & d->data_mask) != 0u;
+}
+
+/**
+ * @brief Queue a Byte, at the front for Replies.
+ */
+static void vb_ps2_push( vb_ps2_t *d, uint8_t byte, uint8_t front )
+{
+  if( d->count == VB_PS2_QUEUE )
+    vb_fatal("PS2 queue full");
+  if( front )
+  {
+    d->tail = (d->tail + VB_PS2_QUEUE - 1u) % VB_PS2_QUEUE;
+    d->queue[d->tail] = byte;
+  }
+  else
+  {
+    d->queue[(d->tail + d->count) % VB_PS2_QUEUE] = byte;
+  }
+  d->count++;
+}
+
+/**
+ * @brief Send the next queued Byte after the Gap.
+ */
+static void vb_ps2_next( vb_ps2_t *d, uint64_t delay )
+{
+  if( d->state == VB_PS2_IDLE && d->count && d->event.when == VB_NEVER )
+    vb_event_at(&d->event, vb_now + delay);
+}
+
+/**
+ * @brief Value of a Frame Bit, Start, Data, odd Parity and Stop.
+ */
+static uint8_t vb_ps2_frame_bit( uint8_t byte, uint8_t bit )
+{
+  if( bit == 0u )
+    return 0;
+  if( bit <= 8u )
+    return (uint8_t)((byte >> (bit - 1u)) & 0x01u);
+  if( bit == 9u )
+    return (uint8_t)((__builtin_popcount(byte) & 0x01u) ^ 0x01u);
+  return 1;
+}
+
+/**
+ * @brief Host inhibits, the Byte goes back in front of the Queue.
+ */
+static void vb_ps2_abort( vb_ps2_t *d )
+{
+  vb_event_cancel(&d->event);
+  if( d->state == VB_PS2_SEND )
+  {
+    vb_ps2_push(d, d->byte, 1u);
+    d->stats.aborted++;
+  }
+  d->state = VB_PS2_IDLE;
+  vb_ps2_data(d, 1u);
+  vb_ps2_clock(d, 0u);
+}
+
+/**
+ * @brief Command received, replies go before the queued Bytes.
+ */
+static void vb_ps2_command( vb_ps2_t *d, uint8_t cmd )
+{
+  static const uint8_t ack[] = { 0xFA };
+  static const uint8_t reset[] = { 0xFA, 0xAA };
+  static const uint8_t id[] = { 0xFA, 0xAB, 0x83 };
+  static const uint8_t echo[] = { 0xEE };
+  const uint8_t *reply = ack;
+  uint32_t length = 1, i;
+  d->stats.received++;
+  if( d->log_count < VB_PS2_LOG )
+    d->log[d->log_count] = cmd;
+  d->log_count++;
+  if( d->argument )
+  {
+    if( d->argument == 0xEDu )
+      d->stats.leds = cmd;
+    else
+      d->stats.typematic = cmd;
+    d->argument = 0;
+  }
+  else if( cmd == 0xFFu )
+  {
+    reply = reset;
+    length = sizeof(reset);
+  }
+  else if( cmd == 0xEDu || cmd == 0xF3u )
+  {
+    d->argument = cmd;
+  }
+  else if( cmd == 0xEEu )
+  {
+    reply = echo;
+  }
+  else if( cmd == 0xFEu )
+  {
+    reply = &d->last_sent;
+  }
+  else if( cmd == 0xF2u )
+  {
+    reply = id;
+    length = sizeof(id);
+  }
+  for( i = length; i > 0u; i-- )
+    vb_ps2_push(d, reply[i - 1u], 1u);
+}
+
+/**
+ * @brief Frame from the Host complete, check Parity and Stop Bit.
+ */
+static void vb_ps2_received( vb_ps2_t *d )
+{
+  uint8_t byte = (uint8_t)(d->frame & 0xFFu);
+  uint8_t parity = (uint8_t)((d->frame >> 8) & 0x01u);
+  uint8_t stop = (uint8_t)((d->frame >> 9) & 0x01u);
+  if( !stop || ((__builtin_popcount(byte) + parity) & 0x01u) == 0u )
+  {
+    d->stats.parity_errors++;
+    vb_ps2_push(d, 0xFEu, 1u);
+  }
+  else
+  {
+    vb_ps2_command(d, byte);
+  }
+}
+
+/**
+ * @brief Next Phase of the Frame on the Bus.
+ */
+static void vb_ps2_step( vb_event_t *ev )
+{
+  vb_ps2_t *d = (vb_ps2_t *)ev->owner;
+  if( d->state == VB_PS2_IDLE )
+  {
+    // Start of a Byte, only while the Clock is released
+    if( !d->count || !vb_ps2_clock_level(d) )
+      return;
+    d->byte = d->queue[d->tail];
+    d->tail = (d->tail + 1u) % VB_PS2_QUEUE;
+    d->count--;
+    d->state = VB_PS2_SEND;
+    d->bit = 0;
+    d->phase = 0;
+  }
+  if( d->state == VB_PS2_SEND )
+  {
+    switch( d->phase )
+    {
+      case 0:
+        if( d->bit == 0u && hook != NULL )
+          hook((uint8_t)(d - devices), d->byte);
+        vb_ps2_data(d, vb_ps2_frame_bit(d->byte, d->bit));
+        d->phase = 1;
+        vb_event_at(ev, vb_now + VB_PS2_SETUP);
+        break;
+      case 1:
+        if( !vb_ps2_clock_level(d) )
+        {
+          vb_ps2_abort(d);
+          return;
+        }
+        vb_ps2_clock(d, 1u);
+        d->phase = 2;
+        vb_event_at(ev, vb_now + VB_PS2_HALF);
+        break;
+      default:
+        vb_ps2_clock(d, 0u);
+        d->phase = 0;
+        if( ++d->bit < 11u )
+        {
+          vb_event_at(ev, vb_now + VB_PS2_SETUP);
+        }
+        else
+        {
+          d->last_sent = d->byte;
+          d->stats.sent++;
+          d->state = VB_PS2_IDLE;
+          vb_ps2_next(d, d->gap);
+        }
+        break;
+    }
+    return;
+  }
+  // Receive, Clock low for 40 us, the Host sets Data meanwhile
+  if( d->phase == 1u )
+  {
+    vb_ps2_clock(d, 1u);
+    d->phase = 2;
+    vb_event_at(ev, vb_now + VB_PS2_HALF);
+    return;
+  }
+  vb_ps2_clock(d, 0u);
+  d->bit++;
+  if( d->bit <= 10u )
+  {
+    d->frame |= (uint16_t)(vb_ps2_data_level(d) << (d->bit - 1u));
+    if( d->bit == 10u )
+      vb_ps2_data(d, 0u);
+    d->phase = 1;
+    vb_event_at(ev, vb_now + VB_PS2_HALF);
+  }
+  else
+  {
+    vb_ps2_data(d, 1u);
+    d->state = VB_PS2_IDLE;
+    vb_ps2_received(d);
+    vb_ps2_next(d, d->gap);
+  }
+}
+
+/**
+ * @brief Clock Line changed, the Host inhibits or releases the Bus.
+ */
+static void vb_ps2_lines( uint8_t port, uint32_t changed, uint32_t level )
+{
+  vb_ps2_t *d;
+  uint8_t i;
+  for( i = 0; i < PS2_PORTS; i++ )
+  {
+    d = &devices[i];
+    if( d->clk_port != port || !(changed & d->clk_mask) || d->clk_low )
+      continue;
+    if( !(level & d->clk_mask) )
+    {
+      if( d->state != VB_PS2_IDLE )
+        vb_ps2_abort(d);
+    }
+    else if( d->state == VB_PS2_IDLE && !vb_ps2_data_level(d) )
+    {
+      // Request to Send
+      vb_event_cancel(&d->event);
+      d->state = VB_PS2_RECEIVE;
+      d->bit = 0;
+      d->phase = 1;
+      d->frame = 0;
+      vb_event_at(&d->event, vb_now + VB_PS2_RTS_DELAY);
+    }
+    else
+    {
+      vb_ps2_next(d, d->gap);
+    }
+  }
+}
+
+/**
+ * @brief Queue Bytes to the Host.
+ */
+void vboard_ps2_bytes( uint8_t port, const uint8_t *bytes, uint32_t length )
+{
+  vb_ps2_t *d = &devices[port];
+  uint32_t i;
+  for( i = 0; i < length; i++ )
+    vb_ps2_push(d, bytes[i], 0u);
+  vb_ps2_next(d, 0u);
+}
+
+/**
+ * @brief Make or Break of a Set 2 Scan Code.
+ */
+void vboard_ps2_key( uint8_t port, uint8_t code, uint8_t extended,
+                     uint8_t make )
+{
+  uint8_t bytes[3];
+  uint32_t length = 0;
+  if( extended )
+    bytes[length++] = PS2_EXTENDED;
+  if( !make )
+    bytes[length++] = PS2_BREAK;
+  bytes[length++] = code;
+  vboard_ps2_bytes(port, bytes, length);
+}
+
+/**
+ * @brief Scan Code of a Character in a Row of PS2_KeyMap, keypad last.
+ */
+static uint8_t vb_ps2_find( uint8_t row, char c )
+{
+  uint8_t code;
+  for( code = 1; code < PS2_SET2_MAX; code++ )
+  {
+    if( (code < 0x69u || code > 0x7Du) && PS2_KeyMap[row][code] == (u8_t)c )
+      return code;
+  }
+  return 0;
+}
+
+/**
+ * @brief Type Text, each Character is pressed and released.
+ * @return Characters typed, others have no key and are skipped.
+ */
+uint32_t vboard_ps2_type( uint8_t port, const char *text )
+{
+  uint32_t typed = 0;
+  uint8_t code, shift;
+  for( ; *text; text++ )
+  {
+    shift = 0;
+    code = ( *text == '\n' ) ? VB_PS2_ENTER : vb_ps2_find(0, *text);
+    if( code == 0u )
+    {
+      code = vb_ps2_find(1, *text);
+      shift = 1;
+    }
+    if( code == 0u )
+      continue;
+    if( shift )
+      vboard_ps2_key(port, VB_PS2_SHIFT, 0u, 1u);
+    vboard_ps2_key(port, code, 0u, 1u);
+    vboard_ps2_key(port, code, 0u, 0u);
+    if( shift )
+      vboard_ps2_key(port, VB_PS2_SHIFT, 0u, 0u);
+    typed++;
+  }
+  return typed;
+}
+
+/**
+ * @brief Bytes not yet sent, with the one in progress.
+ */
+uint32_t vboard_ps2_pending( uint8_t port )
+{
+  vb_ps2_t *d = &devices[port];
+  return d->count + (( d->state == VB_PS2_SEND ) ? 1u : 0u);
+}
+
+void vboard_ps2_gap_us( uint8_t port, uint32_t us )
+{
+  devices[port].gap = (uint64_t)us * VB_US;
+}
+
+void vboard_ps2_hook( vboard_ps2_hook_t new_hook )
+{
+  hook = new_hook;
+}
+
+/**
+ * @brief Commands received from the Host.
+ * @return Number of Commands, log holds the first size of them.
+ */
+uint32_t vboard_ps2_commands( uint8_t port, uint8_t *log, uint32_t size )
+{
+  vb_ps2_t *d = &devices[port];
+  uint32_t n = ( d->log_count < VB_PS2_LOG ) ? d->log_count : VB_PS2_LOG;
+  memcpy(log, d->log, ( n < size ) ? n : size);
+  return d->log_count;
+}
+
+const vboard_ps2_stats_t* vboard_ps2_get_stats( uint8_t port )
+{
+  return &devices[port].stats;
+}
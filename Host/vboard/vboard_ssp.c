@@ -0,0 +1,203 @@
+/**
+ * @file vboard_ssp.c
+ * @author Embedded Laboratory
+ * @brief Virtual Board, SSP0 Model in Master Mode.
+ *
+ * 8 frame FIFOs, one frame is shifted per (DSS + 1) * CPSR * (SCR + 1) *
+ * SSP0CLKDIV cycles while the SSP is enabled. The frame received is the
+ * frame sent in loop back mode, else the answer of the slave hook, by
+ * default the slave echoes. DR is accessed through vboard_ssp_data(), the
+ * access is a write if the firmware changed the published value and a read
+ * else. The receive time-out is not modeled and RIS is read without a sync.
+ */
+
+#include <string.h>
+#include "vboard_model.h"
+
+#define VB_SSP_FIFO         8u
+
+#define VB_CR1_LBM          0x01u
+#define VB_CR1_SSE          0x02u
+#define VB_SR_TFE           0x01u
+#define VB_SR_TNF           0x02u
+#define VB_SR_RNE           0x04u
+#define VB_SR_RFF           0x08u
+#define VB_SR_BSY           0x10u
+#define VB_RIS_ROR          0x01u
+#define VB_RIS_RX           0x04u
+#define VB_RIS_TX           0x08u
+
+static LPC_SSP_TypeDef regs;
+static uint16_t tx_fifo[VB_SSP_FIFO], rx_fifo[VB_SSP_FIFO];
+static uint32_t tx_tail, tx_count, rx_tail, rx_count;
+static uint16_t shift;
+static uint8_t busy, data_access, overrun;
+static uint32_t pub_data;
+static vb_event_t frame_event;
+static vboard_ssp_slave_t slave = NULL;
+
+static void vb_ssp_reset( void );
+static void vb_ssp_commit( void );
+static void vb_ssp_publish( void );
+static void vb_ssp_start( void );
+static void vb_ssp_frame( vb_event_t *ev );
+static uint32_t vb_ssp_ris( void );
+
+const vb_model_t vb_ssp_model =
+{
+  vb_ssp_reset, vb_ssp_commit, vb_ssp_publish
+};
+
+static void vb_ssp_reset( void )
+{
+  memset(&regs, 0, sizeof(regs));
+  tx_tail = tx_count = rx_tail = rx_count = 0;
+  busy = data_access = overrun = 0;
+  vb_event_init(&frame_event, vb_ssp_frame, NULL);
+  vb_ssp_publish();
+}
+
+/**
+ * @brief Shift the next Frame if the SSP is enabled and idle.
+ */
+static void vb_ssp_start( void )
+{
+  uint64_t cycles;
+  uint32_t clkdiv = vb_syscon.SSP0CLKDIV & 0xFFu, cpsr = regs.CPSR & 0xFFu;
+  if( busy || tx_count == 0u || !(regs.CR1 & VB_CR1_SSE) )
+    return;
+  if( clkdiv == 0u )
+    clkdiv = 1u;
+  if( cpsr < 2u )
+    cpsr = 2u;
+  cycles = (uint64_t)((regs.CR0 & 0x0Fu) + 1u) * cpsr *
+           (((regs.CR0 >> 8) & 0xFFu) + 1u) * clkdiv;
+  shift = tx_fifo[tx_tail];
+  tx_tail = (tx_tail + 1u) % VB_SSP_FIFO;
+  tx_count--;
+  busy = 1;
+  vb_event_at(&frame_event, vb_now + cycles);
+}
+
+/**
+ * @brief Frame shifted, the Frame received enters the RX FIFO.
+ */
+static void vb_ssp_frame( vb_event_t *ev )
+{
+  uint16_t frame = shift;
+  (void)ev;
+  if( !(regs.CR1 & VB_CR1_LBM) && slave != NULL )
+    frame = slave(shift);
+  if( rx_count < VB_SSP_FIFO )
+  {
+    rx_fifo[(rx_tail + rx_count) % VB_SSP_FIFO] = frame;
+    rx_count++;
+  }
+  else
+  {
+    overrun = 1;
+  }
+  busy = 0;
+  vb_ssp_start();
+  vb_irq_line(SSP0_IRQn, (vb_ssp_ris() & regs.IMSC) != 0u);
+}
+
+static uint32_t vb_ssp_ris( void )
+{
+  uint32_t ris = 0;
+  if( overrun )
+    ris |= VB_RIS_ROR;
+  if( rx_count >= VB_SSP_FIFO / 2u )
+    ris |= VB_RIS_RX;
+  if( tx_count <= VB_SSP_FIFO / 2u )
+    ris |= VB_RIS_TX;
+  return ris;
+}
+
+/**
+ * @brief Apply Writes of the Firmware.
+ */
+static void vb_ssp_commit( void )
+{
+  if( data_access )
+  {
+    data_access = 0;
+    if( regs.DR_v[0] != pub_data )
+    {
+      if( tx_count < VB_SSP_FIFO )
+      {
+        tx_fifo[(tx_tail + tx_count) % VB_SSP_FIFO] =
+          (uint16_t)regs.DR_v[0];
+        tx_count++;
+      }
+    }
+    else if( rx_count )
+    {
+      rx_tail = (rx_tail + 1u) % VB_SSP_FIFO;
+      rx_count--;
+    }
+  }
+  if( regs.ICR & VB_RIS_ROR )
+    overrun = 0;
+  regs.ICR = 0;
+  vb_ssp_start();
+  vb_irq_line(SSP0_IRQn, (vb_ssp_ris() & regs.IMSC) != 0u);
+}
+
+static void vb_ssp_publish( void )
+{
+  uint32_t sr = 0, ris = vb_ssp_ris();
+  if( tx_count == 0u )
+    sr |= VB_SR_TFE;
+  if( tx_count < VB_SSP_FIFO )
+    sr |= VB_SR_TNF;
+  if( rx_count )
+    sr |= VB_SR_RNE;
+  if( rx_count == VB_SSP_FIFO )
+    sr |= VB_SR_RFF;
+  if( busy || tx_count )
+    sr |= VB_SR_BSY;
+  VB_SET(regs.SR_v[0], sr);
+  VB_SET(regs.RIS, ris);
+  VB_SET(regs.MIS, ris & regs.IMSC);
+  pub_data = (( rx_count ) ? rx_fifo[rx_tail] : 0u) | VB_TAG;
+  regs.DR_v[0] = pub_data;
+}
+
+/**
+ * @brief SSP0 Registers, syncs the Board.
+ */
+LPC_SSP_TypeDef* vboard_ssp( void )
+{
+  vb_sync(VB_MODEL_SSP);
+  return &regs;
+}
+
+/**
+ * @brief Access of DR, resolved at the next Sync.
+ * @return Index of DR in its Array, always 0.
+ */
+uint32_t vboard_ssp_data( void )
+{
+  vb_sync(VB_MODEL_SSP);
+  data_access = 1;
+  return 0;
+}
+
+/**
+ * @brief Read of SR, syncs the Board.
+ * @return Index of SR in its Array, always 0.
+ */
+uint32_t vboard_ssp_status( void )
+{
+  vb_sync(VB_MODEL_SSP);
+  return 0;
+}
+
+/**
+ * @brief Slave on the SSP Bus, NULL echoes the Frames.
+ */
+void vboard_ssp_slave( vboard_ssp_slave_t hook )
+{
+  slave = hook;
+}
@@ -0,0 +1,252 @@
+/**
+ * @file vboard_timer.c
+ * @author Embedded Laboratory
+ * @brief Virtual Board, 16 and 32-Bit Timer Model.
+ *
+ * The counter is not stepped, TC and PC are computed from the cycle the
+ * counter was last set and the prescaler. One event per timer fires at the
+ * earliest match of a channel with a match action, interrupt, reset and stop
+ * are done there. Reset on match sets TC to 0 at the match instead of one
+ * tick later. Capture inputs and external match outputs are not modeled.
+ * A sync commits and publishes only the timers accessed since the last one.
+ */
+
+#include <string.h>
+#include "vboard_model.h"
+
+#define VB_TIMERS           4u
+#define VB_TIMER_CHANNELS   4u
+#define VB_TCR_ENABLE       0x01u
+#define VB_TCR_RESET        0x02u
+#define VB_MCR_INT          0x01u
+#define VB_MCR_RESET        0x02u
+#define VB_MCR_STOP         0x04u
+
+/**
+ * @brief Timer State.
+ */
+typedef struct
+{
+  uint32_t mask;              /**< Counter Width. */
+  IRQn_Type irq;
+  uint32_t tcr, pr, mcr, ir;
+  uint32_t mr[VB_TIMER_CHANNELS];
+  uint32_t base_tc;           /**< TC at base_time. */
+  uint64_t base_time;         /**< Cycle of the last Counter Change. */
+  uint32_t pub_ir, pub_tcr;   /**< IR and TCR last published. */
+  uint32_t pub_tc, pub_pc;    /**< TC and PC last published. */
+  vb_event_t match;           /**< Earliest Match. */
+} vb_timer_t;
+
+/* Order of vboard_timer(): TMR16B0, TMR16B1, TMR32B0, TMR32B1 */
+static LPC_TMR_TypeDef regs[VB_TIMERS];
+static vb_timer_t timers[VB_TIMERS];
+static uint32_t touched;            // Timers accessed, bit n is timer n
+static const IRQn_Type timer_irq[VB_TIMERS] =
+{
+  TIMER_16_0_IRQn, TIMER_16_1_IRQn, TIMER_32_0_IRQn, TIMER_32_1_IRQn
+};
+
+static void vb_timer_reset( void );
+static void vb_timer_commit( void );
+static void vb_timer_publish( void );
+static uint32_t vb_timer_tc( const vb_timer_t *t );
+static void vb_timer_rebase( vb_timer_t *t, uint32_t tc );
+static void vb_timer_arm( vb_timer_t *t );
+static void vb_timer_fire( vb_event_t *ev );
+
+const vb_model_t vb_timer_model =
+{
+  vb_timer_reset, vb_timer_commit, vb_timer_publish
+};
+
+static void vb_timer_reset( void )
+{
+  uint32_t i;
+  memset(regs, 0, sizeof(regs));
+  memset(timers, 0, sizeof(timers));
+  for( i = 0; i < VB_TIMERS; i++ )
+  {
+    timers[i].mask = ( i < 2u ) ? 0xFFFFu : 0xFFFFFFFFu;
+    timers[i].irq = timer_irq[i];
+    vb_event_init(&timers[i].match, vb_timer_fire, &timers[i]);
+  }
+  touched = (1u << VB_TIMERS) - 1u;
+  vb_timer_publish();
+  touched = 0;
+}
+
+/**
+ * @brief Timer Counter now.
+ */
+static uint32_t vb_timer_tc( const vb_timer_t *t )
+{
+  uint64_t ticks = 0;
+  if( (t->tcr & (VB_TCR_ENABLE | VB_TCR_RESET)) == VB_TCR_ENABLE )
+    ticks = (vb_now - t->base_time) / ((uint64_t)t->pr + 1u);
+  return (uint32_t)((t->base_tc + ticks) & t->mask);
+}
+
+/**
+ * @brief Counter set to tc now, the Prescaler starts over.
+ */
+static void vb_timer_rebase( vb_timer_t *t, uint32_t tc )
+{
+  t->base_tc = tc & t->mask;
+  t->base_time = vb_now;
+}
+
+/**
+ * @brief Arm the Event at the next Match with an Action.
+ */
+static void vb_timer_arm( vb_timer_t *t )
+{
+  uint64_t ticks, best = VB_NEVER, tick = (uint64_t)t->pr + 1u;
+  uint32_t tc, ch;
+  if( (t->tcr & (VB_TCR_ENABLE | VB_TCR_RESET)) != VB_TCR_ENABLE )
+  {
+    vb_event_cancel(&t->match);
+    return;
+  }
+  tc = vb_timer_tc(t);
+  for( ch = 0; ch < VB_TIMER_CHANNELS; ch++ )
+  {
+    if( !((t->mcr >> (3u * ch)) & 0x7u) )
+      continue;
+    // A match right now was handled, the next one is a full turn away
+    ticks = (t->mr[ch] - tc) & t->mask;
+    if( ticks == 0u )
+      ticks = (uint64_t)t->mask + 1u;
+    if( ticks < best )
+      best = ticks;
+  }
+  if( best == VB_NEVER )
+  {
+    vb_event_cancel(&t->match);
+    return;
+  }
+  // Ticks are counted from base_time, the prescaler phase is kept
+  vb_event_at(&t->match, t->base_time +
+              ((vb_now - t->base_time) / tick + best) * tick);
+}
+
+/**
+ * @brief Match, the Actions of all Channels matching TC.
+ */
+static void vb_timer_fire( vb_event_t *ev )
+{
+  vb_timer_t *t = (vb_timer_t *)ev->owner;
+  uint32_t tc = vb_timer_tc(t), ch, action = 0;
+  for( ch = 0; ch < VB_TIMER_CHANNELS; ch++ )
+  {
+    if( (t->mr[ch] & t->mask) != tc )
+      continue;
+    action |= (t->mcr >> (3u * ch)) & 0x7u;
+    if( (t->mcr >> (3u * ch)) & VB_MCR_INT )
+      t->ir |= 1u << ch;
+  }
+  if( action & VB_MCR_RESET )
+    tc = 0;
+  vb_timer_rebase(t, tc);
+  if( action & VB_MCR_STOP )
+    t->tcr &= ~VB_TCR_ENABLE;
+  vb_irq_line(t->irq, t->ir != 0u);
+  vb_timer_arm(t);
+}
+
+/**
+ * @brief Apply Writes of the Firmware.
+ */
+static void vb_timer_commit( void )
+{
+  vb_timer_t *t;
+  LPC_TMR_TypeDef *r;
+  uint32_t i, changed;
+  for( i = 0; i < VB_TIMERS; i++ )
+  {
+    if( !(touched & (1u << i)) )
+      continue;
+    t = &timers[i];
+    r = &regs[i];
+    changed = 0;
+    if( r->IR != (t->pub_ir | VB_TAG) )
+    {
+      t->ir &= ~r->IR;
+      changed = 1;
+    }
+    if( r->PR != t->pr || r->PC != t->pub_pc )
+    {
+      vb_timer_rebase(t, vb_timer_tc(t));
+      t->pr = r->PR;
+      changed = 1;
+    }
+    if( r->TC != t->pub_tc )
+    {
+      vb_timer_rebase(t, r->TC);
+      changed = 1;
+    }
+    if( r->TCR != t->pub_tcr )
+    {
+      // Counting resumes from the value it had when it stopped
+      vb_timer_rebase(t, ( r->TCR & VB_TCR_RESET ) ? 0u : vb_timer_tc(t));
+      t->tcr = r->TCR & (VB_TCR_ENABLE | VB_TCR_RESET);
+      changed = 1;
+    }
+    if( r->MCR != t->mcr || r->MR0 != t->mr[0] || r->MR1 != t->mr[1] ||
+        r->MR2 != t->mr[2] || r->MR3 != t->mr[3] )
+    {
+      t->mcr = r->MCR;
+      t->mr[0] = r->MR0;
+      t->mr[1] = r->MR1;
+      t->mr[2] = r->MR2;
+      t->mr[3] = r->MR3;
+      changed = 1;
+    }
+    if( changed )
+    {
+      vb_irq_line(t->irq, t->ir != 0u);
+      vb_timer_arm(t);
+    }
+  }
+}
+
+/**
+ * @brief Refresh the Registers read by the Firmware.
+ */
+static void vb_timer_publish( void )
+{
+  vb_timer_t *t;
+  LPC_TMR_TypeDef *r;
+  uint64_t tick;
+  uint32_t i;
+  for( i = 0; i < VB_TIMERS; i++ )
+  {
+    if( !(touched & (1u << i)) )
+      continue;
+    t = &timers[i];
+    r = &regs[i];
+    tick = (uint64_t)t->pr + 1u;
+    t->pub_ir = t->ir;
+    t->pub_tcr = t->tcr;
+    t->pub_tc = vb_timer_tc(t);
+    t->pub_pc = 0;
+    if( (t->tcr & (VB_TCR_ENABLE | VB_TCR_RESET)) == VB_TCR_ENABLE )
+      t->pub_pc = (uint32_t)((vb_now - t->base_time) % tick);
+    r->IR = t->ir | VB_TAG;
+    r->TCR = t->tcr;
+    r->TC = t->pub_tc;
+    r->PC = t->pub_pc;
+  }
+}
+
+/**
+ * @brief Timer Registers, syncs the Board.
+ * @param timer 0 LPC_TMR16B0, 1 LPC_TMR16B1, 2 LPC_TMR32B0, 3 LPC_TMR32B1.
+ */
+LPC_TMR_TypeDef* vboard_timer( uint32_t timer )
+{
+  touched |= 1u << timer;
+  vb_sync(VB_MODEL_TIMER);
+  touched = 1u << timer;
+  return &regs[timer];
+}
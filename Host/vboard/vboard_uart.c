@@ -0,0 +1,364 @@
+/**
+ * @file vboard_uart.c
+ * @author Embedded Laboratory
+ * @brief Virtual Board, UART Model.
+ *
+ * 16 byte FIFOs, the transmitter shifts one byte per character time given by
+ * the divisor latch, fractional divider, UARTCLKDIV and the line control,
+ * sent bytes are collected for the bench. Bytes from the bench arrive one per
+ * character time, the character time-out fires after 4 idle characters. The
+ * THRE interrupt of a byte written to the idle transmitter comes when it is
+ * sent, as on the LPC1343. Modem lines, auto-baud, RS-485 and line errors
+ * other than overrun are not modeled.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "vboard_model.h"
+
+#define VB_UART_FIFO        16u
+#define VB_UART_INPUT       4096u     /**< Bytes queued by the Bench. */
+#define VB_UART_CTI_CHARS   4u        /**< Character Time-Out. */
+
+#define VB_IER_RBR          0x01u
+#define VB_IER_THRE         0x02u
+#define VB_IER_RLS          0x04u
+#define VB_LSR_RDR          0x01u
+#define VB_LSR_OE           0x02u
+#define VB_LSR_THRE         0x20u
+#define VB_LSR_TEMT         0x40u
+#define VB_IIR_NONE         0x01u
+#define VB_IIR_THRE         0x02u
+#define VB_IIR_RDA          0x04u
+#define VB_IIR_RLS          0x06u
+#define VB_IIR_CTI          0x0Cu
+#define VB_IIR_FIFO         0xC0u
+
+static LPC_UART_TypeDef regs;
+
+// Transmitter, a FIFO and the Shift Register
+static uint8_t tx_fifo[VB_UART_FIFO];
+static uint32_t tx_tail, tx_count;
+static uint8_t tx_shift, tx_busy;
+static uint8_t thre_int, thre_delay;
+static vb_event_t tx_event;
+
+// Receiver, Bytes of the Bench enter the FIFO one per Character Time
+static uint8_t rx_fifo[VB_UART_FIFO];
+static uint32_t rx_tail, rx_count;
+static uint8_t rx_input[VB_UART_INPUT];
+static uint32_t input_tail, input_count;
+static uint8_t overrun, cti;
+static vb_event_t rx_event, cti_event;
+
+static uint32_t ier, fcr;
+static uint8_t *output = NULL;
+static uint32_t output_length, output_size;
+
+static void vb_uart_reset( void );
+static void vb_uart_commit( void );
+static void vb_uart_publish( void );
+static uint64_t vb_uart_char_cycles( void );
+static uint32_t vb_uart_iir( void );
+static uint32_t vb_uart_lsr( void );
+static void vb_uart_irq( void );
+static void vb_uart_tx_done( vb_event_t *ev );
+static void vb_uart_rx_byte( vb_event_t *ev );
+static void vb_uart_cti( vb_event_t *ev );
+
+const vb_model_t vb_uart_model =
+{
+  vb_uart_reset, vb_uart_commit, vb_uart_publish
+};
+
+static void vb_uart_reset( void )
+{
+  memset(&regs, 0, sizeof(regs));
+  tx_tail = tx_count = 0;
+  tx_busy = 0;
+  thre_int = thre_delay = 0;
+  rx_tail = rx_count = 0;
+  input_tail = input_count = 0;
+  overrun = cti = 0;
+  ier = fcr = 0;
+  output_length = 0;
+  regs.LCR = 0x03u;
+  regs.DLL = 1u;
+  regs.FDR = 0x10u;
+  vb_event_init(&tx_event, vb_uart_tx_done, NULL);
+  vb_event_init(&rx_event, vb_uart_rx_byte, NULL);
+  vb_event_init(&cti_event, vb_uart_cti, NULL);
+  vb_uart_publish();
+}
+
+/**
+ * @brief Cycles of one Character with Start, Data, Parity and Stop Bits.
+ */
+static uint64_t vb_uart_char_cycles( void )
+{
+  uint64_t divisor = regs.DLM * 256u + regs.DLL;
+  uint32_t bits, mul = (regs.FDR >> 4) & 0x0Fu, divadd = regs.FDR & 0x0Fu;
+  uint32_t clkdiv = vb_syscon.UARTCLKDIV & 0xFFu;
+  bits = 1u + 5u + (regs.LCR & 0x03u) + (( regs.LCR & 0x04u ) ? 2u : 1u) +
+         (( regs.LCR & 0x08u ) ? 1u : 0u);
+  if( divisor == 0u )
+    divisor = 1u;
+  if( mul == 0u )
+    mul = 1u;
+  if( clkdiv == 0u )
+    clkdiv = 1u;
+  return bits * 16u * divisor * clkdiv * (mul + divadd) / mul;
+}
+
+/**
+ * @brief RX Trigger Level of FCR.
+ */
+static uint32_t vb_uart_trigger( void )
+{
+  static const uint8_t level[4] = { 1u, 4u, 8u, 14u };
+  return ( fcr & 0x01u ) ? level[(fcr >> 6) & 0x03u] : 1u;
+}
+
+/**
+ * @brief Interrupt Identification, highest priority first.
+ */
+static uint32_t vb_uart_iir( void )
+{
+  uint32_t id = VB_IIR_NONE;
+  if( (ier & VB_IER_RLS) && overrun )
+    id = VB_IIR_RLS;
+  else if( (ier & VB_IER_RBR) && rx_count >= vb_uart_trigger() )
+    id = VB_IIR_RDA;
+  else if( (ier & VB_IER_RBR) && cti )
+    id = VB_IIR_CTI;
+  else if( (ier & VB_IER_THRE) && thre_int )
+    id = VB_IIR_THRE;
+  return id | (( fcr & 0x01u ) ? VB_IIR_FIFO : 0u);
+}
+
+static uint32_t vb_uart_lsr( void )
+{
+  uint32_t lsr = 0;
+  if( rx_count )
+    lsr |= VB_LSR_RDR;
+  if( overrun )
+    lsr |= VB_LSR_OE;
+  if( tx_count == 0u )
+    lsr |= VB_LSR_THRE;
+  if( tx_count == 0u && !tx_busy )
+    lsr |= VB_LSR_TEMT;
+  return lsr;
+}
+
+static void vb_uart_irq( void )
+{
+  vb_irq_line(UART_IRQn, (vb_uart_iir() & VB_IIR_NONE) == 0u);
+}
+
+/**
+ * @brief Start shifting the next Byte.
+ */
+static void vb_uart_shift( uint8_t byte )
+{
+  tx_shift = byte;
+  tx_busy = 1;
+  vb_event_at(&tx_event, vb_now + vb_uart_char_cycles());
+}
+
+/**
+ * @brief Byte written to THR.
+ */
+static void vb_uart_write( uint8_t byte )
+{
+  thre_int = 0;
+  if( !tx_busy && tx_count == 0u )
+  {
+    thre_delay = 1;
+    vb_uart_shift(byte);
+  }
+  else if( tx_count < VB_UART_FIFO )
+  {
+    tx_fifo[(tx_tail + tx_count) % VB_UART_FIFO] = byte;
+    tx_count++;
+  }
+}
+
+/**
+ * @brief Byte sent, the next one moves from the FIFO to the Shift Register.
+ */
+static void vb_uart_tx_done( vb_event_t *ev )
+{
+  (void)ev;
+  if( output_length == output_size )
+  {
+    output_size = ( output_size ) ? 2u * output_size : 4096u;
+    output = (uint8_t *)realloc(output, output_size);
+    if( output == NULL )
+      vb_fatal("out of memory for the UART output");
+  }
+  output[output_length++] = tx_shift;
+  tx_busy = 0;
+  if( tx_count )
+  {
+    vb_uart_shift(tx_fifo[tx_tail]);
+    tx_tail = (tx_tail + 1u) % VB_UART_FIFO;
+    tx_count--;
+    thre_delay = 0;
+    if( tx_count == 0u )
+      thre_int = 1;
+  }
+  else if( thre_delay )
+  {
+    thre_delay = 0;
+    thre_int = 1;
+  }
+  vb_uart_irq();
+}
+
+/**
+ * @brief Next Byte of the Bench received.
+ */
+static void vb_uart_rx_byte( vb_event_t *ev )
+{
+  uint64_t cycles = vb_uart_char_cycles();
+  (void)ev;
+  if( rx_count < VB_UART_FIFO )
+  {
+    rx_fifo[(rx_tail + rx_count) % VB_UART_FIFO] = rx_input[input_tail];
+    rx_count++;
+  }
+  else
+  {
+    overrun = 1;
+  }
+  input_tail = (input_tail + 1u) % VB_UART_INPUT;
+  input_count--;
+  cti = 0;
+  vb_event_at(&cti_event, vb_now + VB_UART_CTI_CHARS * cycles);
+  if( input_count )
+    vb_event_at(&rx_event, vb_now + cycles);
+  vb_uart_irq();
+}
+
+/**
+ * @brief No Character for the Time-Out while the FIFO holds Bytes.
+ */
+static void vb_uart_cti( vb_event_t *ev )
+{
+  (void)ev;
+  if( rx_count )
+    cti = 1;
+  vb_uart_irq();
+}
+
+/**
+ * @brief Apply Writes of the Firmware.
+ */
+static void vb_uart_commit( void )
+{
+  uint32_t value;
+  if( regs.THR != VB_TAG )
+    vb_uart_write((uint8_t)regs.THR);
+  if( regs.FCR != (fcr & ~0x06u) )
+  {
+    value = regs.FCR;
+    if( value & 0x02u )
+    {
+      rx_count = 0;
+      cti = 0;
+    }
+    if( value & 0x04u )
+      tx_count = 0;
+    fcr = value & 0xC1u;
+  }
+  if( regs.IER != ier )
+  {
+    // Enabled while the FIFO is empty, THRE is pending right away
+    if( (regs.IER & ~ier & VB_IER_THRE) && tx_count == 0u )
+      thre_int = 1;
+    ier = regs.IER & 0x307u;
+  }
+  vb_uart_irq();
+}
+
+static void vb_uart_publish( void )
+{
+  VB_SET(regs.THR, VB_TAG);
+  VB_SET(regs.FCR, fcr & ~0x06u);
+  regs.IER = ier;
+  VB_SET(regs.IIR_v[0], vb_uart_iir());
+  VB_SET(regs.LSR_v[0], vb_uart_lsr());
+  VB_SET(regs.RBR_v[0], ( rx_count ) ? rx_fifo[rx_tail] : 0u);
+}
+
+/**
+ * @brief UART Registers, syncs the Board.
+ */
+LPC_UART_TypeDef* vboard_uart( void )
+{
+  vb_sync(VB_MODEL_UART);
+  return &regs;
+}
+
+/**
+ * @brief Read of RBR, IIR or LSR, syncs the Board and does the Side Effect.
+ * @return Index of the Register in its Array, always 0.
+ */
+uint32_t vboard_uart_read( uint32_t reg )
+{
+  uint32_t value;
+  vb_sync(VB_MODEL_UART);
+  if( reg == VBOARD_UART_RBR )
+  {
+    VB_SET(regs.RBR_v[0], ( rx_count ) ? rx_fifo[rx_tail] : 0u);
+    if( rx_count )
+    {
+      rx_tail = (rx_tail + 1u) % VB_UART_FIFO;
+      rx_count--;
+    }
+    cti = 0;
+    if( rx_count && input_count == 0u )
+      vb_event_at(&cti_event, vb_now + VB_UART_CTI_CHARS *
+                  vb_uart_char_cycles());
+  }
+  else if( reg == VBOARD_UART_IIR )
+  {
+    value = vb_uart_iir();
+    VB_SET(regs.IIR_v[0], value);
+    if( (value & 0x0Fu) == VB_IIR_THRE )
+      thre_int = 0;
+  }
+  else
+  {
+    VB_SET(regs.LSR_v[0], vb_uart_lsr());
+    overrun = 0;
+  }
+  vb_uart_irq();
+  return 0;
+}
+
+/**
+ * @brief Bytes sent by the Firmware since Boot.
+ */
+const uint8_t* vboard_uart_output( uint32_t *length )
+{
+  *length = output_length;
+  return output;
+}
+
+/**
+ * @brief Send Bytes to the Firmware, they arrive at the Baud Rate.
+ */
+void vboard_uart_input( const uint8_t *data, uint32_t length )
+{
+  uint32_t i;
+  for( i = 0; i < length; i++ )
+  {
+    if( input_count == VB_UART_INPUT )
+      vb_fatal("UART input queue full");
+    rx_input[(input_tail + input_count) % VB_UART_INPUT] = data[i];
+    input_count++;
+  }
+  if( input_count && rx_event.when == VB_NEVER )
+    vb_event_at(&rx_event, vb_now + vb_uart_char_cycles());
+}